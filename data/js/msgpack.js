@@ -0,0 +1,71 @@
+// Minimal MessagePack decoder for host WebSocket frames.
+// Covers the subset ArduinoJson emits: nil, bool, ints, floats, str, array, map.
+const MsgPack = (() => {
+    const textDecoder = new TextDecoder();
+
+    function decode(buffer) {
+        const view = new DataView(buffer);
+        let offset = 0;
+
+        function str(length) {
+            const value = textDecoder.decode(new Uint8Array(buffer, offset, length));
+            offset += length;
+            return value;
+        }
+
+        function array(length) {
+            const value = new Array(length);
+            for (let i = 0; i < length; i++) value[i] = read();
+            return value;
+        }
+
+        function map(length) {
+            const value = {};
+            for (let i = 0; i < length; i++) {
+                const key = read();
+                value[key] = read();
+            }
+            return value;
+        }
+
+        function read() {
+            const type = view.getUint8(offset++);
+            let value;
+
+            if (type < 0x80) return type;                       // positive fixint
+            if (type < 0x90) return map(type & 0x0f);           // fixmap
+            if (type < 0xa0) return array(type & 0x0f);         // fixarray
+            if (type < 0xc0) return str(type & 0x1f);           // fixstr
+            if (type >= 0xe0) return type - 0x100;              // negative fixint
+
+            switch (type) {
+                case 0xc0: return null;
+                case 0xc2: return false;
+                case 0xc3: return true;
+                case 0xca: value = view.getFloat32(offset); offset += 4; return value;
+                case 0xcb: value = view.getFloat64(offset); offset += 8; return value;
+                case 0xcc: return view.getUint8(offset++);
+                case 0xcd: value = view.getUint16(offset); offset += 2; return value;
+                case 0xce: value = view.getUint32(offset); offset += 4; return value;
+                case 0xcf: value = Number(view.getBigUint64(offset)); offset += 8; return value;
+                case 0xd0: return view.getInt8(offset++);
+                case 0xd1: value = view.getInt16(offset); offset += 2; return value;
+                case 0xd2: value = view.getInt32(offset); offset += 4; return value;
+                case 0xd3: value = Number(view.getBigInt64(offset)); offset += 8; return value;
+                case 0xd9: return str(view.getUint8(offset++));
+                case 0xda: value = view.getUint16(offset); offset += 2; return str(value);
+                case 0xdb: value = view.getUint32(offset); offset += 4; return str(value);
+                case 0xdc: value = view.getUint16(offset); offset += 2; return array(value);
+                case 0xdd: value = view.getUint32(offset); offset += 4; return array(value);
+                case 0xde: value = view.getUint16(offset); offset += 2; return map(value);
+                case 0xdf: value = view.getUint32(offset); offset += 4; return map(value);
+                default:
+                    throw new Error(`Unsupported MessagePack type 0x${type.toString(16)}`);
+            }
+        }
+
+        return read();
+    }
+
+    return { decode };
+})();
@@ -2,9 +2,13 @@
 let currentLanguage = 'de';
 let translations = {};
 let selectedClients = new Set();
+let knownClients = new Map();
+let statusSequence = 0;
 let websocket = null;
 let reconnectAttempts = 0;
 const MAX_RECONNECT_ATTEMPTS = 5;
+// Receive host messages as MessagePack binary frames instead of JSON text
+const USE_MSGPACK = typeof MsgPack !== 'undefined';
 
 // Training modes configuration
 const trainingModes = [
@@ -39,6 +43,7 @@ function initializeWebSocket() {
     const ws_url = `${protocol}//${window.location.host}/ws`;
     
     websocket = new WebSocket(ws_url);
+    websocket.binaryType = 'arraybuffer';
     websocket.onopen = onWebSocketOpen;
     websocket.onclose = onWebSocketClose;
     websocket.onerror = onWebSocketError;
@@ -49,6 +54,9 @@ function onWebSocketOpen() {
     console.log('WebSocket Connected');
     reconnectAttempts = 0;
     updateConnectionStatus(true);
+    if (USE_MSGPACK) {
+        websocket.send(JSON.stringify({ command: 'setEncoding', encoding: 'msgpack' }));
+    }
     requestClientList();
 }
 
@@ -71,12 +79,19 @@ function onWebSocketError(error) {
 
 function onWebSocketMessage(event) {
     try {
-        const data = JSON.parse(event.data);
+        const data = event.data instanceof ArrayBuffer
+            ? MsgPack.decode(event.data)
+            : JSON.parse(event.data);
         
         switch (data.type) {
             case 'client_list':
+                knownClients = new Map(data.clients.map(client => [client.id, client]));
+                statusSequence = data.seq;
                 updateClientList(data.clients);
                 break;
+            case 'client_delta':
+                applyClientDelta(data);
+                break;
             case 'training_status':
                 updateTrainingStatus(data);
                 break;
@@ -95,7 +110,27 @@ function onWebSocketMessage(event) {
     }
 }
 
+function requestClientList() {
+    websocket.send(JSON.stringify({ command: 'getClients' }));
+}
+
 // Client Management
+function applyClientDelta(delta) {
+    // A gap in the sequence means we missed a delta; resync with a snapshot
+    if (delta.seq !== statusSequence + 1) {
+        requestClientList();
+        return;
+    }
+    statusSequence = delta.seq;
+
+    delta.clients.forEach(changes => {
+        knownClients.set(changes.id, { ...knownClients.get(changes.id), ...changes });
+    });
+    (delta.removed || []).forEach(id => knownClients.delete(id));
+
+    updateClientList(Array.from(knownClients.values()));
+}
+
 function updateClientList(clients) {
     const clientList = document.getElementById('clientList');
     clientList.innerHTML = '';
@@ -178,27 +213,24 @@ function startTraining() {
         brightness: parseInt(document.getElementById('brightness').value)
     };
 
-    selectedClients.forEach(clientId => {
-        const message = {
-            command: 'startTraining',
-            clientId: clientId,
-            config: config
-        };
-        websocket.send(JSON.stringify(message));
-    });
+    // One message: the host starts all selected targets with one packet
+    const message = {
+        command: 'startTraining',
+        clientIds: Array.from(selectedClients),
+        config: config
+    };
+    websocket.send(JSON.stringify(message));
 
     document.getElementById('startTrainingBtn').disabled = true;
     document.getElementById('stopTrainingBtn').disabled = false;
 }
 
 function stopTraining() {
-    selectedClients.forEach(clientId => {
-        const message = {
-            command: 'stopTraining',
-            clientId: clientId
-        };
-        websocket.send(JSON.stringify(message));
-    });
+    const message = {
+        command: 'stopTraining',
+        clientIds: Array.from(selectedClients)
+    };
+    websocket.send(JSON.stringify(message));
 
     document.getElementById('startTrainingBtn').disabled = false;
     document.getElementById('stopTrainingBtn').disabled = true;
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <Arduino.h>
+#include <IPAddress.h>
+#include <array>
+#include <atomic>
+#include "config.h"
+#include "ClockSync.h"
+#include "ErrorHandling.h"
+#include "Metrics.h"
+#include "SeqLock.h"
+#include "TrainingModes.h"
+
+// Per-client state; plain data so it can be snapshotted with SeqLock
+struct ClientState {
+    uint8_t id;
+    uint32_t ip;                         // IPv4 address as stored by IPAddress
+    uint32_t lastSeen;
+    bool isActive;
+    std::array<uint8_t, 3> currentColor;
+    Config::Effects::Type currentEffect;
+    uint8_t brightness;
+    TrainingModes::TrainingConfig training;
+    TrainingModes::TrainingResult results;
+    Error::Code lastError;
+    ClockSync::Estimate clock;           // Not change-tracked, never broadcast
+};
+
+// Fixed-capacity client table indexed directly by client id.
+//
+// Slots are preallocated, so there is no per-client heap allocation.
+// Readers (JSON builders, UDP sends, monitor tasks) take consistent
+// snapshots without locking; writers are serialized by writeMutex.
+//
+// Every writer reports which fields it changed, so the status broadcaster
+// can send only what is new since its last run (lastSeen is not tracked).
+// lastSeen lives next to the slots so touch() can refresh it per packet
+// without the mutex; snapshots pick up the latest value.
+class ClientTable {
+public:
+    static constexpr size_t CAPACITY = Config::Network::MAX_CLIENTS;
+    static_assert(CAPACITY <= 32, "activeMask holds one bit per client");
+
+    enum Field : uint16_t {
+        FIELD_ACTIVE     = 0x01,
+        FIELD_ADDRESS    = 0x02,
+        FIELD_COLOR      = 0x04,
+        FIELD_EFFECT     = 0x08,
+        FIELD_BRIGHTNESS = 0x10,
+        FIELD_TRAINING   = 0x20,
+        FIELD_RESULTS    = 0x40,
+        FIELD_ALL        = 0x7F
+    };
+
+    ClientTable();
+    ~ClientTable();
+
+    static bool isValidId(uint8_t id) { return id < CAPACITY; }
+
+    // Lock-free readers
+    bool read(uint8_t id, ClientState& out) const;
+    uint32_t getActiveMask() const { return activeMask.load(std::memory_order_acquire); }
+    size_t activeCount() const { return __builtin_popcount(getActiveMask()); }
+    const Metrics::Histogram& getWriteWait() const { return writeWait; }
+
+    template <typename Fn>
+    void forEachActive(Fn&& fn) const {
+        ClientState snapshot;
+        uint32_t mask = getActiveMask();
+        while (mask) {
+            uint8_t id = __builtin_ctz(mask);
+            mask &= mask - 1;
+            slots[id].read(snapshot);
+            snapshot.lastSeen = lastSeen[id].load(std::memory_order_relaxed);
+            if (snapshot.isActive) {
+                fn(snapshot);
+            }
+        }
+    }
+
+    // Change tracking; each call hands the pending changes to the caller.
+    // The optional task is notified whenever something becomes dirty.
+    void setChangeListener(TaskHandle_t task) { changeListener = task; }
+    uint32_t takeDirtyMask() { return dirtyMask.exchange(0, std::memory_order_acq_rel); }
+    uint16_t takeDirtyFields(uint8_t id) {
+        return isValidId(id) ? dirtyFields[id].exchange(0, std::memory_order_acq_rel) : 0;
+    }
+
+    // Lock-free refresh for the ingress path: stamps lastSeen if the client
+    // is active at this address already. False means upsert() is needed.
+    bool touch(uint8_t id, const IPAddress& ip, uint32_t now) {
+        if (!isValidId(id) || !(getActiveMask() & (1UL << id)) ||
+            addresses[id].load(std::memory_order_relaxed) != static_cast<uint32_t>(ip)) {
+            return false;
+        }
+        lastSeen[id].store(now, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Writers; return false if the client is unknown or the table is busy.
+    // upsert sets created (if given) when the client was not active before.
+    bool upsert(uint8_t id, const IPAddress& ip, uint32_t now, bool* created = nullptr);
+    bool remove(uint8_t id);
+
+    // fn edits the client in place and returns the Fields it changed. The
+    // slot is copied once, as the seqlock needs; nothing is compared.
+    template <typename Fn>
+    bool update(uint8_t id, Fn&& fn) {
+        if (!isValidId(id) || !(getActiveMask() & (1UL << id))) {
+            return false;
+        }
+        if (!Metrics::take(writeMutex, pdMS_TO_TICKS(100), writeWait)) {
+            return false;
+        }
+        bool updated = false;
+        uint16_t changed = 0;
+        slots[id].write([&](ClientState& client) {
+            if (client.isActive) {
+                changed = fn(client);
+                updated = true;
+            }
+        });
+        xSemaphoreGive(writeMutex);
+        markDirty(id, changed);
+        return updated;
+    }
+
+private:
+    void markDirty(uint8_t id, uint16_t fields);
+
+    std::array<SeqLock<ClientState>, CAPACITY> slots;
+    std::array<std::atomic<uint16_t>, CAPACITY> dirtyFields;
+    std::array<std::atomic<uint32_t>, CAPACITY> lastSeen;
+    std::array<std::atomic<uint32_t>, CAPACITY> addresses;     // Copy of ip for touch()
+    std::atomic<uint32_t> activeMask;
+    std::atomic<uint32_t> dirtyMask;
+    TaskHandle_t changeListener;
+    SemaphoreHandle_t writeMutex;
+    Metrics::Histogram writeWait;       // us spent waiting for writeMutex
+};
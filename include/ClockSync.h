@@ -0,0 +1,44 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Host <-> target clock synchronisation.
+//
+// The host periodically broadcasts TIME_SYNC with its send time t1; each
+// target answers with t1, its receive time t2 and its send time t3, and the
+// host notes the arrival time t4 (all in microseconds, each on its own
+// clock). From that NTP-style exchange we estimate the target's offset and
+// drift relative to the host, so target timestamps (e.g. hits) can be
+// mapped onto the host timeline independent of WiFi jitter and queueing.
+//
+// All times are 32-bit micros() values and may wrap; only differences are
+// used, so the estimate stays valid across wraparound.
+namespace ClockSync {
+    // Plain data so it can live in ClientState
+    struct Estimate {
+        uint32_t offsetUs;         // target clock - host clock (mod 2^32)
+        int32_t driftPpb;          // target clock rate error, parts per billion
+        uint32_t referenceHostUs;  // host time at which offsetUs was valid
+        uint32_t anchorOffsetUs;   // offset at the start of the drift baseline
+        uint32_t anchorHostUs;     // host time at the start of the drift baseline
+        uint32_t minDelayUs;       // best round-trip delay seen (slowly aged)
+        uint32_t lastDelayUs;      // round-trip delay of the last accepted sample
+        uint16_t samples;          // accepted samples
+        uint16_t rejected;         // samples discarded as delayed
+    };
+
+    constexpr size_t SYNC_REQUEST_SIZE = 4;   // t1
+    constexpr size_t SYNC_REPLY_SIZE = 12;    // t1, t2, t3
+
+    // Feeds one exchange into the estimate; returns false if the sample
+    // was rejected because it was delayed well beyond the best seen.
+    bool addSample(Estimate& estimate, uint32_t t1, uint32_t t2, uint32_t t3, uint32_t t4);
+
+    bool isSynced(const Estimate& estimate);
+
+    // Maps a target timestamp onto the host clock
+    uint32_t toHostTime(const Estimate& estimate, uint32_t targetUs);
+
+    // Drift-corrected host duration between two target timestamps
+    uint32_t toHostDuration(const Estimate& estimate, uint32_t fromTargetUs, uint32_t toTargetUs);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <Arduino.h>
+#include <array>
+#include "config.h"
+#include "FrameStream.h"
+
+// Renders every Config::Effects::Type into an 8x8 frame.
+//
+// Integer math only: sine, hue and fire colors come from lookup tables
+// built at compile time, and effects with memory (sparkle, fire, matrix)
+// keep it in a caller-owned State, so rendering never allocates. Frames
+// are row-major, pixel = y * LED_MATRIX_WIDTH + x.
+namespace EffectEngine {
+    using Config::Effects::Type;
+    using FrameStream::Frame;
+    using FrameStream::Rgb;
+
+    struct Params {
+        Type type;
+        Rgb color;              // Base color where the effect uses one
+        uint8_t brightness;
+        uint8_t speed;          // 16 = nominal
+        uint8_t phase;          // Offset so neighbouring targets differ
+    };
+
+    // Per-target effect memory; reset whenever the effect changes
+    struct State {
+        std::array<uint8_t, Config::Hardware::NUM_LEDS> level;
+        std::array<uint8_t, Config::Hardware::LED_MATRIX_WIDTH> column;
+        uint32_t random;
+        Type type;
+
+        void reset(Type effect);
+    };
+
+    void render(const Params& params, uint32_t tick, State& state, Frame& frame);
+
+    // API names ("solid", "rainbow", ...)
+    bool fromName(const char* name, Type& type);
+    const char* name(Type type);
+}
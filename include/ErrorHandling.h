@@ -1,7 +1,7 @@
 #pragma once
 
 #include <Arduino.h>
-#include <string>
+#include <atomic>
 
 namespace Error {
     enum class Code : uint8_t {
@@ -15,31 +15,81 @@ namespace Error {
         MEMORY_ERROR = 7,
         TASK_CREATE_FAILED = 8,
         TRAINING_ERROR = 9,
-        COMMUNICATION_ERROR = 10
+        COMMUNICATION_ERROR = 10,
+        COUNT
     };
-    
+
+    // Interned texts: records carry only the id, the text is looked up
+    // when the log is read
+    enum class Message : uint8_t {
+        NONE = 0,
+        STORAGE_INIT_FAILED,
+        WIFI_INIT_FAILED,
+        UDP_INIT_FAILED,
+        TASK_CREATE_FAILED,
+        WS_CLIENT_LIMIT,            // arg: WebSocket client id
+        WS_INVALID_MESSAGE,         // arg: WebSocket client id
+        WS_CLIENT_ERROR,            // arg: WebSocket client id
+        CLIENT_REPORTED,            // arg: code byte as sent
+        CLIENT_REPORTED_UNKNOWN,    // arg: code byte as sent
+        HISTORY_UNAVAILABLE,
+        DELIVERY_FAILED,            // arg: message type, out of retries
+        COUNT
+    };
+
+    const char* codeName(Code code);
+    const char* messageText(Message message);
+
+    // One log entry; plain data, copied in and out of the ring
     struct ErrorInfo {
+        uint32_t timestamp;         // millis()
+        uint32_t arg;               // Meaning depends on the message
         Code code;
-        std::string message;
-        uint32_t timestamp;
+        Message message;
         uint8_t clientId;
-        
-        ErrorInfo(Code c, const std::string& msg, uint8_t id = 0)
-            : code(c)
-            , message(msg)
-            , timestamp(millis())
-            , clientId(id) {}
     };
-    
+
+    // Error log that is safe to write from any task, callback or ISR.
+    //
+    // Entries go into a fixed ring of LOG_SIZE slots that keeps the newest
+    // ones. A writer takes a ticket with one atomic add and claims its slot
+    // with one compare-and-swap; no lock, no heap, no formatting. If the
+    // slot is still being written by a writer a full lap behind, the entry
+    // is counted as lost instead of waiting. Readers copy a slot and keep
+    // it only if its sequence number did not change meanwhile.
+    //
+    // Per-code counters count every logged error, including those the ring
+    // has already overwritten.
     class ErrorHandler {
     public:
-        static void logError(Code code, const std::string& message, uint8_t clientId = 0);
+        static constexpr size_t LOG_SIZE = 64;
+
+        static void logError(Code code, Message message, uint8_t clientId = 0, uint32_t arg = 0);
         static void clearErrors();
-        static const std::vector<ErrorInfo>& getErrorLog();
+
+        // Up to max entries, oldest first; returns how many were copied
+        static size_t copyErrors(ErrorInfo* out, size_t max);
         static String getErrorJson();
-        
+
+        static uint32_t getCount(Code code);
+        static uint32_t getTotal() { return head.load(std::memory_order_relaxed) - cleared.load(std::memory_order_relaxed); }
+        static uint32_t getLost() { return lost.load(std::memory_order_relaxed); }
+
     private:
-        static std::vector<ErrorInfo> errorLog;
-        static const size_t MAX_LOG_SIZE = 100;
+        static_assert((LOG_SIZE & (LOG_SIZE - 1)) == 0, "LOG_SIZE must be a power of two");
+
+        // sequence is 2 * ticket + 1 while written, 2 * ticket + 2 once done
+        struct Slot {
+            std::atomic<uint32_t> sequence;
+            std::atomic<uint32_t> timestamp;
+            std::atomic<uint32_t> arg;
+            std::atomic<uint32_t> packed;   // code | message << 8 | clientId << 16
+        };
+
+        static Slot slots[LOG_SIZE];
+        static std::atomic<uint32_t> head;      // Next ticket
+        static std::atomic<uint32_t> cleared;   // Tickets before this are hidden
+        static std::atomic<uint32_t> lost;
+        static std::atomic<uint32_t> counts[static_cast<size_t>(Code::COUNT)];
     };
-}
\ No newline at end of file
+}
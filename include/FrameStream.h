@@ -0,0 +1,97 @@
+#pragma once
+
+#include <Arduino.h>
+#include <array>
+#include <atomic>
+#include "config.h"
+#include "LatencyStats.h"
+
+// Host-rendered LED frames streamed to the targets as deltas.
+//
+// Each FRAME record carries only the pixels that changed since the
+// previous frame sent to that target, as runs of either raw RGB or 4-bit
+// palette indices, whichever is smaller. Frames are numbered per target
+// and name the frame they build on; a target that missed one ignores
+// deltas until the next keyframe (all pixels), which every target gets
+// every keyframeInterval frames, staggered so they do not coincide.
+//
+//   Payload
+//     [0]    flags: bit 0 keyframe, bits 1..2 encoding
+//     [1]    frame number
+//     [2]    base frame number (ignored for keyframes)
+//     RGB:      runs of [skip][count][count x R,G,B]
+//     PALETTE:  [n][n x R,G,B], then runs of [skip][count][ceil(count/2) x index pairs]
+namespace FrameStream {
+    constexpr size_t PIXELS = Config::Hardware::NUM_LEDS;
+    constexpr size_t HEADER_SIZE = 3;
+    constexpr size_t MAX_PAYLOAD = HEADER_SIZE + 2 + PIXELS * 3;   // Single RGB run
+    constexpr size_t MAX_PALETTE = 16;
+
+    enum Flags : uint8_t {
+        FLAG_KEYFRAME = 0x01
+    };
+
+    enum Encoding : uint8_t {
+        ENCODING_RGB = 0,
+        ENCODING_PALETTE = 1
+    };
+
+    struct Rgb {
+        uint8_t r;
+        uint8_t g;
+        uint8_t b;
+
+        bool operator==(const Rgb& other) const { return r == other.r && g == other.g && b == other.b; }
+        bool operator!=(const Rgb& other) const { return !(*this == other); }
+    };
+
+    using Frame = std::array<Rgb, PIXELS>;
+
+    // Per-target delta state on the sending side
+    class Encoder {
+    public:
+        Encoder() { reset(); }
+
+        void reset();
+
+        // Encodes frame against the last frame sent; returns the payload
+        // size, or 0 if nothing changed and no keyframe was requested.
+        size_t encode(const Frame& frame, bool keyframe, uint8_t* out);
+
+    private:
+        Frame reference;
+        uint8_t frameNumber;
+        bool hasReference;
+    };
+
+    // Receiving side; applies a payload to the target's current frame.
+    // Returns false if it is a delta on a frame we do not have.
+    bool decode(const uint8_t* payload, size_t len, Frame& current, uint8_t& currentNumber, bool& synced);
+
+    // Counters shared by the stream task and the API
+    class Stats {
+    public:
+        void reset();
+        void recordFrame(uint32_t encodeMicros, size_t targets);
+        void recordPayload(size_t bytes, bool keyframe, Encoding encoding);
+
+        uint32_t getFrames() const { return frames.load(std::memory_order_relaxed); }
+        uint32_t getPayloads() const { return payloads.load(std::memory_order_relaxed); }
+        uint32_t getKeyframes() const { return keyframes.load(std::memory_order_relaxed); }
+        uint32_t getPaletteFrames() const { return paletteFrames.load(std::memory_order_relaxed); }
+        uint64_t getBytes() const { return bytes.load(std::memory_order_relaxed); }
+        uint32_t getTargetFrames() const { return targetFrames.load(std::memory_order_relaxed); }
+        uint32_t getStartedAt() const { return startedAt.load(std::memory_order_relaxed); }
+        const LatencyStats& getEncodeTime() const { return encodeTime; }
+
+    private:
+        std::atomic<uint32_t> frames{0};          // Render ticks
+        std::atomic<uint32_t> targetFrames{0};    // Frames rendered for some target
+        std::atomic<uint32_t> payloads{0};        // Frames actually sent
+        std::atomic<uint32_t> keyframes{0};
+        std::atomic<uint32_t> paletteFrames{0};
+        std::atomic<uint64_t> bytes{0};           // Record payload bytes
+        std::atomic<uint32_t> startedAt{0};       // millis() of the last reset
+        LatencyStats encodeTime;                  // Render + encode per tick
+    };
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <Arduino.h>
+#include <array>
+#include "SessionStore.h"
+
+// Streams the session history as NDJSON or CSV into whatever buffer the
+// web server hands out, for chunked responses of any length.
+//
+// The working set is fixed: one batch of records and one formatted line,
+// which may be split across buffers. Filters are applied by the store
+// while it scans, so non-matching records are never formatted.
+class HistoryExport {
+public:
+    enum class Format : uint8_t {
+        NDJSON,
+        CSV
+    };
+
+    HistoryExport(SessionStore& store, const SessionStore::Query& query, Format format);
+
+    // Fills up to maxLen bytes; returns 0 once everything has been sent,
+    // or while the store is busy (see isDone)
+    size_t fill(uint8_t* buffer, size_t maxLen);
+
+    // False after a 0 from fill means the store's index was locked; the
+    // caller should try again rather than end the download
+    bool isDone() const { return cursor == UINT32_MAX && batchIndex == batchSize && lineOffset == lineLength; }
+
+    uint32_t getRecords() const { return records; }
+
+    static size_t formatLine(const SessionRecord& record, Format format, char* out, size_t size);
+
+private:
+    static constexpr size_t BATCH = 8;
+    static constexpr size_t LINE_SIZE = 256;
+
+    bool nextLine();
+
+    SessionStore& store;
+    SessionStore::Query query;
+    Format format;
+    uint32_t cursor;
+    std::array<SessionRecord, BATCH> batch;
+    size_t batchSize;
+    size_t batchIndex;
+    char line[LINE_SIZE];
+    size_t lineLength;
+    size_t lineOffset;
+    bool headerDone;
+    uint32_t records;
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Walks the elements of a JSON array one at a time and hands each out as
+// a slice of the source text, to be parsed on its own with
+// deserializeJson. A large array thus costs the memory of one element.
+// The array is the text itself or, if the text is an object, its member
+// named key.
+//
+// Only the structure is checked here (strings, nesting, separators); an
+// element's own syntax is checked when it is parsed. Nothing after the
+// array is looked at.
+class JsonItems {
+public:
+    JsonItems(const char* text, size_t length, const char* key);
+
+    // Next element; false at the end of the array or on malformed input
+    bool next(const char*& item, size_t& itemLength);
+
+    // Neither an array nor an object with an array under key
+    bool isMissing() const { return state == State::MISSING; }
+    bool isMalformed() const { return state == State::MALFORMED; }
+
+private:
+    static constexpr size_t NPOS = SIZE_MAX;
+
+    enum class State : uint8_t {
+        ITEMS,
+        END,
+        MISSING,
+        MALFORMED
+    };
+
+    void findArray(const char* key);
+    void enterArray();
+    size_t skipSpace(size_t at) const;
+    size_t skipString(size_t at) const;
+    size_t skipValue(size_t at) const;
+
+    const char* text;
+    size_t length;
+    size_t pos;
+    State state;
+};
@@ -5,13 +5,26 @@
 #include <ESPAsyncWebServer.h>
 #include <AsyncUDP.h>
 #include <ArduinoJson.h>
-#include <SPIFFS.h>
+#include <LittleFS.h>
 #include <memory>
-#include <map>
-#include <queue>
 #include <vector>
 #include "config.h"
+#include "ClientTable.h"
+#include "EffectEngine.h"
 #include "ErrorHandling.h"
+#include "FrameStream.h"
+#include "HistoryExport.h"
+#include "LatencyStats.h"
+#include "MessageRing.h"
+#include "Metrics.h"
+#include "Protocol.h"
+#include "ReliableLink.h"
+#include "SessionStore.h"
+#include "ShotStats.h"
+#include "StaticAssets.h"
+#include "TimerWheel.h"
+#include "Trace.h"
+#include "WsBufferPool.h"
 #include "TrainingModes.h"
 
 class LEDMatrixHost {
@@ -23,25 +36,30 @@ public:
     void loop();
 
 private:
-    struct Client {
-        uint8_t id;
-        IPAddress ip;
-        uint32_t lastSeen;
-        bool isActive;
-        std::array<uint8_t, 3> currentColor;
-        Config::Effects::Type currentEffect;
-        uint8_t brightness;
-        TrainingModes::TrainingConfig training;
-        TrainingModes::TrainingResult results;
-        Error::Code lastError;
-    };
-
+    // Ingress ring slot holding one decoded command record; only as much
+    // payload as the longest handler reads (the clock sync reply)
+    static constexpr size_t MAX_INGRESS_PAYLOAD = ClockSync::SYNC_REPLY_SIZE;
     struct Message {
         Config::MessageType type;
         uint8_t clientId;
-        std::vector<uint8_t> data;
-        uint32_t timestamp;
+        uint16_t length;             // Bytes kept, at most MAX_INGRESS_PAYLOAD
+        uint32_t timestamp;          // micros() at arrival
+        std::array<uint8_t, MAX_INGRESS_PAYLOAD> data;
+    };
+
+    // Ingress dispatch, one route per Config::MessageType a target may
+    // send. Records shorter than minLength are rejected in the UDP
+    // callback; a route without handler only counts as a sign of life.
+    using IngressHandler = void (LEDMatrixHost::*)(const Message& msg);
+    struct IngressRoute {
+        Config::MessageType type;
+        uint8_t minLength;
+        IngressHandler handler;
     };
+    static const IngressRoute* ingressRoute(Config::MessageType type);
+
+    // Dashboard slot: WebSocket client id << 1 | binary flag, 0 = free
+    static constexpr uint32_t DASHBOARD_BINARY = 0x01;
 
     // Server-Komponenten
     AsyncWebServer webServer;
@@ -49,22 +67,98 @@ private:
     AsyncUDP udp;
 
     // Datenverwaltung
-    std::map<uint8_t, std::unique_ptr<Client>> clients;
-    std::queue<Message> messageQueue;
-    
-    // Synchronisation
-    SemaphoreHandle_t clientsMutex;
-    SemaphoreHandle_t messageMutex;
+    ClientTable clients;
+    ShotStatsTable shotStats;
+    MessageRing<Message, Config::Network::MESSAGE_QUEUE_SIZE> messageQueue;
+    std::atomic<uint16_t> txSequence;
+
+    // Opt-in acknowledged delivery; clients whose session was started
+    // reliably get their stop the same way
+    ReliableLink reliable;
+    std::atomic<uint32_t> reliableClients;
     
+    // Verbundene Dashboards und deren Kodierung (JSON oder MessagePack)
+    std::array<std::atomic<uint32_t>, Config::Network::MAX_WEBSOCKET_CLIENTS> dashboards;
+    WsBufferPool wsBuffers;
+
     // Status
     uint8_t wsClientCount;
     bool isInitialized;
+    uint32_t statusSequence;        // Incremented per delta broadcast
+    uint32_t statusBytesSent;
+    uint32_t statusMessagesSent;
+    uint32_t storageMountMs;        // Time LittleFS took to mount, 0 if not mounted
+
+    // Tasks (set by createTasks, notified instead of polled)
+    TaskHandle_t heartbeatTaskHandle;
+    TaskHandle_t processorTaskHandle;
+    TaskHandle_t statusTaskHandle;
+    TaskHandle_t timerTaskHandle;
+    TaskHandle_t storageTaskHandle;
+
+    // Zeitgeber: one timer per kind and client, id = kind * MAX_CLIENTS + client
+    enum TimerKind : uint8_t {
+        TIMER_TRAINING_END = 0,     // training.duration elapsed
+        TIMER_PHASE = 1,            // reactTime window without a hit
+        TIMER_LIVENESS = 2,         // Re-checks lastSeen, expires after CLIENT_TIMEOUT
+        TIMER_RETRANSMIT = 3,       // Earliest unacknowledged reliable command
+        TIMER_KINDS
+    };
+    TimerWheel<TIMER_KINDS * Config::Network::MAX_CLIENTS> timers;
+
+    // Finished sessions on flash, written by the storage task
+    SessionStore history;
+
+    // Web UI from the asset index (owned by webServer), nullptr if the
+    // image has none and files are served raw
+    StaticAssets::Handler* staticAssets;
+
+    // Frame-Streaming (only the stream task touches the encoders)
+    TaskHandle_t streamTaskHandle;
+    std::array<FrameStream::Encoder, Config::Network::MAX_CLIENTS> frameEncoders;
+    std::array<EffectEngine::State, Config::Network::MAX_CLIENTS> effectStates;
+    FrameStream::Stats streamStats;
+    std::atomic<bool> streamEnabled;
+    std::atomic<uint8_t> streamFps;
+    std::atomic<uint8_t> keyframeInterval;
+
+    // End-to-end latency from UDP arrival to processed / sent to dashboards
+    LatencyStats ingressLatency;
+    LatencyStats dashboardLatency;
+
+    // Laufzeitmetriken: updated on the hot paths, the gauges below the
+    // counters are refreshed by sampleMetrics() just before rendering
+    static constexpr size_t MONITORED_TASKS = 6;
+    Metrics::Registry metrics;
+    Metrics::Counter udpRxPackets;
+    Metrics::Counter udpRxBytes;
+    Metrics::Counter udpRxInvalid;
+    Metrics::Counter udpRxRejected;
+    Metrics::Counter udpTxPackets;
+    Metrics::Counter udpTxBytes;
+    Metrics::Counter udpTxErrors;
+    Metrics::Counter wsPublished;
+    Metrics::Histogram jsonSerializeUs;
+    Metrics::Histogram msgpackSerializeUs;
+    Metrics::Gauge queueDepth;
+    Metrics::Gauge queueHighWater;
+    Metrics::Counter queueDropped;
+    Metrics::Gauge wsClients;
+    Metrics::Gauge wsSendQueueMax;
+    Metrics::Gauge heapFree;
+    Metrics::Gauge heapMinFree;
+    Metrics::Gauge heapLargestBlock;
+    std::array<Metrics::Gauge, MONITORED_TASKS> taskStackFree;
+    Metrics::Gauge uptimeSeconds;
+    Metrics::Gauge metricsRenderUs;
+    uint32_t lastMetricsPush;       // Heartbeat task only
 
     // Initialisierungsmethoden
     bool initializeStorage();
     bool initializeWiFi();
     bool initializeUDP();
     bool createTasks();
+    void setupMetrics();
 
     // WebSocket-Handler
     void setupWebSocket();
@@ -72,9 +166,17 @@ private:
                             AwsEventType type, void* arg, uint8_t* data, size_t len);
     void handleWebSocketConnect(AsyncWebSocketClient* client);
     void handleWebSocketDisconnect(AsyncWebSocketClient* client);
-    void handleWebSocketData(void* arg, uint8_t* data, size_t len);
-    void handleWebSocketError(AsyncWebSocketClient* client, void* arg);
-    void processWebSocketMessage(const JsonDocument& doc);
+    void handleWebSocketData(AsyncWebSocketClient* client, void* arg, uint8_t* data, size_t len);
+    void handleWebSocketError(AsyncWebSocketClient* client);
+    void processWebSocketMessage(AsyncWebSocketClient* client, const JsonDocument& doc);
+
+    // WebSocket-Ausgabe
+    bool registerDashboard(uint32_t wsClientId);
+    bool unregisterDashboard(uint32_t wsClientId);
+    void setDashboardEncoding(uint32_t wsClientId, bool binary);
+    AsyncWebSocketSharedBuffer serializeFrame(const JsonDocument& doc, bool binary);
+    void publish(const JsonDocument& doc);
+    void sendTo(AsyncWebSocketClient* client, const JsonDocument& doc);
 
     // Webserver-Setup
     void setupWebServer();
@@ -86,29 +188,74 @@ private:
     void handleTrainingRequest(AsyncWebServerRequest* request);
     void handleStatusRequest(AsyncWebServerRequest* request);
     void handleConfigRequest(AsyncWebServerRequest* request);
+    void handleSystemRequest(AsyncWebServerRequest* request);
+    void handleMetricsRequest(AsyncWebServerRequest* request);
+    void handleTraceRequest(AsyncWebServerRequest* request);
+    void handleStreamRequest(AsyncWebServerRequest* request);
+    void handleHistoryRequest(AsyncWebServerRequest* request);
+    void handleHistoryExport(AsyncWebServerRequest* request);
+    void handleErrorsRequest(AsyncWebServerRequest* request);
+    void handleBatchRequest(AsyncWebServerRequest* request);
+    static TrainingModes::TrainingConfig parseTrainingConfig(JsonVariantConst doc);
+    static uint32_t resolveTargets(JsonVariantConst doc);
+    static bool encodeCommand(Config::MessageType type, JsonVariantConst item, uint8_t* payload, size_t& len);
+    void applyCommand(uint32_t targetMask, Config::MessageType type, const uint8_t* payload);
     
     // UDP-Handler
     void handleUDPPacket(AsyncUDPPacket& packet);
     void processMessage(const Message& msg);
+    void handleStatusReport(const Message& msg);
+    void handleHitEvent(const Message& msg);
+    void handleErrorReport(const Message& msg);
+    void handleAck(const Message& msg);
     
     // Client-Verwaltung
     void updateClientStatus(uint8_t clientId, const IPAddress& ip);
-    void removeInactiveClients();
+    void checkLiveness(uint8_t clientId);
+    void expireClient(uint8_t clientId);
+    void sendTimeSync();
+    void handleTimeSync(const Message& msg);
     void broadcastClientStatus();
+    void broadcastClientSnapshot();
     
     // Training-Verwaltung
-    void startTraining(uint8_t clientId, const TrainingModes::TrainingConfig& config);
-    void stopTraining(uint8_t clientId);
-    void updateTrainingStatus(uint8_t clientId, const TrainingModes::TrainingResult& result);
+    void startTraining(uint32_t targetMask, const TrainingModes::TrainingConfig& config, bool reliableDelivery);
+    void stopTraining(uint32_t targetMask);
+    uint32_t beginTraining(uint32_t targetMask, TrainingModes::TrainingConfig& config);
+    uint32_t endTraining(uint32_t targetMask);
+    void updateTrainingStatus(uint8_t clientId, uint16_t hits, uint16_t misses);
+    void recordHit(uint8_t clientId, uint32_t stimulusUs, uint32_t hitUs, Shot shot);
+    void publishTrainingStatus(const ClientState& client, const ShotStats* stats);
+    void handlePhaseTimeout(uint8_t clientId);
     
     // Hilfsmethoden
+    bool sendCommand(uint8_t clientId, Config::MessageType type, const uint8_t* payload, size_t len);
+    bool sendGroupCommand(uint32_t targetMask, Config::MessageType type, const uint8_t* payload, size_t len);
+    void sendFrame(Protocol::FrameWriter& frame);
     void sendPacketToClient(uint8_t* packet, size_t packetSize, uint8_t clientId);
-    String getClientListJson();
-    String getTrainingStatusJson(uint8_t clientId);
+    void sendReliable(uint32_t targetMask, Config::MessageType type, const uint8_t* payload, size_t len);
+    void sendReliableCommand(uint8_t clientId, const ReliableLink::Command& command);
+    void retransmit(uint8_t clientId);
+    uint16_t nextSequence() { return txSequence.fetch_add(1, std::memory_order_relaxed); }
+    void buildClientList(JsonDocument& doc);
+    static size_t clientListSize(size_t count);
+    static void serializeClient(const ClientState& client, uint16_t fields, JsonObject obj, uint32_t now);
+    static void serializeTrainingStatus(const ClientState& client, JsonObject obj, uint32_t now);
+    static void serializeShotStats(const ShotStats& stats, JsonObject obj, bool detailed);
+    static SessionStore::Query parseHistoryQuery(AsyncWebServerRequest* request);
+    static void serializeSession(const SessionRecord& record, JsonObject obj);
+    void armTimer(TimerKind kind, uint8_t clientId, uint32_t delay);
+    void cancelTimer(TimerKind kind, uint8_t clientId);
+    void renderFrame(const ClientState& client, uint32_t frameIndex, FrameStream::Frame& frame);
+    void handleTimer(uint16_t timerId);
+    void sampleMetrics();
+    void pushMetrics();
     
     // Task-Handler
     static void heartbeatTask(void* parameter);
     static void messageProcessorTask(void* parameter);
     static void statusBroadcastTask(void* parameter);
-    static void trainingMonitorTask(void* parameter);
+    static void timerTask(void* parameter);
+    static void streamTask(void* parameter);
+    static void storageTask(void* parameter);
 };
\ No newline at end of file
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <Arduino.h>
+#include <array>
+#include <atomic>
+
+// Running latency statistics in microseconds with a power-of-two
+// histogram for percentile estimates. Meant for a single writer task;
+// readers may see a sample half-applied, which is fine for reporting.
+class LatencyStats {
+public:
+    static constexpr size_t BUCKETS = 24;   // 1 us .. ~16 s
+
+    void record(uint32_t micros) {
+        count.fetch_add(1, std::memory_order_relaxed);
+        total.fetch_add(micros, std::memory_order_relaxed);
+        if (micros > maximum.load(std::memory_order_relaxed)) {
+            maximum.store(micros, std::memory_order_relaxed);
+        }
+        size_t bucket = micros ? 32 - __builtin_clz(micros) : 0;
+        if (bucket >= BUCKETS) bucket = BUCKETS - 1;
+        histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void reset() {
+        count.store(0, std::memory_order_relaxed);
+        total.store(0, std::memory_order_relaxed);
+        maximum.store(0, std::memory_order_relaxed);
+        for (auto& bucket : histogram) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    uint32_t getCount() const { return count.load(std::memory_order_relaxed); }
+    uint32_t getMax() const { return maximum.load(std::memory_order_relaxed); }
+    uint32_t getMean() const {
+        uint32_t n = getCount();
+        return n ? total.load(std::memory_order_relaxed) / n : 0;
+    }
+
+    // Upper bound of the bucket containing the given percentile
+    uint32_t getPercentile(uint8_t percent) const {
+        uint32_t n = getCount();
+        if (n == 0) {
+            return 0;
+        }
+        uint64_t rank = (static_cast<uint64_t>(n) * percent + 99) / 100;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            seen += histogram[i].load(std::memory_order_relaxed);
+            if (seen >= rank) {
+                return (1UL << i) - 1;
+            }
+        }
+        return getMax();
+    }
+
+private:
+    std::atomic<uint32_t> count{0};
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint32_t> maximum{0};
+    std::array<std::atomic<uint32_t>, BUCKETS> histogram{};
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <Arduino.h>
+#include <array>
+#include <atomic>
+
+// Fixed-capacity single-producer/single-consumer ring.
+//
+// Used for UDP ingress: the AsyncUDP callback is the only producer and
+// messageProcessorTask the only consumer, so head and tail each have exactly
+// one writer and no lock is required. All slots are preallocated; the
+// producer fills a slot in place and the consumer processes it in place.
+template <typename T, size_t Capacity>
+class MessageRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "MessageRing capacity must be a power of two");
+
+public:
+    // Producer: returns the next free slot, or nullptr (and counts a drop)
+    // when the ring is full. The slot becomes visible to the consumer only
+    // after publish().
+    T* acquire() {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= Capacity) {
+            dropCount.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        return &slots[h & (Capacity - 1)];
+    }
+
+    void publish() {
+        uint32_t h = head.load(std::memory_order_relaxed) + 1;
+        head.store(h, std::memory_order_release);
+
+        uint32_t depth = h - tail.load(std::memory_order_relaxed);
+        if (depth > highWater.load(std::memory_order_relaxed)) {
+            highWater.store(depth, std::memory_order_relaxed);
+        }
+    }
+
+    // Consumer: returns the oldest published slot or nullptr when empty.
+    // The slot stays owned by the consumer until pop().
+    T* front() {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return &slots[t & (Capacity - 1)];
+    }
+
+    void pop() {
+        tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Statistics (safe to read from any task)
+    size_t size() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+    static constexpr size_t capacity() { return Capacity; }
+    uint32_t dropped() const { return dropCount.load(std::memory_order_relaxed); }
+    uint32_t highWaterMark() const { return highWater.load(std::memory_order_relaxed); }
+
+private:
+    std::array<T, Capacity> slots;
+    std::atomic<uint32_t> head{0};        // written by producer only
+    std::atomic<uint32_t> tail{0};        // written by consumer only
+    std::atomic<uint32_t> dropCount{0};   // written by producer only
+    std::atomic<uint32_t> highWater{0};   // written by producer only
+};
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <Arduino.h>
+#include <array>
+#include <atomic>
+
+// Runtime metrics: counters, gauges and fixed-bucket histograms that hot
+// paths update with a relaxed atomic or two, plus a registry that renders
+// them on demand.
+//
+// Metrics are plain members of whatever owns them; nothing is allocated
+// when one is updated or registered. Values that live elsewhere (queue
+// depth, heap, stack high-water) are copied into gauges right before
+// rendering instead of being tracked on every change.
+namespace Metrics {
+    class Counter {
+    public:
+        void inc(uint32_t n = 1) { value.fetch_add(n, std::memory_order_relaxed); }
+        // For totals kept elsewhere, copied in when sampling
+        void set(uint32_t n) { value.store(n, std::memory_order_relaxed); }
+        uint32_t get() const { return value.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<uint32_t> value{0};
+    };
+
+    class Gauge {
+    public:
+        void set(int32_t n) { value.store(n, std::memory_order_relaxed); }
+        int32_t get() const { return value.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<int32_t> value{0};
+    };
+
+    // Power-of-two buckets: bucket i counts values <= 2^i - 1, the last one
+    // everything above. Meant for microseconds (0 .. ~16 ms resolved).
+    class Histogram {
+    public:
+        static constexpr size_t BUCKETS = 16;
+
+        void observe(uint32_t value) {
+            size_t bucket = value ? 32 - __builtin_clz(value) : 0;
+            if (bucket >= BUCKETS) bucket = BUCKETS - 1;
+            buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+            sum.fetch_add(value, std::memory_order_relaxed);
+        }
+
+        uint32_t getBucket(size_t i) const { return buckets[i].load(std::memory_order_relaxed); }
+        static uint32_t upperBound(size_t i) { return (1UL << i) - 1; }
+        uint32_t getSum() const { return sum.load(std::memory_order_relaxed); }
+        uint32_t getCount() const {
+            uint32_t n = 0;
+            for (const auto& bucket : buckets) {
+                n += bucket.load(std::memory_order_relaxed);
+            }
+            return n;
+        }
+
+    private:
+        std::array<std::atomic<uint32_t>, BUCKETS> buckets{};
+        std::atomic<uint32_t> sum{0};
+    };
+
+    // Takes a mutex and records how long that took, in microseconds; a
+    // free mutex costs no clock reads
+    inline bool take(SemaphoreHandle_t mutex, TickType_t wait, Histogram& waited) {
+        if (xSemaphoreTake(mutex, 0) == pdTRUE) {
+            waited.observe(0);
+            return true;
+        }
+        uint32_t start = micros();
+        bool taken = xSemaphoreTake(mutex, wait) == pdTRUE;
+        waited.observe(micros() - start);
+        return taken;
+    }
+
+    enum class Type : uint8_t {
+        COUNTER,
+        GAUGE,
+        HISTOGRAM
+    };
+
+    struct Entry {
+        const char* name;           // Prometheus name, shared by all label values
+        const char* help;
+        const char* labelKey;       // nullptr if unlabelled
+        const char* labelValue;
+        Type type;
+        const void* metric;
+    };
+
+    // Fixed list of metrics in registration order; entries sharing a name
+    // must be registered one after another. Registration happens at setup,
+    // rendering from any task.
+    class Registry {
+    public:
+        static constexpr size_t CAPACITY = 48;
+
+        bool add(const char* name, const char* help, const Counter& counter,
+                 const char* labelKey = nullptr, const char* labelValue = nullptr) {
+            return add({name, help, labelKey, labelValue, Type::COUNTER, &counter});
+        }
+        bool add(const char* name, const char* help, const Gauge& gauge,
+                 const char* labelKey = nullptr, const char* labelValue = nullptr) {
+            return add({name, help, labelKey, labelValue, Type::GAUGE, &gauge});
+        }
+        bool add(const char* name, const char* help, const Histogram& histogram,
+                 const char* labelKey = nullptr, const char* labelValue = nullptr) {
+            return add({name, help, labelKey, labelValue, Type::HISTOGRAM, &histogram});
+        }
+
+        size_t size() const { return count; }
+        const Entry& operator[](size_t i) const { return entries[i]; }
+
+        // Prometheus text exposition format 0.0.4
+        void writePrometheus(String& out) const;
+
+    private:
+        bool add(const Entry& entry);
+
+        std::array<Entry, CAPACITY> entries;
+        size_t count = 0;
+    };
+}
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <Arduino.h>
+#include "config.h"
+#include "TrainingModes.h"
+
+// Host <-> target UDP wire protocol.
+//
+// Every datagram is one frame: a fixed header followed by one or more
+// command records, so several commands for one or many targets travel in
+// a single packet. All multi-byte fields are big endian.
+//
+//   Header (8 bytes)
+//     [0]    version
+//     [1]    flags
+//     [2..3] sequence number
+//     [4..5] payload length (bytes following the header)
+//     [6..7] CRC-16/CCITT over header bytes 0..5 and the payload
+//
+//   Record (3 bytes + payload)
+//     [0]    Config::MessageType
+//     [1]    target client id (sender id on ingress, 0xFF = all targets,
+//            0xFE = the targets set in a 32-bit mask leading the payload)
+//     [2]    payload length (including the mask)
+namespace Protocol {
+    constexpr uint8_t VERSION = 1;
+    constexpr size_t HEADER_SIZE = 8;
+    constexpr size_t RECORD_HEADER_SIZE = 3;
+    constexpr size_t MAX_FRAME_SIZE = Config::Network::UDP_BUFFER_SIZE;
+    constexpr size_t MAX_RECORD_PAYLOAD = 255;
+    constexpr uint8_t TARGET_ALL = 0xFF;
+    constexpr uint8_t TARGET_MASK = 0xFE;
+    constexpr size_t MASK_SIZE = 4;
+
+    // FLAG_RELIABLE: the sequence number is the target's own reliable
+    // sequence (see ReliableLink). The target answers with an ACK record
+    // carrying it, every time, but applies the frame only once.
+    enum Flags : uint8_t {
+        FLAG_NONE = 0x00,
+        FLAG_RELIABLE = 0x01
+    };
+
+    // Shortest payloads the host accepts from a target
+    constexpr size_t ACK_SIZE = 2;              // Acknowledged sequence number
+    constexpr size_t STATUS_REPORT_SIZE = 4;    // Hits, misses
+    constexpr size_t HIT_EVENT_SIZE = 8;        // Stimulus time, hit time
+    constexpr size_t HIT_EVENT_FULL_SIZE = 11;  // Plus hit position and round
+    constexpr size_t ERROR_REPORT_SIZE = 1;     // Error code
+
+    struct Header {
+        uint8_t version;
+        uint8_t flags;
+        uint16_t seq;
+        uint16_t length;
+    };
+
+    // View into a record of a received frame; payload points into the
+    // original buffer and is only valid as long as that buffer is.
+    struct Command {
+        Config::MessageType type;
+        uint8_t target;
+        uint8_t length;             // Without the mask
+        const uint8_t* payload;
+        uint32_t mask;              // Addressed targets, one bit per client id
+
+        bool addresses(uint8_t id) const { return id < 32 && (mask >> id) & 1; }
+    };
+
+    uint16_t crc16(const uint8_t* data, size_t len, uint16_t crc = 0xFFFF);
+
+    // Builds a frame in a caller-provided buffer
+    class FrameWriter {
+    public:
+        FrameWriter(uint8_t* buffer, size_t capacity, uint16_t seq, uint8_t flags = FLAG_NONE);
+
+        // Appends a record; returns false (and leaves the frame untouched)
+        // if it does not fit.
+        bool add(Config::MessageType type, uint8_t target, const uint8_t* payload, size_t len);
+
+        // Appends a record for every target in mask; receivers that are
+        // not in it skip the record.
+        bool addMasked(Config::MessageType type, uint32_t mask, const uint8_t* payload, size_t len);
+
+        // Appends a record and returns its payload area for in-place
+        // encoding, or nullptr if it does not fit.
+        uint8_t* append(Config::MessageType type, uint8_t target, size_t len);
+
+        // Writes length and CRC; returns the total frame size.
+        size_t finish();
+        void reset(uint16_t seq);
+
+        bool empty() const { return commands == 0; }
+        size_t commandCount() const { return commands; }
+        size_t remaining() const { return capacity - position; }
+        // Single target of all records, or TARGET_ALL if they differ or
+        // a record addresses a group
+        uint8_t destination() const { return commands && target != TARGET_MASK ? target : TARGET_ALL; }
+        uint8_t* data() { return buffer; }
+
+    private:
+        uint8_t* buffer;
+        size_t capacity;
+        size_t position;
+        size_t commands;
+        uint8_t target;
+    };
+
+    // Validates a frame and iterates its records without copying. The
+    // cheap checks (size, version, length field, at least one record) run
+    // before the CRC, so most garbage is turned away without touching the
+    // payload.
+    class FrameReader {
+    public:
+        FrameReader(const uint8_t* data, size_t len);
+
+        bool isValid() const { return valid; }
+        const Header& header() const { return hdr; }
+        bool next(Command& cmd);
+
+    private:
+        const uint8_t* buffer;
+        size_t end;
+        size_t position;
+        Header hdr;
+        bool valid;
+    };
+
+    // Receiver side of FLAG_RELIABLE: remembers the last 32 sequence
+    // numbers below the highest one seen. Anything older than that counts
+    // as new, so a rebooted host is not ignored.
+    class DuplicateFilter {
+    public:
+        // True if seq has not been seen before; marks it as seen
+        bool accept(uint16_t seq) {
+            int16_t ahead = static_cast<int16_t>(seq - highest);
+            if (!seen || ahead > 0 || ahead < -31) {
+                window = (seen && ahead > 0 && ahead < 32) ? (window << ahead) | 1 : 1;
+                highest = seq;
+                seen = true;
+                return true;
+            }
+            uint32_t bit = 1UL << -ahead;
+            if (window & bit) {
+                return false;
+            }
+            window |= bit;
+            return true;
+        }
+
+    private:
+        uint32_t window = 0;        // Bit i: highest - i seen
+        uint16_t highest = 0;
+        bool seen = false;
+    };
+
+    // Payload encodings. The training config carries the sequence seed and
+    // pattern; targets regenerate the target list with TargetSequence.
+    constexpr size_t TRAINING_CONFIG_SIZE = 15;
+    size_t encodeTrainingConfig(const TrainingModes::TrainingConfig& config, uint8_t* out);
+    bool decodeTrainingConfig(const uint8_t* in, size_t len, TrainingModes::TrainingConfig& config);
+
+    inline void writeU16(uint8_t* out, uint16_t value) {
+        out[0] = (value >> 8) & 0xFF;
+        out[1] = value & 0xFF;
+    }
+
+    inline uint16_t readU16(const uint8_t* in) {
+        return (static_cast<uint16_t>(in[0]) << 8) | in[1];
+    }
+
+    inline void writeU32(uint8_t* out, uint32_t value) {
+        writeU16(out, value >> 16);
+        writeU16(out + 2, value & 0xFFFF);
+    }
+
+    inline uint32_t readU32(const uint8_t* in) {
+        return (static_cast<uint32_t>(readU16(in)) << 16) | readU16(in + 2);
+    }
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <Arduino.h>
+#include <array>
+#include "config.h"
+#include "LatencyStats.h"
+#include "Metrics.h"
+#include "Protocol.h"
+
+// Acknowledged delivery of critical commands (training start and stop)
+// over UDP, next to the fire-and-forget path everything else uses.
+//
+// Each client has its own sequence numbers and a window of WINDOW
+// unacknowledged commands. The host sends a command unicast with
+// Protocol::FLAG_RELIABLE; the target ACKs the sequence number and drops
+// repeats with Protocol::DuplicateFilter. A command that is not ACKed
+// within the retransmission timeout goes out again with the same sequence
+// number. The timeout follows the measured round trip as in RFC 6298
+// (SRTT + 4 * RTTVAR, Karn's rule, doubled per retry) within MIN_RTO and
+// MAX_RTO; after MAX_RETRIES the command is dropped and counted as failed.
+//
+// The link only keeps state; the caller sends, and drives retransmissions
+// from its timer with collectDue(). All methods are safe to call from any
+// task.
+class ReliableLink {
+public:
+    static constexpr size_t CAPACITY = Config::Network::MAX_CLIENTS;
+    static constexpr uint8_t WINDOW = Config::Network::RELIABLE_WINDOW;
+    static constexpr size_t MAX_PAYLOAD = Protocol::TRAINING_CONFIG_SIZE;
+    static constexpr uint32_t IDLE = UINT32_MAX;
+
+    // One command as it goes on the wire
+    struct Command {
+        Config::MessageType type;
+        uint16_t seq;
+        uint8_t length;
+        uint8_t attempt;            // 0 = first transmission
+        bool expired;               // Out of retries, dropped instead of resent
+        uint8_t payload[MAX_PAYLOAD];
+    };
+
+    ReliableLink();
+    ~ReliableLink();
+
+    // Takes a command into the client's window and fills out with what to
+    // send now. False if the window is full or the payload too large.
+    bool submit(uint8_t clientId, Config::MessageType type, const uint8_t* payload, size_t len,
+                uint32_t nowUs, Command& out);
+
+    // ACK from the target at nowUs; false if nothing was waiting for it
+    bool acknowledge(uint8_t clientId, uint16_t seq, uint32_t nowUs);
+
+    // Commands whose timeout has passed, already backed off for the next
+    // round. Returns how many were written to out; nextMs is the delay to
+    // the client's next deadline, IDLE if nothing is left in flight.
+    size_t collectDue(uint8_t clientId, uint32_t nowUs, std::array<Command, WINDOW>& out, uint32_t& nextMs);
+
+    // Delay to the client's next deadline, IDLE if nothing is in flight
+    uint32_t nextTimeout(uint8_t clientId, uint32_t nowUs) const;
+
+    // Drops unacknowledged commands of a type, e.g. a start that a stop
+    // has made obsolete. Returns how many were dropped.
+    size_t cancel(uint8_t clientId, Config::MessageType type);
+
+    // Client gone: forget everything in flight, keep the RTT estimate
+    void reset(uint8_t clientId);
+
+    uint32_t getRtoUs(uint8_t clientId) const;
+    uint8_t getInFlight() const;
+
+    Metrics::Counter& getSent() { return sent; }
+    Metrics::Counter& getDelivered() { return delivered; }
+    Metrics::Counter& getRetransmits() { return retransmits; }
+    Metrics::Counter& getFailed() { return failed; }
+    Metrics::Counter& getSuperseded() { return superseded; }
+    // First transmission to ACK, retransmissions included
+    const LatencyStats& getDeliveryLatency() const { return deliveryLatency; }
+
+private:
+    struct Entry {
+        Command command;
+        uint32_t firstSentUs;
+        uint32_t sentUs;
+        uint32_t deadlineUs;
+        bool used;
+    };
+
+    struct Peer {
+        std::array<Entry, WINDOW> entries;
+        uint16_t nextSeq;
+        uint32_t srttUs;
+        uint32_t rttvarUs;
+        uint32_t rtoUs;
+        bool sampled;               // srttUs/rttvarUs hold a measurement
+    };
+
+    void addSample(Peer& peer, uint32_t rttUs);
+    static uint32_t nextDeadline(const Peer& peer, uint32_t nowUs);
+
+    std::array<Peer, CAPACITY> peers;
+    SemaphoreHandle_t linkMutex;
+
+    Metrics::Counter sent;
+    Metrics::Counter delivered;
+    Metrics::Counter retransmits;
+    Metrics::Counter failed;
+    Metrics::Counter superseded;
+    LatencyStats deliveryLatency;   // Written by the task that handles ACKs
+};
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
+// Double-buffered sequence lock for small trivially copyable values.
+//
+// Writers prepare the next value in the inactive copy and publish it by
+// bumping the version; readers copy the active value and retry only if a
+// second write started during their copy (the first one touches the other
+// copy). A writer that is preempted half-way therefore never stalls a
+// reader, which matters on FreeRTOS where a spinning high-priority reader
+// would otherwise starve it.
+//
+// Readers are lock-free. Writers must be serialized by the caller.
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "SeqLock requires a trivially copyable type");
+
+public:
+    SeqLock() : started(0), version(0) {
+        memset(copies, 0, sizeof(copies));
+    }
+
+    void read(T& out) const {
+        for (;;) {
+            uint32_t before = version.load(std::memory_order_acquire);
+            memcpy(&out, &copies[before & 1], sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            uint32_t after = started.load(std::memory_order_relaxed);
+            // A single write since 'before' went to the other copy
+            if (after - before <= 1) {
+                return;
+            }
+        }
+    }
+
+    // Applies fn to a copy of the current value and publishes the result.
+    template <typename Fn>
+    void write(Fn&& fn) {
+        uint32_t current = version.load(std::memory_order_relaxed);
+        started.store(current + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        T& next = copies[(current + 1) & 1];
+        memcpy(&next, &copies[current & 1], sizeof(T));
+        fn(next);
+        version.store(current + 1, std::memory_order_release);
+    }
+
+    // Number of completed writes; doubles as a change counter.
+    uint32_t getVersion() const {
+        return version.load(std::memory_order_acquire);
+    }
+
+private:
+    T copies[2];
+    std::atomic<uint32_t> started;   // writes begun
+    std::atomic<uint32_t> version;   // writes completed
+};
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <Arduino.h>
+#include <FS.h>
+#include <atomic>
+#include <vector>
+#include "config.h"
+
+// Result of one finished training session, as kept in the history
+struct SessionRecord {
+    enum Flags : uint8_t {
+        FLAG_UPTIME = 0x01      // endedAt counts from boot, the clock was not set
+    };
+
+    uint32_t sequence;          // Assigned by the store, strictly increasing
+    uint32_t endedAt;           // Unix seconds (or uptime seconds, see flags)
+    uint32_t seed;              // Replays the exact target sequence
+    uint32_t durationMs;
+    uint32_t score;
+    uint16_t hits;
+    uint16_t misses;
+    uint16_t avgReactionMs;
+    uint16_t bestReactionMs;
+    uint8_t clientId;
+    uint8_t mode;
+    uint8_t difficulty;
+    uint8_t flags;
+};
+
+// Append-only session history on LittleFS.
+//
+// Records are 32 bytes with a CRC, appended to segment files of
+// SEGMENT_RECORDS each. A segment is named after the sequence number of
+// its first record, the rest follow without gaps, so records need not
+// store their own. Beyond MAX_SEGMENTS the oldest file is deleted.
+// Every append is synced, so a power cut loses at most the record being
+// written. On recovery a record that fails its CRC ends its segment and
+// writing continues in a fresh one, so nothing is ever rewritten.
+//
+// The in-RAM index is one summary per segment (sequence range, time range,
+// client and mode masks); queries read only segments that can match.
+//
+// append() only queues the record and never waits; the storage task
+// writes it with writePending().
+class SessionStore {
+public:
+    static constexpr size_t RECORD_SIZE = 32;
+
+    struct Query {
+        int16_t clientId = -1;      // -1 = any
+        int16_t mode = -1;
+        uint32_t from = 0;          // endedAt range, inclusive
+        uint32_t to = UINT32_MAX;
+    };
+
+    // directory holds the segment files and nothing else
+    explicit SessionStore(fs::FS& fs, const char* directory = Config::Storage::SESSION_DIR);
+    ~SessionStore();
+
+    // Storage task, once before writing: rebuilds the index from flash
+    bool recover();
+
+    // Any task; false if the queue is full (the record is dropped)
+    bool append(const SessionRecord& record);
+
+    // Storage task: writes one queued record, waiting up to wait for it
+    bool writePending(TickType_t wait);
+
+    // Up to max matching records with sequence >= cursor, oldest first.
+    // cursor is moved past the last record examined; it is UINT32_MAX
+    // when nothing is left.
+    size_t query(const Query& query, uint32_t& cursor, SessionRecord* out, size_t max);
+
+    // Everything but the sequence, which follows from the position
+    static void encode(const SessionRecord& record, uint8_t* out);
+    static bool decode(const uint8_t* in, SessionRecord& record);
+
+    bool isReady() const { return ready.load(std::memory_order_acquire); }
+    uint32_t getCount() const;
+    size_t getSegmentCount() const;
+    uint32_t getWritten() const { return written.load(std::memory_order_relaxed); }
+    uint32_t getDropped() const { return dropped.load(std::memory_order_relaxed); }
+    uint32_t getFailed() const { return failed.load(std::memory_order_relaxed); }
+    uint32_t getCorrupt() const { return corrupt; }
+
+private:
+    struct Segment {
+        uint32_t firstSequence;     // Also the file name
+        uint16_t count;
+        bool sealed;                // Full or cut short; never appended to again
+        uint32_t minEndedAt;
+        uint32_t maxEndedAt;
+        uint32_t clientMask;
+        uint32_t modeMask;
+
+        bool mayMatch(const Query& query) const;
+    };
+
+    // On the stack; queries open a segment file per call
+    struct Path {
+        char text[48];
+        operator const char*() const { return text; }
+    };
+
+    Path pathFor(uint32_t firstSequence) const;
+    bool scan(Segment& segment);
+    bool openSegment();
+    void dropOldest();
+    void addToSummary(Segment& segment, const SessionRecord& record);
+
+    fs::FS& fs;
+    const char* directory;
+    QueueHandle_t pending;
+    SemaphoreHandle_t indexMutex;
+    std::vector<Segment> segments;      // Oldest first
+    fs::File active;                    // Storage task only
+    uint32_t nextSequence;
+    uint32_t corrupt;                   // Records cut off by recovery
+    std::atomic<bool> ready{false};
+    std::atomic<uint32_t> written{0};
+    std::atomic<uint32_t> dropped{0};
+    std::atomic<uint32_t> failed{0};
+};
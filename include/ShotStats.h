@@ -0,0 +1,87 @@
+#pragma once
+
+#include <Arduino.h>
+#include <array>
+#include "config.h"
+
+// One hit as reported by a target
+struct Shot {
+    uint32_t reactionUs;    // Stimulus to hit, host-clock corrected
+    uint8_t position;       // row * 8 + column, POSITION_UNKNOWN if not reported
+    uint16_t round;
+};
+
+// Streaming reaction-time statistics for one training session.
+//
+// Every shot is folded in O(1) and the footprint is fixed, so the full
+// distribution is available at any time without keeping the shots:
+// Welford mean/variance, a log histogram with four buckets per octave
+// (percentiles within ~12%), the most recent rounds and an 8x8 hit map.
+class ShotStats {
+public:
+    static constexpr uint8_t MATRIX_SIZE = 8;
+    static constexpr uint8_t POSITION_UNKNOWN = 0xFF;
+    static constexpr size_t ROUND_HISTORY = 16;
+
+    static constexpr uint8_t SUB_BUCKET_BITS = 2;
+    static constexpr uint8_t MIN_EXPONENT = 10;    // Bucket 0 holds everything below ~1 ms
+    static constexpr uint8_t OCTAVES = 12;         // Up to ~4.2 s, clamped above
+    static constexpr size_t BUCKETS = 1 + (OCTAVES << SUB_BUCKET_BITS);
+
+    struct Round {
+        uint16_t number;
+        uint16_t hits;
+        uint32_t sumUs;
+        uint32_t bestUs;
+    };
+
+    void reset();
+    void record(const Shot& shot);
+
+    uint32_t getCount() const { return count; }
+    uint32_t getMin() const { return count ? minUs : 0; }
+    uint32_t getMax() const { return maxUs; }
+    uint32_t getMean() const { return static_cast<uint32_t>(mean + 0.5f); }
+    uint32_t getStdDev() const;
+    uint32_t getPercentile(uint8_t percent) const;
+
+    // Rounds are kept in a ring; only the last ROUND_HISTORY survive
+    uint16_t getLastRound() const { return lastRound; }
+    const Round* getRound(uint16_t number) const;
+
+    uint16_t getHitsAt(uint8_t position) const {
+        return position < heatmap.size() ? heatmap[position] : 0;
+    }
+
+private:
+    static size_t bucketFor(uint32_t micros);
+    static uint32_t bucketMidpoint(size_t bucket);
+
+    uint32_t count;
+    float mean;
+    float m2;                // Sum of squared deviations from the mean
+    uint32_t minUs;
+    uint32_t maxUs;
+    uint16_t lastRound;
+    std::array<uint16_t, BUCKETS> histogram;
+    std::array<Round, ROUND_HISTORY> rounds;
+    std::array<uint16_t, MATRIX_SIZE * MATRIX_SIZE> heatmap;
+};
+
+// Per-client statistics, indexed like ClientTable. Written by the message
+// processor, read by the JSON builders; a short mutex hold covers both.
+class ShotStatsTable {
+public:
+    static constexpr size_t CAPACITY = Config::Network::MAX_CLIENTS;
+
+    ShotStatsTable();
+    ~ShotStatsTable();
+
+    bool reset(uint8_t id);
+    bool record(uint8_t id, const Shot& shot);
+    bool read(uint8_t id, ShotStats& out) const;
+
+private:
+    std::array<ShotStats, CAPACITY> stats;
+    SemaphoreHandle_t statsMutex;
+};
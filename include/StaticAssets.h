@@ -0,0 +1,78 @@
+#pragma once
+
+#include <Arduino.h>
+#include <FS.h>
+#include <ESPAsyncWebServer.h>
+#include <atomic>
+#include <vector>
+
+// Serves the web UI from the gzipped files that scripts/build_assets.py
+// puts into the filesystem image, or links into the firmware.
+//
+// The build lists every asset in /assets.idx, which is read once at boot;
+// requests are matched against that in-RAM index, so serving never probes
+// the filesystem and only opens the file it sends. EMBED_ASSETS builds
+// take index and bytes from the generated EmbeddedAssets.h instead and
+// never touch the filesystem.
+//
+// Responses carry the content hash as ETag and a matching If-None-Match
+// gets a 304. URLs that name the current hash (?v=..., as index.html
+// references its scripts and styles) are immutable; everything else is
+// revalidated on each use.
+namespace StaticAssets {
+    constexpr char MANIFEST[] = "/assets.idx";
+
+    struct Asset {
+        String url;             // "/js/script.js"
+        String path;            // Gzipped file, url + ".gz"
+        String version;         // Content hash
+        String etag;            // Quoted version
+        String mime;
+        uint32_t size;          // Uncompressed
+        uint32_t gzipSize;
+        const uint8_t* data;    // Flash copy, nullptr to read path instead
+    };
+
+    // Row of the table generated for EMBED_ASSETS builds
+    struct EmbeddedAsset {
+        const char* url;
+        const char* version;
+        const char* mime;
+        uint32_t size;
+        uint32_t gzipSize;
+        const uint8_t* data;
+    };
+
+    class Handler : public AsyncWebHandler {
+    public:
+        explicit Handler(fs::FS& fs) : fs(fs) {}
+
+        // Reads the manifest; false if the image was not built with it
+        bool load();
+        // Takes the index from the firmware instead
+        bool load(const EmbeddedAsset* table, size_t count);
+
+        bool canHandle(AsyncWebServerRequest* request) override;
+        void handleRequest(AsyncWebServerRequest* request) override;
+        bool isRequestHandlerTrivial() override { return true; }
+
+        const Asset* find(const String& url) const;
+        size_t count() const { return assets.size(); }
+
+        uint32_t getRequests() const { return requests.load(std::memory_order_relaxed); }
+        uint32_t getNotModified() const { return notModified.load(std::memory_order_relaxed); }
+        uint32_t getBytesSent() const { return bytesSent.load(std::memory_order_relaxed); }
+        uint32_t getBytesSaved() const { return bytesSaved.load(std::memory_order_relaxed); }
+        uint32_t getFirstResponseAt() const { return firstResponseAt.load(std::memory_order_relaxed); }
+
+    private:
+        fs::FS& fs;
+        std::vector<Asset> assets;      // Fixed after load()
+
+        std::atomic<uint32_t> requests{0};
+        std::atomic<uint32_t> notModified{0};
+        std::atomic<uint32_t> bytesSent{0};     // Gzipped bodies
+        std::atomic<uint32_t> bytesSaved{0};    // vs. uncompressed or not re-sent
+        std::atomic<uint32_t> firstResponseAt{0};   // millis() since boot, 0 = none yet
+    };
+}
@@ -0,0 +1,294 @@
+#pragma once
+
+#include <Arduino.h>
+#include <array>
+#include <atomic>
+
+// Hierarchical timer wheel with millisecond ticks.
+//
+// Timers are identified by a caller-chosen id below Capacity and live in a
+// preallocated pool as intrusive list nodes, so arm, re-arm and cancel are
+// O(1) and never allocate. Level 0 has one slot per millisecond for the
+// next 256 ms; each further level covers 64 slots of the level below, up
+// to ~18.6 h. A timer moves down a level at most three times before it
+// fires exactly on its tick.
+//
+// arm() and cancel() are lock-free and safe from any task: they leave the
+// new deadline in the timer's pending slot and flag it, and the owner's
+// advance() applies it. Only the owner calls advance() and touches the
+// wheel itself; the callbacks run there and may re-arm or cancel timers.
+template <size_t Capacity>
+class TimerWheel {
+    static_assert(Capacity < 0xFFFF, "Timer ids are 16 bit");
+
+public:
+    static constexpr uint32_t IDLE = UINT32_MAX;
+
+    TimerWheel() : current(0), armedCount(0), wakeAt(0), idle(true) {
+        for (auto& timer : timers) {
+            timer = Node{NONE, NONE, 0, 0, 0, false};
+        }
+        wheel0.fill(NONE);
+        for (auto& level : upper) {
+            level.fill(NONE);
+        }
+        occupied.fill(0);
+        for (auto& deadline : pending) {
+            deadline.store(CANCELLED, std::memory_order_relaxed);
+        }
+        for (auto& word : pendingIds) {
+            word.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // (Re-)arms a timer to fire delay ms after now. Returns true if it
+    // expires before the owner's planned wake-up, i.e. the owner must be
+    // woken to apply it.
+    bool arm(uint16_t id, uint32_t now, uint32_t delay) {
+        if (id >= Capacity) {
+            return false;
+        }
+        if (delay > MAX_DELAY) delay = MAX_DELAY;
+        uint32_t expires = now + delay;
+        if (expires == CANCELLED) expires++;    // A millisecond late, once every 49 days
+        post(id, expires);
+
+        // advance() publishes its plan before it looks for pending timers
+        // again, so either it sees this one or this sees the new plan
+        if (idle.load(std::memory_order_seq_cst)) {
+            return true;
+        }
+        return static_cast<int32_t>(expires - wakeAt.load(std::memory_order_seq_cst)) < 0;
+    }
+
+    // Never wakes the owner: advance() applies pending changes before it
+    // fires anything. Only an advance() already firing may still call it.
+    void cancel(uint16_t id) {
+        if (id < Capacity) {
+            post(id, CANCELLED);
+        }
+    }
+
+    // Fires every timer due at or before now, calling fn(id) for each, and
+    // returns the ms until the next call is needed (IDLE if none is armed).
+    // Owner only.
+    template <typename Fn>
+    uint32_t advance(uint32_t now, Fn&& fn) {
+        uint32_t delay;
+        do {
+            delay = step(now, fn);
+        } while (hasPending());
+        return delay;
+    }
+
+private:
+    static constexpr uint16_t NONE = 0xFFFF;
+    static constexpr uint32_t CANCELLED = UINT32_MAX;   // Pending deadline that disarms
+    static constexpr size_t PENDING_WORDS = (Capacity + 31) / 32;
+    static constexpr size_t LEVELS = 4;
+    static constexpr uint8_t LEVEL0_BITS = 8;
+    static constexpr uint8_t LEVEL_BITS = 6;
+    static constexpr size_t LEVEL0_SLOTS = 1 << LEVEL0_BITS;
+    static constexpr size_t LEVEL_SLOTS = 1 << LEVEL_BITS;
+    static constexpr uint32_t MAX_DELAY = (1UL << (LEVEL0_BITS + (LEVELS - 1) * LEVEL_BITS)) - 1;
+
+    struct Node {
+        uint16_t next;
+        uint16_t prev;
+        uint32_t expires;
+        uint8_t level;
+        uint8_t slot;
+        bool armed;
+    };
+
+    // The deadline is written before its flag is set and read after the
+    // flag is taken, so the owner sees it or a later one
+    void post(uint16_t id, uint32_t expires) {
+        pending[id].store(expires, std::memory_order_relaxed);
+        pendingIds[id >> 5].fetch_or(1UL << (id & 31), std::memory_order_seq_cst);
+    }
+
+    bool hasPending() const {
+        for (const auto& word : pendingIds) {
+            if (word.load(std::memory_order_seq_cst)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Moves the pending deadlines into the wheel
+    void applyPending(uint32_t now) {
+        if (armedCount == 0) {
+            current = now - 1;  // Nothing to catch up on
+        }
+        for (size_t w = 0; w < PENDING_WORDS; ++w) {
+            uint32_t bits = pendingIds[w].exchange(0, std::memory_order_acquire);
+            while (bits) {
+                uint16_t id = w * 32 + __builtin_ctz(bits);
+                bits &= bits - 1;
+                uint32_t expires = pending[id].load(std::memory_order_relaxed);
+                Node& node = timers[id];
+                if (node.armed) {
+                    unlink(id);
+                    if (expires == CANCELLED) {
+                        node.armed = false;
+                        armedCount--;
+                        continue;
+                    }
+                } else if (expires == CANCELLED) {
+                    continue;
+                } else {
+                    armedCount++;
+                }
+                // Ticks up to current are already processed
+                if (static_cast<int32_t>(expires - current) <= 0) {
+                    expires = current + 1;
+                }
+                node.expires = expires;
+                node.armed = true;
+                link(id);
+            }
+        }
+    }
+
+    template <typename Fn>
+    uint32_t step(uint32_t now, Fn& fn) {
+        std::array<uint16_t, Capacity> due;
+        size_t dueCount = 0;
+
+        applyPending(now);
+        while (static_cast<int32_t>(now - current) > 0) {
+            // Skip empty level-0 stretches up to the next cascade point
+            if (occupiedMask(0) == 0) {
+                uint32_t boundary = current | (LEVEL0_SLOTS - 1);
+                current = static_cast<int32_t>(now - boundary) < 0 ? now : boundary;
+                if (current == now) {
+                    break;
+                }
+            }
+            current++;
+            cascade();
+            uint8_t slot = current & (LEVEL0_SLOTS - 1);
+            while (wheel0[slot] != NONE) {
+                uint16_t id = wheel0[slot];
+                unlink(id);
+                timers[id].armed = false;
+                armedCount--;
+                due[dueCount++] = id;
+            }
+        }
+        uint32_t delay = nextDelay();
+        wakeAt.store(current + delay, std::memory_order_seq_cst);
+        idle.store(delay == IDLE, std::memory_order_seq_cst);
+
+        for (size_t i = 0; i < dueCount; ++i) {
+            fn(due[i]);
+        }
+        return delay;
+    }
+
+    static uint8_t shiftFor(size_t level) {
+        return level == 0 ? 0 : LEVEL0_BITS + (level - 1) * LEVEL_BITS;
+    }
+
+    uint16_t& head(size_t level, size_t slot) {
+        return level == 0 ? wheel0[slot] : upper[level - 1][slot];
+    }
+
+    uint64_t occupiedMask(size_t level) const {
+        return level == 0 ? (occupied[0] | occupied[1] | occupied[2] | occupied[3]) : occupied[3 + level];
+    }
+
+    void setOccupied(size_t level, size_t slot, bool set) {
+        uint64_t& word = level == 0 ? occupied[slot >> 6] : occupied[3 + level];
+        uint64_t bit = 1ULL << (slot & 63);
+        word = set ? (word | bit) : (word & ~bit);
+    }
+
+    void link(uint16_t id) {
+        Node& node = timers[id];
+        uint32_t delta = node.expires - current;
+        size_t level = 0;
+        while (level + 1 < LEVELS && delta >= (1UL << shiftFor(level + 1))) {
+            level++;
+        }
+        size_t mask = level == 0 ? LEVEL0_SLOTS - 1 : LEVEL_SLOTS - 1;
+        size_t slot = (node.expires >> shiftFor(level)) & mask;
+
+        node.slot = slot;
+        node.level = level;
+        node.prev = NONE;
+        node.next = head(level, slot);
+        if (node.next != NONE) {
+            timers[node.next].prev = id;
+        }
+        head(level, slot) = id;
+        setOccupied(level, slot, true);
+    }
+
+    void unlink(uint16_t id) {
+        Node& node = timers[id];
+        if (node.prev != NONE) {
+            timers[node.prev].next = node.next;
+        } else {
+            head(node.level, node.slot) = node.next;
+            if (node.next == NONE) {
+                setOccupied(node.level, node.slot, false);
+            }
+        }
+        if (node.next != NONE) {
+            timers[node.next].prev = node.prev;
+        }
+        node.next = node.prev = NONE;
+    }
+
+    // At each level boundary, redistribute the matching upper slot
+    void cascade() {
+        for (size_t level = 1; level < LEVELS; ++level) {
+            uint32_t lowerMask = (1UL << shiftFor(level)) - 1;
+            if (current & lowerMask) {
+                return;
+            }
+            size_t slot = (current >> shiftFor(level)) & (LEVEL_SLOTS - 1);
+            uint16_t id = head(level, slot);
+            head(level, slot) = NONE;
+            setOccupied(level, slot, false);
+            while (id != NONE) {
+                uint16_t next = timers[id].next;
+                link(id);
+                id = next;
+            }
+        }
+    }
+
+    // Level-0 timers give the exact delay; otherwise wake at the next
+    // cascade point, which is at most 256 ms away
+    uint32_t nextDelay() const {
+        if (armedCount == 0) {
+            return IDLE;
+        }
+        for (uint32_t ahead = 1; ahead <= LEVEL0_SLOTS; ) {
+            size_t slot = (current + ahead) & (LEVEL0_SLOTS - 1);
+            uint64_t word = occupied[slot >> 6] >> (slot & 63);
+            if (word) {
+                return ahead + __builtin_ctzll(word);
+            }
+            ahead += 64 - (slot & 63);
+        }
+        return LEVEL0_SLOTS - (current & (LEVEL0_SLOTS - 1));
+    }
+
+    std::array<Node, Capacity> timers;
+    std::array<uint16_t, LEVEL0_SLOTS> wheel0;
+    std::array<std::array<uint16_t, LEVEL_SLOTS>, LEVELS - 1> upper;
+    std::array<uint64_t, 4 + LEVELS - 1> occupied;   // 4 words for level 0, one per upper level
+    uint32_t current;       // Last processed tick
+    uint16_t armedCount;
+
+    // Shared with arm() and cancel()
+    std::array<std::atomic<uint32_t>, Capacity> pending;    // Latest deadline per timer
+    std::array<std::atomic<uint32_t>, PENDING_WORDS> pendingIds;
+    std::atomic<uint32_t> wakeAt;   // Tick the owner plans to call advance() next
+    std::atomic<bool> idle;
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Hot-path tracing for timeline analysis, compiled in with -DTRACE_ENABLED
+// (pio run -e esp32dev-trace). Without it every macro expands to nothing.
+//
+//   TRACE_SCOPE("udp_rx");                 // Duration of the enclosing block
+//   TRACE_SCOPE_ARG("process", msg.type);  // Same, with a number attached
+//   TRACE_INSTANT("hit", clientId);        // Single point in time
+//
+// Names must be string literals: events keep the pointer. Each core
+// records into its own ring of Config::Trace::EVENTS_PER_CORE events with
+// the CPU cycle counter, so a scope costs two register reads and a few
+// stores. /api/trace dumps the rings as Chrome trace JSON, which
+// chrome://tracing and ui.perfetto.dev open directly.
+#ifdef TRACE_ENABLED
+
+#include <array>
+#include <atomic>
+#include "config.h"
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(name) Trace::Scope TRACE_CONCAT(traceScope, __LINE__)(name, 0)
+#define TRACE_SCOPE_ARG(name, arg) Trace::Scope TRACE_CONCAT(traceScope, __LINE__)(name, arg)
+#define TRACE_INSTANT(name, arg) Trace::record(name, ESP.getCycleCount(), Trace::INSTANT, arg)
+
+namespace Trace {
+    constexpr uint32_t INSTANT = UINT32_MAX;    // Duration marking an instant event
+
+    void record(const char* name, uint32_t startCycles, uint32_t cycles, uint32_t arg);
+
+    class Scope {
+    public:
+        Scope(const char* name, uint32_t arg) : name(name), arg(arg), start(ESP.getCycleCount()) {}
+        ~Scope() { record(name, start, ESP.getCycleCount() - start, arg); }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const char* name;
+        uint32_t arg;
+        uint32_t start;
+    };
+
+    // Streams both rings as Chrome trace JSON into whatever buffer the web
+    // server hands out. Recording is paused while an exporter exists, so
+    // the dump is a consistent picture and does not trace itself.
+    class Exporter {
+    public:
+        Exporter();
+        ~Exporter();
+
+        // Fills up to maxLen bytes; returns 0 once everything has been sent
+        size_t fill(uint8_t* buffer, size_t maxLen);
+
+    private:
+        // The cycle counter and wall clock of one core at the same moment
+        struct Anchor {
+            uint32_t cycles;
+            int64_t micros;
+            TickType_t tick;
+        };
+
+        static void sampleClock(void* anchor);
+        bool nextLine();
+        bool formatEvent(uint32_t ticket);
+
+        std::array<Anchor, portNUM_PROCESSORS> anchors;
+        double cyclesPerMicro;
+        uint8_t core;
+        uint32_t ticket;            // Next event to look at on this core
+        uint32_t end;
+        bool started;
+        bool finished;
+        bool trackNamed;            // Current core's metadata event sent
+        char line[192];
+        size_t lineLength;
+        size_t lineOffset;
+    };
+}
+
+#else
+
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACE_SCOPE_ARG(name, arg) ((void)0)
+#define TRACE_INSTANT(name, arg) ((void)0)
+
+#endif
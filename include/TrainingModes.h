@@ -38,6 +38,8 @@ namespace TrainingModes {
         bool soundEnabled;           // Ton aktiviert
         bool stressorsEnabled;       // Stressfaktoren aktiviert
         uint8_t brightness;          // LED-Helligkeit (0-255)
+        uint32_t timestamp;          // Startzeitpunkt (millis), 0 = inaktiv
+        uint32_t seed;               // Startwert der Zielfolge
         
         // Spezifische Konfigurationen für verschiedene Modi
         struct {
@@ -57,6 +59,70 @@ namespace TrainingModes {
         std::array<uint16_t, 8> roundScores; // Punktzahlen pro Runde
     };
 
+    enum class Pattern : uint8_t {
+        RANDOM = 0,
+        SEQUENCE = 1,
+        WAVE = 2,
+        SPIRAL = 3
+    };
+
+    // Ein einzelnes Ziel der Zielfolge
+    struct Target {
+        uint8_t x;                  // Spalte (0-7)
+        uint8_t y;                  // Zeile (0-7)
+        uint8_t size;               // Kantenlänge in LEDs
+        uint8_t color;              // Farbindex, siehe TargetColor
+        uint8_t flags;              // TargetFlags
+        uint8_t direction;          // Bewegungsrichtung (0-7, 45°-Schritte)
+        uint16_t delay;             // Pause vor dem Erscheinen in Millisekunden
+        uint16_t showTime;          // Sichtbarkeitsdauer in Millisekunden
+    };
+
+    enum TargetColor : uint8_t {
+        COLOR_GREEN = 0,            // Schießen
+        COLOR_RED = 1,              // Nicht schießen
+        COLOR_BLUE = 2,
+        COLOR_YELLOW = 3
+    };
+
+    enum TargetFlags : uint8_t {
+        TARGET_NO_SHOOT = 0x01,     // Treffer zählt als Fehler
+        TARGET_MOVING = 0x02,
+        TARGET_DISTRACTOR = 0x04,   // Ablenkung, kein Ziel
+        TARGET_DIMMED = 0x08        // Reduzierte Helligkeit (Nachtmodus)
+    };
+
+    // Deterministic target sequence for one session.
+    //
+    // Host and targets construct it from the same (mode, difficulty, seed,
+    // targetPattern) and get identical targets, so only those few bytes go
+    // over the air and every session can be replayed from its seed. Uses
+    // xoshiro128** and integer-only geometry, so the sequence does not
+    // depend on compiler or FPU. Targets are produced on demand; the state
+    // is a few bytes regardless of targetCount.
+    class TargetSequence {
+    public:
+        explicit TargetSequence(const TrainingConfig& config);
+
+        bool hasNext() const { return index < count; }
+        Target next();
+        uint16_t position() const { return index; }
+
+    private:
+        uint32_t nextRandom();
+        uint32_t nextBelow(uint32_t bound);
+        void place(Target& target);
+
+        std::array<uint32_t, 4> state;
+        Mode mode;
+        Difficulty difficulty;
+        Pattern pattern;
+        uint16_t count;
+        uint16_t index;
+        uint16_t reactTime;
+        bool stressors;
+    };
+
     class TrainingManager {
     public:
         static TrainingConfig getDefaultConfig(Mode mode, Difficulty diff);
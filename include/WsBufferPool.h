@@ -0,0 +1,46 @@
+#pragma once
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include <array>
+#include <atomic>
+#include "config.h"
+#include "Metrics.h"
+
+// Pool of reusable WebSocket frame buffers.
+//
+// A broadcast is serialized once into a pooled buffer that every recipient
+// queues by reference. The library holds each queued message's reference
+// as a shared_ptr and drops it on async_tcp once the frame is sent; the
+// pool keeps one reference of its own, so a buffer whose use count is back
+// to one is free again. The count is atomic, which makes that check safe
+// from any task.
+//
+// Buffers keep their capacity across uses and are resized to the exact
+// frame length, so repeated messages of similar size allocate nothing.
+class WsBufferPool {
+public:
+    WsBufferPool();
+    ~WsBufferPool();
+
+    // Returns a buffer of exactly size bytes, reserved for the caller
+    // while it holds it. With every pooled buffer in flight, returns a
+    // fresh one the pool does not keep.
+    AsyncWebSocketSharedBuffer acquire(size_t size);
+
+    // Statistics
+    uint32_t getAllocations() const { return allocations.load(std::memory_order_relaxed); }
+    uint32_t getReuses() const { return reuses.load(std::memory_order_relaxed); }
+    uint32_t getExhausted() const { return exhausted.load(std::memory_order_relaxed); }
+    const Metrics::Histogram& getLockWait() const { return lockWait; }
+
+private:
+    bool isIdle(const AsyncWebSocketSharedBuffer& buffer) const;
+
+    std::array<AsyncWebSocketSharedBuffer, Config::Network::WS_BUFFER_POOL_SIZE> slots;
+    SemaphoreHandle_t poolMutex;
+    std::atomic<uint32_t> allocations;
+    std::atomic<uint32_t> reuses;
+    std::atomic<uint32_t> exhausted;
+    Metrics::Histogram lockWait;        // us spent waiting for poolMutex
+};
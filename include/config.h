@@ -33,10 +33,21 @@ namespace Config {
         constexpr uint8_t HOST_ID = 1;
         constexpr uint16_t UDP_PORT = 4210;
         constexpr uint16_t UDP_BUFFER_SIZE = 256;
+        constexpr uint16_t MESSAGE_QUEUE_SIZE = 64;   // Ingress ring slots (power of two)
         constexpr uint16_t WEB_SERVER_PORT = 80;
         constexpr uint8_t MAX_WEBSOCKET_CLIENTS = 8;
         constexpr uint32_t WEBSOCKET_PING_INTERVAL = 5000;  // ms
+        constexpr uint8_t WS_BUFFER_POOL_SIZE = 8;    // Shared outbound frame buffers
         constexpr uint32_t UDP_TIMEOUT = 1000;        // ms
+        constexpr uint8_t MAX_BATCH_COMMANDS = 128;   // Items per /api/batch request
+        
+        // Zuverlässige Zustellung (opt-in für Trainingsstart/-stopp)
+        constexpr bool RELIABLE_TRAINING_COMMANDS = false; // Default when a request does not say
+        constexpr uint8_t RELIABLE_WINDOW = 4;        // Unacknowledged commands per client
+        constexpr uint8_t RELIABLE_MAX_RETRIES = 8;   // Retransmissions before giving up
+        constexpr uint32_t RELIABLE_INITIAL_RTO = 200; // ms, until the first RTT sample
+        constexpr uint32_t RELIABLE_MIN_RTO = 20;     // ms
+        constexpr uint32_t RELIABLE_MAX_RTO = 2000;   // ms, also caps the backoff
         
         // IP Configuration
         constexpr char AP_IP[] = "192.168.4.1";
@@ -66,6 +77,14 @@ namespace Config {
         constexpr uint32_t BUTTON_DEBOUNCE_TIME = 50; // ms
     }
     
+    // Session history on LittleFS
+    namespace Storage {
+        constexpr char SESSION_DIR[] = "/sessions";
+        constexpr uint16_t SEGMENT_RECORDS = 512;          // 16 KB per segment file
+        constexpr uint8_t MAX_SEGMENTS = 24;               // Oldest segment is dropped beyond this
+        constexpr uint8_t SESSION_QUEUE_SIZE = 16;         // Finished sessions waiting to be written
+    }
+    
     // Task Configuration
     namespace Tasks {
         constexpr uint32_t STACK_SIZE = 8192;         // Increased stack size
@@ -73,6 +92,9 @@ namespace Config {
         constexpr uint8_t PRIORITY_MEDIUM = 1;
         constexpr uint8_t PRIORITY_LOW = 0;
         constexpr uint32_t HEARTBEAT_INTERVAL = 2000;      // ms
+        constexpr uint32_t TIME_SYNC_INTERVAL = 500;       // ms between clock sync probes
+        constexpr uint32_t STATUS_MIN_INTERVAL = 20;       // ms between status deltas under load
+        constexpr uint32_t METRICS_PUSH_INTERVAL = 5000;   // ms between metrics pushes to dashboards
         constexpr uint32_t CLIENT_TIMEOUT = 10000;         // ms
         constexpr uint32_t WIFI_RECONNECT_INTERVAL = 5000; // ms
         constexpr uint32_t WATCHDOG_TIMEOUT = 30000;       // ms
@@ -96,6 +118,20 @@ namespace Config {
             SPECTRUM = 7
         };
     }
+
+    // Host-rendered frame streaming
+    namespace Stream {
+        constexpr uint8_t DEFAULT_FPS = 30;
+        constexpr uint8_t MAX_FPS = 60;
+        constexpr uint8_t KEYFRAME_INTERVAL = 30;          // frames, per target
+        constexpr uint8_t PACKET_OVERHEAD = 73;            // Frame/record, UDP/IP and 802.11 headers
+    }
+
+    // Tracing (only with -DTRACE_ENABLED)
+    namespace Trace {
+        constexpr size_t EVENTS_PER_CORE = 512;            // 24 bytes each
+        constexpr uint32_t MAX_EVENT_AGE = 15000;          // ms; older cycle counts may have wrapped
+    }
     
     // Message Types
     enum class MessageType : uint8_t {
@@ -106,27 +142,12 @@ namespace Config {
         STATUS_REQUEST = 0x05,
         CONFIG_UPDATE = 0x06,
         ERROR_REPORT = 0x07,
+        TRAINING_START = 0x08,
+        TRAINING_STOP = 0x09,
+        TIME_SYNC = 0x0A,
+        HIT_EVENT = 0x0B,
+        FRAME = 0x0C,
+        ACK = 0x0D,
         BROADCAST = 0xFF
     };
 }
-
-// Error handling
-namespace Error {
-    enum class Code : uint8_t {
-        NONE = 0,
-        WIFI_CONNECTION_FAILED = 1,
-        UDP_INIT_FAILED = 2,
-        WEBSOCKET_ERROR = 3,
-        INVALID_MESSAGE = 4,
-        HARDWARE_ERROR = 5,
-        AUTHENTICATION_FAILED = 6,
-        MEMORY_ERROR = 7,
-        TASK_CREATE_FAILED = 8
-    };
-    
-    struct ErrorInfo {
-        Code code;
-        const char* message;
-        uint32_t timestamp;
-    };
-}
\ No newline at end of file
@@ -0,0 +1,152 @@
+"""
+Builds the filesystem image contents from data/.
+
+Every asset is stored gzipped (deterministic, mtime 0) and listed in
+/assets.idx, which the host loads once at boot:
+
+    <url> <hash> <mime> <size> <gzip size>
+
+Local scripts and stylesheets referenced from HTML get ?v=<hash>, so the
+browser may cache them for good; everything else is revalidated with its
+ETag.
+
+The same index and bytes are also written as EmbeddedAssets.h, which
+EMBED_ASSETS builds compile into the firmware so the UI is served from
+flash without a filesystem.
+
+Runs as a PlatformIO pre-script (see platformio.ini) or by hand:
+
+    python scripts/build_assets.py [source] [output] [header]
+"""
+
+import gzip
+import hashlib
+import os
+import re
+import shutil
+import sys
+
+MIME_TYPES = {
+    ".html": "text/html",
+    ".css": "text/css",
+    ".js": "application/javascript",
+    ".json": "application/json",
+    ".svg": "image/svg+xml",
+    ".png": "image/png",
+    ".ico": "image/x-icon",
+}
+
+MANIFEST = "assets.idx"
+HEADER = "EmbeddedAssets.h"
+REFERENCE = re.compile(r'(src|href)="(/[^"?#]+)"')
+
+
+def content_hash(data):
+    return hashlib.sha256(data).hexdigest()[:16]
+
+
+def version_references(html, hashes):
+    def replace(match):
+        url = match.group(2)
+        if url not in hashes:
+            return match.group(0)
+        return '%s="%s?v=%s"' % (match.group(1), url, hashes[url])
+    return REFERENCE.sub(replace, html.decode("utf-8")).encode("utf-8")
+
+
+def collect(source):
+    assets = {}
+    for root, _, files in os.walk(source):
+        for name in sorted(files):
+            path = os.path.join(root, name)
+            url = "/" + os.path.relpath(path, source).replace(os.sep, "/")
+            if os.path.splitext(name)[1] not in MIME_TYPES:
+                print("build_assets: skipping %s (unknown type)" % url)
+                continue
+            with open(path, "rb") as f:
+                assets[url] = f.read()
+    return assets
+
+
+def write_header(path, entries):
+    out = [
+        "// Generated by scripts/build_assets.py from data/; do not edit.",
+        "#pragma once",
+        "",
+        '#include "StaticAssets.h"',
+        "",
+        "namespace StaticAssets {",
+    ]
+    for index, (url, _, _, _, packed) in enumerate(entries):
+        out.append("    // %s" % url)
+        out.append("    const uint8_t EMBEDDED_%d[] PROGMEM = {" % index)
+        for offset in range(0, len(packed), 16):
+            row = ", ".join("0x%02x" % b for b in packed[offset:offset + 16])
+            out.append("        %s," % row)
+        out.append("    };")
+    out.append("")
+    out.append("    constexpr EmbeddedAsset EMBEDDED[] = {")
+    for index, (url, version, mime, size, packed) in enumerate(entries):
+        out.append('        {"%s", "%s", "%s", %d, %d, EMBEDDED_%d},'
+                   % (url, version, mime, size, len(packed), index))
+    out.append("    };")
+    out.append("    constexpr size_t EMBEDDED_COUNT = sizeof(EMBEDDED) / sizeof(EMBEDDED[0]);")
+    out.append("}")
+
+    os.makedirs(os.path.dirname(path), exist_ok=True)
+    with open(path, "w") as f:
+        f.write("\n".join(out) + "\n")
+
+
+def build(source, output, header):
+    assets = collect(source)
+
+    # HTML last, so it can name the hashes of everything it references
+    hashes = {url: content_hash(data) for url, data in assets.items() if not url.endswith(".html")}
+    for url, data in assets.items():
+        if url.endswith(".html"):
+            assets[url] = version_references(data, hashes)
+            hashes[url] = content_hash(assets[url])
+
+    if os.path.isdir(output):
+        shutil.rmtree(output)
+    os.makedirs(output)
+
+    lines = []
+    entries = []
+    total_size = total_gzip = 0
+    for url in sorted(assets):
+        data = assets[url]
+        packed = gzip.compress(data, compresslevel=9, mtime=0)
+        target = os.path.join(output, url.lstrip("/") + ".gz")
+        os.makedirs(os.path.dirname(target), exist_ok=True)
+        with open(target, "wb") as f:
+            f.write(packed)
+
+        mime = MIME_TYPES[os.path.splitext(url)[1]]
+        lines.append("%s %s %s %d %d" % (url, hashes[url], mime, len(data), len(packed)))
+        entries.append((url, hashes[url], mime, len(data), packed))
+        total_size += len(data)
+        total_gzip += len(packed)
+        print("build_assets: %-22s %6d -> %5d bytes" % (url, len(data), len(packed)))
+
+    with open(os.path.join(output, MANIFEST), "w") as f:
+        f.write("\n".join(lines) + "\n")
+    write_header(header, entries)
+    print("build_assets: %d assets, %d -> %d bytes" % (len(lines), total_size, total_gzip))
+
+
+try:
+    Import("env")  # noqa: F821 (provided by PlatformIO)
+except NameError:
+    env = None
+
+if env is not None:
+    generated = os.path.join(env.subst("$BUILD_DIR"), "generated")
+    build(os.path.join(env["PROJECT_DIR"], "data"), env.subst("$PROJECT_DATA_DIR"),
+          os.path.join(generated, HEADER))
+    env.Append(CPPPATH=[generated])
+elif __name__ == "__main__":
+    output = sys.argv[2] if len(sys.argv) > 2 else os.path.join(".pio", "assets")
+    build(sys.argv[1] if len(sys.argv) > 1 else "data", output,
+          sys.argv[3] if len(sys.argv) > 3 else os.path.join(".pio", "generated", HEADER))
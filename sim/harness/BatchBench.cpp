@@ -0,0 +1,128 @@
+#include "MicroBench.h"
+#include <ESPAsyncWebServer.h>
+#include <thread>
+#include "Protocol.h"
+#include "Sim.h"
+
+namespace MicroBench {
+    namespace {
+        constexpr uint32_t DEFAULT_UPDATES = 50;
+        constexpr uint32_t DRAIN_MS = 100;      // Processor task catches up
+        constexpr uint8_t CLIENTS = Config::Network::MAX_CLIENTS;
+
+        struct Request {
+            const char* url;
+            String body;
+        };
+
+        // One update gives every target its own color and, with effects,
+        // an effect too; as single requests or as one batch
+        std::vector<Request> build(uint32_t update, bool batch, bool effects) {
+            static const char* EFFECTS[] = {"solid", "rainbow", "fade", "wave"};
+            std::vector<Request> requests;
+            String records;
+            for (uint8_t id = 0; id < CLIENTS; ++id) {
+                char led[48];
+                snprintf(led, sizeof(led), "{\"clientId\":%u,\"color\":\"#%06X\"", id,
+                         (update * 0x10101 + id * 0x30507) & 0xFFFFFF);
+                char effect[48];
+                snprintf(effect, sizeof(effect), "{\"clientId\":%u,\"effect\":\"%s\"", id,
+                         EFFECTS[(update + id) % 4]);
+                if (!batch) {
+                    requests.push_back({"/api/led", String(led) + "}"});
+                    if (effects) {
+                        requests.push_back({"/api/effect", String(effect) + "}"});
+                    }
+                    continue;
+                }
+                records += String(records.length() ? "," : "") + led + ",\"type\":\"led\"}";
+                if (effects) {
+                    records += String(",") + effect + ",\"type\":\"effect\"}";
+                }
+            }
+            if (batch) {
+                requests.push_back({"/api/batch", "{\"commands\":[" + records + "]}"});
+            }
+            return requests;
+        }
+
+        uint64_t metric(const std::string& text, const char* name) {
+            std::string prefix = std::string(name) + " ";
+            size_t at = text.find("\n" + prefix);
+            return at == std::string::npos ? 0 : strtoull(text.c_str() + at + 1 + prefix.size(), nullptr, 10);
+        }
+
+        void sample(uint64_t& datagrams, uint64_t& bytes) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(DRAIN_MS));
+            Sim::HttpResponse response = Sim::Web::request(HTTP_GET, "/api/metrics", String(),
+                                                           Config::Security::API_USERNAME,
+                                                           Config::Security::API_PASSWORD);
+            datagrams = metric(response.body, "udp_tx_packets_total");
+            bytes = metric(response.body, "udp_tx_bytes_total");
+        }
+
+        Row measure(const char* name, bool batch, bool effects, uint32_t updates) {
+            uint64_t datagramsBefore, bytesBefore, datagramsAfter, bytesAfter;
+            sample(datagramsBefore, bytesBefore);
+
+            Clock::time_point phaseStart = Clock::now();
+            uint32_t requests = 0;
+            uint32_t failed = 0;
+            std::vector<uint64_t> updateNs;
+            for (uint32_t update = 0; update < updates; ++update) {
+                std::vector<Request> batchRequests = build(update, batch, effects);
+                Clock::time_point start = Clock::now();
+                for (const Request& request : batchRequests) {
+                    Sim::HttpResponse response = Sim::Web::request(HTTP_POST, request.url, request.body,
+                                                                   Config::Security::API_USERNAME,
+                                                                   Config::Security::API_PASSWORD);
+                    failed += response.code != 200;
+                }
+                updateNs.push_back(nanosSince(start));
+                requests += batchRequests.size();
+            }
+
+            sample(datagramsAfter, bytesAfter);
+            uint64_t datagrams = datagramsAfter - datagramsBefore;
+            uint64_t bytes = bytesAfter - bytesBefore;
+
+            // The host's own heartbeat and clock sync broadcasts keep going;
+            // take off what it sends while idle for as long
+            std::this_thread::sleep_for(std::chrono::nanoseconds(nanosSince(phaseStart)));
+            sample(datagramsBefore, bytesBefore);
+            datagrams -= std::min(datagrams, datagramsBefore - datagramsAfter);
+            bytes -= std::min(bytes, bytesBefore - bytesAfter);
+            double meanMs = 0;
+            for (uint64_t ns : updateNs) {
+                meanMs += ns / 1e6 / updates;
+            }
+            return Row{name, {
+                {"ms/update", meanMs},
+                {"p99 ms", percentile(updateNs, 99) / 1e6},
+                {"requests", static_cast<double>(requests) / updates},
+                {"datagrams", static_cast<double>(datagrams) / updates},
+                {"UDP bytes", static_cast<double>(bytes) / updates},
+                {"failed", static_cast<double>(failed)},
+            }};
+        }
+    }
+
+    std::vector<Row> batch(uint32_t iterations) {
+        uint32_t updates = iterations ? iterations : DEFAULT_UPDATES;
+
+        // Every target known to the host, as in steady operation
+        for (uint8_t id = 0; id < CLIENTS; ++id) {
+            uint8_t buffer[Protocol::MAX_FRAME_SIZE];
+            Protocol::FrameWriter frame(buffer, sizeof(buffer), id);
+            frame.add(Config::MessageType::HEARTBEAT, id, nullptr, 0);
+            Sim::Network::deliverNow(IPAddress(192, 168, 4, id + 10), buffer, frame.finish());
+        }
+
+        return {
+            measure("single, led", false, false, updates),
+            measure("batch, led", true, false, updates),
+            measure("single, led + effect", false, true, updates),
+            measure("batch, led + effect", true, true, updates),
+        };
+    }
+}
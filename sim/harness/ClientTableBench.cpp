@@ -0,0 +1,196 @@
+#include "MicroBench.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <thread>
+#include "ClientTable.h"
+
+namespace MicroBench {
+    namespace {
+        constexpr uint32_t DEFAULT_OPS = 100000;    // Per thread
+        constexpr uint8_t CLIENTS = Config::Network::MAX_CLIENTS;
+
+        // Who uses the table, one thread each: the four FreeRTOS tasks the
+        // table was built for and the HTTP handlers
+        enum class Actor : uint8_t {
+            PROCESSOR,      // Counts a hit, then replies to the target
+            MONITOR,        // Counts a timed-out window (the timer task)
+            HEARTBEAT,      // Looks up one target per send
+            STATUS,         // Snapshots every client for a broadcast
+            HTTP            // Client list, then one target's address for a command
+        };
+        constexpr Actor ACTORS[] = {Actor::PROCESSOR, Actor::MONITOR, Actor::HEARTBEAT, Actor::STATUS, Actor::HTTP};
+
+        // Snapshots of all clients, single-slot reads (as sendPacketToClient
+        // does for every datagram) and hit counts
+        class TableClients {
+        public:
+            TableClients() {
+                for (uint8_t id = 0; id < CLIENTS; ++id) {
+                    table.upsert(id, IPAddress(192, 168, 4, id + 10), 0);
+                }
+            }
+
+            uint32_t readAll() {
+                uint32_t hits = 0;
+                table.forEachActive([&hits](const ClientState& client) { hits += client.results.hits; });
+                return hits;
+            }
+
+            uint32_t readOne(uint8_t id) {
+                ClientState client;
+                return table.read(id, client) ? client.ip : 0;
+            }
+
+            void write(uint8_t id) {
+                table.update(id, [](ClientState& client) -> uint16_t {
+                    client.results.hits++;
+                    return ClientTable::FIELD_RESULTS;
+                });
+            }
+
+        private:
+            ClientTable table;
+        };
+
+        // What the table replaced: heap-allocated clients in a std::map
+        // behind one mutex for readers and writers
+        class MapClients {
+        public:
+            MapClients() : mutex(xSemaphoreCreateMutex()) {
+                for (uint8_t id = 0; id < CLIENTS; ++id) {
+                    std::unique_ptr<ClientState> client(new ClientState());
+                    client->id = id;
+                    client->isActive = true;
+                    clients[id] = std::move(client);
+                }
+            }
+
+            ~MapClients() { vSemaphoreDelete(mutex); }
+
+            uint32_t readAll() {
+                uint32_t hits = 0;
+                xSemaphoreTake(mutex, portMAX_DELAY);
+                for (const auto& entry : clients) {
+                    ClientState snapshot = *entry.second;
+                    hits += snapshot.results.hits;
+                }
+                xSemaphoreGive(mutex);
+                return hits;
+            }
+
+            uint32_t readOne(uint8_t id) {
+                uint32_t ip = 0;
+                xSemaphoreTake(mutex, portMAX_DELAY);
+                auto found = clients.find(id);
+                if (found != clients.end()) {
+                    ip = found->second->ip;
+                }
+                xSemaphoreGive(mutex);
+                return ip;
+            }
+
+            void write(uint8_t id) {
+                xSemaphoreTake(mutex, portMAX_DELAY);
+                auto found = clients.find(id);
+                if (found != clients.end()) {
+                    found->second->results.hits++;
+                }
+                xSemaphoreGive(mutex);
+            }
+
+        private:
+            SemaphoreHandle_t mutex;
+            std::map<uint8_t, std::unique_ptr<ClientState>> clients;
+        };
+
+        struct Samples {
+            std::vector<uint32_t> snapshotNs;
+            std::vector<uint32_t> readNs;
+            std::vector<uint32_t> writeNs;
+        };
+
+        template <typename Fn>
+        void timed(std::vector<uint32_t>& samples, Fn&& fn) {
+            Clock::time_point begin = Clock::now();
+            fn();
+            samples.push_back(nanosSince(begin));
+        }
+
+        template <typename Clients>
+        Row measure(const char* variant, uint32_t ops) {
+            Clients clients;
+            constexpr size_t ACTOR_COUNT = sizeof(ACTORS) / sizeof(ACTORS[0]);
+            std::vector<Samples> samples(ACTOR_COUNT);
+            std::atomic<uint32_t> sink(0);
+
+            Clock::time_point start = Clock::now();
+            std::vector<std::thread> threads;
+            for (size_t a = 0; a < ACTOR_COUNT; ++a) {
+                threads.emplace_back([&, a] {
+                    Samples& own = samples[a];
+                    own.snapshotNs.reserve(ops);
+                    own.readNs.reserve(ops);
+                    own.writeNs.reserve(ops);
+                    uint32_t seen = 0;
+                    for (uint32_t i = 0; i < ops; ++i) {
+                        uint8_t id = (i + a * 7) % CLIENTS;
+                        switch (ACTORS[a]) {
+                            case Actor::PROCESSOR:
+                                timed(own.writeNs, [&] { clients.write(id); });
+                                timed(own.readNs, [&] { seen += clients.readOne(id); });
+                                break;
+                            case Actor::MONITOR:
+                                timed(own.writeNs, [&] { clients.write(id); });
+                                break;
+                            case Actor::HEARTBEAT:
+                                timed(own.readNs, [&] { seen += clients.readOne(id); });
+                                break;
+                            case Actor::STATUS:
+                                timed(own.snapshotNs, [&] { seen += clients.readAll(); });
+                                break;
+                            case Actor::HTTP:
+                                if (i & 1) {
+                                    timed(own.readNs, [&] { seen += clients.readOne(id); });
+                                } else {
+                                    timed(own.snapshotNs, [&] { seen += clients.readAll(); });
+                                }
+                                break;
+                        }
+                    }
+                    sink.fetch_add(seen, std::memory_order_relaxed);
+                });
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+            double seconds = nanosSince(start) / 1e9;
+
+            Samples all;
+            for (const auto& own : samples) {
+                all.snapshotNs.insert(all.snapshotNs.end(), own.snapshotNs.begin(), own.snapshotNs.end());
+                all.readNs.insert(all.readNs.end(), own.readNs.begin(), own.readNs.end());
+                all.writeNs.insert(all.writeNs.end(), own.writeNs.begin(), own.writeNs.end());
+            }
+            return Row{variant, {
+                {"snapshots/s", all.snapshotNs.size() / seconds},
+                {"snapshot p50 ns", static_cast<double>(percentile(all.snapshotNs, 50))},
+                {"snapshot p99 ns", static_cast<double>(percentile(all.snapshotNs, 99))},
+                {"read p50 ns", static_cast<double>(percentile(all.readNs, 50))},
+                {"read p99 ns", static_cast<double>(percentile(all.readNs, 99))},
+                {"write p50 ns", static_cast<double>(percentile(all.writeNs, 50))},
+                {"write p99 ns", static_cast<double>(percentile(all.writeNs, 99))},
+            }};
+        }
+    }
+
+    std::vector<Row> clientTable(uint32_t iterations) {
+        uint32_t ops = iterations ? iterations : DEFAULT_OPS;
+        return {
+            measure<TableClients>("ClientTable (SeqLock)", ops),
+            measure<MapClients>("std::map + mutex", ops),
+        };
+    }
+}
@@ -0,0 +1,40 @@
+#include "MicroBench.h"
+#include "EffectEngine.h"
+
+namespace MicroBench {
+    namespace {
+        constexpr uint32_t DEFAULT_FRAMES = 200000;
+        constexpr uint8_t EFFECTS = 8;
+
+        Row measure(EffectEngine::Type type, uint32_t frames) {
+            EffectEngine::Params params = {type, {255, 96, 0}, 200, 16, 0};
+            EffectEngine::State state;
+            state.reset(type);
+            EffectEngine::Frame frame;
+
+            volatile uint8_t sink = 0;
+            Clock::time_point start = Clock::now();
+            for (uint32_t tick = 0; tick < frames; ++tick) {
+                EffectEngine::render(params, tick, state, frame);
+                sink = sink + frame[tick % frame.size()].r;
+            }
+            double us = nanosSince(start) / 1e3 / frames;
+
+            // Share of one core to stream it to every target at the default rate
+            double load = us * Config::Network::MAX_CLIENTS * Config::Stream::DEFAULT_FPS / 1e4;
+            return Row{EffectEngine::name(type), {
+                {"us/frame", us},
+                {"% core, all targets", load},
+            }};
+        }
+    }
+
+    std::vector<Row> effects(uint32_t iterations) {
+        uint32_t frames = iterations ? iterations : DEFAULT_FRAMES;
+        std::vector<Row> rows;
+        for (uint8_t i = 0; i < EFFECTS; ++i) {
+            rows.push_back(measure(static_cast<EffectEngine::Type>(i), frames));
+        }
+        return rows;
+    }
+}
@@ -0,0 +1,130 @@
+#include "MicroBench.h"
+#include <LittleFS.h>
+#include <memory>
+#include "SessionStore.h"
+#include "Sim.h"
+
+namespace MicroBench {
+    namespace {
+        constexpr uint32_t DEFAULT_RECORDS = 10000;    // Of the 12288 the store keeps
+        constexpr char DIRECTORY[] = "/bench_sessions";    // Next to the host's own history
+        constexpr uint32_t SESSION_SPACING = 30;            // Seconds between finished sessions
+        constexpr uint32_t EPOCH = 1700000000;
+        constexpr size_t BATCH = 8;                         // As HistoryExport reads
+
+        // Leaves the directory as the bench found it: absent
+        void clear() {
+            std::vector<String> paths;
+            File dir = LittleFS.open(DIRECTORY);
+            if (dir && dir.isDirectory()) {
+                for (File file = dir.openNextFile(); file; file = dir.openNextFile()) {
+                    const char* name = file.name();
+                    const char* slash = strrchr(name, '/');
+                    paths.push_back(String(DIRECTORY) + "/" + (slash ? slash + 1 : name));
+                }
+            }
+            dir.close();
+            for (const String& path : paths) {
+                LittleFS.remove(path);
+            }
+            LittleFS.rmdir(DIRECTORY);
+        }
+
+        SessionRecord record(uint32_t i) {
+            SessionRecord record = {};
+            record.endedAt = EPOCH + i * SESSION_SPACING;
+            record.seed = i * 2654435761u;
+            record.durationMs = 60000;
+            record.score = 1000 + i % 700;
+            record.hits = 40 + i % 20;
+            record.misses = i % 7;
+            record.avgReactionMs = 350 + i % 100;
+            record.bestReactionMs = 210 + i % 40;
+            record.clientId = i % Config::Network::MAX_CLIENTS;
+            record.mode = i % 4;
+            record.difficulty = i % 3;
+            return record;
+        }
+
+        // Every record is queued and written with its sync, as the
+        // storage task does
+        Row append(SessionStore& store, uint32_t records) {
+            std::vector<uint64_t> writeNs;
+            writeNs.reserve(records);
+            uint32_t failed = 0;
+            uint64_t allocations = Sim::threadAllocations();
+            Clock::time_point start = Clock::now();
+            for (uint32_t i = 0; i < records; ++i) {
+                Clock::time_point one = Clock::now();
+                store.append(record(i));
+                failed += !store.writePending(0);
+                writeNs.push_back(nanosSince(one));
+            }
+            double seconds = nanosSince(start) / 1e9;
+            allocations = Sim::threadAllocations() - allocations;
+            return Row{"append + sync", {
+                {"writes/s", records / seconds},
+                {"p99 us", percentile(writeNs, 99) / 1e3},
+                {"allocs/write", static_cast<double>(allocations) / records},
+                {"segments", static_cast<double>(store.getSegmentCount())},
+                {"failed", static_cast<double>(failed)},
+            }};
+        }
+
+        // One full pass in exporter-sized batches, timed per call
+        Row query(SessionStore& store, const char* name, const SessionStore::Query& filter, uint32_t passes) {
+            std::vector<uint64_t> callNs;
+            callNs.reserve(passes * (store.getCount() / BATCH + 2));
+            uint32_t found = 0;
+            uint64_t allocations = 0;
+            Clock::time_point start = Clock::now();
+            for (uint32_t pass = 0; pass < passes; ++pass) {
+                SessionRecord out[BATCH];
+                uint32_t cursor = 0;
+                while (cursor != UINT32_MAX) {
+                    uint64_t before = Sim::threadAllocations();
+                    Clock::time_point one = Clock::now();
+                    found += store.query(filter, cursor, out, BATCH);
+                    callNs.push_back(nanosSince(one));
+                    allocations += Sim::threadAllocations() - before;
+                }
+            }
+            double passMs = nanosSince(start) / 1e6 / passes;
+            double meanUs = 0;
+            for (uint64_t ns : callNs) {
+                meanUs += ns / 1e3 / callNs.size();
+            }
+            return Row{name, {
+                {"us/call", meanUs},
+                {"p99 us", percentile(callNs, 99) / 1e3},
+                {"ms/pass", passMs},
+                {"records", static_cast<double>(found) / passes},
+                {"allocs/call", static_cast<double>(allocations) / callNs.size()},
+            }};
+        }
+    }
+
+    std::vector<Row> history(uint32_t iterations) {
+        uint32_t records = iterations ? iterations : DEFAULT_RECORDS;
+        clear();
+        std::unique_ptr<SessionStore> store(new SessionStore(LittleFS, DIRECTORY));
+        store->recover();
+
+        std::vector<Row> rows;
+        rows.push_back(append(*store, records));
+
+        SessionStore::Query all;
+        SessionStore::Query client;
+        client.clientId = 7;
+        // Only the newest segment can match; the index skips the rest
+        SessionStore::Query lastHour;
+        lastHour.from = EPOCH + records * SESSION_SPACING - 3600;
+        rows.push_back(query(*store, "query, all", all, 5));
+        rows.push_back(query(*store, "query, one client", client, 5));
+        rows.push_back(query(*store, "query, last hour", lastHour, 20));
+
+        store.reset();
+        clear();
+        return rows;
+    }
+}
@@ -0,0 +1,130 @@
+#include "IngressBench.h"
+#include <ESPAsyncWebServer.h>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+#include "Protocol.h"
+#include "Sim.h"
+
+namespace IngressBench {
+    namespace {
+        constexpr uint32_t DRAIN_MS = 100;      // Processor task catches up between kinds
+        // Untimed gap after each round of one datagram per sender, so
+        // queued kinds measure the ingress path and not a full ring
+        constexpr uint32_t ROUND_GAP_US = 500;
+
+        struct Packet {
+            std::vector<uint8_t> data;
+            IPAddress from;
+        };
+
+        struct Kind {
+            const char* name;
+            bool valid;
+            Config::MessageType type;
+            uint8_t length;
+            bool foreignSender;                 // Sender id TARGET_ALL instead of 0..31
+            std::function<void(std::vector<uint8_t>&)> damage;
+        };
+
+        // One datagram per client id, addressed like SimTarget's
+        std::vector<Packet> build(const Kind& kind) {
+            std::vector<Packet> packets;
+            uint8_t payload[Protocol::MAX_RECORD_PAYLOAD] = {};
+            for (uint8_t id = 0; id < Config::Network::MAX_CLIENTS; ++id) {
+                uint8_t buffer[Protocol::MAX_FRAME_SIZE];
+                Protocol::FrameWriter frame(buffer, sizeof(buffer), id);
+                frame.add(kind.type, kind.foreignSender ? Protocol::TARGET_ALL : id, payload, kind.length);
+                Packet packet{std::vector<uint8_t>(buffer, buffer + frame.finish()),
+                              IPAddress(192, 168, 4, id + 10)};
+                if (kind.damage) {
+                    kind.damage(packet.data);
+                }
+                packets.push_back(std::move(packet));
+            }
+            return packets;
+        }
+
+        template <typename Fn>
+        double nsPerPacket(const std::vector<Packet>& packets, uint32_t count, bool paced, Fn&& fn) {
+            std::chrono::duration<double, std::nano> elapsed(0);
+            for (uint32_t done = 0; done < count;) {
+                auto start = std::chrono::steady_clock::now();
+                for (size_t i = 0; i < packets.size() && done < count; ++i, ++done) {
+                    fn(packets[i]);
+                }
+                elapsed += std::chrono::steady_clock::now() - start;
+                if (paced) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(ROUND_GAP_US));
+                }
+            }
+            return elapsed.count() / count;
+        }
+
+        uint64_t metric(const std::string& text, const char* name) {
+            std::string prefix = std::string(name) + " ";
+            size_t at = text.find("\n" + prefix);
+            return at == std::string::npos ? 0 : strtoull(text.c_str() + at + 1 + prefix.size(), nullptr, 10);
+        }
+
+        // Host counters that move per kind: rejected datagrams plus
+        // records, and ring drops
+        void sample(uint64_t& rejected, uint64_t& dropped) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(DRAIN_MS));
+            Sim::HttpResponse response = Sim::Web::request(HTTP_GET, "/api/metrics", String(),
+                                                           Config::Security::API_USERNAME,
+                                                           Config::Security::API_PASSWORD);
+            rejected = metric(response.body, "udp_rx_invalid_total") + metric(response.body, "udp_rx_rejected_total");
+            dropped = metric(response.body, "message_queue_dropped_total");
+        }
+    }
+
+    std::vector<Result> run(uint32_t packets) {
+        using Type = Config::MessageType;
+        const std::vector<Kind> kinds = {
+            {"heartbeat", true, Type::HEARTBEAT, 0, false, nullptr},
+            {"status", true, Type::STATUS_REQUEST, Protocol::STATUS_REPORT_SIZE, false, nullptr},
+            {"ack", true, Type::ACK, Protocol::ACK_SIZE, false, nullptr},
+            {"runt", false, Type::HEARTBEAT, 0, false, [](std::vector<uint8_t>& d) { d.resize(4); }},
+            {"bad version", false, Type::HEARTBEAT, 0, false, [](std::vector<uint8_t>& d) { d[0]++; }},
+            {"truncated", false, Type::STATUS_REQUEST, Protocol::STATUS_REPORT_SIZE, false,
+             [](std::vector<uint8_t>& d) { d.pop_back(); }},
+            {"bad crc", false, Type::STATUS_REQUEST, Protocol::STATUS_REPORT_SIZE, false,
+             [](std::vector<uint8_t>& d) { d.back() ^= 0x01; }},
+            {"unknown type", false, Type::LED_COMMAND, 3, false, nullptr},
+            {"short payload", false, Type::STATUS_REQUEST, 2, false, nullptr},
+            {"bad sender", false, Type::HEARTBEAT, 0, true, nullptr},
+        };
+
+        // Every client id known first, as in steady operation
+        for (const Packet& packet : build(kinds[0])) {
+            Sim::Network::deliverNow(packet.from, packet.data.data(), packet.data.size());
+        }
+
+        std::vector<Result> results;
+        for (const Kind& kind : kinds) {
+            std::vector<Packet> batch = build(kind);
+            volatile uint32_t sink = 0;
+            double parseNs = nsPerPacket(batch, packets, false, [&](const Packet& packet) {
+                Protocol::FrameReader frame(packet.data.data(), packet.data.size());
+                Protocol::Command cmd;
+                while (frame.next(cmd)) {
+                    sink = sink + cmd.length;
+                }
+            });
+
+            uint64_t rejectedBefore, droppedBefore, rejectedAfter, droppedAfter;
+            sample(rejectedBefore, droppedBefore);
+            double hostNs = nsPerPacket(batch, packets, true, [](const Packet& packet) {
+                Sim::Network::deliverNow(packet.from, packet.data.data(), packet.data.size());
+            });
+            sample(rejectedAfter, droppedAfter);
+
+            results.push_back(Result{kind.name, kind.valid, packets, parseNs, hostNs,
+                                     static_cast<uint32_t>(rejectedAfter - rejectedBefore),
+                                     static_cast<uint32_t>(droppedAfter - droppedBefore)});
+        }
+        return results;
+    }
+}
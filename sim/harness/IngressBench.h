@@ -0,0 +1,24 @@
+#pragma once
+
+#include <Arduino.h>
+#include <vector>
+
+// Cost of the UDP ingress path per datagram, for valid packets and the
+// usual kinds of garbage. Each kind is timed twice: the frame check and
+// record walk alone, and the host's whole callback (run on the calling
+// thread through Sim::Network::deliverNow) with the route table, the
+// client refresh and the ring.
+namespace IngressBench {
+    struct Result {
+        const char* kind;
+        bool valid;                 // Expected to reach the host's handlers
+        uint32_t packets;
+        double parseNs;             // Protocol::FrameReader only
+        double hostNs;              // LEDMatrixHost's UDP callback
+        uint32_t rejected;          // Counted by the host as invalid or rejected
+        uint32_t dropped;           // Lost on a full message ring
+    };
+
+    // The host must be listening and no targets attached
+    std::vector<Result> run(uint32_t packets);
+}
@@ -0,0 +1,189 @@
+#include "LinkBench.h"
+#include <AsyncUDP.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include "Protocol.h"
+#include "ReliableLink.h"
+#include "Sim.h"
+#include "SimTarget.h"
+
+namespace LinkBench {
+    namespace {
+        constexpr uint32_t DRAIN_TIMEOUT_MS = 15000;   // Longer than a full backoff series
+
+        // The host's sending side, reduced to what reaches the wire
+        class Sender {
+        public:
+            explicit Sender(const std::vector<std::unique_ptr<SimTarget>>& targets)
+                : targets(targets), sequence(0), running(true) {
+                udp.listen(Config::Network::UDP_PORT);
+                udp.onPacket([this](AsyncUDPPacket& packet) { onPacket(packet); });
+                timerThread = std::thread([this] {
+                    while (running.load(std::memory_order_relaxed)) {
+                        retransmitDue();
+                        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    }
+                });
+            }
+
+            ~Sender() {
+                running.store(false, std::memory_order_relaxed);
+                timerThread.join();
+                udp.close();
+            }
+
+            void send(uint8_t clientId, Config::MessageType type, const uint8_t* payload, size_t len, bool reliable) {
+                if (!reliable) {
+                    uint8_t buffer[Protocol::MAX_FRAME_SIZE];
+                    Protocol::FrameWriter frame(buffer, sizeof(buffer), sequence++);
+                    frame.add(type, clientId, payload, len);
+                    transmit(clientId, frame);
+                    return;
+                }
+                link.cancel(clientId, Config::MessageType::TRAINING_START);
+                link.cancel(clientId, Config::MessageType::TRAINING_STOP);
+                ReliableLink::Command command;
+                uint32_t now = micros();
+                if (link.submit(clientId, type, payload, len, now, command)) {
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        submitted[key(clientId, command.seq)] = now;
+                    }
+                    transmit(clientId, command);
+                }
+            }
+
+            ReliableLink& getLink() { return link; }
+
+            std::vector<uint32_t> takeLatencies() {
+                std::lock_guard<std::mutex> lock(mutex);
+                std::sort(latencies.begin(), latencies.end());
+                return latencies;
+            }
+
+        private:
+            static uint32_t key(uint8_t clientId, uint16_t seq) { return static_cast<uint32_t>(clientId) << 16 | seq; }
+
+            void transmit(uint8_t clientId, Protocol::FrameWriter& frame) {
+                size_t size = frame.finish();
+                udp.writeTo(frame.data(), size, targets[clientId]->address(), Config::Network::UDP_PORT);
+            }
+
+            void transmit(uint8_t clientId, const ReliableLink::Command& command) {
+                uint8_t buffer[Protocol::MAX_FRAME_SIZE];
+                Protocol::FrameWriter frame(buffer, sizeof(buffer), command.seq, Protocol::FLAG_RELIABLE);
+                frame.add(command.type, clientId, command.payload, command.length);
+                transmit(clientId, frame);
+            }
+
+            void retransmitDue() {
+                std::array<ReliableLink::Command, ReliableLink::WINDOW> due;
+                uint32_t next;
+                for (uint8_t clientId = 0; clientId < targets.size(); ++clientId) {
+                    size_t count = link.collectDue(clientId, micros(), due, next);
+                    for (size_t i = 0; i < count; ++i) {
+                        if (!due[i].expired) {
+                            transmit(clientId, due[i]);
+                        }
+                    }
+                }
+            }
+
+            // Network thread
+            void onPacket(AsyncUDPPacket& packet) {
+                uint32_t now = micros();
+                Protocol::FrameReader frame(packet.data(), packet.length());
+                Protocol::Command cmd;
+                while (frame.isValid() && frame.next(cmd)) {
+                    if (cmd.type != Config::MessageType::ACK || cmd.length < Protocol::ACK_SIZE) {
+                        continue;
+                    }
+                    uint16_t seq = Protocol::readU16(cmd.payload);
+                    if (!link.acknowledge(cmd.target, seq, now)) {
+                        continue;
+                    }
+                    std::lock_guard<std::mutex> lock(mutex);
+                    auto found = submitted.find(key(cmd.target, seq));
+                    if (found != submitted.end()) {
+                        latencies.push_back(now - found->second);
+                        submitted.erase(found);
+                    }
+                }
+            }
+
+            const std::vector<std::unique_ptr<SimTarget>>& targets;
+            AsyncUDP udp;
+            ReliableLink link;
+            uint16_t sequence;
+            std::atomic<bool> running;
+            std::thread timerThread;
+
+            std::mutex mutex;
+            std::unordered_map<uint32_t, uint32_t> submitted;
+            std::vector<uint32_t> latencies;
+        };
+    }
+
+    Result run(uint16_t targetCount, uint16_t rounds, uint32_t intervalMs, float lossPercent, bool reliable,
+               uint32_t seed) {
+        // One target per client id, the link has no more
+        targetCount = std::min<uint16_t>(targetCount, Config::Network::MAX_CLIENTS);
+        std::vector<std::unique_ptr<SimTarget>> targets;
+        for (uint16_t i = 0; i < targetCount; ++i) {
+            targets.emplace_back(new SimTarget(i, seed));
+            Sim::Network::attach(targets.back()->address(), targets.back().get());
+        }
+        Sim::Network::setLoss(lossPercent / 100.0f, lossPercent / 100.0f);
+
+        Result result = {};
+        result.lossPercent = lossPercent;
+        result.reliable = reliable;
+        {
+            Sender sender(targets);
+            TrainingModes::TrainingConfig config = {};
+            config.duration = 60;
+            config.seed = seed;
+            uint8_t payload[Protocol::TRAINING_CONFIG_SIZE];
+            size_t payloadSize = Protocol::encodeTrainingConfig(config, payload);
+
+            for (uint16_t round = 0; round < rounds; ++round) {
+                bool start = round % 2 == 0;
+                for (uint8_t clientId = 0; clientId < targets.size(); ++clientId) {
+                    if (start) {
+                        sender.send(clientId, Config::MessageType::TRAINING_START, payload, payloadSize, reliable);
+                    } else {
+                        sender.send(clientId, Config::MessageType::TRAINING_STOP, nullptr, 0, reliable);
+                    }
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(intervalMs));
+            }
+
+            ReliableLink& link = sender.getLink();
+            for (uint32_t waited = 0; link.getInFlight() && waited < DRAIN_TIMEOUT_MS; waited += 10) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));     // Last ACKs and repeats
+
+            result.commands = static_cast<uint32_t>(rounds) * targets.size();
+            result.retransmits = link.getRetransmits().get();
+            result.failed = link.getFailed().get();
+            result.superseded = link.getSuperseded().get();
+            result.latencies = sender.takeLatencies();
+        }
+
+        bool shouldTrain = rounds % 2 == 1;
+        for (const auto& target : targets) {
+            result.applied += target->getSessionCommands();
+            result.duplicates += target->getDuplicates();
+            result.stale += target->isTraining() != shouldTrain;
+            Sim::Network::attach(target->address(), nullptr);
+        }
+        Sim::Network::setLoss(0.0f, 0.0f);
+        return result;
+    }
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <Arduino.h>
+#include <vector>
+
+// Training start/stop delivery to simulated targets without the host:
+// the bench plays the host's sending side over the simulated network,
+// either fire-and-forget or through ReliableLink, and counts what the
+// targets actually applied.
+namespace LinkBench {
+    struct Result {
+        float lossPercent;
+        bool reliable;
+        uint32_t commands;          // Starts and stops sent, one per target and round
+        uint32_t applied;           // Applied by the targets, repeats not counted
+        uint32_t duplicates;        // Repeats the targets dropped
+        uint16_t stale;             // Targets left in the wrong state at the end
+        uint32_t retransmits;
+        uint32_t failed;
+        uint32_t superseded;
+        std::vector<uint32_t> latencies;    // First send to ACK, us, sorted
+    };
+
+    // Alternating start/stop rounds every intervalMs to up to MAX_CLIENTS
+    // targets, then waits until nothing is in flight
+    Result run(uint16_t targets, uint16_t rounds, uint32_t intervalMs, float lossPercent, bool reliable,
+               uint32_t seed);
+}
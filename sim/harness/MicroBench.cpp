@@ -0,0 +1,27 @@
+#include "MicroBench.h"
+
+namespace MicroBench {
+    const std::vector<Bench>& all() {
+        static const std::vector<Bench> benches = {
+            {"ring", "UDP ingress ring vs mutex-guarded std::queue", ring},
+            {"clients", "ClientTable under the host tasks and HTTP handlers vs std::map + mutex", clientTable},
+            {"protocol", "FrameWriter/FrameReader per frame shape, CRC included", protocol},
+            {"serialize", "Dashboard messages as JSON vs MessagePack, serialize and parse; fan-out buffers", serialize},
+            {"timers", "Training and liveness timers: TimerWheel vs a linear deadline scan", timers},
+            {"sequence", "TargetSequence generation per placement pattern, all modes", sequence},
+            {"effects", "EffectEngine render time per effect type", effects},
+            {"batch", "Updating every target through /api/batch vs one request per command", batch},
+            {"history", "SessionStore appends with sync, and indexed queries", history},
+        };
+        return benches;
+    }
+
+    const Bench* find(const std::string& name) {
+        for (const Bench& bench : all()) {
+            if (name == bench.name) {
+                return &bench;
+            }
+        }
+        return nullptr;
+    }
+}
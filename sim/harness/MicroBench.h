@@ -0,0 +1,69 @@
+#pragma once
+
+#include <Arduino.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Component benchmarks for the native build. Each bench runs one part of
+// the host on its own against the simulated FreeRTOS, next to the simpler
+// structure it replaced where there was one, and reports a row per
+// variant. Units are part of the value names.
+//
+//   program --bench ring --bench timers
+//   program --bench all --json
+namespace MicroBench {
+    struct Row {
+        std::string variant;
+        std::vector<std::pair<std::string, double>> values;
+    };
+
+    struct Bench {
+        const char* name;
+        const char* description;
+        // iterations == 0: the bench's own default
+        std::vector<Row> (*run)(uint32_t iterations);
+    };
+
+    // In the order of the changes they measure
+    const std::vector<Bench>& all();
+    const Bench* find(const std::string& name);
+
+    // Helpers for the benches
+    using Clock = std::chrono::steady_clock;
+
+    inline uint64_t nanosSince(Clock::time_point start) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    }
+
+    // Sorts samples in place
+    template <typename T>
+    T percentile(std::vector<T>& samples, uint8_t p) {
+        if (samples.empty()) {
+            return T();
+        }
+        std::sort(samples.begin(), samples.end());
+        size_t rank = (samples.size() * p + 99) / 100;
+        return samples[std::max<size_t>(rank, 1) - 1];
+    }
+
+    // Busy work standing in for message processing
+    inline void spinFor(uint32_t ns) {
+        Clock::time_point end = Clock::now() + std::chrono::nanoseconds(ns);
+        while (Clock::now() < end) {
+        }
+    }
+
+    // The benches, one per file (*Bench.cpp)
+    std::vector<Row> ring(uint32_t iterations);
+    std::vector<Row> clientTable(uint32_t iterations);
+    std::vector<Row> protocol(uint32_t iterations);
+    std::vector<Row> serialize(uint32_t iterations);
+    std::vector<Row> timers(uint32_t iterations);
+    std::vector<Row> sequence(uint32_t iterations);
+    std::vector<Row> effects(uint32_t iterations);
+    std::vector<Row> batch(uint32_t iterations);
+    std::vector<Row> history(uint32_t iterations);
+}
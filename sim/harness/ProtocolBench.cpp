@@ -0,0 +1,70 @@
+#include "MicroBench.h"
+#include "Protocol.h"
+
+namespace MicroBench {
+    namespace {
+        constexpr uint32_t DEFAULT_FRAMES = 500000;
+
+        struct Shape {
+            const char* name;
+            uint8_t records;
+            uint8_t payload;            // Per record
+            bool masked;
+        };
+
+        Row measure(const Shape& shape, uint32_t frames) {
+            uint8_t buffer[Protocol::MAX_FRAME_SIZE];
+            uint8_t payload[Protocol::MAX_RECORD_PAYLOAD] = {};
+            size_t size = 0;
+
+            Clock::time_point start = Clock::now();
+            for (uint32_t i = 0; i < frames; ++i) {
+                Protocol::FrameWriter writer(buffer, sizeof(buffer), i);
+                payload[0] = i & 0xFF;
+                for (uint8_t r = 0; r < shape.records; ++r) {
+                    if (shape.masked) {
+                        writer.addMasked(Config::MessageType::LED_COMMAND, 0x0000FFFF, payload, shape.payload);
+                    } else {
+                        writer.add(Config::MessageType::LED_COMMAND, r, payload, shape.payload);
+                    }
+                }
+                size = writer.finish();
+            }
+            double writeNs = static_cast<double>(nanosSince(start)) / frames;
+
+            volatile uint32_t sink = 0;
+            start = Clock::now();
+            for (uint32_t i = 0; i < frames; ++i) {
+                Protocol::FrameReader reader(buffer, size);
+                Protocol::Command cmd;
+                while (reader.next(cmd)) {
+                    sink = sink + cmd.payload[0] + cmd.mask;
+                }
+            }
+            double readNs = static_cast<double>(nanosSince(start)) / frames;
+
+            return Row{shape.name, {
+                {"bytes", static_cast<double>(size)},
+                {"write ns/frame", writeNs},
+                {"read ns/frame", readNs},
+                {"read MB/s", size * 1e3 / readNs},
+                {"read Mrecords/s", shape.records * 1e3 / readNs},
+            }};
+        }
+    }
+
+    std::vector<Row> protocol(uint32_t iterations) {
+        uint32_t frames = iterations ? iterations : DEFAULT_FRAMES;
+        const Shape shapes[] = {
+            {"1 record, 4 B", 1, 4, false},
+            {"16 records, 3 B", 16, 3, false},
+            {"16 masked, 3 B", 16, 3, true},
+            {"1 record, 240 B", 1, 240, false},
+        };
+        std::vector<Row> rows;
+        for (const Shape& shape : shapes) {
+            rows.push_back(measure(shape, frames));
+        }
+        return rows;
+    }
+}
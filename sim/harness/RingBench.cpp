@@ -0,0 +1,175 @@
+#include "MicroBench.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <array>
+#include <atomic>
+#include <queue>
+#include <thread>
+#include "MessageRing.h"
+#include "config.h"
+
+namespace MicroBench {
+    namespace {
+        constexpr uint32_t DEFAULT_PACKETS = 200000;
+        constexpr uint32_t PROCESS_NS = 500;        // Consumer work per message in the paced run
+        constexpr uint32_t BURST = 16;              // Paced run: datagrams per burst, at half load
+        constexpr uint32_t BURST_PERIOD_NS = BURST * PROCESS_NS * 2;
+        constexpr size_t PAYLOAD = 12;
+
+        // Same shape as LEDMatrixHost::Message
+        struct Slot {
+            uint32_t seq;
+            Clock::time_point enqueued;
+            uint16_t length;
+            std::array<uint8_t, PAYLOAD> data;
+        };
+
+        class RingQueue {
+        public:
+            bool push(uint32_t seq) {
+                Slot* slot = ring.acquire();
+                if (!slot) {
+                    return false;
+                }
+                slot->seq = seq;
+                slot->enqueued = Clock::now();
+                slot->length = PAYLOAD;
+                slot->data.fill(seq & 0xFF);
+                ring.publish();
+                return true;
+            }
+
+            template <typename Fn>
+            void drain(Fn&& fn) {
+                while (const Slot* slot = ring.front()) {
+                    fn(slot->enqueued);
+                    ring.pop();
+                }
+            }
+
+        private:
+            MessageRing<Slot, Config::Network::MESSAGE_QUEUE_SIZE> ring;
+        };
+
+        // What the ring replaced: a heap-backed message per datagram in a
+        // std::queue, drained under the same mutex the producer takes
+        class LockedQueue {
+        public:
+            LockedQueue() : mutex(xSemaphoreCreateMutex()) {}
+            ~LockedQueue() { vSemaphoreDelete(mutex); }
+
+            bool push(uint32_t seq) {
+                Message msg{seq, Clock::now(), std::vector<uint8_t>(PAYLOAD, seq & 0xFF)};
+                xSemaphoreTake(mutex, portMAX_DELAY);
+                queue.push(std::move(msg));
+                xSemaphoreGive(mutex);
+                return true;
+            }
+
+            template <typename Fn>
+            void drain(Fn&& fn) {
+                xSemaphoreTake(mutex, portMAX_DELAY);
+                while (!queue.empty()) {
+                    Message msg = queue.front();
+                    queue.pop();
+                    fn(msg.enqueued);
+                }
+                xSemaphoreGive(mutex);
+            }
+
+        private:
+            struct Message {
+                uint32_t seq;
+                Clock::time_point enqueued;
+                std::vector<uint8_t> data;
+            };
+
+            SemaphoreHandle_t mutex;
+            std::queue<Message> queue;
+        };
+
+        // Consumer thread until expected messages are through; expected
+        // is only known once the producer has counted its drops
+        template <typename Queue, typename Fn>
+        std::thread consume(Queue& queue, const std::atomic<uint32_t>& expected, Fn&& fn) {
+            return std::thread([&queue, &expected, fn] {
+                uint32_t count = 0;
+                while (count < expected.load(std::memory_order_acquire)) {
+                    queue.drain([&](Clock::time_point enqueued) {
+                        fn(enqueued);
+                        count++;
+                    });
+                    std::this_thread::yield();
+                }
+            });
+        }
+
+        template <typename Queue>
+        Row measure(const char* variant, uint32_t packets) {
+            Row row{variant, {}};
+
+            // Throughput: the producer retries while the queue is full,
+            // the consumer does no work
+            {
+                Queue queue;
+                std::atomic<uint32_t> expected(packets);
+                Clock::time_point start = Clock::now();
+                std::thread consumer = consume(queue, expected, [](Clock::time_point) {});
+                for (uint32_t seq = 0; seq < packets;) {
+                    if (queue.push(seq)) {
+                        seq++;
+                    } else {
+                        std::this_thread::yield();
+                    }
+                }
+                consumer.join();
+                row.values.emplace_back("max pkts/s", packets * 1e9 / nanosSince(start));
+            }
+
+            // Latency: bursts at half the consumer's capacity, drops
+            // counted instead of retried as in the UDP callback
+            {
+                Queue queue;
+                std::vector<uint32_t> enqueueNs;
+                std::vector<uint32_t> waitNs;
+                enqueueNs.reserve(packets);
+                waitNs.reserve(packets);
+                std::atomic<uint32_t> expected(UINT32_MAX);
+                std::thread consumer = consume(queue, expected, [&waitNs](Clock::time_point enqueued) {
+                    waitNs.push_back(nanosSince(enqueued));
+                    spinFor(PROCESS_NS);
+                });
+
+                uint32_t drops = 0;
+                Clock::time_point next = Clock::now();
+                for (uint32_t seq = 0; seq < packets; ++seq) {
+                    if (seq % BURST == 0) {
+                        next += std::chrono::nanoseconds(BURST_PERIOD_NS);
+                        while (Clock::now() < next) {
+                            std::this_thread::yield();
+                        }
+                    }
+                    Clock::time_point start = Clock::now();
+                    drops += !queue.push(seq);
+                    enqueueNs.push_back(nanosSince(start));
+                }
+                expected.store(packets - drops, std::memory_order_release);
+                consumer.join();
+
+                row.values.emplace_back("enqueue p50 ns", percentile(enqueueNs, 50));
+                row.values.emplace_back("enqueue p99 ns", percentile(enqueueNs, 99));
+                row.values.emplace_back("wait p99 us", percentile(waitNs, 99) / 1000.0);
+                row.values.emplace_back("drops", drops);
+            }
+            return row;
+        }
+    }
+
+    std::vector<Row> ring(uint32_t iterations) {
+        uint32_t packets = iterations ? iterations : DEFAULT_PACKETS;
+        return {
+            measure<RingQueue>("MessageRing", packets),
+            measure<LockedQueue>("std::queue + mutex", packets),
+        };
+    }
+}
@@ -0,0 +1,53 @@
+#include "MicroBench.h"
+#include "TrainingModes.h"
+
+namespace MicroBench {
+    namespace {
+        using namespace TrainingModes;
+
+        constexpr uint32_t DEFAULT_TARGETS = 2000000;
+        constexpr uint8_t MODES = 15;
+        constexpr uint8_t DIFFICULTIES = 3;
+
+        Row measure(const char* name, Pattern pattern, uint32_t targets) {
+            TrainingConfig config = {};
+            config.targetCount = 1000;
+            config.reactTime = 1200;
+            config.stressorsEnabled = true;
+            config.modeConfig.targetPattern = static_cast<uint8_t>(pattern);
+
+            // Every mode and difficulty in turn, one session each
+            uint32_t sessions = (targets + config.targetCount - 1) / config.targetCount;
+            uint32_t generated = 0;
+            volatile uint32_t sink = 0;
+            Clock::time_point start = Clock::now();
+            for (uint32_t s = 0; s < sessions; ++s) {
+                config.mode = static_cast<Mode>(s % MODES);
+                config.difficulty = static_cast<Difficulty>((s / MODES) % DIFFICULTIES);
+                config.seed = s;
+                TargetSequence sequence(config);
+                while (sequence.hasNext()) {
+                    Target target = sequence.next();
+                    sink = sink + target.x + target.delay;
+                    generated++;
+                }
+            }
+            double ns = static_cast<double>(nanosSince(start)) / generated;
+            return Row{name, {
+                {"ns/target", ns},
+                {"Mtargets/s", 1e3 / ns},
+                {"state bytes", static_cast<double>(sizeof(TargetSequence))},
+            }};
+        }
+    }
+
+    std::vector<Row> sequence(uint32_t iterations) {
+        uint32_t targets = iterations ? iterations : DEFAULT_TARGETS;
+        return {
+            measure("random", Pattern::RANDOM, targets),
+            measure("sequence", Pattern::SEQUENCE, targets),
+            measure("wave", Pattern::WAVE, targets),
+            measure("spiral", Pattern::SPIRAL, targets),
+        };
+    }
+}
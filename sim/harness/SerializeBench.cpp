@@ -0,0 +1,179 @@
+#include "MicroBench.h"
+#include "config.h"
+#include <ArduinoJson.h>
+#include <ESPAsyncWebServer.h>
+#include <atomic>
+#include <thread>
+#include "Sim.h"
+#include "WsBufferPool.h"
+
+namespace MicroBench {
+    namespace {
+        constexpr uint32_t DEFAULT_MESSAGES = 20000;
+        constexpr uint8_t DASHBOARDS = 8;
+        constexpr char FANOUT_URL[] = "/bench_ws";     // Apart from the host's /ws
+
+        // Same fields as LEDMatrixHost::serializeClient with everything set
+        void buildClientList(JsonDocument& doc, uint8_t clients) {
+            doc["type"] = "client_list";
+            doc["seq"] = 123456;
+            JsonArray clientArray = doc.createNestedArray("clients");
+            for (uint8_t i = 0; i < clients; ++i) {
+                JsonObject obj = clientArray.createNestedObject();
+                char ip[16];
+                snprintf(ip, sizeof(ip), "192.168.4.%u", i + 10);
+                obj["id"] = i;
+                obj["ip"] = ip;
+                obj["lastSeen"] = 1000000UL + i * 37;
+                obj["color"] = "255,128,0";
+                obj["effect"] = i % 6;
+                obj["brightness"] = 200;
+                JsonObject training = obj.createNestedObject("training");
+                training["mode"] = i % 4;
+                training["difficulty"] = i % 3;
+                training["duration"] = 60;
+                training["elapsed"] = 17;
+                training["hits"] = 12 + i;
+                training["misses"] = i % 5;
+                training["score"] = 1450 + i * 11;
+            }
+        }
+
+        // Delta after one hit, as sent between snapshots
+        void buildDelta(JsonDocument& doc) {
+            doc["type"] = "client_delta";
+            doc["seq"] = 123457;
+            JsonObject obj = doc.createNestedArray("clients").createNestedObject();
+            obj["id"] = 7;
+            JsonObject training = obj.createNestedObject("training");
+            training["hits"] = 19;
+            training["misses"] = 2;
+            training["score"] = 1527;
+        }
+
+        Row measure(const char* name, const JsonDocument& doc, bool binary, uint32_t messages) {
+            size_t size = binary ? measureMsgPack(doc) : measureJson(doc);
+            std::vector<uint8_t> buffer(size + 1);
+
+            Clock::time_point start = Clock::now();
+            for (uint32_t i = 0; i < messages; ++i) {
+                if (binary) {
+                    serializeMsgPack(doc, buffer.data(), buffer.size());
+                } else {
+                    serializeJson(doc, reinterpret_cast<char*>(buffer.data()), buffer.size());
+                }
+            }
+            double writeUs = nanosSince(start) / 1e3 / messages;
+
+            DynamicJsonDocument parsed(doc.capacity());
+            bool ok = true;
+            start = Clock::now();
+            for (uint32_t i = 0; i < messages; ++i) {
+                DeserializationError error = binary
+                    ? deserializeMsgPack(parsed, reinterpret_cast<const char*>(buffer.data()), size)
+                    : deserializeJson(parsed, reinterpret_cast<const char*>(buffer.data()), size);
+                ok = ok && !error;
+            }
+            double readUs = nanosSince(start) / 1e3 / messages;
+
+            return Row{std::string(name) + (binary ? ", msgpack" : ", json"), {
+                {"bytes", static_cast<double>(size)},
+                {"serialize us", writeUs},
+                {"parse us", readUs},
+                {"parse ok", ok ? 1.0 : 0.0},
+            }};
+        }
+
+        // Counts what the simulated socket delivered
+        class Peer : public Sim::WsPeer {
+        public:
+            void onMessage(const uint8_t* data, size_t len, bool binary) override {
+                (void)data;
+                (void)len;
+                (void)binary;
+                received.fetch_add(1, std::memory_order_release);
+            }
+
+            std::atomic<uint32_t> received{0};
+        };
+
+        // One message queued to every dashboard by reference, from a pooled
+        // buffer or one allocated per message as with makeBuffer(). Each
+        // waits until it was sent, as dashboards that keep up. Allocations
+        // are counted on the publishing thread only: getting the buffer,
+        // then the library's queue.
+        Row fanOut(const char* name, const JsonDocument& doc, bool pooled, uint32_t messages) {
+            AsyncWebSocket socket(FANOUT_URL);
+            std::vector<std::unique_ptr<Peer>> peers;
+            std::vector<AsyncWebSocketClient*> clients;
+            for (uint8_t i = 0; i < DASHBOARDS; ++i) {
+                peers.emplace_back(new Peer());
+                clients.push_back(socket.client(Sim::Web::connect(FANOUT_URL, peers.back().get())));
+            }
+
+            std::unique_ptr<WsBufferPool> pool(new WsBufferPool());
+            uint64_t bufferAllocations = 0;
+            uint64_t queueAllocations = 0;
+            Clock::time_point start = Clock::now();
+            for (uint32_t i = 0; i < messages; ++i) {
+                size_t size = measureJson(doc);
+                uint64_t before = Sim::threadAllocations();
+                AsyncWebSocketSharedBuffer buffer = pooled
+                    ? pool->acquire(size + 1)
+                    : std::make_shared<std::vector<uint8_t>>(size + 1);
+                bufferAllocations += Sim::threadAllocations() - before;
+                serializeJson(doc, reinterpret_cast<char*>(buffer->data()), size + 1);
+                buffer->resize(size);
+                uint64_t queued = Sim::threadAllocations();
+                for (AsyncWebSocketClient* client : clients) {
+                    client->text(buffer);
+                }
+                queueAllocations += Sim::threadAllocations() - queued;
+                buffer.reset();
+
+                for (const auto& peer : peers) {
+                    while (peer->received.load(std::memory_order_acquire) <= i) {
+                        std::this_thread::yield();
+                    }
+                }
+            }
+            double publishUs = nanosSince(start) / 1e3 / messages;
+
+            for (AsyncWebSocketClient* client : clients) {
+                Sim::Web::disconnect(client->id());
+            }
+            while (socket.count()) {
+                std::this_thread::yield();
+            }
+            // No socket at this URL: returns once async_tcp ran the closes
+            Sim::Web::connect("/bench_ws_gone", nullptr);
+
+            return Row{std::string(name) + (pooled ? ", pooled x8" : ", per message x8"), {
+                {"us/publish", publishUs},
+                {"buffer allocs/msg", static_cast<double>(bufferAllocations) / messages},
+                {"queue allocs/msg", static_cast<double>(queueAllocations) / messages},
+                {"pool reuses", static_cast<double>(pool->getReuses())},
+                {"pool exhausted", static_cast<double>(pool->getExhausted())},
+            }};
+        }
+    }
+
+    std::vector<Row> serialize(uint32_t iterations) {
+        uint32_t messages = iterations ? iterations : DEFAULT_MESSAGES;
+        DynamicJsonDocument snapshot(8192);
+        buildClientList(snapshot, Config::Network::MAX_CLIENTS);
+        DynamicJsonDocument delta(256);
+        buildDelta(delta);
+
+        std::vector<Row> rows;
+        for (bool binary : {false, true}) {
+            rows.push_back(measure("client_list", snapshot, binary, messages / 10 + 1));
+            rows.push_back(measure("client_delta", delta, binary, messages));
+        }
+        for (bool pooled : {false, true}) {
+            rows.push_back(fanOut("client_list", snapshot, pooled, messages / 10 + 1));
+            rows.push_back(fanOut("client_delta", delta, pooled, messages));
+        }
+        return rows;
+    }
+}
@@ -0,0 +1,77 @@
+#include "SimDashboard.h"
+#include <ArduinoJson.h>
+#include <algorithm>
+
+std::vector<uint32_t> LatencySink::take(size_t phase) {
+    std::vector<uint32_t> sorted;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        sorted = samples[phase];
+    }
+    std::sort(sorted.begin(), sorted.end());
+    return sorted;
+}
+
+SimDashboard::SimDashboard(bool msgpack, const HitLog& log, LatencySink& sink)
+    : msgpack(msgpack)
+    , log(log)
+    , sink(sink)
+    , id(0)
+    , messages(0)
+    , bytes(0)
+    , parseErrors(0)
+    , trainingStatus(0)
+    , closed(false) {
+    lastRound.fill(-1);
+}
+
+bool SimDashboard::connect() {
+    id = Sim::Web::connect("/ws", this, Config::Security::API_USERNAME, Config::Security::API_PASSWORD);
+    if (!id) {
+        return false;
+    }
+    if (msgpack) {
+        Sim::Web::send(id, "{\"command\":\"setEncoding\",\"encoding\":\"msgpack\"}");
+    }
+    return true;
+}
+
+void SimDashboard::disconnect() {
+    if (id) {
+        Sim::Web::disconnect(id);
+        id = 0;
+    }
+}
+
+void SimDashboard::onMessage(const uint8_t* data, size_t len, bool binary) {
+    uint32_t now = micros();
+    messages.fetch_add(1, std::memory_order_relaxed);
+    bytes.fetch_add(len, std::memory_order_relaxed);
+
+    // Frames are padded to the buffer granularity (whitespace or nil)
+    DynamicJsonDocument doc(4096);
+    DeserializationError error = binary ? deserializeMsgPack(doc, data, len) : deserializeJson(doc, data, len);
+    if (error) {
+        parseErrors.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    if (doc["type"] != "training_status") {
+        return;
+    }
+    trainingStatus.fetch_add(1, std::memory_order_relaxed);
+
+    uint8_t clientId = doc["clientId"] | 0xFF;
+    JsonVariantConst round = doc["stats"]["round"];
+    if (clientId >= Config::Network::MAX_CLIENTS || round.isNull()) {
+        return;
+    }
+    uint16_t number = round.as<uint16_t>();
+    if (number == lastRound[clientId]) {
+        return;
+    }
+    lastRound[clientId] = number;
+    uint32_t sentUs;
+    if (log.lookup(clientId, number, sentUs)) {
+        sink.add(now - sentUs);
+    }
+}
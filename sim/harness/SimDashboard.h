@@ -0,0 +1,68 @@
+#pragma once
+
+#include <Arduino.h>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include "Sim.h"
+#include "SimTarget.h"
+
+// Hit-to-dashboard latencies, in microseconds, per phase of the script
+class LatencySink {
+public:
+    explicit LatencySink(size_t phases) : samples(phases) {}
+
+    void setPhase(int phase) { current.store(phase, std::memory_order_relaxed); }
+    void add(uint32_t latencyUs) {
+        int phase = current.load(std::memory_order_relaxed);
+        if (phase < 0) {
+            return;     // Warm-up or drain
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        samples[phase].push_back(latencyUs);
+    }
+
+    // Sorted copy
+    std::vector<uint32_t> take(size_t phase);
+
+private:
+    std::mutex mutex;
+    std::vector<std::vector<uint32_t>> samples;
+    std::atomic<int> current{-1};
+};
+
+// A dashboard on /ws, speaking JSON or MessagePack. Every training_status
+// carries the client's last round; the first sighting of a round gives
+// the latency of the hit that started it.
+class SimDashboard : public Sim::WsPeer {
+public:
+    SimDashboard(bool msgpack, const HitLog& log, LatencySink& sink);
+
+    bool connect();
+    void disconnect();
+
+    // async_tcp thread
+    void onMessage(const uint8_t* data, size_t len, bool binary) override;
+    void onClose() override { closed.store(true, std::memory_order_relaxed); }
+
+    uint32_t getMessages() const { return messages.load(std::memory_order_relaxed); }
+    uint32_t getBytes() const { return bytes.load(std::memory_order_relaxed); }
+    uint32_t getParseErrors() const { return parseErrors.load(std::memory_order_relaxed); }
+    uint32_t getTrainingStatus() const { return trainingStatus.load(std::memory_order_relaxed); }
+    bool isClosed() const { return closed.load(std::memory_order_relaxed); }
+    bool isMsgpack() const { return msgpack; }
+
+private:
+    bool msgpack;
+    const HitLog& log;
+    LatencySink& sink;
+    uint32_t id;
+    std::array<int32_t, Config::Network::MAX_CLIENTS> lastRound;    // async_tcp thread only
+
+    std::atomic<uint32_t> messages;
+    std::atomic<uint32_t> bytes;
+    std::atomic<uint32_t> parseErrors;
+    std::atomic<uint32_t> trainingStatus;
+    std::atomic<bool> closed;
+};
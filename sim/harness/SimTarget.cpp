@@ -0,0 +1,128 @@
+#include "SimTarget.h"
+#include <cmath>
+#include "ClockSync.h"
+
+SimTarget::SimTarget(uint8_t index, uint32_t seed)
+    : ip(192, 168, 4, index + 10)
+    , id(index)
+    , sequence(0)
+    , training(false)
+    , random(seed ^ (index * 2654435761u))
+    , nextHitUs(0)
+    , nextStatusUs(0)
+    , hits(0)
+    , scheduled(false)
+    , hitsSent(0)
+    , statusSent(0)
+    , syncReplies(0)
+    , sessionCommands(0)
+    , duplicates(0) {
+    // Crystal tolerance of a few tens of ppm, clocks booted at random times
+    clockOffsetUs = std::uniform_int_distribution<int32_t>(-50000000, 50000000)(random);
+    clockDriftPpm = std::uniform_real_distribution<float>(-40.0f, 40.0f)(random);
+}
+
+uint32_t SimTarget::localMicros() const {
+    uint32_t now = micros();
+    return now + clockOffsetUs + static_cast<int32_t>(now * (clockDriftPpm * 1e-6f));
+}
+
+void SimTarget::send(Config::MessageType type, const uint8_t* payload, size_t len) {
+    uint8_t buffer[Protocol::MAX_FRAME_SIZE];
+    Protocol::FrameWriter frame(buffer, sizeof(buffer), sequence.fetch_add(1, std::memory_order_relaxed));
+    frame.add(type, id, payload, len);
+    size_t size = frame.finish();
+    Sim::Network::sendToHost(ip, buffer, size);
+}
+
+void SimTarget::onDatagram(const uint8_t* data, size_t len) {
+    uint32_t received = localMicros();
+    Protocol::FrameReader frame(data, len);
+    if (!frame.isValid()) {
+        return;
+    }
+    if (frame.header().flags & Protocol::FLAG_RELIABLE) {
+        // The ACK may have been the lost part, so repeats are ACKed too
+        uint8_t ack[Protocol::ACK_SIZE];
+        Protocol::writeU16(ack, frame.header().seq);
+        send(Config::MessageType::ACK, ack, sizeof(ack));
+        if (!duplicateFilter.accept(frame.header().seq)) {
+            duplicates.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+    Protocol::Command cmd;
+    while (frame.next(cmd)) {
+        bool forUs = cmd.target == Protocol::TARGET_ALL || cmd.target == id ||
+                     (cmd.target == Protocol::TARGET_MASK && cmd.addresses(id));
+        if (!forUs) {
+            continue;
+        }
+        switch (cmd.type) {
+            case Config::MessageType::TIME_SYNC:
+                if (cmd.length >= ClockSync::SYNC_REQUEST_SIZE) {
+                    uint8_t reply[ClockSync::SYNC_REPLY_SIZE];
+                    memcpy(reply, cmd.payload, 4);
+                    Protocol::writeU32(reply + 4, received);
+                    Protocol::writeU32(reply + 8, localMicros());
+                    send(Config::MessageType::TIME_SYNC, reply, sizeof(reply));
+                    syncReplies.fetch_add(1, std::memory_order_relaxed);
+                }
+                break;
+
+            case Config::MessageType::TRAINING_START:
+                training.store(true, std::memory_order_relaxed);
+                sessionCommands.fetch_add(1, std::memory_order_relaxed);
+                break;
+
+            case Config::MessageType::TRAINING_STOP:
+                training.store(false, std::memory_order_relaxed);
+                sessionCommands.fetch_add(1, std::memory_order_relaxed);
+                break;
+
+            default:
+                break;
+        }
+    }
+}
+
+// Hits go out whether or not the host started us, so ingress load follows
+// the script; the host simply ignores hits outside a training.
+void SimTarget::poll(uint32_t nowUs, float hitsPerSecond, uint32_t statusIntervalMs, HitLog& log) {
+    if (!scheduled) {
+        nextStatusUs = nowUs + std::uniform_int_distribution<uint32_t>(0, statusIntervalMs * 1000)(random);
+        scheduled = true;
+    }
+
+    if (hitsPerSecond <= 0.0f) {
+        nextHitUs = 0;
+    } else {
+        if (nextHitUs == 0) {
+            nextHitUs = nowUs + std::exponential_distribution<float>(hitsPerSecond)(random) * 1e6f;
+        }
+        while (static_cast<int32_t>(nowUs - nextHitUs) >= 0) {
+            uint32_t hitAt = localMicros();
+            uint32_t reaction = std::uniform_int_distribution<uint32_t>(150000, 600000)(random);
+            uint16_t round = log.nextRound(id);
+            uint8_t payload[11];
+            Protocol::writeU32(payload, hitAt - reaction);
+            Protocol::writeU32(payload + 4, hitAt);
+            payload[8] = std::uniform_int_distribution<int>(0, 63)(random);
+            Protocol::writeU16(payload + 9, round);
+            log.sent(id, round, micros());
+            send(Config::MessageType::HIT_EVENT, payload, sizeof(payload));
+            hits++;
+            hitsSent.fetch_add(1, std::memory_order_relaxed);
+            nextHitUs += std::max(1.0f, std::exponential_distribution<float>(hitsPerSecond)(random) * 1e6f);
+        }
+    }
+
+    if (statusIntervalMs && static_cast<int32_t>(nowUs - nextStatusUs) >= 0) {
+        uint8_t payload[4];
+        Protocol::writeU16(payload, hits);
+        Protocol::writeU16(payload + 2, 0);
+        send(Config::MessageType::STATUS_REQUEST, payload, sizeof(payload));
+        statusSent.fetch_add(1, std::memory_order_relaxed);
+        nextStatusUs = nowUs + statusIntervalMs * 1000;
+    }
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <Arduino.h>
+#include <array>
+#include <atomic>
+#include <random>
+#include "Sim.h"
+#include "config.h"
+#include "Protocol.h"
+
+// Send times of the hits, by client id and round, so a dashboard can tell
+// how long a hit took to show up. Targets from MAX_CLIENTS on are not
+// logged: the host rejects their ids, so no dashboard ever sees their hits.
+class HitLog {
+public:
+    static constexpr size_t WINDOW = 1024;      // Rounds remembered per client
+
+    uint16_t nextRound(uint8_t clientId) {
+        if (clientId >= Config::Network::MAX_CLIENTS) {
+            return 0;
+        }
+        return rounds[clientId].fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    void sent(uint8_t clientId, uint16_t round, uint32_t atUs) {
+        if (clientId >= Config::Network::MAX_CLIENTS) {
+            return;
+        }
+        Entry& entry = entries[clientId][round % WINDOW];
+        entry.atUs.store(atUs, std::memory_order_relaxed);
+        entry.round.store(round, std::memory_order_release);
+    }
+
+    // Send time of the round, false if it fell out of the window
+    bool lookup(uint8_t clientId, uint16_t round, uint32_t& atUs) const {
+        const Entry& entry = entries[clientId][round % WINDOW];
+        if (entry.round.load(std::memory_order_acquire) != round) {
+            return false;
+        }
+        atUs = entry.atUs.load(std::memory_order_relaxed);
+        return true;
+    }
+
+private:
+    struct Entry {
+        std::atomic<uint16_t> round{0};
+        std::atomic<uint32_t> atUs{0};
+    };
+
+    std::array<std::array<Entry, WINDOW>, Config::Network::MAX_CLIENTS> entries;
+    std::array<std::atomic<uint16_t>, Config::Network::MAX_CLIENTS> rounds{};
+};
+
+// One simulated target: its own clock (offset and drift against the host),
+// answers clock sync probes, follows training start/stop (ACKing reliable
+// frames and applying each only once) and sends hits at a Poisson rate
+// plus a periodic status report.
+class SimTarget : public Sim::UdpEndpoint {
+public:
+    // index is also the client id; from MAX_CLIENTS on the host rejects it
+    SimTarget(uint8_t index, uint32_t seed);
+
+    IPAddress address() const { return ip; }
+    uint8_t clientId() const { return id; }
+
+    // Network thread
+    void onDatagram(const uint8_t* data, size_t len) override;
+
+    // Worker thread: sends whatever is due at nowUs (host micros)
+    void poll(uint32_t nowUs, float hitsPerSecond, uint32_t statusIntervalMs, HitLog& log);
+
+    uint32_t getHitsSent() const { return hitsSent.load(std::memory_order_relaxed); }
+    uint32_t getStatusSent() const { return statusSent.load(std::memory_order_relaxed); }
+    uint32_t getSyncReplies() const { return syncReplies.load(std::memory_order_relaxed); }
+    bool isTraining() const { return training.load(std::memory_order_relaxed); }
+    // Training starts and stops applied, repeats not counted
+    uint32_t getSessionCommands() const { return sessionCommands.load(std::memory_order_relaxed); }
+    uint32_t getDuplicates() const { return duplicates.load(std::memory_order_relaxed); }
+
+private:
+    uint32_t localMicros() const;
+    void send(Config::MessageType type, const uint8_t* payload, size_t len);
+
+    IPAddress ip;
+    uint8_t id;
+    int32_t clockOffsetUs;
+    float clockDriftPpm;
+    std::atomic<uint16_t> sequence;
+    std::atomic<bool> training;
+    Protocol::DuplicateFilter duplicateFilter;  // Network thread only
+
+    // Worker thread only
+    std::mt19937 random;
+    uint32_t nextHitUs;
+    uint32_t nextStatusUs;
+    uint16_t hits;
+    bool scheduled;
+
+    std::atomic<uint32_t> hitsSent;
+    std::atomic<uint32_t> statusSent;
+    std::atomic<uint32_t> syncReplies;
+    std::atomic<uint32_t> sessionCommands;
+    std::atomic<uint32_t> duplicates;
+};
@@ -0,0 +1,177 @@
+#include "MicroBench.h"
+#include "TimerWheel.h"
+#include "config.h"
+#include <array>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+namespace MicroBench {
+    namespace {
+        constexpr uint32_t DEFAULT_TICKS = 600000;     // 10 min of 1 ms ticks
+        constexpr uint8_t CLIENTS = Config::Network::MAX_CLIENTS;
+        constexpr uint16_t TIMERS = CLIENTS * 3;
+
+        // Per client, as the host arms them
+        enum Kind : uint8_t { TRAINING_END, REACTION, LIVENESS };
+        constexpr uint32_t TRAINING_MS = 60000;
+        constexpr uint32_t REACTION_MS = 500;
+        constexpr uint32_t LIVENESS_MS = Config::Network::UDP_TIMEOUT;
+        constexpr uint32_t HEARTBEAT_MS = 20;
+        constexpr uint32_t HIT_PERIOD_MS = 700;
+        constexpr uint8_t ARMING_THREADS = 2;       // UDP ingress and the processor task
+
+        // What happens at tick t outside the timers: heartbeats re-arm
+        // liveness, hits re-arm the reaction window
+        template <typename Arm>
+        void traffic(uint32_t t, Arm&& arm) {
+            for (uint8_t c = 0; c < CLIENTS; ++c) {
+                if (t % HEARTBEAT_MS == c % HEARTBEAT_MS) {
+                    arm(c * 3 + LIVENESS, t, LIVENESS_MS);
+                }
+                if (t % HIT_PERIOD_MS == (c * 37u) % HIT_PERIOD_MS) {
+                    arm(c * 3 + REACTION, t, REACTION_MS);
+                }
+            }
+        }
+
+        // A fired window counts a miss and opens the next one; a finished
+        // training starts the next
+        template <typename Arm>
+        void fire(uint16_t id, uint32_t t, Arm&& arm, uint32_t& fired) {
+            fired++;
+            if (id % 3 == REACTION) {
+                arm(id, t, REACTION_MS);
+            } else if (id % 3 == TRAINING_END) {
+                arm(id, t, TRAINING_MS);
+            }
+        }
+
+        // The structure the wheel replaced: a deadline per timer, all of
+        // them scanned on each wake-up to fire the due ones and find the
+        // next deadline
+        struct LinearTimers {
+            std::array<uint32_t, TIMERS> expires;
+            std::array<bool, TIMERS> armed;
+            uint32_t wakeAt;
+
+            bool arm(uint16_t id, uint32_t now, uint32_t delay) {
+                expires[id] = now + delay;
+                armed[id] = true;
+                return static_cast<int32_t>(expires[id] - wakeAt) < 0;
+            }
+
+            template <typename Fn>
+            uint32_t advance(uint32_t now, Fn&& fn) {
+                uint32_t next = UINT32_MAX;
+                for (uint16_t id = 0; id < TIMERS; ++id) {
+                    if (!armed[id]) {
+                        continue;
+                    }
+                    int32_t remaining = static_cast<int32_t>(expires[id] - now);
+                    if (remaining <= 0) {
+                        armed[id] = false;
+                        fn(id);
+                    } else if (static_cast<uint32_t>(remaining) < next) {
+                        next = remaining;
+                    }
+                }
+                wakeAt = now + next;
+                return next;
+            }
+        };
+
+        // Runs the timers the way the host's timer task does: sleep until
+        // the returned delay, or until an arm asks for an earlier wake-up
+        template <typename Timers>
+        Row measure(const char* name, Timers& timers, uint32_t ticks) {
+            uint32_t fired = 0;
+            uint32_t wakeups = 0;
+            bool wake = false;
+            auto arm = [&timers, &wake](uint16_t id, uint32_t t, uint32_t delay) {
+                wake |= timers.arm(id, t, delay);
+            };
+            for (uint8_t c = 0; c < CLIENTS; ++c) {
+                arm(c * 3 + TRAINING_END, 0, TRAINING_MS + c * 10);
+                arm(c * 3 + REACTION, 0, REACTION_MS);
+                arm(c * 3 + LIVENESS, 0, LIVENESS_MS);
+            }
+
+            uint32_t wakeAt = 0;
+            Clock::time_point start = Clock::now();
+            for (uint32_t now = 1; now <= ticks; ++now) {
+                traffic(now, arm);
+                if (!wake && static_cast<int32_t>(now - wakeAt) < 0) {
+                    continue;
+                }
+                wake = false;
+                wakeups++;
+                uint32_t delay = timers.advance(now, [&](uint16_t id) { fire(id, now, arm, fired); });
+                wakeAt = now + std::min<uint32_t>(delay, INT32_MAX);
+            }
+            double ns = static_cast<double>(nanosSince(start)) / ticks;
+            return Row{name, {
+                {"ns/ms", ns},
+                {"wakeups/s", wakeups * 1000.0 / ticks},
+                {"fired", static_cast<double>(fired)},
+            }};
+        }
+
+        // arm() from other threads while the owner advances as fast as it
+        // can, each thread re-arming its own timers; time per arm call
+        Row contended(TimerWheel<TIMERS>& wheel, uint32_t arms) {
+            std::atomic<uint32_t> now{1};
+            std::atomic<bool> done{false};
+            uint32_t fired = 0;
+            std::thread owner([&] {
+                while (!done.load(std::memory_order_relaxed)) {
+                    uint32_t t = now.fetch_add(1, std::memory_order_relaxed) + 1;
+                    wheel.advance(t, [&fired](uint16_t) { fired++; });
+                }
+            });
+
+            std::array<std::vector<uint64_t>, ARMING_THREADS> armNs;
+            std::vector<std::thread> arming;
+            for (uint8_t i = 0; i < ARMING_THREADS; ++i) {
+                arming.emplace_back([&, i] {
+                    armNs[i].reserve(arms);
+                    for (uint32_t n = 0; n < arms; ++n) {
+                        uint16_t id = (n * ARMING_THREADS + i) % TIMERS;
+                        uint32_t delay = id % 3 == LIVENESS ? LIVENESS_MS : REACTION_MS;
+                        Clock::time_point one = Clock::now();
+                        wheel.arm(id, now.load(std::memory_order_relaxed), delay);
+                        armNs[i].push_back(nanosSince(one));
+                    }
+                });
+            }
+            for (auto& thread : arming) {
+                thread.join();
+            }
+            done.store(true);
+            owner.join();
+
+            std::vector<uint64_t> all;
+            for (const auto& samples : armNs) {
+                all.insert(all.end(), samples.begin(), samples.end());
+            }
+            return Row{"timer wheel, 2 arming threads", {
+                {"arm p50 ns", static_cast<double>(percentile(all, 50))},
+                {"arm p99 ns", static_cast<double>(percentile(all, 99))},
+                {"ticks", static_cast<double>(now.load())},
+                {"fired", static_cast<double>(fired)},
+            }};
+        }
+    }
+
+    std::vector<Row> timers(uint32_t iterations) {
+        uint32_t ticks = iterations ? iterations : DEFAULT_TICKS;
+        std::unique_ptr<TimerWheel<TIMERS>> wheel(new TimerWheel<TIMERS>());
+        std::unique_ptr<LinearTimers> linear(new LinearTimers());
+        std::unique_ptr<TimerWheel<TIMERS>> shared(new TimerWheel<TIMERS>());
+        return {
+            measure("timer wheel", *wheel, ticks),
+            measure("linear scan", *linear, ticks),
+            contended(*shared, ticks / 2),
+        };
+    }
+}
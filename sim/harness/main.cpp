@@ -0,0 +1,676 @@
+// Load harness for the native build (pio run -e native).
+//
+// Runs the unchanged LEDMatrixHost against simulated targets and
+// dashboards, following a script of phases with their own hit rate and
+// packet loss, and reports throughput, latency percentiles and memory.
+//
+//   program --targets 32 --dashboards 4 --msgpack 2 --phase 10:2:0 --phase 10:2:20 --json
+//
+// More targets than the host's MAX_CLIENTS still send hits, status reports
+// and clock sync replies; the host has to reject their ids at ingress:
+//
+//   program --targets 200 --hit-rate 5
+//
+// --link-bench compares fire-and-forget and acknowledged training
+// start/stop at the loss of each phase instead, without the host:
+//
+//   program --targets 32 --link-bench 40 --loss 10 --phase 1:0:20 --phase 1:0:30
+//
+// --ingress-bench times the host's UDP callback in ns per datagram, for
+// valid packets and malformed ones:
+//
+//   program --ingress-bench 200000
+//
+// --bench runs component benchmarks (see MicroBench.h) against the idle
+// host:
+//
+//   program --bench ring --bench timers
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <LittleFS.h>
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "IngressBench.h"
+#include "LEDMatrixHost.h"
+#include "LinkBench.h"
+#include "MicroBench.h"
+#include "Sim.h"
+#include "SimDashboard.h"
+#include "SimTarget.h"
+
+namespace {
+    struct Phase {
+        float seconds;
+        float hitsPerSecond;        // Per target
+        float lossPercent;          // Both directions
+    };
+
+    struct Options {
+        uint16_t targets = 32;
+        uint8_t dashboards = 2;
+        uint8_t msgpack = 0;        // The first N dashboards use MessagePack
+        float duration = 10.0f;
+        float hitRate = 1.0f;
+        float loss = 0.0f;
+        std::vector<Phase> phases;
+        uint32_t statusIntervalMs = 1000;
+        float warmup = 3.0f;
+        uint32_t seed = 1;
+        bool json = false;
+        bool verbose = false;
+        bool keepFs = false;
+        uint16_t linkRounds = 0;    // > 0: run the link bench instead
+        uint32_t linkIntervalMs = 200;
+        uint32_t ingressPackets = 0;    // > 0: run the ingress bench instead
+        std::vector<std::string> benches;   // Non-empty: run these component benches instead
+        uint32_t benchIterations = 0;
+    };
+
+    struct PhaseResult {
+        Phase phase;
+        float seconds;
+        uint32_t hitsSent;
+        Sim::Network::Stats network;
+        Sim::Web::Stats web;
+        std::vector<uint32_t> latencies;
+    };
+
+    constexpr uint8_t WORKER_THREADS = 4;
+    constexpr uint16_t MAX_TARGETS = 240;      // 192.168.4.10-249; ids 0xFE and 0xFF are reserved
+    constexpr uint32_t SETTLE_MS = 1000;    // Host tasks done starting up before benches
+
+    void usage() {
+        fprintf(stderr,
+                "Usage: program [options]\n"
+                "  --targets N            simulated targets (32, up to %u; ids from %u on are rejected)\n"
+                "  --dashboards N         WebSocket dashboards (2, up to %u)\n"
+                "  --msgpack N            dashboards that switch to MessagePack (0)\n"
+                "  --duration S           seconds of the single phase (10)\n"
+                "  --hit-rate R           hits per second and target (1)\n"
+                "  --loss P               packet loss in percent, both directions (0)\n"
+                "  --phase S:R:P          scripted phase; repeat for several, replaces the three above\n"
+                "  --status-interval MS   status report period per target (1000)\n"
+                "  --warmup S             clock sync time before training starts (3)\n"
+                "  --seed N               random seed (1)\n"
+                "  --json                 report as JSON\n"
+                "  --verbose              show the host's serial output\n"
+                "  --keep-fs              keep the LittleFS directory\n"
+                "  --link-bench N         N start/stop rounds per target and phase loss, no host\n"
+                "  --link-interval MS     time between link bench rounds (200)\n"
+                "  --ingress-bench N      time N datagrams per kind through the UDP callback\n"
+                "  --bench NAME           component benchmark, repeatable; 'all' or 'list'\n"
+                "  --bench-iterations N   iterations per bench (bench default)\n",
+                MAX_TARGETS, Config::Network::MAX_CLIENTS, Config::Network::MAX_WEBSOCKET_CLIENTS);
+    }
+
+    bool parse(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+            auto needs = [&]() {
+                if (!value) {
+                    fprintf(stderr, "%s needs a value\n", arg.c_str());
+                    return false;
+                }
+                ++i;
+                return true;
+            };
+
+            if (arg == "--targets") {
+                if (!needs()) return false;
+                options.targets = atoi(value);
+            } else if (arg == "--dashboards") {
+                if (!needs()) return false;
+                options.dashboards = atoi(value);
+            } else if (arg == "--msgpack") {
+                if (!needs()) return false;
+                options.msgpack = atoi(value);
+            } else if (arg == "--duration") {
+                if (!needs()) return false;
+                options.duration = atof(value);
+            } else if (arg == "--hit-rate") {
+                if (!needs()) return false;
+                options.hitRate = atof(value);
+            } else if (arg == "--loss") {
+                if (!needs()) return false;
+                options.loss = atof(value);
+            } else if (arg == "--phase") {
+                if (!needs()) return false;
+                Phase phase;
+                if (sscanf(value, "%f:%f:%f", &phase.seconds, &phase.hitsPerSecond, &phase.lossPercent) != 3) {
+                    fprintf(stderr, "--phase expects SECONDS:HITS_PER_SECOND:LOSS_PERCENT\n");
+                    return false;
+                }
+                options.phases.push_back(phase);
+            } else if (arg == "--status-interval") {
+                if (!needs()) return false;
+                options.statusIntervalMs = strtoul(value, nullptr, 10);
+            } else if (arg == "--warmup") {
+                if (!needs()) return false;
+                options.warmup = atof(value);
+            } else if (arg == "--seed") {
+                if (!needs()) return false;
+                options.seed = strtoul(value, nullptr, 10);
+            } else if (arg == "--json") {
+                options.json = true;
+            } else if (arg == "--verbose") {
+                options.verbose = true;
+            } else if (arg == "--keep-fs") {
+                options.keepFs = true;
+            } else if (arg == "--link-bench") {
+                if (!needs()) return false;
+                options.linkRounds = atoi(value);
+            } else if (arg == "--link-interval") {
+                if (!needs()) return false;
+                options.linkIntervalMs = strtoul(value, nullptr, 10);
+            } else if (arg == "--ingress-bench") {
+                if (!needs()) return false;
+                options.ingressPackets = strtoul(value, nullptr, 10);
+            } else if (arg == "--bench") {
+                if (!needs()) return false;
+                options.benches.push_back(value);
+            } else if (arg == "--bench-iterations") {
+                if (!needs()) return false;
+                options.benchIterations = strtoul(value, nullptr, 10);
+            } else {
+                return false;
+            }
+        }
+
+        for (const auto& name : options.benches) {
+            if (name == "list") {
+                for (const auto& bench : MicroBench::all()) {
+                    printf("%-12s %s\n", bench.name, bench.description);
+                }
+                exit(EXIT_SUCCESS);
+            }
+            if (name != "all" && !MicroBench::find(name)) {
+                fprintf(stderr, "Unknown bench %s (--bench list)\n", name.c_str());
+                return false;
+            }
+        }
+        // Every target needs a client id and an address of its own
+        if (options.targets < 1 || options.targets > MAX_TARGETS) {
+            fprintf(stderr, "--targets must be 1..%u\n", MAX_TARGETS);
+            return false;
+        }
+        options.msgpack = std::min(options.msgpack, options.dashboards);
+        if (options.phases.empty()) {
+            options.phases.push_back(Phase{options.duration, options.hitRate, options.loss});
+        }
+        for (const auto& phase : options.phases) {
+            if (phase.seconds <= 0 || phase.hitsPerSecond < 0 || phase.lossPercent < 0 || phase.lossPercent > 100) {
+                fprintf(stderr, "Invalid phase %.1f:%.1f:%.1f\n", phase.seconds, phase.hitsPerSecond,
+                        phase.lossPercent);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    uint32_t percentile(const std::vector<uint32_t>& sorted, uint8_t p) {
+        if (sorted.empty()) {
+            return 0;
+        }
+        size_t rank = (sorted.size() * p + 99) / 100;
+        return sorted[std::max<size_t>(rank, 1) - 1];
+    }
+
+    Sim::Network::Stats operator-(const Sim::Network::Stats& a, const Sim::Network::Stats& b) {
+        return Sim::Network::Stats{
+            a.rxSent - b.rxSent, a.rxLost - b.rxLost, a.rxOverflow - b.rxOverflow, a.rxDelivered - b.rxDelivered,
+            a.txSent - b.txSent, a.txLost - b.txLost, a.txOverflow - b.txOverflow, a.txDelivered - b.txDelivered
+        };
+    }
+
+    Sim::Web::Stats operator-(const Sim::Web::Stats& a, const Sim::Web::Stats& b) {
+        return Sim::Web::Stats{a.messagesSent - b.messagesSent, a.bytesSent - b.bytesSent,
+                               a.messagesDropped - b.messagesDropped};
+    }
+
+    void sleepSeconds(float seconds) {
+        std::this_thread::sleep_for(std::chrono::microseconds(static_cast<int64_t>(seconds * 1e6f)));
+    }
+
+    // Both delivery modes at the loss of every phase
+    void runLinkBench(const Options& options) {
+        DynamicJsonDocument report(8192);
+        JsonArray runs = report.createNestedArray("linkBench");
+        if (!options.json) {
+            printf("Training start/stop to %u targets, %u rounds %u ms apart, loss in both directions\n\n",
+                   options.targets, options.linkRounds, options.linkIntervalMs);
+            printf("%6s %-8s %8s %8s %9s %6s %6s %7s %7s %7s %8s %8s %8s %8s\n", "loss%", "mode", "commands",
+                   "applied", "delivery", "stale", "dups", "resent", "failed", "replaced", "p50 ms", "p90 ms",
+                   "p99 ms", "max ms");
+        }
+        for (const auto& phase : options.phases) {
+            for (bool reliable : {false, true}) {
+                LinkBench::Result r = LinkBench::run(options.targets, options.linkRounds, options.linkIntervalMs,
+                                                     phase.lossPercent, reliable, options.seed);
+                float delivery = r.commands ? 100.0f * r.applied / r.commands : 0.0f;
+                uint32_t maximum = r.latencies.empty() ? 0 : r.latencies.back();
+                JsonObject obj = runs.createNestedObject();
+                obj["lossPercent"] = r.lossPercent;
+                obj["mode"] = reliable ? "reliable" : "plain";
+                obj["commands"] = r.commands;
+                obj["applied"] = r.applied;
+                obj["deliveryPercent"] = delivery;
+                obj["staleTargets"] = r.stale;
+                obj["duplicatesDropped"] = r.duplicates;
+                obj["retransmits"] = r.retransmits;
+                obj["failed"] = r.failed;
+                obj["superseded"] = r.superseded;
+                JsonObject latency = obj.createNestedObject("ackLatencyUs");
+                latency["samples"] = r.latencies.size();
+                latency["p50"] = percentile(r.latencies, 50);
+                latency["p90"] = percentile(r.latencies, 90);
+                latency["p99"] = percentile(r.latencies, 99);
+                latency["max"] = maximum;
+                if (!options.json) {
+                    printf("%6.1f %-8s %8u %8u %8.1f%% %6u %6u %7u %7u %7u %8.2f %8.2f %8.2f %8.2f\n",
+                           r.lossPercent, reliable ? "reliable" : "plain", r.commands, r.applied, delivery, r.stale,
+                           r.duplicates, r.retransmits, r.failed, r.superseded,
+                           percentile(r.latencies, 50) / 1000.0, percentile(r.latencies, 90) / 1000.0,
+                           percentile(r.latencies, 99) / 1000.0, maximum / 1000.0);
+                    fflush(stdout);
+                }
+            }
+        }
+        if (options.json) {
+            std::string out;
+            serializeJsonPretty(report, out);
+            printf("%s\n", out.c_str());
+        }
+        fflush(stdout);
+    }
+
+    // Valid and malformed datagrams through the running host
+    void runIngressBench(const Options& options) {
+        std::vector<IngressBench::Result> results = IngressBench::run(options.ingressPackets);
+        if (options.json) {
+            DynamicJsonDocument report(4096);
+            JsonArray kinds = report.createNestedArray("ingressBench");
+            for (const auto& r : results) {
+                JsonObject obj = kinds.createNestedObject();
+                obj["kind"] = r.kind;
+                obj["valid"] = r.valid;
+                obj["packets"] = r.packets;
+                obj["parseNs"] = r.parseNs;
+                obj["hostNs"] = r.hostNs;
+                obj["rejected"] = r.rejected;
+                obj["dropped"] = r.dropped;
+            }
+            std::string out;
+            serializeJsonPretty(report, out);
+            printf("%s\n", out.c_str());
+        } else {
+            printf("UDP ingress, %u datagrams per kind, %u sender ids\n\n", options.ingressPackets,
+                   Config::Network::MAX_CLIENTS);
+            printf("%-14s %-6s %10s %10s %10s %10s\n", "kind", "valid", "parse ns", "host ns", "rejected",
+                   "ring drops");
+            for (const auto& r : results) {
+                printf("%-14s %-6s %10.1f %10.1f %10u %10u\n", r.kind, r.valid ? "yes" : "no", r.parseNs,
+                       r.hostNs, r.rejected, r.dropped);
+            }
+        }
+        fflush(stdout);
+    }
+
+    // Component benches, one table (or JSON object) per bench
+    void runMicroBench(const Options& options) {
+        std::vector<const MicroBench::Bench*> selected;
+        for (const auto& name : options.benches) {
+            if (name == "all") {
+                for (const auto& bench : MicroBench::all()) {
+                    selected.push_back(&bench);
+                }
+            } else {
+                selected.push_back(MicroBench::find(name));
+            }
+        }
+
+        DynamicJsonDocument report(16384);
+        JsonObject benches = report.createNestedObject("bench");
+        for (const MicroBench::Bench* bench : selected) {
+            std::vector<MicroBench::Row> rows = bench->run(options.benchIterations);
+            if (options.json) {
+                JsonArray out = benches.createNestedArray(bench->name);
+                for (const auto& row : rows) {
+                    JsonObject obj = out.createNestedObject();
+                    obj["variant"] = row.variant;
+                    for (const auto& value : row.values) {
+                        obj[value.first] = value.second;
+                    }
+                }
+                continue;
+            }
+            printf("%s: %s\n", bench->name, bench->description);
+            for (const auto& row : rows) {
+                printf("  %-26s", row.variant.c_str());
+                for (const auto& value : row.values) {
+                    printf(value.second >= 1000 ? "  %s %.0f" : "  %s %.3g", value.first.c_str(), value.second);
+                }
+                printf("\n");
+            }
+            printf("\n");
+            fflush(stdout);
+        }
+        if (options.json) {
+            std::string out;
+            serializeJsonPretty(report, out);
+            printf("%s\n", out.c_str());
+        }
+        fflush(stdout);
+    }
+
+    // Lines of the Prometheus text that start with one of the names
+    std::vector<std::string> metricLines(const std::string& text, std::initializer_list<const char*> names) {
+        std::vector<std::string> lines;
+        size_t start = 0;
+        while (start < text.size()) {
+            size_t end = text.find('\n', start);
+            if (end == std::string::npos) end = text.size();
+            std::string line = text.substr(start, end - start);
+            for (const char* name : names) {
+                if (line.compare(0, strlen(name), name) == 0) {
+                    lines.push_back(line);
+                    break;
+                }
+            }
+            start = end + 1;
+        }
+        return lines;
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parse(argc, argv, options)) {
+        usage();
+        return EXIT_FAILURE;
+    }
+
+    Sim::setLogOutput(options.verbose);
+    Sim::Network::setSeed(options.seed);
+    randomSeed(options.seed);
+    if (options.linkRounds) {
+        runLinkBench(options);
+        Sim::shutdown(EXIT_SUCCESS);
+    }
+
+    // Simulation objects first, so the heap baseline only covers the host
+    HitLog log;
+    std::vector<std::unique_ptr<SimTarget>> targets;
+    for (uint16_t i = 0; i < options.targets; ++i) {
+        targets.emplace_back(new SimTarget(i, options.seed));
+    }
+    LatencySink sink(options.phases.size());
+    std::vector<std::unique_ptr<SimDashboard>> dashboards;
+    for (uint8_t i = 0; i < options.dashboards; ++i) {
+        dashboards.emplace_back(new SimDashboard(i < options.msgpack, log, sink));
+    }
+
+    // Host wie auf dem ESP32: setup(), dann loop() alle 10 ms
+    Sim::resetHeapBaseline();
+    LEDMatrixHost* host = new LEDMatrixHost();
+    if (!host->begin()) {
+        fprintf(stderr, "Host initialization failed\n");
+        Sim::shutdown(EXIT_FAILURE);
+    }
+    std::atomic<bool> running(true);
+    std::thread loopThread([&] {
+        while (running.load(std::memory_order_relaxed)) {
+            host->loop();
+            vTaskDelay(pdMS_TO_TICKS(10));
+        }
+    });
+    if (options.ingressPackets) {
+        runIngressBench(options);
+        running.store(false);
+        Sim::shutdown(EXIT_SUCCESS);
+    }
+    if (!options.benches.empty()) {
+        // Otherwise the first variant measured shares the CPU with it
+        delay(SETTLE_MS);
+        runMicroBench(options);
+        running.store(false);
+        Sim::shutdown(EXIT_SUCCESS);
+    }
+
+    // Ziele
+    for (const auto& target : targets) {
+        Sim::Network::attach(target->address(), target.get());
+    }
+    std::atomic<float> hitRate(0.0f);
+    std::vector<std::thread> workers;
+    for (uint8_t w = 0; w < std::min<size_t>(WORKER_THREADS, targets.size()); ++w) {
+        workers.emplace_back([&, w] {
+            while (running.load(std::memory_order_relaxed)) {
+                float rate = hitRate.load(std::memory_order_relaxed);
+                for (size_t i = w; i < targets.size(); i += WORKER_THREADS) {
+                    targets[i]->poll(micros(), rate, options.statusIntervalMs, log);
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+    }
+
+    // Dashboards
+    uint8_t refused = 0;
+    for (const auto& dashboard : dashboards) {
+        if (!dashboard->connect()) {
+            refused++;
+        }
+    }
+    uint32_t connectedAt = millis();
+
+    // Clocks settle, then one training for everybody
+    sleepSeconds(options.warmup);
+    float total = 0;
+    for (const auto& phase : options.phases) {
+        total += phase.seconds;
+    }
+    String body = "{\"all\":true,\"config\":{\"duration\":";
+    body += String(static_cast<uint32_t>(total) + 10);
+    body += ",\"reactTime\":0}}";
+    Sim::HttpResponse started = Sim::Web::request(HTTP_POST, "/api/training", body,
+                                                  Config::Security::API_USERNAME, Config::Security::API_PASSWORD);
+    sleepSeconds(0.2f);
+    uint16_t training = std::count_if(targets.begin(), targets.end(),
+                                      [](const std::unique_ptr<SimTarget>& t) { return t->isTraining(); });
+
+    // Ablauf
+    std::vector<PhaseResult> results;
+    for (size_t p = 0; p < options.phases.size(); ++p) {
+        const Phase& phase = options.phases[p];
+        Sim::Network::setLoss(phase.lossPercent / 100.0f, phase.lossPercent / 100.0f);
+        uint32_t hitsBefore = 0;
+        for (const auto& target : targets) hitsBefore += target->getHitsSent();
+        Sim::Network::Stats network = Sim::Network::getStats();
+        Sim::Web::Stats web = Sim::Web::getStats();
+        uint32_t begin = micros();
+
+        sink.setPhase(p);
+        hitRate.store(phase.hitsPerSecond, std::memory_order_relaxed);
+        sleepSeconds(phase.seconds);
+
+        PhaseResult result;
+        result.phase = phase;
+        result.seconds = (micros() - begin) / 1e6f;
+        result.hitsSent = 0;
+        for (const auto& target : targets) result.hitsSent += target->getHitsSent();
+        result.hitsSent -= hitsBefore;
+        result.network = Sim::Network::getStats() - network;
+        result.web = Sim::Web::getStats() - web;
+        results.push_back(result);
+    }
+
+    // Late dashboard updates still count for the last phase
+    hitRate.store(0.0f, std::memory_order_relaxed);
+    Sim::Network::setLoss(0.0f, 0.0f);
+    sleepSeconds(1.0f);
+    sink.setPhase(-1);
+    for (size_t p = 0; p < results.size(); ++p) {
+        results[p].latencies = sink.take(p);
+    }
+
+    Sim::HttpResponse system = Sim::Web::request(HTTP_GET, "/api/system", String(),
+                                                 Config::Security::API_USERNAME, Config::Security::API_PASSWORD);
+    Sim::HttpResponse metrics = Sim::Web::request(HTTP_GET, "/api/metrics", String(),
+                                                  Config::Security::API_USERNAME, Config::Security::API_PASSWORD);
+    DynamicJsonDocument systemDoc(4096);
+    deserializeJson(systemDoc, system.body);
+    // The host counts status bytes only while dashboards are connected
+    float connectedSeconds = (millis() - connectedAt) / 1000.0f;
+    uint32_t statusBytes = systemDoc["statusBroadcast"]["bytes"];
+    std::vector<std::string> memoryLines = metricLines(metrics.body, {"heap_", "task_stack_free_bytes"});
+    std::vector<std::string> ingressLines = metricLines(metrics.body, {"udp_rx_"});
+
+    uint32_t syncReplies = 0;
+    uint32_t statusSent = 0;
+    for (const auto& target : targets) {
+        syncReplies += target->getSyncReplies();
+        statusSent += target->getStatusSent();
+    }
+
+    // Bericht
+    DynamicJsonDocument report(16384);
+    JsonObject setup = report.createNestedObject("setup");
+    setup["targets"] = options.targets;
+    setup["targetsAddressable"] = std::min<uint16_t>(options.targets, Config::Network::MAX_CLIENTS);
+    setup["targetsTraining"] = training;
+    setup["trainingStartCode"] = started.code;
+    setup["dashboards"] = options.dashboards;
+    setup["dashboardsRefused"] = refused;
+    setup["msgpack"] = options.msgpack;
+    setup["statusIntervalMs"] = options.statusIntervalMs;
+    setup["syncReplies"] = syncReplies;
+    setup["statusSent"] = statusSent;
+    setup["seed"] = options.seed;
+
+    JsonArray phases = report.createNestedArray("phases");
+    for (const auto& result : results) {
+        JsonObject obj = phases.createNestedObject();
+        obj["seconds"] = result.seconds;
+        obj["hitRate"] = result.phase.hitsPerSecond;
+        obj["lossPercent"] = result.phase.lossPercent;
+        obj["hitsSent"] = result.hitsSent;
+        obj["hitsPerSecond"] = result.hitsSent / result.seconds;
+        JsonObject udp = obj.createNestedObject("udp");
+        udp["toHost"] = result.network.rxSent;
+        udp["toHostLost"] = result.network.rxLost;
+        udp["toHostOverflow"] = result.network.rxOverflow;
+        udp["delivered"] = result.network.rxDelivered;
+        udp["deliveredPerSecond"] = result.network.rxDelivered / result.seconds;
+        udp["fromHost"] = result.network.txSent;
+        udp["fromHostLost"] = result.network.txLost;
+        udp["fromHostOverflow"] = result.network.txOverflow;
+        JsonObject ws = obj.createNestedObject("ws");
+        ws["messages"] = result.web.messagesSent;
+        ws["bytes"] = result.web.bytesSent;
+        ws["dropped"] = result.web.messagesDropped;
+        JsonObject latency = obj.createNestedObject("hitLatencyUs");
+        latency["samples"] = result.latencies.size();
+        latency["p50"] = percentile(result.latencies, 50);
+        latency["p90"] = percentile(result.latencies, 90);
+        latency["p99"] = percentile(result.latencies, 99);
+        latency["max"] = result.latencies.empty() ? 0 : result.latencies.back();
+    }
+
+    JsonArray dashboardArray = report.createNestedArray("dashboards");
+    for (const auto& dashboard : dashboards) {
+        JsonObject obj = dashboardArray.createNestedObject();
+        obj["encoding"] = dashboard->isMsgpack() ? "msgpack" : "json";
+        obj["messages"] = dashboard->getMessages();
+        obj["bytes"] = dashboard->getBytes();
+        obj["trainingStatus"] = dashboard->getTrainingStatus();
+        obj["parseErrors"] = dashboard->getParseErrors();
+        obj["closed"] = dashboard->isClosed();
+    }
+
+    JsonObject hostStats = report.createNestedObject("host");
+    hostStats["latency"] = systemDoc["latency"];
+    hostStats["messageQueue"] = systemDoc["messageQueue"];
+    hostStats["wsBuffers"] = systemDoc["wsBuffers"];
+    hostStats["statusBroadcast"] = systemDoc["statusBroadcast"];
+    hostStats["statusBytesPerSecond"] = statusBytes / connectedSeconds;
+    hostStats["reliable"] = systemDoc["reliable"];
+    JsonArray ingress = hostStats.createNestedArray("ingress");
+    for (const auto& line : ingressLines) {
+        ingress.add(line.c_str());
+    }
+    JsonObject memory = report.createNestedObject("memory");
+    memory["heapFree"] = ESP.getFreeHeap();
+    memory["heapMinFree"] = ESP.getMinFreeHeap();
+    memory["processHeapBytes"] = Sim::heapInUse();
+    memory["peakRssBytes"] = Sim::peakRss();
+    JsonArray lines = memory.createNestedArray("metrics");
+    for (const auto& line : memoryLines) {
+        lines.add(line.c_str());
+    }
+
+    if (options.json) {
+        std::string out;
+        serializeJsonPretty(report, out);
+        printf("%s\n", out.c_str());
+    } else {
+        printf("Targets %u (%u training, start HTTP %d), dashboards %u (%u msgpack, %u refused)\n",
+               options.targets, training, started.code, options.dashboards, options.msgpack, refused);
+        printf("Clock sync replies %u, status reports %u\n\n", syncReplies, statusSent);
+        printf("%-5s %7s %7s %6s %9s %9s %8s %8s %9s %8s %8s %8s %8s %8s\n", "phase", "seconds", "rate", "loss%",
+               "hits/s", "rx/s", "rxLost", "rxOvfl", "wsMsgs", "wsDrop", "p50 ms", "p90 ms", "p99 ms", "max ms");
+        for (size_t p = 0; p < results.size(); ++p) {
+            const PhaseResult& r = results[p];
+            printf("%-5zu %7.1f %7.2f %6.1f %9.1f %9.1f %8u %8u %9u %8u %8.2f %8.2f %8.2f %8.2f\n", p + 1, r.seconds,
+                   r.phase.hitsPerSecond, r.phase.lossPercent, r.hitsSent / r.seconds,
+                   r.network.rxDelivered / r.seconds, r.network.rxLost, r.network.rxOverflow, r.web.messagesSent,
+                   r.web.messagesDropped, percentile(r.latencies, 50) / 1000.0, percentile(r.latencies, 90) / 1000.0,
+                   percentile(r.latencies, 99) / 1000.0,
+                   (r.latencies.empty() ? 0 : r.latencies.back()) / 1000.0);
+        }
+        printf("\nHit latency samples per phase:");
+        for (const auto& r : results) {
+            printf(" %zu", r.latencies.size());
+        }
+        printf("\nHost latency (us): ingress count %u p99 %u max %u, dashboard count %u p99 %u max %u\n",
+               systemDoc["latency"]["ingress"]["count"].as<uint32_t>(),
+               systemDoc["latency"]["ingress"]["p99Us"].as<uint32_t>(),
+               systemDoc["latency"]["ingress"]["maxUs"].as<uint32_t>(),
+               systemDoc["latency"]["dashboard"]["count"].as<uint32_t>(),
+               systemDoc["latency"]["dashboard"]["p99Us"].as<uint32_t>(),
+               systemDoc["latency"]["dashboard"]["maxUs"].as<uint32_t>());
+        printf("Status broadcast: %u messages, %u bytes, %.0f B/s to %u dashboards\n",
+               systemDoc["statusBroadcast"]["messages"].as<uint32_t>(), statusBytes,
+               statusBytes / connectedSeconds, options.dashboards - refused);
+        printf("Ingress:\n");
+        for (const auto& line : ingressLines) {
+            printf("  %s\n", line.c_str());
+        }
+        printf("Message queue: high water %u of %u, dropped %u\n",
+               systemDoc["messageQueue"]["highWater"].as<uint32_t>(),
+               systemDoc["messageQueue"]["capacity"].as<uint32_t>(),
+               systemDoc["messageQueue"]["dropped"].as<uint32_t>());
+        printf("Heap: free %u, min free %u (simulated %u KB ESP32 heap); process heap %zu, peak RSS %zu\n",
+               ESP.getFreeHeap(), ESP.getMinFreeHeap(), ESP.getHeapSize() / 1024, Sim::heapInUse(), Sim::peakRss());
+        for (const auto& line : memoryLines) {
+            printf("  %s\n", line.c_str());
+        }
+    }
+    fflush(stdout);
+
+    running.store(false);
+    for (auto& dashboard : dashboards) {
+        dashboard->disconnect();
+    }
+    if (!options.keepFs) {
+        std::error_code error;
+        std::filesystem::remove_all(Sim::FileSystem::getRoot(), error);
+    }
+    // Host tasks never return; leave without joining them
+    Sim::shutdown(EXIT_SUCCESS);
+}
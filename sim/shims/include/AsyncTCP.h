@@ -0,0 +1,6 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Included by the host for ESPAsyncWebServer's sake only; the connections
+// themselves are simulated in ESPAsyncWebServer.h
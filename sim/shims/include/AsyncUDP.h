@@ -0,0 +1,63 @@
+#pragma once
+
+#include <Arduino.h>
+#include <functional>
+
+// One received datagram. Only valid inside the onPacket callback, like
+// the pbuf-backed original.
+class AsyncUDPPacket {
+public:
+    AsyncUDPPacket(const uint8_t* data, size_t length, const IPAddress& remoteIP, uint16_t remotePort,
+                   uint16_t localPort, bool broadcast)
+        : payload(data), size(length), remote(remoteIP), remotePortNumber(remotePort),
+          localPortNumber(localPort), broadcastPacket(broadcast) {}
+
+    uint8_t* data() { return const_cast<uint8_t*>(payload); }
+    size_t length() const { return size; }
+    IPAddress remoteIP() const { return remote; }
+    uint16_t remotePort() const { return remotePortNumber; }
+    uint16_t localPort() const { return localPortNumber; }
+    bool isBroadcast() const { return broadcastPacket; }
+    bool isMulticast() const { return false; }
+
+private:
+    const uint8_t* payload;
+    size_t size;
+    IPAddress remote;
+    uint16_t remotePortNumber;
+    uint16_t localPortNumber;
+    bool broadcastPacket;
+};
+
+typedef std::function<void(AsyncUDPPacket& packet)> AuPacketHandlerFunction;
+
+// Socket on the simulated network (see Sim::Network). Packets are handed
+// to onPacket from a single network thread, one at a time.
+class AsyncUDP {
+public:
+    AsyncUDP() = default;
+    ~AsyncUDP();
+
+    bool listen(uint16_t port);
+    void onPacket(AuPacketHandlerFunction callback) { handler = callback; }
+    void close();
+
+    size_t writeTo(const uint8_t* data, size_t len, const IPAddress& address, uint16_t port);
+    size_t broadcastTo(const uint8_t* data, size_t len, uint16_t port);
+    size_t broadcastTo(const char* data, uint16_t port) {
+        return broadcastTo(reinterpret_cast<const uint8_t*>(data), strlen(data), port);
+    }
+
+    bool connected() const { return port != 0; }
+
+    // Network thread only
+    void deliver(AsyncUDPPacket& packet) {
+        if (handler) {
+            handler(packet);
+        }
+    }
+
+private:
+    AuPacketHandlerFunction handler;
+    uint16_t port = 0;
+};
@@ -0,0 +1,405 @@
+#pragma once
+
+#include <Arduino.h>
+#include <FS.h>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// ESPAsyncWebServer without sockets. Requests and WebSocket connections
+// come from Sim::Web and are handled on the async_tcp thread, in handler
+// registration order, with the original's URI matching rules. Responses
+// are collected whole; chunked fillers are drained right after the
+// handler returns.
+
+namespace Sim {
+    class WsPeer;
+    namespace Web {
+        class Access;
+    }
+}
+
+typedef enum {
+    HTTP_GET = 0b00000001,
+    HTTP_POST = 0b00000010,
+    HTTP_DELETE = 0b00000100,
+    HTTP_PUT = 0b00001000,
+    HTTP_PATCH = 0b00010000,
+    HTTP_HEAD = 0b00100000,
+    HTTP_OPTIONS = 0b01000000,
+    HTTP_ANY = 0b01111111
+} WebRequestMethod;
+
+typedef uint8_t WebRequestMethodComposite;
+
+#define RESPONSE_TRY_AGAIN 0xFFFFFFFF
+
+class AsyncWebServerRequest;
+class AsyncWebServerResponse;
+
+typedef std::function<void(AsyncWebServerRequest* request)> ArRequestHandlerFunction;
+typedef std::function<bool(AsyncWebServerRequest* request)> ArRequestFilterFunction;
+typedef std::function<size_t(uint8_t* buffer, size_t maxLen, size_t index)> AwsResponseFiller;
+
+class AsyncWebHeader {
+public:
+    AsyncWebHeader(const String& name, const String& value) : headerName(name), headerValue(value) {}
+    const String& name() const { return headerName; }
+    const String& value() const { return headerValue; }
+
+private:
+    String headerName;
+    String headerValue;
+};
+
+class AsyncWebParameter {
+public:
+    AsyncWebParameter(const String& name, const String& value, bool form = false, bool file = false)
+        : paramName(name), paramValue(value), form(form), file(file) {}
+    const String& name() const { return paramName; }
+    const String& value() const { return paramValue; }
+    size_t size() const { return paramValue.length(); }
+    bool isPost() const { return form; }
+    bool isFile() const { return file; }
+
+private:
+    String paramName;
+    String paramValue;
+    bool form;
+    bool file;
+};
+
+class AsyncWebServerResponse {
+public:
+    AsyncWebServerResponse(int code, const String& contentType, AwsResponseFiller filler)
+        : responseCode(code), type(contentType), filler(std::move(filler)) {}
+    virtual ~AsyncWebServerResponse() = default;
+
+    void setCode(int code) { responseCode = code; }
+    void setContentType(const String& contentType) { type = contentType; }
+    void setContentLength(size_t length) { (void)length; }
+    void addHeader(const String& name, const String& value) { headers.emplace_back(name, value); }
+
+private:
+    friend class Sim::Web::Access;
+
+    int responseCode;
+    String type;
+    std::vector<AsyncWebHeader> headers;
+    AwsResponseFiller filler;
+};
+
+class AsyncWebServerRequest {
+public:
+    WebRequestMethodComposite method() const { return requestMethod; }
+    const String& url() const { return requestUrl; }
+    const String& host() const { return requestHost; }
+    const String& contentType() const { return requestContentType; }
+    size_t contentLength() const { return bodyLength; }
+
+    bool hasParam(const String& name, bool post = false, bool file = false) const {
+        return getParam(name, post, file) != nullptr;
+    }
+    AsyncWebParameter* getParam(const String& name, bool post = false, bool file = false) const;
+    size_t params() const { return parameters.size(); }
+    AsyncWebParameter* getParam(size_t index) const {
+        return index < parameters.size() ? const_cast<AsyncWebParameter*>(&parameters[index]) : nullptr;
+    }
+    bool hasArg(const char* name) const { return hasParam(name) || hasParam(name, true); }
+    const String& arg(const String& name) const;
+    const String& pathArg(size_t index) const;
+
+    bool hasHeader(const String& name) const { return getHeader(name) != nullptr; }
+    AsyncWebHeader* getHeader(const String& name) const;
+    size_t headers() const { return requestHeaders.size(); }
+    void addInterestingHeader(const String& name) { (void)name; }    // All headers are kept
+
+    bool authenticate(const char* username, const char* password, const char* realm = nullptr,
+                      bool passwordIsHash = false);
+    void requestAuthentication(const char* realm = nullptr, bool isDigest = true);
+
+    void send(AsyncWebServerResponse* response);
+    void send(int code, const String& contentType = String(), const String& content = String()) {
+        send(beginResponse(code, contentType, content));
+    }
+    void send(FS& fs, const String& path, const String& contentType = String(), bool download = false) {
+        send(beginResponse(fs, path, contentType, download));
+    }
+    void send(File content, const String& path, const String& contentType = String(), bool download = false) {
+        send(beginResponse(content, path, contentType, download));
+    }
+
+    AsyncWebServerResponse* beginResponse(int code, const String& contentType = String(),
+                                          const String& content = String());
+    AsyncWebServerResponse* beginResponse(FS& fs, const String& path, const String& contentType = String(),
+                                          bool download = false);
+    AsyncWebServerResponse* beginResponse(File content, const String& path, const String& contentType = String(),
+                                          bool download = false);
+    AsyncWebServerResponse* beginResponse_P(int code, const String& contentType, const uint8_t* content, size_t len);
+    AsyncWebServerResponse* beginChunkedResponse(const String& contentType, AwsResponseFiller callback);
+
+    void _addPathParam(const char* param) { pathParameters.emplace_back(param); }
+
+private:
+    friend class Sim::Web::Access;
+
+    WebRequestMethodComposite requestMethod = HTTP_GET;
+    String requestUrl;
+    String requestHost;
+    String requestContentType;
+    size_t bodyLength = 0;
+    std::vector<AsyncWebParameter> parameters;
+    std::vector<String> pathParameters;
+    std::vector<AsyncWebHeader> requestHeaders;
+    String username;
+    String password;
+    String staticPath;              // Resolved by AsyncStaticWebHandler::canHandle
+    std::unique_ptr<AsyncWebServerResponse> response;
+};
+
+class AsyncWebHandler {
+public:
+    virtual ~AsyncWebHandler() = default;
+
+    AsyncWebHandler& setFilter(ArRequestFilterFunction fn) { requestFilter = fn; return *this; }
+    bool filter(AsyncWebServerRequest* request) { return !requestFilter || requestFilter(request); }
+
+    virtual bool canHandle(AsyncWebServerRequest* request) { (void)request; return false; }
+    virtual void handleRequest(AsyncWebServerRequest* request) { (void)request; }
+    virtual bool isRequestHandlerTrivial() { return true; }
+
+protected:
+    ArRequestFilterFunction requestFilter;
+};
+
+class AsyncCallbackWebHandler : public AsyncWebHandler {
+public:
+    void setUri(const String& uri);
+    void setMethod(WebRequestMethodComposite method) { methods = method; }
+    void onRequest(ArRequestHandlerFunction fn) { callback = fn; }
+
+    bool canHandle(AsyncWebServerRequest* request) override;
+    void handleRequest(AsyncWebServerRequest* request) override;
+    bool isRequestHandlerTrivial() override { return !callback; }
+
+private:
+    String uri;
+    WebRequestMethodComposite methods = HTTP_ANY;
+    ArRequestHandlerFunction callback;
+    bool isRegex = false;           // ^...$ with ASYNCWEBSERVER_REGEX
+};
+
+class AsyncStaticWebHandler : public AsyncWebHandler {
+public:
+    AsyncStaticWebHandler(const char* uri, FS& fs, const char* path, const char* cacheControl);
+
+    AsyncStaticWebHandler& setDefaultFile(const char* filename) { defaultFile = filename; return *this; }
+    AsyncStaticWebHandler& setCacheControl(const char* cacheControl) { this->cacheControl = cacheControl; return *this; }
+
+    bool canHandle(AsyncWebServerRequest* request) override;
+    void handleRequest(AsyncWebServerRequest* request) override;
+
+private:
+    String uri;
+    FS fs;
+    String path;
+    String defaultFile = "index.htm";
+    String cacheControl;
+};
+
+class AsyncWebServer {
+public:
+    explicit AsyncWebServer(uint16_t port);
+    ~AsyncWebServer();
+
+    void begin() { started = true; }
+    void end() { started = false; }
+
+    AsyncWebHandler& addHandler(AsyncWebHandler* handler);
+    bool removeHandler(AsyncWebHandler* handler);
+    AsyncCallbackWebHandler& on(const char* uri, ArRequestHandlerFunction onRequest) {
+        return on(uri, HTTP_ANY, onRequest);
+    }
+    AsyncCallbackWebHandler& on(const char* uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest);
+    AsyncStaticWebHandler& serveStatic(const char* uri, FS& fs, const char* path, const char* cacheControl = nullptr);
+    void onNotFound(ArRequestHandlerFunction fn) { notFound = fn; }
+
+private:
+    friend class Sim::Web::Access;
+
+    void handle(AsyncWebServerRequest* request);
+
+    uint16_t port;
+    bool started = false;
+    std::mutex handlersMutex;
+    std::vector<AsyncWebHandler*> handlers;                 // Registration order
+    std::vector<std::unique_ptr<AsyncWebHandler>> owned;    // Created by on()/serveStatic()
+    ArRequestHandlerFunction notFound;
+};
+
+// WebSocket
+typedef enum {
+    WS_DISCONNECTED,
+    WS_CONNECTED,
+    WS_DISCONNECTING
+} AwsClientStatus;
+
+typedef enum {
+    WS_CONTINUATION,
+    WS_TEXT,
+    WS_BINARY,
+    WS_DISCONNECT = 0x08,
+    WS_PING,
+    WS_PONG
+} AwsFrameType;
+
+typedef enum {
+    WS_EVT_CONNECT,
+    WS_EVT_DISCONNECT,
+    WS_EVT_PONG,
+    WS_EVT_ERROR,
+    WS_EVT_DATA
+} AwsEventType;
+
+typedef struct {
+    uint8_t message_opcode;
+    uint32_t num;
+    uint8_t final;
+    uint8_t masked;
+    uint8_t opcode;
+    uint64_t len;
+    uint8_t mask[4];
+    uint64_t index;
+} AwsFrameInfo;
+
+#define WS_MAX_QUEUED_MESSAGES 32
+
+// Payload shared by every queued message that references it, as in the
+// library since 3.0; the last message sent releases it
+using AsyncWebSocketSharedBuffer = std::shared_ptr<std::vector<uint8_t>>;
+
+// Wrapper from makeBuffer(); text() and textAll() take over its payload
+// and delete it
+class AsyncWebSocketMessageBuffer {
+public:
+    AsyncWebSocketMessageBuffer() = default;
+    explicit AsyncWebSocketMessageBuffer(size_t size) { reserve(size); }
+    AsyncWebSocketMessageBuffer(const uint8_t* data, size_t size) {
+        if (reserve(size) && data) memcpy(buffer->data(), data, size);
+    }
+
+    bool reserve(size_t size) {
+        buffer = std::make_shared<std::vector<uint8_t>>(size);
+        return true;
+    }
+    uint8_t* get() const { return buffer->data(); }
+    size_t length() const { return buffer->size(); }
+
+private:
+    friend class AsyncWebSocket;
+    friend class AsyncWebSocketClient;
+
+    AsyncWebSocketSharedBuffer buffer;
+};
+
+class AsyncWebSocket;
+
+class AsyncWebSocketClient {
+public:
+    uint32_t id() const { return clientId; }
+    AwsClientStatus status() const { return state.load(std::memory_order_acquire); }
+    AsyncWebSocket* server() { return owner; }
+    IPAddress remoteIP() const { return IPAddress(127, 0, 0, 1); }
+    uint16_t remotePort() const { return 0; }
+
+    size_t queueLen();
+    bool queueIsFull() { return queueLen() >= WS_MAX_QUEUED_MESSAGES; }
+    bool canSend() { return !queueIsFull(); }
+    void close(uint16_t code = 0, const char* message = nullptr);
+
+    void text(const char* message) { text(message, strlen(message)); }
+    void text(const char* message, size_t len);
+    void text(const String& message) { text(message.c_str(), message.length()); }
+    void text(AsyncWebSocketMessageBuffer* buffer);
+    void text(AsyncWebSocketSharedBuffer buffer) { queue(std::move(buffer), false); }
+    void binary(const uint8_t* message, size_t len);
+    void binary(AsyncWebSocketMessageBuffer* buffer);
+    void binary(AsyncWebSocketSharedBuffer buffer) { queue(std::move(buffer), true); }
+
+private:
+    friend class AsyncWebSocket;
+    friend class Sim::Web::Access;
+
+    struct Message {
+        AsyncWebSocketSharedBuffer buffer;
+        bool binary;
+    };
+
+    AsyncWebSocketClient(AsyncWebSocket* owner, uint32_t id) : owner(owner), clientId(id) {}
+    void queue(AsyncWebSocketSharedBuffer buffer, bool binary);
+
+    AsyncWebSocket* owner;
+    uint32_t clientId;
+    std::atomic<AwsClientStatus> state{WS_CONNECTED};
+    std::mutex queueMutex;
+    std::deque<Message> messages;
+    bool draining = false;
+    Sim::WsPeer* peer = nullptr;
+};
+
+typedef std::function<void(AsyncWebSocket* server, AsyncWebSocketClient* client, AwsEventType type,
+                           void* arg, uint8_t* data, size_t len)> AwsEventHandler;
+
+class AsyncWebSocket : public AsyncWebHandler {
+public:
+    explicit AsyncWebSocket(const String& url);
+    ~AsyncWebSocket() override;
+
+    const char* url() const { return path.c_str(); }
+    void enable(bool enabled) { this->enabled = enabled; }
+    size_t count();
+    AsyncWebSocketClient* client(uint32_t id);
+    bool hasClient(uint32_t id) { return client(id) != nullptr; }
+    void close(uint32_t id, uint16_t code = 0, const char* message = nullptr);
+    void closeAll(uint16_t code = 0, const char* message = nullptr);
+    void cleanupClients(uint16_t maxClients = 8) { (void)maxClients; }
+
+    void textAll(const char* message) { textAll(message, strlen(message)); }
+    void textAll(const char* message, size_t len);
+    void textAll(const String& message) { textAll(message.c_str(), message.length()); }
+    void textAll(AsyncWebSocketMessageBuffer* buffer);
+    void textAll(AsyncWebSocketSharedBuffer buffer) { sendAll(std::move(buffer), false); }
+    void binaryAll(AsyncWebSocketMessageBuffer* buffer);
+    void binaryAll(AsyncWebSocketSharedBuffer buffer) { sendAll(std::move(buffer), true); }
+
+    void setAuthentication(const char* username, const char* password) {
+        this->username = username ? username : "";
+        this->password = password ? password : "";
+    }
+    void onEvent(AwsEventHandler handler) { eventHandler = handler; }
+
+    AsyncWebSocketMessageBuffer* makeBuffer(size_t size = 0);
+    AsyncWebSocketMessageBuffer* makeBuffer(uint8_t* data, size_t size);
+
+    // Plain HTTP requests never carry the upgrade
+    bool canHandle(AsyncWebServerRequest* request) override { (void)request; return false; }
+
+private:
+    friend class AsyncWebSocketClient;
+    friend class Sim::Web::Access;
+
+    void sendAll(AsyncWebSocketSharedBuffer buffer, bool binary);
+
+    String path;
+    String username;
+    String password;
+    bool enabled = true;
+    AwsEventHandler eventHandler;
+    std::mutex clientsMutex;
+    // Kept until the server goes, so pointers handed out stay valid
+    std::vector<std::unique_ptr<AsyncWebSocketClient>> clients;
+    uint32_t nextId = 1;
+};
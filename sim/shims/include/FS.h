@@ -0,0 +1,79 @@
+#pragma once
+
+#include <Arduino.h>
+#include <memory>
+
+// Arduino filesystem API over a directory of the host machine. Paths are
+// absolute within the filesystem ("/sessions/1.bin"), as on the target.
+namespace fs {
+    enum SeekMode {
+        SeekSet = 0,
+        SeekCur = 1,
+        SeekEnd = 2
+    };
+
+    class FileImpl;
+    class FSImpl;
+
+    class File {
+    public:
+        File() = default;
+        explicit File(std::shared_ptr<FileImpl> impl) : impl(std::move(impl)) {}
+
+        explicit operator bool() const;
+
+        size_t write(uint8_t c) { return write(&c, 1); }
+        size_t write(const uint8_t* buffer, size_t size);
+        size_t read(uint8_t* buffer, size_t size);
+        int read();
+        int peek();
+        int available();
+        void flush();
+        bool seek(uint32_t pos, SeekMode mode = SeekSet);
+        size_t position() const;
+        size_t size() const;
+        void close();
+
+        const char* path() const;
+        const char* name() const;           // Without the directory, as core 2.x
+        bool isDirectory() const;
+        File openNextFile(const char* mode = "r");
+        void rewindDirectory();
+
+        String readStringUntil(char terminator);
+        String readString();
+
+    private:
+        std::shared_ptr<FileImpl> impl;
+    };
+
+    class FS {
+    public:
+        explicit FS(std::shared_ptr<FSImpl> impl) : impl(std::move(impl)) {}
+
+        File open(const char* path, const char* mode = "r", bool create = false);
+        File open(const String& path, const char* mode = "r", bool create = false) {
+            return open(path.c_str(), mode, create);
+        }
+        bool exists(const char* path);
+        bool exists(const String& path) { return exists(path.c_str()); }
+        bool remove(const char* path);
+        bool remove(const String& path) { return remove(path.c_str()); }
+        bool rename(const char* from, const char* to);
+        bool rename(const String& from, const String& to) { return rename(from.c_str(), to.c_str()); }
+        bool mkdir(const char* path);
+        bool mkdir(const String& path) { return mkdir(path.c_str()); }
+        bool rmdir(const char* path);
+        bool rmdir(const String& path) { return rmdir(path.c_str()); }
+
+    protected:
+        std::shared_ptr<FSImpl> impl;
+    };
+}
+
+using fs::File;
+using fs::FS;
+using fs::SeekMode;
+using fs::SeekSet;
+using fs::SeekCur;
+using fs::SeekEnd;
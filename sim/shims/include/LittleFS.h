@@ -0,0 +1,22 @@
+#pragma once
+
+#include "FS.h"
+
+namespace fs {
+    // Backed by Sim::FileSystem's root directory. Capacity defaults to the
+    // spiffs partition of huge_app.csv; writes beyond it fail like a full
+    // flash does. Mounting creates the directory if needed.
+    class LittleFSFS : public FS {
+    public:
+        LittleFSFS();
+
+        bool begin(bool formatOnFail = false, const char* basePath = "/littlefs",
+                   uint8_t maxOpenFiles = 10, const char* partitionLabel = "spiffs");
+        void end();
+        bool format();
+        size_t totalBytes();
+        size_t usedBytes();
+    };
+}
+
+extern fs::LittleFSFS LittleFS;
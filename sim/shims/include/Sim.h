@@ -0,0 +1,111 @@
+#pragma once
+
+#include <Arduino.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+// The simulator's side of the shims: what the load harness uses to play
+// the targets, dashboards and API clients the host normally talks to.
+//
+// The host runs unchanged against the shims. Datagrams it sends reach the
+// attached UdpEndpoints, datagrams the harness sends reach the host's
+// AsyncUDP callback, each with its own loss rate. All WebSocket events,
+// HTTP requests and outbound WebSocket messages are handled by a single
+// async_tcp thread, as AsyncTCP does on the ESP32.
+namespace Sim {
+    // Runtime
+    void setLogOutput(bool enabled);            // Serial on stderr, on by default
+    void resetHeapBaseline();                   // ESP heap figures count from here
+    size_t heapInUse();                         // Bytes allocated by the process
+    size_t peakRss();                           // Peak resident set, bytes
+    // Heap allocations through operator new since start, by all threads or
+    // by the calling one; the host allocates nothing through malloc itself
+    uint64_t allocations();
+    uint64_t threadAllocations();
+    [[noreturn]] void shutdown(int code);       // Exits without joining host tasks
+
+    // Network
+    class UdpEndpoint {
+    public:
+        virtual ~UdpEndpoint() = default;
+        // Called on the network thread for every datagram addressed to
+        // this endpoint (or broadcast) that survived the loss
+        virtual void onDatagram(const uint8_t* data, size_t len) = 0;
+    };
+
+    namespace Network {
+        // Mirrors the queue between lwIP and the AsyncUDP callback
+        constexpr size_t RX_QUEUE_SIZE = 32;
+        // Mirrors the WiFi driver's dynamic TX buffers
+        constexpr size_t TX_QUEUE_SIZE = 32;
+
+        struct Stats {
+            uint32_t rxSent;            // Harness -> host
+            uint32_t rxLost;
+            uint32_t rxOverflow;        // Dropped on a full RX queue
+            uint32_t rxDelivered;
+            uint32_t txSent;            // Host -> endpoints, per receiver
+            uint32_t txLost;
+            uint32_t txOverflow;        // writeTo/broadcastTo refused
+            uint32_t txDelivered;
+        };
+
+        void attach(const IPAddress& address, UdpEndpoint* endpoint);
+        // Loss probabilities 0..1 per direction, applied per datagram
+        void setLoss(float toHost, float fromHost);
+        void setSeed(uint32_t seed);
+        // Queues a datagram for the host; false if lost or dropped
+        bool sendToHost(const IPAddress& from, const uint8_t* data, size_t len);
+        // Runs the host's packet callback on the calling thread, past loss
+        // and the RX queue (for benchmarks); false if nothing listens
+        bool deliverNow(const IPAddress& from, const uint8_t* data, size_t len);
+        Stats getStats();
+    }
+
+    // Web
+    class WsPeer {
+    public:
+        virtual ~WsPeer() = default;
+        // Called on the async_tcp thread for every message the host sent
+        virtual void onMessage(const uint8_t* data, size_t len, bool binary) = 0;
+        virtual void onClose() {}
+    };
+
+    struct HttpResponse {
+        int code;                   // 0 if the handler never responded
+        std::string contentType;
+        std::vector<std::pair<std::string, std::string>> headers;
+        std::string body;
+    };
+
+    namespace Web {
+        constexpr size_t CHUNK_SIZE = 1436;     // One TCP segment per filler call
+
+        struct Stats {
+            uint32_t messagesSent;      // Host -> dashboards
+            uint32_t bytesSent;
+            uint32_t messagesDropped;   // Send queue full
+        };
+
+        // Runs the request through the server's handlers and collects the
+        // whole response; blocks until the async_tcp thread is done
+        HttpResponse request(uint8_t method, const char* url, const String& body = String(),
+                             const char* username = nullptr, const char* password = nullptr);
+
+        // Opens a WebSocket on url; returns the client id, 0 if refused
+        uint32_t connect(const char* url, WsPeer* peer,
+                         const char* username = nullptr, const char* password = nullptr);
+        void send(uint32_t clientId, const String& text);
+        void disconnect(uint32_t clientId);
+        Stats getStats();
+    }
+
+    // Filesystem
+    namespace FileSystem {
+        // Directory that backs LittleFS; a fresh temporary one if unset
+        void setRoot(const char* directory);
+        const char* getRoot();
+        void setCapacity(size_t bytes);
+    }
+}
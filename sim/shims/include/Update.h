@@ -0,0 +1,14 @@
+#pragma once
+
+#include <Arduino.h>
+
+// No flash to update in the simulator; every step fails
+class UpdateClass {
+public:
+    bool begin(size_t size) { (void)size; return false; }
+    size_t write(const uint8_t* data, size_t len) { (void)data; (void)len; return 0; }
+    bool end(bool evenIfRemaining = false) { (void)evenIfRemaining; return false; }
+    bool hasError() const { return true; }
+};
+
+extern UpdateClass Update;
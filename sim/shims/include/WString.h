@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+// Arduino String on top of std::string. Deliberately not derived from it,
+// so ArduinoJson picks its Arduino String adapter instead of seeing two.
+class String {
+public:
+    String() = default;
+    String(const char* cstr) : value(cstr ? cstr : "") {}
+    String(const std::string& str) : value(str) {}
+    explicit String(char c) : value(1, c) {}
+    explicit String(int number, unsigned char base = 10);
+    explicit String(unsigned int number, unsigned char base = 10);
+    explicit String(long number, unsigned char base = 10);
+    explicit String(unsigned long number, unsigned char base = 10);
+    explicit String(long long number, unsigned char base = 10);
+    explicit String(unsigned long long number, unsigned char base = 10);
+    explicit String(float number, unsigned int decimals = 2);
+    explicit String(double number, unsigned int decimals = 2);
+
+    const char* c_str() const { return value.c_str(); }
+    char* begin() { return &value[0]; }
+    char* end() { return &value[0] + value.size(); }
+    const char* begin() const { return value.c_str(); }
+    const char* end() const { return value.c_str() + value.size(); }
+    unsigned int length() const { return value.length(); }
+    bool isEmpty() const { return value.empty(); }
+    bool reserve(unsigned int size) { value.reserve(size); return true; }
+
+    bool concat(const String& str) { value += str.value; return true; }
+    bool concat(const char* cstr) { if (!cstr) return false; value += cstr; return true; }
+    bool concat(const char* cstr, unsigned int length) { if (!cstr) return false; value.append(cstr, length); return true; }
+    bool concat(char c) { value += c; return true; }
+    bool concat(int number) { return concat(String(number)); }
+    bool concat(unsigned int number) { return concat(String(number)); }
+    bool concat(long number) { return concat(String(number)); }
+    bool concat(unsigned long number) { return concat(String(number)); }
+    bool concat(double number) { return concat(String(number)); }
+
+    template <typename T>
+    String& operator+=(const T& rhs) { concat(rhs); return *this; }
+
+    bool equals(const String& other) const { return value == other.value; }
+    bool equals(const char* cstr) const { return value == (cstr ? cstr : ""); }
+    bool operator==(const String& other) const { return equals(other); }
+    bool operator==(const char* cstr) const { return equals(cstr); }
+    bool operator!=(const String& other) const { return !equals(other); }
+    bool operator!=(const char* cstr) const { return !equals(cstr); }
+    bool operator<(const String& other) const { return value < other.value; }
+
+    char charAt(unsigned int index) const { return index < value.size() ? value[index] : 0; }
+    char operator[](unsigned int index) const { return charAt(index); }
+    char& operator[](unsigned int index) { return value[index]; }
+
+    int indexOf(char c, unsigned int from = 0) const { return position(value.find(c, from)); }
+    int indexOf(const String& str, unsigned int from = 0) const { return position(value.find(str.value, from)); }
+    int lastIndexOf(char c) const { return position(value.rfind(c)); }
+    int lastIndexOf(const String& str) const { return position(value.rfind(str.value)); }
+    bool startsWith(const String& prefix) const { return value.compare(0, prefix.value.size(), prefix.value) == 0; }
+    bool endsWith(const String& suffix) const {
+        return value.size() >= suffix.value.size() &&
+               value.compare(value.size() - suffix.value.size(), suffix.value.size(), suffix.value) == 0;
+    }
+    String substring(unsigned int from) const { return from < value.size() ? String(value.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const;
+
+    void trim();
+    void toLowerCase();
+    void toUpperCase();
+    void replace(const String& find, const String& replacement);
+    void remove(unsigned int index, unsigned int count = UINT32_MAX) { if (index < value.size()) value.erase(index, count); }
+
+    long toInt() const { return strtol(value.c_str(), nullptr, 10); }
+    float toFloat() const { return strtof(value.c_str(), nullptr); }
+    double toDouble() const { return strtod(value.c_str(), nullptr); }
+
+    const std::string& str() const { return value; }
+
+private:
+    static int position(size_t found) { return found == std::string::npos ? -1 : static_cast<int>(found); }
+
+    std::string value;
+};
+
+// Result type of String concatenation in the Arduino core; ArduinoJson
+// names it in one of its adapters
+class StringSumHelper : public String {
+public:
+    StringSumHelper(const String& str) : String(str) {}
+    StringSumHelper(const char* cstr) : String(cstr) {}
+};
+
+inline StringSumHelper operator+(const String& lhs, const String& rhs) { String out(lhs); out.concat(rhs); return out; }
+inline StringSumHelper operator+(const String& lhs, const char* rhs) { String out(lhs); out.concat(rhs); return out; }
+inline StringSumHelper operator+(const char* lhs, const String& rhs) { String out(lhs); out.concat(rhs); return out; }
+inline StringSumHelper operator+(const String& lhs, char rhs) { String out(lhs); out.concat(rhs); return out; }
+inline bool operator==(const char* lhs, const String& rhs) { return rhs.equals(lhs); }
+inline bool operator!=(const char* lhs, const String& rhs) { return !rhs.equals(lhs); }
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <Arduino.h>
+
+typedef enum {
+    WIFI_MODE_NULL = 0,
+    WIFI_MODE_STA,
+    WIFI_MODE_AP,
+    WIFI_MODE_APSTA
+} wifi_mode_t;
+
+#define WIFI_OFF WIFI_MODE_NULL
+#define WIFI_STA WIFI_MODE_STA
+#define WIFI_AP WIFI_MODE_AP
+#define WIFI_AP_STA WIFI_MODE_APSTA
+
+// Access point that is always up; stations are the attached endpoints
+class WiFiClass {
+public:
+    bool mode(wifi_mode_t mode) { current = mode; return true; }
+    wifi_mode_t getMode() const { return current; }
+
+    bool softAPConfig(IPAddress localIP, IPAddress gateway, IPAddress subnet) {
+        (void)gateway;
+        (void)subnet;
+        apIP = localIP;
+        return true;
+    }
+    bool softAP(const char* ssid, const char* passphrase = nullptr, int channel = 1,
+                int hidden = 0, int maxConnection = 4) {
+        (void)passphrase;
+        (void)channel;
+        (void)hidden;
+        (void)maxConnection;
+        return ssid && *ssid && current != WIFI_MODE_NULL && current != WIFI_MODE_STA;
+    }
+    IPAddress softAPIP() const { return apIP; }
+    uint8_t softAPgetStationNum() const;
+
+private:
+    wifi_mode_t current = WIFI_MODE_NULL;
+    IPAddress apIP;
+};
+
+extern WiFiClass WiFi;
@@ -0,0 +1,7 @@
+#pragma once
+
+#include <Arduino.h>
+
+typedef void (*esp_ipc_func_t)(void* arg);
+
+esp_err_t esp_ipc_call_blocking(uint32_t cpuId, esp_ipc_func_t func, void* arg);
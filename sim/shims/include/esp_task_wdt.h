@@ -0,0 +1,9 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Accepted and ignored: nothing resets the process on a stuck task
+esp_err_t esp_task_wdt_init(uint32_t timeoutSeconds, bool panic);
+esp_err_t esp_task_wdt_add(TaskHandle_t task);
+esp_err_t esp_task_wdt_delete(TaskHandle_t task);
+esp_err_t esp_task_wdt_reset();
@@ -0,0 +1,6 @@
+#pragma once
+
+#include <cstdint>
+
+// Microseconds since start, 64 bit
+int64_t esp_timer_get_time();
@@ -0,0 +1,364 @@
+#include "LittleFS.h"
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include "Sim.h"
+
+namespace {
+    constexpr size_t DEFAULT_CAPACITY = 0xE0000;    // spiffs in huge_app.csv
+
+    std::mutex rootMutex;
+    std::string rootDirectory;
+    std::atomic<size_t> capacity{DEFAULT_CAPACITY};
+
+    const char* fopenMode(const char* mode) {
+        if (strcmp(mode, "w") == 0) return "wb";
+        if (strcmp(mode, "a") == 0) return "ab";
+        if (strcmp(mode, "r+") == 0) return "r+b";
+        if (strcmp(mode, "w+") == 0) return "w+b";
+        if (strcmp(mode, "a+") == 0) return "a+b";
+        return "rb";
+    }
+
+    bool writes(const char* mode) {
+        return mode[0] == 'w' || mode[0] == 'a' || strchr(mode, '+');
+    }
+
+    size_t fileSize(const std::string& path) {
+        struct stat info;
+        return stat(path.c_str(), &info) == 0 && S_ISREG(info.st_mode) ? info.st_size : 0;
+    }
+}
+
+namespace fs {
+    class FSImpl {
+    public:
+        bool mounted = false;
+        std::atomic<size_t> used{0};    // Sum of file sizes
+
+        std::string realPath(const char* path) const {
+            std::lock_guard<std::mutex> lock(rootMutex);
+            return rootDirectory + (path[0] == '/' ? "" : "/") + path;
+        }
+
+        void recount() {
+            size_t total = 0;
+            std::error_code error;
+            for (const auto& entry : std::filesystem::recursive_directory_iterator(realPath("/"), error)) {
+                if (entry.is_regular_file(error)) {
+                    total += entry.file_size(error);
+                }
+            }
+            used.store(total, std::memory_order_relaxed);
+        }
+    };
+
+    class FileImpl {
+    public:
+        FSImpl* fs = nullptr;
+        std::string path;               // Within the filesystem
+        std::string realPath;
+        FILE* file = nullptr;
+        DIR* dir = nullptr;
+        size_t size = 0;                // Tracked so writes can be charged
+        bool append = false;            // Every write goes to the end
+
+        ~FileImpl() { close(); }
+
+        void close() {
+            if (file) {
+                fclose(file);
+                file = nullptr;
+            }
+            if (dir) {
+                closedir(dir);
+                dir = nullptr;
+            }
+        }
+
+        const char* name() const {
+            size_t slash = path.rfind('/');
+            return path.c_str() + (slash == std::string::npos ? 0 : slash + 1);
+        }
+    };
+
+    // File
+    File::operator bool() const {
+        return impl && (impl->file || impl->dir);
+    }
+
+    size_t File::write(const uint8_t* buffer, size_t size) {
+        if (!impl || !impl->file) {
+            return 0;
+        }
+        long pos = impl->append ? -1 : ftell(impl->file);
+        size_t end = (pos < 0 ? impl->size : static_cast<size_t>(pos)) + size;
+        size_t growth = end > impl->size ? end - impl->size : 0;
+        if (impl->fs->used.load(std::memory_order_relaxed) + growth > capacity.load(std::memory_order_relaxed)) {
+            return 0;   // Flash full
+        }
+        size_t written = fwrite(buffer, 1, size, impl->file);
+        if (written == size && growth) {
+            impl->size += growth;
+            impl->fs->used.fetch_add(growth, std::memory_order_relaxed);
+        }
+        return written;
+    }
+
+    size_t File::read(uint8_t* buffer, size_t size) {
+        return impl && impl->file ? fread(buffer, 1, size, impl->file) : 0;
+    }
+
+    int File::read() {
+        return impl && impl->file ? fgetc(impl->file) : -1;
+    }
+
+    int File::peek() {
+        if (!impl || !impl->file) {
+            return -1;
+        }
+        int c = fgetc(impl->file);
+        if (c != EOF) {
+            ungetc(c, impl->file);
+        }
+        return c;
+    }
+
+    int File::available() {
+        if (!impl || !impl->file) {
+            return 0;
+        }
+        size_t pos = position();
+        return pos < size() ? static_cast<int>(size() - pos) : 0;
+    }
+
+    void File::flush() {
+        if (impl && impl->file) {
+            fflush(impl->file);
+        }
+    }
+
+    bool File::seek(uint32_t pos, SeekMode mode) {
+        static const int whence[] = {SEEK_SET, SEEK_CUR, SEEK_END};
+        return impl && impl->file && fseek(impl->file, pos, whence[mode]) == 0;
+    }
+
+    size_t File::position() const {
+        long pos = impl && impl->file ? ftell(impl->file) : -1;
+        return pos < 0 ? 0 : static_cast<size_t>(pos);
+    }
+
+    size_t File::size() const {
+        return impl && impl->file ? impl->size : 0;
+    }
+
+    void File::close() {
+        if (impl) {
+            impl->close();
+        }
+    }
+
+    const char* File::path() const {
+        return impl ? impl->path.c_str() : "";
+    }
+
+    const char* File::name() const {
+        return impl ? impl->name() : "";
+    }
+
+    bool File::isDirectory() const {
+        return impl && impl->dir;
+    }
+
+    File File::openNextFile(const char* mode) {
+        if (!impl || !impl->dir) {
+            return File();
+        }
+        while (struct dirent* entry = readdir(impl->dir)) {
+            if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+                continue;
+            }
+            std::string child = impl->path == "/" ? "/" : impl->path + "/";
+            child += entry->d_name;
+            FS owner(std::shared_ptr<FSImpl>(impl->fs, [](FSImpl*) {}));
+            return owner.open(child.c_str(), mode);
+        }
+        return File();
+    }
+
+    void File::rewindDirectory() {
+        if (impl && impl->dir) {
+            rewinddir(impl->dir);
+        }
+    }
+
+    String File::readStringUntil(char terminator) {
+        String out;
+        int c;
+        while ((c = read()) >= 0 && c != terminator) {
+            out += static_cast<char>(c);
+        }
+        return out;
+    }
+
+    String File::readString() {
+        String out;
+        int c;
+        while ((c = read()) >= 0) {
+            out += static_cast<char>(c);
+        }
+        return out;
+    }
+
+    // FS
+    File FS::open(const char* path, const char* mode, bool create) {
+        if (!impl->mounted || !path || path[0] != '/') {
+            return File();
+        }
+        auto file = std::make_shared<FileImpl>();
+        file->fs = impl.get();
+        file->path = path;
+        file->realPath = impl->realPath(path);
+
+        struct stat info;
+        bool exists = stat(file->realPath.c_str(), &info) == 0;
+        if (exists && S_ISDIR(info.st_mode)) {
+            file->dir = opendir(file->realPath.c_str());
+            return file->dir ? File(file) : File();
+        }
+        if (!exists && !writes(mode)) {
+            return File();
+        }
+        if (create) {
+            std::error_code error;
+            std::filesystem::create_directories(std::filesystem::path(file->realPath).parent_path(), error);
+        }
+
+        size_t before = exists ? static_cast<size_t>(info.st_size) : 0;
+        file->file = fopen(file->realPath.c_str(), fopenMode(mode));
+        if (!file->file) {
+            return File();
+        }
+        file->size = fileSize(file->realPath);
+        file->append = mode[0] == 'a';
+        if (before > file->size) {
+            impl->used.fetch_sub(before - file->size, std::memory_order_relaxed);    // Truncated
+        }
+        return File(file);
+    }
+
+    bool FS::exists(const char* path) {
+        struct stat info;
+        return impl->mounted && stat(impl->realPath(path).c_str(), &info) == 0;
+    }
+
+    bool FS::remove(const char* path) {
+        std::string real = impl->realPath(path);
+        size_t size = fileSize(real);
+        if (!impl->mounted || unlink(real.c_str()) != 0) {
+            return false;
+        }
+        impl->used.fetch_sub(size, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool FS::rename(const char* from, const char* to) {
+        return impl->mounted && ::rename(impl->realPath(from).c_str(), impl->realPath(to).c_str()) == 0;
+    }
+
+    bool FS::mkdir(const char* path) {
+        if (!impl->mounted) {
+            return false;
+        }
+        std::string real = impl->realPath(path);
+        ::mkdir(real.c_str(), 0755);
+        struct stat info;
+        return stat(real.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+    }
+
+    bool FS::rmdir(const char* path) {
+        return impl->mounted && ::rmdir(impl->realPath(path).c_str()) == 0;
+    }
+
+    // LittleFS
+    LittleFSFS::LittleFSFS() : FS(std::make_shared<FSImpl>()) {}
+
+    bool LittleFSFS::begin(bool formatOnFail, const char* basePath, uint8_t maxOpenFiles, const char* partitionLabel) {
+        (void)formatOnFail;
+        (void)basePath;
+        (void)maxOpenFiles;
+        (void)partitionLabel;
+        if (impl->mounted) {
+            return true;
+        }
+        {
+            std::lock_guard<std::mutex> lock(rootMutex);
+            if (rootDirectory.empty()) {
+                char pattern[] = "/tmp/ledhost-sim-XXXXXX";
+                if (!mkdtemp(pattern)) {
+                    return false;
+                }
+                rootDirectory = pattern;
+            }
+            std::error_code error;
+            std::filesystem::create_directories(rootDirectory, error);
+            if (error) {
+                return false;
+            }
+        }
+        impl->mounted = true;
+        impl->recount();
+        return true;
+    }
+
+    void LittleFSFS::end() {
+        impl->mounted = false;
+    }
+
+    bool LittleFSFS::format() {
+        if (!impl->mounted) {
+            return false;
+        }
+        std::error_code error;
+        for (const auto& entry : std::filesystem::directory_iterator(impl->realPath("/"), error)) {
+            std::filesystem::remove_all(entry.path(), error);
+        }
+        impl->used.store(0, std::memory_order_relaxed);
+        return true;
+    }
+
+    size_t LittleFSFS::totalBytes() {
+        return capacity.load(std::memory_order_relaxed);
+    }
+
+    size_t LittleFSFS::usedBytes() {
+        return impl->used.load(std::memory_order_relaxed);
+    }
+}
+
+fs::LittleFSFS LittleFS;
+
+namespace Sim {
+    namespace FileSystem {
+        void setRoot(const char* directory) {
+            std::lock_guard<std::mutex> lock(rootMutex);
+            rootDirectory = directory ? directory : "";
+            while (rootDirectory.size() > 1 && rootDirectory.back() == '/') {
+                rootDirectory.pop_back();
+            }
+        }
+
+        const char* getRoot() {
+            std::lock_guard<std::mutex> lock(rootMutex);
+            return rootDirectory.c_str();
+        }
+
+        void setCapacity(size_t bytes) {
+            capacity.store(bytes, std::memory_order_relaxed);
+        }
+    }
+}
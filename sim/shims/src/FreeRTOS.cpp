@@ -0,0 +1,344 @@
+#include <Arduino.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Sim {
+    struct Task {
+        std::string name;
+        TaskFunction_t code = nullptr;
+        void* parameter = nullptr;
+        uint32_t stackDepth = 0;        // Bytes, as requested
+        UBaseType_t priority = 0;
+        BaseType_t core = 1;            // Arduino's loopTask runs on core 1
+        uint8_t* stack = nullptr;       // Usable part, above the guard page
+        size_t stackSize = 0;
+        uint8_t* top = nullptr;         // First frame; glibc keeps TLS above it
+
+        std::mutex mutex;
+        std::condition_variable notified;
+        uint32_t notifications = 0;
+    };
+
+    struct Semaphore {
+        std::mutex mutex;
+        std::condition_variable available;
+        UBaseType_t count;
+        UBaseType_t maxCount;
+    };
+
+    struct Queue {
+        std::mutex mutex;
+        std::condition_variable notEmpty;
+        std::condition_variable notFull;
+        std::vector<uint8_t> storage;
+        size_t itemSize;
+        size_t length;
+        size_t head = 0;
+        size_t count = 0;
+    };
+}
+
+namespace {
+    // x86-64 frames are not Xtensa frames, so every task gets a roomy
+    // stack; the high-water mark is still reported against what it asked for
+    constexpr size_t MIN_STACK = 64 * 1024;
+    constexpr uint8_t STACK_FILL = 0xA5;    // tskSTACK_FILL_BYTE
+
+    thread_local Sim::Task* currentTask = nullptr;
+
+    Sim::Task* self() {
+        if (!currentTask) {
+            // A thread the shims did not start (main, harness threads)
+            currentTask = new Sim::Task();
+            currentTask->name = "native";
+        }
+        return currentTask;
+    }
+
+    // Waits on cv until ready() or the timeout; portMAX_DELAY waits forever
+    template <typename Predicate>
+    bool waitFor(std::condition_variable& cv, std::unique_lock<std::mutex>& lock,
+                 TickType_t wait, Predicate ready) {
+        if (wait == portMAX_DELAY) {
+            cv.wait(lock, ready);
+            return true;
+        }
+        return cv.wait_for(lock, std::chrono::milliseconds(wait), ready);
+    }
+
+    void* runTask(void* argument) {
+        Sim::Task* task = static_cast<Sim::Task*>(argument);
+        currentTask = task;
+        task->top = static_cast<uint8_t*>(__builtin_frame_address(0));
+        pthread_setname_np(pthread_self(), task->name.substr(0, 15).c_str());
+        task->code(task->parameter);
+        // FreeRTOS tasks must not return; treat it as deleting itself
+        return nullptr;
+    }
+}
+
+// Tasks
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t code, const char* name, uint32_t stackDepth,
+                                   void* parameter, UBaseType_t priority, TaskHandle_t* created,
+                                   BaseType_t coreId) {
+    Sim::Task* task = new Sim::Task();
+    task->name = name ? name : "";
+    task->code = code;
+    task->parameter = parameter;
+    task->stackDepth = stackDepth;
+    task->priority = priority;
+    task->core = coreId == tskNO_AFFINITY ? 0 : coreId;
+
+    size_t page = sysconf(_SC_PAGESIZE);
+    size_t size = std::max<size_t>(MIN_STACK, stackDepth * 4);
+    size = (size + page - 1) / page * page;
+    void* mapping = mmap(nullptr, size + page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED) {
+        delete task;
+        return pdFAIL;
+    }
+    mprotect(mapping, page, PROT_NONE);     // Overflow faults instead of corrupting
+    task->stack = static_cast<uint8_t*>(mapping) + page;
+    task->stackSize = size;
+    memset(task->stack, STACK_FILL, size);
+
+    // The handle is set before the task first runs, as on FreeRTOS
+    if (created) {
+        *created = task;
+    }
+
+    pthread_attr_t attributes;
+    pthread_attr_init(&attributes);
+    pthread_attr_setstack(&attributes, task->stack, task->stackSize);
+    pthread_attr_setdetachstate(&attributes, PTHREAD_CREATE_DETACHED);
+    pthread_t thread;
+    int result = pthread_create(&thread, &attributes, runTask, task);
+    pthread_attr_destroy(&attributes);
+    if (result != 0) {
+        if (created) {
+            *created = nullptr;
+        }
+        munmap(mapping, size + page);
+        delete task;
+        return pdFAIL;
+    }
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t code, const char* name, uint32_t stackDepth,
+                       void* parameter, UBaseType_t priority, TaskHandle_t* created) {
+    return xTaskCreatePinnedToCore(code, name, stackDepth, parameter, priority, created, tskNO_AFFINITY);
+}
+
+// Only a task can end itself; deleting another one is not supported
+void vTaskDelete(TaskHandle_t task) {
+    if (!task || task == currentTask) {
+        pthread_exit(nullptr);
+    }
+}
+
+void vTaskDelay(TickType_t ticks) {
+    if (ticks == 0) {
+        std::this_thread::yield();
+        return;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+void vTaskDelayUntil(TickType_t* previousWake, TickType_t increment) {
+    TickType_t wake = *previousWake + increment;
+    TickType_t now = xTaskGetTickCount();
+    *previousWake = wake;
+    TickType_t remaining = wake - now;
+    if (remaining != 0 && remaining <= increment) {
+        vTaskDelay(remaining);
+    }
+}
+
+TickType_t xTaskGetTickCount() {
+    return millis();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    return self();
+}
+
+const char* pcTaskGetName(TaskHandle_t task) {
+    return (task ? task : self())->name.c_str();
+}
+
+// Bytes of the requested stack never touched so far
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+    task = task ? task : self();
+    if (!task->stack || !task->top) {
+        return 0;
+    }
+    size_t untouched = 0;
+    while (untouched < task->stackSize && task->stack[untouched] == STACK_FILL) {
+        untouched++;
+    }
+    size_t used = task->top - (task->stack + untouched);
+    return used < task->stackDepth ? task->stackDepth - used : 0;
+}
+
+BaseType_t xPortGetCoreID() {
+    return self()->core;
+}
+
+void taskYIELD() {
+    std::this_thread::yield();
+}
+
+// Notifications
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    {
+        std::lock_guard<std::mutex> lock(task->mutex);
+        task->notifications++;
+    }
+    task->notified.notify_one();
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higherPriorityTaskWoken) {
+    xTaskNotifyGive(task);
+    if (higherPriorityTaskWoken) {
+        *higherPriorityTaskWoken = pdFALSE;
+    }
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t wait) {
+    Sim::Task* task = self();
+    std::unique_lock<std::mutex> lock(task->mutex);
+    waitFor(task->notified, lock, wait, [task] { return task->notifications > 0; });
+    uint32_t value = task->notifications;
+    if (value) {
+        task->notifications = clearOnExit ? 0 : value - 1;
+    }
+    return value;
+}
+
+// Semaphores
+namespace {
+    SemaphoreHandle_t createSemaphore(UBaseType_t maxCount, UBaseType_t initialCount) {
+        Sim::Semaphore* semaphore = new Sim::Semaphore();
+        semaphore->maxCount = maxCount;
+        semaphore->count = initialCount;
+        return semaphore;
+    }
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+    return createSemaphore(1, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary() {
+    return createSemaphore(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t maxCount, UBaseType_t initialCount) {
+    return createSemaphore(maxCount, initialCount);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t wait) {
+    std::unique_lock<std::mutex> lock(semaphore->mutex);
+    if (!waitFor(semaphore->available, lock, wait, [semaphore] { return semaphore->count > 0; })) {
+        return pdFALSE;
+    }
+    semaphore->count--;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    {
+        std::lock_guard<std::mutex> lock(semaphore->mutex);
+        if (semaphore->count >= semaphore->maxCount) {
+            return pdFALSE;
+        }
+        semaphore->count++;
+    }
+    semaphore->available.notify_one();
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t* higherPriorityTaskWoken) {
+    if (higherPriorityTaskWoken) {
+        *higherPriorityTaskWoken = pdFALSE;
+    }
+    return xSemaphoreGive(semaphore);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+    delete semaphore;
+}
+
+// Queues
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    if (length == 0) {
+        return nullptr;
+    }
+    Sim::Queue* queue = new Sim::Queue();
+    queue->itemSize = itemSize;
+    queue->length = length;
+    queue->storage.resize(static_cast<size_t>(length) * itemSize);
+    return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t wait) {
+    {
+        std::unique_lock<std::mutex> lock(queue->mutex);
+        if (!waitFor(queue->notFull, lock, wait, [queue] { return queue->count < queue->length; })) {
+            return errQUEUE_FULL;
+        }
+        size_t slot = (queue->head + queue->count) % queue->length;
+        memcpy(&queue->storage[slot * queue->itemSize], item, queue->itemSize);
+        queue->count++;
+    }
+    queue->notEmpty.notify_one();
+    return pdTRUE;
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t queue, const void* item, TickType_t wait) {
+    return xQueueSend(queue, item, wait);
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void* item, BaseType_t* higherPriorityTaskWoken) {
+    if (higherPriorityTaskWoken) {
+        *higherPriorityTaskWoken = pdFALSE;
+    }
+    return xQueueSend(queue, item, 0);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t wait) {
+    {
+        std::unique_lock<std::mutex> lock(queue->mutex);
+        if (!waitFor(queue->notEmpty, lock, wait, [queue] { return queue->count > 0; })) {
+            return pdFALSE;
+        }
+        memcpy(item, &queue->storage[queue->head * queue->itemSize], queue->itemSize);
+        queue->head = (queue->head + 1) % queue->length;
+        queue->count--;
+    }
+    queue->notFull.notify_one();
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    return queue->count;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue) {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    return queue->length - queue->count;
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+    delete queue;
+}
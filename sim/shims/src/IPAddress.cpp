@@ -0,0 +1,25 @@
+#include "IPAddress.h"
+#include <cstdio>
+
+const IPAddress INADDR_NONE(0, 0, 0, 0);
+
+bool IPAddress::fromString(const char* address) {
+    unsigned parts[4];
+    char tail;
+    if (!address || sscanf(address, "%u.%u.%u.%u%c", &parts[0], &parts[1], &parts[2], &parts[3], &tail) != 4) {
+        return false;
+    }
+    for (size_t i = 0; i < 4; ++i) {
+        if (parts[i] > 255) {
+            return false;
+        }
+        bytes[i] = parts[i];
+    }
+    return true;
+}
+
+String IPAddress::toString() const {
+    char text[16];
+    snprintf(text, sizeof(text), "%u.%u.%u.%u", bytes[0], bytes[1], bytes[2], bytes[3]);
+    return String(text);
+}
@@ -0,0 +1,262 @@
+#include <AsyncUDP.h>
+#include <WiFi.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Sim.h"
+
+WiFiClass WiFi;
+
+namespace {
+    struct Datagram {
+        std::vector<uint8_t> data;
+        IPAddress address;          // Sender on RX, receiver on TX
+        bool broadcast;
+    };
+
+    // Bounded FIFO between a producer and the thread that delivers
+    class Link {
+    public:
+        explicit Link(size_t capacity) : capacity(capacity) {}
+
+        bool push(Datagram&& datagram) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (queue.size() >= capacity) {
+                    return false;
+                }
+                queue.push_back(std::move(datagram));
+            }
+            ready.notify_one();
+            return true;
+        }
+
+        Datagram pop() {
+            std::unique_lock<std::mutex> lock(mutex);
+            ready.wait(lock, [this] { return !queue.empty(); });
+            Datagram datagram = std::move(queue.front());
+            queue.pop_front();
+            return datagram;
+        }
+
+    private:
+        std::mutex mutex;
+        std::condition_variable ready;
+        std::deque<Datagram> queue;
+        size_t capacity;
+    };
+
+    struct Counters {
+        std::atomic<uint32_t> rxSent{0};
+        std::atomic<uint32_t> rxLost{0};
+        std::atomic<uint32_t> rxOverflow{0};
+        std::atomic<uint32_t> rxDelivered{0};
+        std::atomic<uint32_t> txSent{0};
+        std::atomic<uint32_t> txLost{0};
+        std::atomic<uint32_t> txOverflow{0};
+        std::atomic<uint32_t> txDelivered{0};
+    };
+
+    Link rxLink(Sim::Network::RX_QUEUE_SIZE);
+    Link txLink(Sim::Network::TX_QUEUE_SIZE);
+    Counters counters;
+
+    std::mutex socketMutex;
+    AsyncUDP* listener = nullptr;
+    uint16_t listenPort = 0;
+
+    std::mutex endpointMutex;
+    std::unordered_map<uint32_t, Sim::UdpEndpoint*> endpoints;
+
+    std::atomic<float> lossToHost{0.0f};
+    std::atomic<float> lossFromHost{0.0f};
+    std::mutex randomMutex;
+    std::mt19937 randomEngine(1);
+
+    bool lost(const std::atomic<float>& probability) {
+        float p = probability.load(std::memory_order_relaxed);
+        if (p <= 0.0f) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(randomMutex);
+        return std::uniform_real_distribution<float>(0.0f, 1.0f)(randomEngine) < p;
+    }
+
+    // lwIP -> AsyncUDP callback, one datagram at a time
+    void receiveLoop() {
+        for (;;) {
+            Datagram datagram = rxLink.pop();
+            std::lock_guard<std::mutex> lock(socketMutex);
+            if (!listener) {
+                continue;
+            }
+            AsyncUDPPacket packet(datagram.data.data(), datagram.data.size(), datagram.address,
+                                  listenPort, listenPort, false);
+            listener->deliver(packet);
+            counters.rxDelivered.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void deliver(Sim::UdpEndpoint* endpoint, const Datagram& datagram) {
+        counters.txSent.fetch_add(1, std::memory_order_relaxed);
+        if (lost(lossFromHost)) {
+            counters.txLost.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        endpoint->onDatagram(datagram.data.data(), datagram.data.size());
+        counters.txDelivered.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // WiFi driver -> stations; a broadcast reaches each one independently
+    void transmitLoop() {
+        std::vector<Sim::UdpEndpoint*> receivers;
+        for (;;) {
+            Datagram datagram = txLink.pop();
+            receivers.clear();
+            {
+                std::lock_guard<std::mutex> lock(endpointMutex);
+                if (datagram.broadcast) {
+                    for (const auto& entry : endpoints) {
+                        receivers.push_back(entry.second);
+                    }
+                } else {
+                    auto found = endpoints.find(static_cast<uint32_t>(datagram.address));
+                    if (found != endpoints.end()) {
+                        receivers.push_back(found->second);
+                    }
+                }
+            }
+            if (receivers.empty()) {
+                counters.txSent.fetch_add(1, std::memory_order_relaxed);
+                counters.txLost.fetch_add(1, std::memory_order_relaxed);
+            }
+            for (Sim::UdpEndpoint* endpoint : receivers) {
+                deliver(endpoint, datagram);
+            }
+        }
+    }
+
+    void startThreads() {
+        static std::once_flag started;
+        std::call_once(started, [] {
+            std::thread(receiveLoop).detach();
+            std::thread(transmitLoop).detach();
+        });
+    }
+
+    size_t transmit(const uint8_t* data, size_t len, const IPAddress& address, bool broadcast) {
+        startThreads();
+        Datagram datagram{std::vector<uint8_t>(data, data + len), address, broadcast};
+        if (!txLink.push(std::move(datagram))) {
+            counters.txOverflow.fetch_add(1, std::memory_order_relaxed);
+            return 0;   // ERR_MEM: no TX buffer left
+        }
+        return len;
+    }
+}
+
+// AsyncUDP
+AsyncUDP::~AsyncUDP() {
+    close();
+}
+
+bool AsyncUDP::listen(uint16_t port) {
+    std::lock_guard<std::mutex> lock(socketMutex);
+    if (listener && listener != this) {
+        return false;   // One host per simulated network
+    }
+    listener = this;
+    listenPort = port;
+    this->port = port;
+    startThreads();
+    return true;
+}
+
+void AsyncUDP::close() {
+    std::lock_guard<std::mutex> lock(socketMutex);
+    if (listener == this) {
+        listener = nullptr;
+    }
+    port = 0;
+}
+
+size_t AsyncUDP::writeTo(const uint8_t* data, size_t len, const IPAddress& address, uint16_t port) {
+    (void)port;
+    return transmit(data, len, address, false);
+}
+
+size_t AsyncUDP::broadcastTo(const uint8_t* data, size_t len, uint16_t port) {
+    (void)port;
+    return transmit(data, len, IPAddress(255, 255, 255, 255), true);
+}
+
+// WiFi
+uint8_t WiFiClass::softAPgetStationNum() const {
+    std::lock_guard<std::mutex> lock(endpointMutex);
+    return std::min<size_t>(endpoints.size(), UINT8_MAX);
+}
+
+namespace Sim {
+    namespace Network {
+        void attach(const IPAddress& address, UdpEndpoint* endpoint) {
+            std::lock_guard<std::mutex> lock(endpointMutex);
+            if (endpoint) {
+                endpoints[static_cast<uint32_t>(address)] = endpoint;
+            } else {
+                endpoints.erase(static_cast<uint32_t>(address));
+            }
+        }
+
+        void setLoss(float toHost, float fromHost) {
+            lossToHost.store(toHost, std::memory_order_relaxed);
+            lossFromHost.store(fromHost, std::memory_order_relaxed);
+        }
+
+        void setSeed(uint32_t seed) {
+            std::lock_guard<std::mutex> lock(randomMutex);
+            randomEngine.seed(seed);
+        }
+
+        bool sendToHost(const IPAddress& from, const uint8_t* data, size_t len) {
+            startThreads();
+            counters.rxSent.fetch_add(1, std::memory_order_relaxed);
+            if (lost(lossToHost)) {
+                counters.rxLost.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            if (!rxLink.push(Datagram{std::vector<uint8_t>(data, data + len), from, false})) {
+                counters.rxOverflow.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            return true;
+        }
+
+        bool deliverNow(const IPAddress& from, const uint8_t* data, size_t len) {
+            std::lock_guard<std::mutex> lock(socketMutex);
+            if (!listener) {
+                return false;
+            }
+            AsyncUDPPacket packet(data, len, from, listenPort, listenPort, false);
+            listener->deliver(packet);
+            return true;
+        }
+
+        Stats getStats() {
+            return Stats{
+                counters.rxSent.load(std::memory_order_relaxed),
+                counters.rxLost.load(std::memory_order_relaxed),
+                counters.rxOverflow.load(std::memory_order_relaxed),
+                counters.rxDelivered.load(std::memory_order_relaxed),
+                counters.txSent.load(std::memory_order_relaxed),
+                counters.txLost.load(std::memory_order_relaxed),
+                counters.txOverflow.load(std::memory_order_relaxed),
+                counters.txDelivered.load(std::memory_order_relaxed)
+            };
+        }
+    }
+}
@@ -0,0 +1,265 @@
+#include <Arduino.h>
+#include <Update.h>
+#include <esp_ipc.h>
+#include <esp_task_wdt.h>
+#include <esp_timer.h>
+#include <malloc.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <new>
+#include <random>
+#include <thread>
+#include "Sim.h"
+
+namespace {
+    constexpr uint32_t HEAP_SIZE = 320 * 1024;
+    constexpr uint32_t CPU_MHZ = 240;
+
+    std::chrono::steady_clock::time_point bootTime() {
+        static const auto boot = std::chrono::steady_clock::now();
+        return boot;
+    }
+
+    // Touched during static initialization, so boot is process start
+    const auto bootAnchor = bootTime();
+
+    int64_t elapsedNanos() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - bootTime()).count();
+    }
+
+    std::atomic<bool> logOutput{true};
+    std::atomic<size_t> heapBaseline{0};
+    std::atomic<uint32_t> minFreeHeap{HEAP_SIZE};
+
+    std::mutex randomMutex;
+    std::mt19937 randomEngine(0x5EED);
+
+    std::atomic<uint64_t> allocationCount{0};
+    thread_local uint64_t threadAllocationCount = 0;
+}
+
+// Counted allocation for Sim::allocations(); everything else as usual
+void* operator new(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    threadAllocationCount++;
+    void* memory = malloc(size ? size : 1);
+    if (!memory) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    threadAllocationCount++;
+    return malloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept {
+    return operator new(size, tag);
+}
+
+void operator delete(void* memory) noexcept { free(memory); }
+void operator delete[](void* memory) noexcept { free(memory); }
+void operator delete(void* memory, size_t) noexcept { free(memory); }
+void operator delete[](void* memory, size_t) noexcept { free(memory); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept { free(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { free(memory); }
+
+HardwareSerial Serial;
+EspClass ESP;
+UpdateClass Update;
+
+uint32_t millis() {
+    return static_cast<uint32_t>(elapsedNanos() / 1000000);
+}
+
+uint32_t micros() {
+    return static_cast<uint32_t>(elapsedNanos() / 1000);
+}
+
+int64_t esp_timer_get_time() {
+    return elapsedNanos() / 1000;
+}
+
+void delay(uint32_t ms) {
+    vTaskDelay(pdMS_TO_TICKS(ms));
+}
+
+void delayMicroseconds(uint32_t us) {
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+void yield() {
+    std::this_thread::yield();
+}
+
+uint32_t esp_random() {
+    std::lock_guard<std::mutex> lock(randomMutex);
+    return randomEngine();
+}
+
+long random(long howBig) {
+    return howBig > 0 ? esp_random() % howBig : 0;
+}
+
+long random(long howSmall, long howBig) {
+    return howBig > howSmall ? howSmall + random(howBig - howSmall) : howSmall;
+}
+
+void randomSeed(unsigned long seed) {
+    std::lock_guard<std::mutex> lock(randomMutex);
+    randomEngine.seed(seed);
+}
+
+uint32_t getCpuFrequencyMhz() {
+    return CPU_MHZ;
+}
+
+// Print / Serial
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    size_t written = 0;
+    while (written < size && write(buffer[written])) {
+        written++;
+    }
+    return written;
+}
+
+size_t Print::printf(const char* format, ...) {
+    char small[128];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(small, sizeof(small), format, args);
+    va_end(args);
+    if (length < 0) {
+        return 0;
+    }
+    if (static_cast<size_t>(length) < sizeof(small)) {
+        return write(reinterpret_cast<const uint8_t*>(small), length);
+    }
+
+    std::string large(length + 1, '\0');
+    va_start(args, format);
+    vsnprintf(&large[0], large.size(), format, args);
+    va_end(args);
+    return write(reinterpret_cast<const uint8_t*>(large.data()), length);
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    if (logOutput.load(std::memory_order_relaxed)) {
+        fwrite(buffer, 1, size, stderr);
+    }
+    return size;
+}
+
+// ESP
+uint32_t EspClass::getHeapSize() {
+    return HEAP_SIZE;
+}
+
+uint32_t EspClass::getFreeHeap() {
+    size_t used = Sim::heapInUse();
+    size_t baseline = heapBaseline.load(std::memory_order_relaxed);
+    size_t grown = used > baseline ? used - baseline : 0;
+    uint32_t free = grown < HEAP_SIZE ? HEAP_SIZE - grown : 0;
+
+    uint32_t lowest = minFreeHeap.load(std::memory_order_relaxed);
+    while (free < lowest && !minFreeHeap.compare_exchange_weak(lowest, free, std::memory_order_relaxed)) {
+    }
+    return free;
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+    getFreeHeap();
+    return minFreeHeap.load(std::memory_order_relaxed);
+}
+
+// No fragmentation to speak of on the host
+uint32_t EspClass::getMaxAllocHeap() {
+    return getFreeHeap();
+}
+
+uint32_t EspClass::getCycleCount() {
+    return static_cast<uint32_t>(elapsedNanos() * CPU_MHZ / 1000);
+}
+
+void EspClass::restart() {
+    Serial.println("ESP.restart() called, exiting");
+    Sim::shutdown(EXIT_FAILURE);
+}
+
+// ESP-IDF
+esp_err_t esp_task_wdt_init(uint32_t timeoutSeconds, bool panic) {
+    (void)timeoutSeconds;
+    (void)panic;
+    return ESP_OK;
+}
+
+esp_err_t esp_task_wdt_add(TaskHandle_t task) {
+    (void)task;
+    return ESP_OK;
+}
+
+esp_err_t esp_task_wdt_delete(TaskHandle_t task) {
+    (void)task;
+    return ESP_OK;
+}
+
+esp_err_t esp_task_wdt_reset() {
+    return ESP_OK;
+}
+
+// There is no other core to interrupt; run it right here
+esp_err_t esp_ipc_call_blocking(uint32_t cpuId, esp_ipc_func_t func, void* arg) {
+    (void)cpuId;
+    func(arg);
+    return ESP_OK;
+}
+
+namespace Sim {
+    void setLogOutput(bool enabled) {
+        logOutput.store(enabled, std::memory_order_relaxed);
+    }
+
+    void resetHeapBaseline() {
+        heapBaseline.store(heapInUse(), std::memory_order_relaxed);
+        minFreeHeap.store(HEAP_SIZE, std::memory_order_relaxed);
+    }
+
+    size_t heapInUse() {
+        struct mallinfo2 info = mallinfo2();
+        return info.uordblks + info.hblkhd;
+    }
+
+    size_t peakRss() {
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return static_cast<size_t>(usage.ru_maxrss) * 1024;
+    }
+
+    uint64_t allocations() {
+        return allocationCount.load(std::memory_order_relaxed);
+    }
+
+    uint64_t threadAllocations() {
+        return threadAllocationCount;
+    }
+
+    void shutdown(int code) {
+        fflush(stdout);
+        fflush(stderr);
+        _exit(code);
+    }
+}
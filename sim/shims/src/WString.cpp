@@ -0,0 +1,84 @@
+#include "WString.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+    std::string toBase(unsigned long long number, unsigned char base, bool negative) {
+        if (base < 2 || base > 36) {
+            base = 10;
+        }
+        char digits[72];
+        size_t pos = sizeof(digits);
+        do {
+            unsigned digit = number % base;
+            digits[--pos] = digit < 10 ? '0' + digit : 'a' + digit - 10;
+            number /= base;
+        } while (number);
+        if (negative) {
+            digits[--pos] = '-';
+        }
+        return std::string(digits + pos, sizeof(digits) - pos);
+    }
+
+    std::string signedToBase(long long number, unsigned char base) {
+        // Arduino prints negative numbers in other bases as two's complement
+        if (number < 0 && base == 10) {
+            return toBase(0ULL - static_cast<unsigned long long>(number), base, true);
+        }
+        return toBase(static_cast<unsigned long long>(number), base, false);
+    }
+
+    std::string fixed(double number, unsigned int decimals) {
+        char buffer[64];
+        snprintf(buffer, sizeof(buffer), "%.*f", static_cast<int>(decimals), number);
+        return buffer;
+    }
+}
+
+String::String(int number, unsigned char base) : value(signedToBase(number, base)) {}
+String::String(unsigned int number, unsigned char base) : value(toBase(number, base, false)) {}
+String::String(long number, unsigned char base) : value(signedToBase(number, base)) {}
+String::String(unsigned long number, unsigned char base) : value(toBase(number, base, false)) {}
+String::String(long long number, unsigned char base) : value(signedToBase(number, base)) {}
+String::String(unsigned long long number, unsigned char base) : value(toBase(number, base, false)) {}
+String::String(float number, unsigned int decimals) : value(fixed(number, decimals)) {}
+String::String(double number, unsigned int decimals) : value(fixed(number, decimals)) {}
+
+String String::substring(unsigned int from, unsigned int to) const {
+    if (from > to) {
+        std::swap(from, to);
+    }
+    if (from >= value.size()) {
+        return String();
+    }
+    return String(value.substr(from, std::min<size_t>(to, value.size()) - from));
+}
+
+void String::trim() {
+    size_t begin = 0;
+    size_t end = value.size();
+    while (begin < end && isspace(static_cast<unsigned char>(value[begin]))) ++begin;
+    while (end > begin && isspace(static_cast<unsigned char>(value[end - 1]))) --end;
+    value = value.substr(begin, end - begin);
+}
+
+void String::toLowerCase() {
+    for (auto& c : value) c = tolower(static_cast<unsigned char>(c));
+}
+
+void String::toUpperCase() {
+    for (auto& c : value) c = toupper(static_cast<unsigned char>(c));
+}
+
+void String::replace(const String& find, const String& replacement) {
+    if (find.value.empty()) {
+        return;
+    }
+    size_t pos = 0;
+    while ((pos = value.find(find.value, pos)) != std::string::npos) {
+        value.replace(pos, find.value.size(), replacement.value);
+        pos += replacement.value.size();
+    }
+}
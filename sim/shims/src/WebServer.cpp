@@ -0,0 +1,828 @@
+#include <ESPAsyncWebServer.h>
+#include <algorithm>
+#include <condition_variable>
+#include <future>
+#include <regex>
+#include <thread>
+#include "Sim.h"
+
+namespace {
+    // The async_tcp task: runs every server-side callback, one job at a time
+    class AsyncTcp {
+    public:
+        void post(std::function<void()> job) {
+            std::call_once(started, [this] {
+                std::thread([this] { run(); }).detach();
+            });
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                jobs.push_back(std::move(job));
+            }
+            ready.notify_one();
+        }
+
+        // Blocks the caller until the job ran
+        void call(const std::function<void()>& job) {
+            if (std::this_thread::get_id() == thread) {
+                job();
+                return;
+            }
+            std::promise<void> done;
+            post([&] {
+                job();
+                done.set_value();
+            });
+            done.get_future().wait();
+        }
+
+    private:
+        void run() {
+            thread = std::this_thread::get_id();
+            for (;;) {
+                std::function<void()> job;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    ready.wait(lock, [this] { return !jobs.empty(); });
+                    job = std::move(jobs.front());
+                    jobs.pop_front();
+                }
+                job();
+            }
+        }
+
+        std::once_flag started;
+        std::atomic<std::thread::id> thread;
+        std::mutex mutex;
+        std::condition_variable ready;
+        std::deque<std::function<void()>> jobs;
+    };
+
+    AsyncTcp asyncTcp;
+
+    std::mutex registryMutex;
+    std::vector<AsyncWebServer*> servers;
+    std::vector<AsyncWebSocket*> sockets;
+
+    std::atomic<uint32_t> messagesSent{0};
+    std::atomic<uint32_t> bytesSent{0};
+    std::atomic<uint32_t> messagesDropped{0};
+
+    const String emptyString;
+
+    String contentTypeFor(const String& path) {
+        static const struct {
+            const char* extension;
+            const char* type;
+        } types[] = {
+            {".html", "text/html"}, {".htm", "text/html"}, {".css", "text/css"},
+            {".json", "application/json"}, {".js", "application/javascript"},
+            {".png", "image/png"}, {".gif", "image/gif"}, {".jpg", "image/jpeg"},
+            {".ico", "image/x-icon"}, {".svg", "image/svg+xml"}, {".woff2", "font/woff2"},
+            {".woff", "font/woff"}, {".ttf", "font/ttf"}, {".xml", "text/xml"},
+            {".pdf", "application/pdf"}, {".zip", "application/zip"}, {".gz", "application/x-gzip"},
+        };
+        for (const auto& entry : types) {
+            if (path.endsWith(entry.extension)) {
+                return entry.type;
+            }
+        }
+        return "text/plain";
+    }
+
+    int hexValue(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    String urlDecode(const std::string& text) {
+        std::string out;
+        out.reserve(text.size());
+        for (size_t i = 0; i < text.size(); i++) {
+            if (text[i] == '+') {
+                out += ' ';
+            } else if (text[i] == '%' && i + 2 < text.size() && hexValue(text[i + 1]) >= 0 &&
+                       hexValue(text[i + 2]) >= 0) {
+                out += static_cast<char>(hexValue(text[i + 1]) * 16 + hexValue(text[i + 2]));
+                i += 2;
+            } else {
+                out += text[i];
+            }
+        }
+        return String(out);
+    }
+
+    AwsResponseFiller fileFiller(File file) {
+        return [file](uint8_t* buffer, size_t maxLen, size_t index) mutable -> size_t {
+            (void)index;
+            return file.read(buffer, maxLen);
+        };
+    }
+}
+
+namespace Sim {
+    namespace Web {
+        // Reaches into the shim classes on behalf of the harness
+        class Access {
+        public:
+            static std::unique_ptr<AsyncWebServerRequest> makeRequest(uint8_t method, const char* url,
+                                                                      const String& body, const char* username,
+                                                                      const char* password) {
+                std::unique_ptr<AsyncWebServerRequest> request(new AsyncWebServerRequest());
+                std::string full(url ? url : "/");
+                size_t query = full.find('?');
+                request->requestMethod = method;
+                request->requestUrl = urlDecode(full.substr(0, query));
+                request->requestHost = "192.168.4.1";
+                if (query != std::string::npos) {
+                    std::string rest = full.substr(query + 1);
+                    size_t start = 0;
+                    while (start <= rest.size()) {
+                        size_t end = rest.find('&', start);
+                        if (end == std::string::npos) end = rest.size();
+                        std::string pair = rest.substr(start, end - start);
+                        if (!pair.empty()) {
+                            size_t equals = pair.find('=');
+                            request->parameters.emplace_back(
+                                urlDecode(pair.substr(0, equals)),
+                                equals == std::string::npos ? String() : urlDecode(pair.substr(equals + 1)));
+                        }
+                        start = end + 1;
+                    }
+                }
+                if (body.length()) {
+                    request->requestContentType = "application/json";
+                    request->bodyLength = body.length();
+                    request->parameters.emplace_back("plain", body, true);
+                }
+                if (username) request->username = username;
+                if (password) request->password = password;
+                return request;
+            }
+
+            static bool started(AsyncWebServer* server) {
+                return server->started;
+            }
+
+            static void dispatch(AsyncWebServer* server, AsyncWebServerRequest* request) {
+                server->handle(request);
+            }
+
+            static HttpResponse collect(AsyncWebServerRequest* request) {
+                HttpResponse out{0, std::string(), {}, std::string()};
+                AsyncWebServerResponse* response = request->response.get();
+                if (!response) {
+                    return out;
+                }
+                out.code = response->responseCode;
+                out.contentType = response->type.c_str();
+                for (const auto& header : response->headers) {
+                    out.headers.emplace_back(header.name().c_str(), header.value().c_str());
+                }
+                if (response->filler) {
+                    uint8_t chunk[CHUNK_SIZE];
+                    size_t index = 0;
+                    for (;;) {
+                        size_t len = response->filler(chunk, sizeof(chunk), index);
+                        if (len == RESPONSE_TRY_AGAIN) {
+                            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                            continue;
+                        }
+                        if (len == 0) {
+                            break;
+                        }
+                        len = std::min(len, sizeof(chunk));
+                        out.body.append(reinterpret_cast<const char*>(chunk), len);
+                        index += len;
+                    }
+                }
+                return out;
+            }
+
+            static void setStaticPath(AsyncWebServerRequest* request, const String& path) {
+                request->staticPath = path;
+            }
+
+            static const String& staticPath(AsyncWebServerRequest* request) {
+                return request->staticPath;
+            }
+
+            static bool authorized(AsyncWebSocket* socket, const char* username, const char* password) {
+                if (!socket->username.length() || !socket->password.length()) {
+                    return true;
+                }
+                return username && password && socket->username == username && socket->password == password;
+            }
+
+            static AsyncWebSocketClient* addClient(AsyncWebSocket* socket, WsPeer* peer) {
+                std::lock_guard<std::mutex> lock(socket->clientsMutex);
+                socket->clients.emplace_back(new AsyncWebSocketClient(socket, socket->nextId++));
+                socket->clients.back()->peer = peer;
+                return socket->clients.back().get();
+            }
+
+            static AsyncWebSocketClient* findClient(uint32_t id) {
+                std::lock_guard<std::mutex> lock(registryMutex);
+                for (AsyncWebSocket* socket : sockets) {
+                    std::lock_guard<std::mutex> clientsLock(socket->clientsMutex);
+                    for (const auto& client : socket->clients) {
+                        if (client->clientId == id) {
+                            return client.get();
+                        }
+                    }
+                }
+                return nullptr;
+            }
+
+            static void event(AsyncWebSocketClient* client, AwsEventType type, void* arg, uint8_t* data, size_t len) {
+                AsyncWebSocket* socket = client->owner;
+                if (socket->eventHandler) {
+                    socket->eventHandler(socket, client, type, arg, data, len);
+                }
+            }
+
+            // Delivers one queued message; re-posts itself while more wait,
+            // so clients and requests take turns as on the real stack
+            static void drain(AsyncWebSocketClient* client) {
+                AsyncWebSocketClient::Message message{nullptr, false};
+                bool more;
+                {
+                    std::lock_guard<std::mutex> lock(client->queueMutex);
+                    if (client->messages.empty()) {
+                        client->draining = false;
+                        return;
+                    }
+                    message = std::move(client->messages.front());
+                    client->messages.pop_front();
+                    more = !client->messages.empty();
+                    if (!more) {
+                        client->draining = false;
+                    }
+                }
+                if (client->status() == WS_CONNECTED && client->peer) {
+                    client->peer->onMessage(message.buffer->data(), message.buffer->size(), message.binary);
+                    messagesSent.fetch_add(1, std::memory_order_relaxed);
+                    bytesSent.fetch_add(message.buffer->size(), std::memory_order_relaxed);
+                }
+                // Sent: this message's reference goes, here on async_tcp
+                message.buffer.reset();
+                if (more) {
+                    asyncTcp.post([client] { drain(client); });
+                }
+            }
+
+            // Async thread: the connection is gone, from either side
+            static void closed(AsyncWebSocketClient* client, bool notifyPeer) {
+                if (client->state.exchange(WS_DISCONNECTED) == WS_DISCONNECTED) {
+                    return;
+                }
+                event(client, WS_EVT_DISCONNECT, nullptr, nullptr, 0);
+                std::deque<AsyncWebSocketClient::Message> pending;
+                {
+                    std::lock_guard<std::mutex> lock(client->queueMutex);
+                    pending.swap(client->messages);
+                }
+                pending.clear();
+                if (notifyPeer && client->peer) {
+                    client->peer->onClose();
+                }
+            }
+
+            static void data(AsyncWebSocketClient* client, const std::string& text) {
+                if (client->status() != WS_CONNECTED) {
+                    return;
+                }
+                std::vector<uint8_t> payload(text.begin(), text.end());
+                payload.push_back(0);
+                AwsFrameInfo info = {};
+                info.message_opcode = WS_TEXT;
+                info.final = 1;
+                info.opcode = WS_TEXT;
+                info.len = text.size();
+                event(client, WS_EVT_DATA, &info, payload.data(), text.size());
+            }
+        };
+    }
+}
+
+using Sim::Web::Access;
+
+// AsyncWebServerRequest
+AsyncWebParameter* AsyncWebServerRequest::getParam(const String& name, bool post, bool file) const {
+    for (const auto& param : parameters) {
+        if (param.name() == name && param.isPost() == post && param.isFile() == file) {
+            return const_cast<AsyncWebParameter*>(&param);
+        }
+    }
+    return nullptr;
+}
+
+const String& AsyncWebServerRequest::arg(const String& name) const {
+    for (const auto& param : parameters) {
+        if (param.name() == name) {
+            return param.value();
+        }
+    }
+    return emptyString;
+}
+
+const String& AsyncWebServerRequest::pathArg(size_t index) const {
+    return index < pathParameters.size() ? pathParameters[index] : emptyString;
+}
+
+AsyncWebHeader* AsyncWebServerRequest::getHeader(const String& name) const {
+    String wanted = name;
+    wanted.toLowerCase();
+    for (const auto& header : requestHeaders) {
+        String candidate = header.name();
+        candidate.toLowerCase();
+        if (candidate == wanted) {
+            return const_cast<AsyncWebHeader*>(&header);
+        }
+    }
+    return nullptr;
+}
+
+bool AsyncWebServerRequest::authenticate(const char* username, const char* password, const char* realm,
+                                         bool passwordIsHash) {
+    (void)realm;
+    (void)passwordIsHash;
+    if (!this->username.length() || !username || !password) {
+        return false;
+    }
+    return this->username == username && this->password == password;
+}
+
+void AsyncWebServerRequest::requestAuthentication(const char* realm, bool isDigest) {
+    AsyncWebServerResponse* response = beginResponse(401);
+    String challenge = isDigest ? "Digest realm=\"" : "Basic realm=\"";
+    challenge += realm ? realm : (isDigest ? "asyncesp" : "Login Required");
+    challenge += "\"";
+    response->addHeader("WWW-Authenticate", challenge);
+    send(response);
+}
+
+void AsyncWebServerRequest::send(AsyncWebServerResponse* response) {
+    if (this->response) {
+        delete response;    // Only the first response goes out
+        return;
+    }
+    this->response.reset(response);
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(int code, const String& contentType,
+                                                             const String& content) {
+    String type = contentType.length() || !content.length() ? contentType : String("text/plain");
+    std::string body = content.str();
+    return new AsyncWebServerResponse(code, type, [body](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+        if (index >= body.size()) {
+            return 0;
+        }
+        size_t len = std::min(maxLen, body.size() - index);
+        memcpy(buffer, body.data() + index, len);
+        return len;
+    });
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(FS& fs, const String& path, const String& contentType,
+                                                             bool download) {
+    bool gzipped = false;
+    File file = fs.open(path, "r");
+    if ((!file || file.isDirectory()) && !download) {
+        file = fs.open(path + ".gz", "r");
+        gzipped = true;
+    }
+    if (!file || file.isDirectory()) {
+        return nullptr;
+    }
+    auto* response = new AsyncWebServerResponse(200, contentType.length() ? contentType : contentTypeFor(path),
+                                                fileFiller(file));
+    if (gzipped) {
+        response->addHeader("Content-Encoding", "gzip");
+    }
+    if (download) {
+        String name = path.substring(path.lastIndexOf('/') + 1);
+        response->addHeader("Content-Disposition", "attachment; filename=\"" + name + "\"");
+    }
+    return response;
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(File content, const String& path,
+                                                             const String& contentType, bool download) {
+    if (!content) {
+        return nullptr;
+    }
+    auto* response = new AsyncWebServerResponse(200, contentType.length() ? contentType : contentTypeFor(path),
+                                                fileFiller(content));
+    if (!download && String(content.name()).endsWith(".gz") && !path.endsWith(".gz")) {
+        response->addHeader("Content-Encoding", "gzip");
+    }
+    if (download) {
+        String name = path.substring(path.lastIndexOf('/') + 1);
+        response->addHeader("Content-Disposition", "attachment; filename=\"" + name + "\"");
+    }
+    return response;
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse_P(int code, const String& contentType,
+                                                               const uint8_t* content, size_t len) {
+    return new AsyncWebServerResponse(code, contentType,
+                                      [content, len](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+        if (index >= len) {
+            return 0;
+        }
+        size_t count = std::min(maxLen, len - index);
+        memcpy(buffer, content + index, count);
+        return count;
+    });
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginChunkedResponse(const String& contentType,
+                                                                    AwsResponseFiller callback) {
+    auto* response = new AsyncWebServerResponse(200, contentType, callback);
+    response->addHeader("Transfer-Encoding", "chunked");
+    return response;
+}
+
+// AsyncCallbackWebHandler
+void AsyncCallbackWebHandler::setUri(const String& uri) {
+    this->uri = uri;
+    isRegex = uri.startsWith("^") && uri.endsWith("$");
+}
+
+// Same rules as the library: "^...$" regex, "/*.ext" suffix, "prefix*",
+// otherwise the exact path or anything below it
+bool AsyncCallbackWebHandler::canHandle(AsyncWebServerRequest* request) {
+    if (!callback || !(methods & request->method())) {
+        return false;
+    }
+    const String& url = request->url();
+    if (isRegex) {
+        std::smatch match;
+        std::string subject = url.str();
+        if (!std::regex_search(subject, match, std::regex(uri.c_str()))) {
+            return false;
+        }
+        for (size_t i = 1; i < match.size(); i++) {
+            request->_addPathParam(match[i].str().c_str());
+        }
+    } else if (uri.length() && uri.startsWith("/*.")) {
+        if (!url.endsWith(uri.substring(uri.lastIndexOf('.')))) {
+            return false;
+        }
+    } else if (uri.length() && uri.endsWith("*")) {
+        if (!url.startsWith(uri.substring(0, uri.length() - 1))) {
+            return false;
+        }
+    } else if (uri.length() && uri != url && !url.startsWith(uri + "/")) {
+        return false;
+    }
+    return true;
+}
+
+void AsyncCallbackWebHandler::handleRequest(AsyncWebServerRequest* request) {
+    if (callback) {
+        callback(request);
+    } else {
+        request->send(500);
+    }
+}
+
+// AsyncStaticWebHandler
+AsyncStaticWebHandler::AsyncStaticWebHandler(const char* uri, FS& fs, const char* path, const char* cacheControl)
+    : uri(uri), fs(fs), path(path), cacheControl(cacheControl ? cacheControl : "") {
+    if (!this->uri.startsWith("/")) this->uri = "/" + this->uri;
+    if (!this->path.startsWith("/")) this->path = "/" + this->path;
+    if (this->uri.endsWith("/")) this->uri = this->uri.substring(0, this->uri.length() - 1);
+    if (this->path.endsWith("/")) this->path = this->path.substring(0, this->path.length() - 1);
+}
+
+// Only claims requests for files that exist (or their .gz)
+bool AsyncStaticWebHandler::canHandle(AsyncWebServerRequest* request) {
+    if (request->method() != HTTP_GET || !request->url().startsWith(uri)) {
+        return false;
+    }
+    String rest = request->url().substring(uri.length());
+    String file = path + rest;
+    auto exists = [this](const String& candidate) {
+        if (fs.exists(candidate) && !fs.open(candidate, "r").isDirectory()) return true;
+        return fs.exists(candidate + ".gz");
+    };
+    if (rest.length() && !rest.endsWith("/") && exists(file)) {
+        Access::setStaticPath(request, file);
+        return true;
+    }
+    if (!defaultFile.length()) {
+        return false;
+    }
+    if (!file.endsWith("/")) file += "/";
+    file += defaultFile;
+    if (!exists(file)) {
+        return false;
+    }
+    Access::setStaticPath(request, file);
+    return true;
+}
+
+void AsyncStaticWebHandler::handleRequest(AsyncWebServerRequest* request) {
+    AsyncWebServerResponse* response = request->beginResponse(fs, Access::staticPath(request));
+    if (!response) {
+        request->send(404);
+        return;
+    }
+    if (cacheControl.length()) {
+        response->addHeader("Cache-Control", cacheControl);
+    }
+    request->send(response);
+}
+
+// AsyncWebServer
+AsyncWebServer::AsyncWebServer(uint16_t port) : port(port) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    servers.push_back(this);
+}
+
+AsyncWebServer::~AsyncWebServer() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    servers.erase(std::remove(servers.begin(), servers.end(), this), servers.end());
+}
+
+AsyncWebHandler& AsyncWebServer::addHandler(AsyncWebHandler* handler) {
+    std::lock_guard<std::mutex> lock(handlersMutex);
+    handlers.push_back(handler);
+    return *handler;
+}
+
+bool AsyncWebServer::removeHandler(AsyncWebHandler* handler) {
+    std::lock_guard<std::mutex> lock(handlersMutex);
+    auto found = std::find(handlers.begin(), handlers.end(), handler);
+    if (found == handlers.end()) {
+        return false;
+    }
+    handlers.erase(found);
+    return true;
+}
+
+AsyncCallbackWebHandler& AsyncWebServer::on(const char* uri, WebRequestMethodComposite method,
+                                            ArRequestHandlerFunction onRequest) {
+    auto* handler = new AsyncCallbackWebHandler();
+    handler->setUri(uri);
+    handler->setMethod(method);
+    handler->onRequest(onRequest);
+    std::lock_guard<std::mutex> lock(handlersMutex);
+    owned.emplace_back(handler);
+    handlers.push_back(handler);
+    return *handler;
+}
+
+AsyncStaticWebHandler& AsyncWebServer::serveStatic(const char* uri, FS& fs, const char* path,
+                                                   const char* cacheControl) {
+    auto* handler = new AsyncStaticWebHandler(uri, fs, path, cacheControl);
+    std::lock_guard<std::mutex> lock(handlersMutex);
+    owned.emplace_back(handler);
+    handlers.push_back(handler);
+    return *handler;
+}
+
+// First handler that takes the request wins; without onNotFound the
+// library's catch-all answers 500
+void AsyncWebServer::handle(AsyncWebServerRequest* request) {
+    AsyncWebHandler* chosen = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(handlersMutex);
+        for (AsyncWebHandler* handler : handlers) {
+            if (handler->filter(request) && handler->canHandle(request)) {
+                chosen = handler;
+                break;
+            }
+        }
+    }
+    if (chosen) {
+        chosen->handleRequest(request);
+    } else if (notFound) {
+        notFound(request);
+    } else {
+        request->send(500);
+    }
+}
+
+// AsyncWebSocketClient
+size_t AsyncWebSocketClient::queueLen() {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return messages.size();
+}
+
+void AsyncWebSocketClient::close(uint16_t code, const char* message) {
+    (void)code;
+    (void)message;
+    AwsClientStatus expected = WS_CONNECTED;
+    if (!state.compare_exchange_strong(expected, WS_DISCONNECTING)) {
+        return;
+    }
+    asyncTcp.post([this] { Access::closed(this, true); });
+}
+
+void AsyncWebSocketClient::text(const char* message, size_t len) {
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(message);
+    queue(std::make_shared<std::vector<uint8_t>>(data, data + len), false);
+}
+
+void AsyncWebSocketClient::text(AsyncWebSocketMessageBuffer* buffer) {
+    if (buffer) {
+        queue(std::move(buffer->buffer), false);
+        delete buffer;
+    }
+}
+
+void AsyncWebSocketClient::binary(const uint8_t* message, size_t len) {
+    queue(std::make_shared<std::vector<uint8_t>>(message, message + len), true);
+}
+
+void AsyncWebSocketClient::binary(AsyncWebSocketMessageBuffer* buffer) {
+    if (buffer) {
+        queue(std::move(buffer->buffer), true);
+        delete buffer;
+    }
+}
+
+// Like the library: nothing is queued for a client that is not connected,
+// and a full queue drops the message
+void AsyncWebSocketClient::queue(AsyncWebSocketSharedBuffer buffer, bool binary) {
+    if (!buffer || status() != WS_CONNECTED) {
+        return;
+    }
+    bool schedule;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (messages.size() >= WS_MAX_QUEUED_MESSAGES) {
+            messagesDropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        messages.push_back(Message{std::move(buffer), binary});
+        schedule = !draining;
+        draining = true;
+    }
+    if (schedule) {
+        asyncTcp.post([this] { Access::drain(this); });
+    }
+}
+
+// AsyncWebSocket
+AsyncWebSocket::AsyncWebSocket(const String& url) : path(url) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    sockets.push_back(this);
+}
+
+AsyncWebSocket::~AsyncWebSocket() {
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        sockets.erase(std::remove(sockets.begin(), sockets.end(), this), sockets.end());
+    }
+}
+
+size_t AsyncWebSocket::count() {
+    std::lock_guard<std::mutex> lock(clientsMutex);
+    return std::count_if(clients.begin(), clients.end(), [](const std::unique_ptr<AsyncWebSocketClient>& client) {
+        return client->status() == WS_CONNECTED;
+    });
+}
+
+AsyncWebSocketClient* AsyncWebSocket::client(uint32_t id) {
+    std::lock_guard<std::mutex> lock(clientsMutex);
+    for (const auto& client : clients) {
+        if (client->id() == id && client->status() == WS_CONNECTED) {
+            return client.get();
+        }
+    }
+    return nullptr;
+}
+
+void AsyncWebSocket::close(uint32_t id, uint16_t code, const char* message) {
+    if (AsyncWebSocketClient* found = client(id)) {
+        found->close(code, message);
+    }
+}
+
+void AsyncWebSocket::closeAll(uint16_t code, const char* message) {
+    std::lock_guard<std::mutex> lock(clientsMutex);
+    for (const auto& client : clients) {
+        client->close(code, message);
+    }
+}
+
+void AsyncWebSocket::textAll(const char* message, size_t len) {
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(message);
+    sendAll(std::make_shared<std::vector<uint8_t>>(data, data + len), false);
+}
+
+void AsyncWebSocket::textAll(AsyncWebSocketMessageBuffer* buffer) {
+    if (buffer) {
+        sendAll(std::move(buffer->buffer), false);
+        delete buffer;
+    }
+}
+
+void AsyncWebSocket::binaryAll(AsyncWebSocketMessageBuffer* buffer) {
+    if (buffer) {
+        sendAll(std::move(buffer->buffer), true);
+        delete buffer;
+    }
+}
+
+void AsyncWebSocket::sendAll(AsyncWebSocketSharedBuffer buffer, bool binary) {
+    if (!buffer) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(clientsMutex);
+    for (const auto& client : clients) {
+        if (client->status() == WS_CONNECTED) {
+            client->queue(buffer, binary);
+        }
+    }
+}
+
+AsyncWebSocketMessageBuffer* AsyncWebSocket::makeBuffer(size_t size) {
+    return new AsyncWebSocketMessageBuffer(size);
+}
+
+AsyncWebSocketMessageBuffer* AsyncWebSocket::makeBuffer(uint8_t* data, size_t size) {
+    return new AsyncWebSocketMessageBuffer(data, size);
+}
+
+// Harness side
+namespace Sim {
+    namespace Web {
+        HttpResponse request(uint8_t method, const char* url, const String& body, const char* username,
+                             const char* password) {
+            HttpResponse out{0, std::string(), {}, std::string()};
+            asyncTcp.call([&] {
+                AsyncWebServer* server = nullptr;
+                {
+                    std::lock_guard<std::mutex> lock(registryMutex);
+                    for (AsyncWebServer* candidate : servers) {
+                        if (Access::started(candidate)) {
+                            server = candidate;
+                            break;
+                        }
+                    }
+                }
+                if (!server) {
+                    return;     // Connection refused
+                }
+                auto request = Access::makeRequest(method, url, body, username, password);
+                Access::dispatch(server, request.get());
+                out = Access::collect(request.get());
+            });
+            return out;
+        }
+
+        uint32_t connect(const char* url, WsPeer* peer, const char* username, const char* password) {
+            uint32_t id = 0;
+            asyncTcp.call([&] {
+                AsyncWebSocket* socket = nullptr;
+                {
+                    std::lock_guard<std::mutex> lock(registryMutex);
+                    for (AsyncWebSocket* candidate : sockets) {
+                        if (candidate->url() == String(url)) {
+                            socket = candidate;
+                            break;
+                        }
+                    }
+                }
+                if (!socket || !Access::authorized(socket, username, password)) {
+                    return;
+                }
+                AsyncWebSocketClient* client = Access::addClient(socket, peer);
+                id = client->id();
+                Access::event(client, WS_EVT_CONNECT, nullptr, nullptr, 0);
+            });
+            return id;
+        }
+
+        void send(uint32_t clientId, const String& text) {
+            std::string payload = text.str();
+            asyncTcp.post([clientId, payload] {
+                if (AsyncWebSocketClient* client = Access::findClient(clientId)) {
+                    Access::data(client, payload);
+                }
+            });
+        }
+
+        void disconnect(uint32_t clientId) {
+            asyncTcp.post([clientId] {
+                if (AsyncWebSocketClient* client = Access::findClient(clientId)) {
+                    Access::closed(client, false);
+                }
+            });
+        }
+
+        Stats getStats() {
+            return Stats{
+                messagesSent.load(std::memory_order_relaxed),
+                bytesSent.load(std::memory_order_relaxed),
+                messagesDropped.load(std::memory_order_relaxed)
+            };
+        }
+    }
+}
@@ -0,0 +1,89 @@
+#include "ClientTable.h"
+
+ClientTable::ClientTable() : activeMask(0), dirtyMask(0), changeListener(nullptr) {
+    for (size_t id = 0; id < CAPACITY; ++id) {
+        dirtyFields[id].store(0, std::memory_order_relaxed);
+        lastSeen[id].store(0, std::memory_order_relaxed);
+        addresses[id].store(0, std::memory_order_relaxed);
+    }
+    writeMutex = xSemaphoreCreateMutex();
+}
+
+ClientTable::~ClientTable() {
+    if (writeMutex) vSemaphoreDelete(writeMutex);
+}
+
+bool ClientTable::read(uint8_t id, ClientState& out) const {
+    if (!isValidId(id) || !(getActiveMask() & (1UL << id))) {
+        return false;
+    }
+    slots[id].read(out);
+    out.lastSeen = lastSeen[id].load(std::memory_order_relaxed);
+    return out.isActive;
+}
+
+bool ClientTable::upsert(uint8_t id, const IPAddress& ip, uint32_t now, bool* created) {
+    if (!isValidId(id)) {
+        return false;
+    }
+    if (!Metrics::take(writeMutex, pdMS_TO_TICKS(100), writeWait)) {
+        return false;
+    }
+
+    uint16_t changed = 0;
+    bool added = false;
+    slots[id].write([&](ClientState& client) {
+        if (!client.isActive) {
+            added = true;
+            client = ClientState();
+            client.id = id;
+            client.isActive = true;
+            client.brightness = Config::Hardware::DEFAULT_BRIGHTNESS;
+            changed = FIELD_ALL;
+        }
+        if (client.ip != static_cast<uint32_t>(ip)) {
+            client.ip = static_cast<uint32_t>(ip);
+            changed |= FIELD_ADDRESS;
+        }
+        client.lastSeen = now;
+    });
+    lastSeen[id].store(now, std::memory_order_relaxed);
+    addresses[id].store(static_cast<uint32_t>(ip), std::memory_order_relaxed);
+    activeMask.fetch_or(1UL << id, std::memory_order_release);
+
+    xSemaphoreGive(writeMutex);
+    markDirty(id, changed);
+    if (created) {
+        *created = added;
+    }
+    return true;
+}
+
+bool ClientTable::remove(uint8_t id) {
+    if (!isValidId(id)) {
+        return false;
+    }
+    if (!Metrics::take(writeMutex, pdMS_TO_TICKS(100), writeWait)) {
+        return false;
+    }
+
+    activeMask.fetch_and(~(1UL << id), std::memory_order_release);
+    slots[id].write([](ClientState& client) {
+        client.isActive = false;
+    });
+
+    xSemaphoreGive(writeMutex);
+    markDirty(id, FIELD_ACTIVE);
+    return true;
+}
+
+void ClientTable::markDirty(uint8_t id, uint16_t fields) {
+    if (fields == 0) {
+        return;
+    }
+    dirtyFields[id].fetch_or(fields, std::memory_order_release);
+    dirtyMask.fetch_or(1UL << id, std::memory_order_release);
+    if (changeListener) {
+        xTaskNotifyGive(changeListener);
+    }
+}
@@ -0,0 +1,98 @@
+#include "ClockSync.h"
+
+namespace ClockSync {
+
+namespace {
+    constexpr uint16_t MIN_SAMPLES = 4;
+    constexpr uint32_t DELAY_SLACK_US = 200;            // Tolerated queueing beyond best path
+    constexpr uint32_t DRIFT_BASELINE_US = 20000000;    // Interval between drift updates
+    constexpr int32_t MAX_DRIFT_PPB = 500000;           // 500 ppm, far beyond any crystal
+
+    int32_t driftCorrection(const Estimate& estimate, uint32_t hostUs) {
+        int32_t elapsed = static_cast<int32_t>(hostUs - estimate.referenceHostUs);
+        return static_cast<int32_t>(static_cast<int64_t>(estimate.driftPpb) * elapsed / 1000000000LL);
+    }
+}
+
+bool addSample(Estimate& estimate, uint32_t t1, uint32_t t2, uint32_t t3, uint32_t t4) {
+    uint32_t roundTrip = t4 - t1;
+    uint32_t targetHold = t3 - t2;
+    uint32_t delay = roundTrip > targetHold ? roundTrip - targetHold : 0;
+
+    // Assumes symmetric paths; the error is bounded by delay / 2
+    uint32_t measuredOffset = t2 - t1 - delay / 2;
+    uint32_t sampleHostUs = t1 + roundTrip / 2;
+
+    if (estimate.samples == 0) {
+        estimate = Estimate();
+        estimate.offsetUs = measuredOffset;
+        estimate.referenceHostUs = sampleHostUs;
+        estimate.anchorOffsetUs = measuredOffset;
+        estimate.anchorHostUs = sampleHostUs;
+        estimate.minDelayUs = delay;
+        estimate.lastDelayUs = delay;
+        estimate.samples = 1;
+        return true;
+    }
+
+    // Age the best delay so a permanently slower path is accepted again
+    estimate.minDelayUs += estimate.minDelayUs / 256 + 1;
+    if (delay < estimate.minDelayUs) {
+        estimate.minDelayUs = delay;
+    }
+
+    // Samples that queued noticeably longer than the best path carry a
+    // large asymmetry error; skip them rather than let them bias the offset
+    if (delay > estimate.minDelayUs + estimate.minDelayUs / 2 + DELAY_SLACK_US) {
+        estimate.rejected++;
+        return false;
+    }
+
+    // Blend the measurement into the drift-projected offset; faster gain
+    // while the estimate is still settling
+    uint32_t predicted = estimate.offsetUs + driftCorrection(estimate, sampleHostUs);
+    int32_t error = static_cast<int32_t>(measuredOffset - predicted);
+    int32_t gainShift = estimate.samples < MIN_SAMPLES ? 1 : 2;
+    estimate.offsetUs = predicted + (error >> gainShift);
+    estimate.referenceHostUs = sampleHostUs;
+
+    // Drift is the slope of the filtered offset over a long baseline,
+    // smoothed across baselines
+    int32_t baseline = static_cast<int32_t>(sampleHostUs - estimate.anchorHostUs);
+    if (baseline >= static_cast<int32_t>(DRIFT_BASELINE_US)) {
+        int32_t change = static_cast<int32_t>(estimate.offsetUs - estimate.anchorOffsetUs);
+        int64_t slope = static_cast<int64_t>(change) * 1000000000LL / baseline;
+        int64_t drift = estimate.driftPpb + (slope - estimate.driftPpb) / 4;
+        if (drift > MAX_DRIFT_PPB) drift = MAX_DRIFT_PPB;
+        if (drift < -MAX_DRIFT_PPB) drift = -MAX_DRIFT_PPB;
+        estimate.driftPpb = static_cast<int32_t>(drift);
+        estimate.anchorOffsetUs = estimate.offsetUs;
+        estimate.anchorHostUs = sampleHostUs;
+    }
+
+    estimate.lastDelayUs = delay;
+    if (estimate.samples < UINT16_MAX) {
+        estimate.samples++;
+    }
+    return true;
+}
+
+bool isSynced(const Estimate& estimate) {
+    return estimate.samples >= MIN_SAMPLES;
+}
+
+uint32_t toHostTime(const Estimate& estimate, uint32_t targetUs) {
+    uint32_t approxHostUs = targetUs - estimate.offsetUs;
+    return approxHostUs - driftCorrection(estimate, approxHostUs);
+}
+
+uint32_t toHostDuration(const Estimate& estimate, uint32_t fromTargetUs, uint32_t toTargetUs) {
+    int32_t duration = static_cast<int32_t>(toTargetUs - fromTargetUs);
+    if (duration < 0) {
+        return 0;
+    }
+    int64_t correction = static_cast<int64_t>(duration) * estimate.driftPpb / 1000000000LL;
+    return static_cast<uint32_t>(duration - correction);
+}
+
+}
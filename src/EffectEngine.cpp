@@ -0,0 +1,258 @@
+#include "EffectEngine.h"
+
+namespace EffectEngine {
+
+namespace {
+    using Config::Hardware::LED_MATRIX_WIDTH;
+    using Config::Hardware::LED_MATRIX_HEIGHT;
+    using Config::Hardware::NUM_LEDS;
+
+    // 128 + 127 * sin(2 pi i / 256), Bhaskara's rational approximation
+    // (error below 0.2%) so the table is exact integer math
+    constexpr std::array<uint8_t, 256> makeSine() {
+        std::array<uint8_t, 256> table{};
+        for (int i = 0; i < 256; ++i) {
+            int x = i & 127;
+            int p = x * (128 - x);
+            int v = 127 * 16 * p / (5 * 128 * 128 - 4 * p);
+            table[i] = i < 128 ? 128 + v : 128 - v;
+        }
+        return table;
+    }
+
+    // Full-saturation hue wheel in six linear segments
+    constexpr std::array<Rgb, 256> makeHue() {
+        std::array<Rgb, 256> table{};
+        for (int h = 0; h < 256; ++h) {
+            int segment = h / 43;
+            uint8_t rise = (h - segment * 43) * 6;
+            uint8_t fall = 255 - rise;
+            switch (segment) {
+                case 0:  table[h] = Rgb{255, rise, 0};  break;
+                case 1:  table[h] = Rgb{fall, 255, 0};  break;
+                case 2:  table[h] = Rgb{0, 255, rise};  break;
+                case 3:  table[h] = Rgb{0, fall, 255};  break;
+                case 4:  table[h] = Rgb{rise, 0, 255};  break;
+                default: table[h] = Rgb{255, 0, fall};  break;
+            }
+        }
+        return table;
+    }
+
+    // Black -> red -> yellow -> white
+    constexpr std::array<Rgb, 256> makeHeat() {
+        std::array<Rgb, 256> table{};
+        for (int t = 0; t < 256; ++t) {
+            int ramp = (t % 86) * 3;
+            if (t < 86) {
+                table[t] = Rgb{static_cast<uint8_t>(ramp), 0, 0};
+            } else if (t < 172) {
+                table[t] = Rgb{255, static_cast<uint8_t>(ramp), 0};
+            } else {
+                table[t] = Rgb{255, 255, static_cast<uint8_t>(ramp)};
+            }
+        }
+        return table;
+    }
+
+    constexpr std::array<uint8_t, 256> SINE = makeSine();
+    constexpr std::array<Rgb, 256> HUE = makeHue();
+    constexpr std::array<Rgb, 256> HEAT = makeHeat();
+
+    static_assert(SINE[0] == 128 && SINE[64] == 255 && SINE[192] == 1, "sine table");
+    static_assert(HUE[0].r == 255 && HUE[0].g == 0, "hue table");
+
+    constexpr const char* NAMES[] = {
+        "solid", "rainbow", "fade", "sparkle", "wave", "fire", "matrix", "spectrum"
+    };
+    static_assert(sizeof(NAMES) / sizeof(NAMES[0]) == Config::Effects::MAX_EFFECTS, "one name per effect");
+
+    inline uint8_t scale8(uint8_t value, uint8_t scale) {
+        return (value * (scale + 1)) >> 8;
+    }
+
+    inline Rgb scale(const Rgb& color, uint8_t level) {
+        return Rgb{scale8(color.r, level), scale8(color.g, level), scale8(color.b, level)};
+    }
+
+    inline uint8_t qadd8(uint8_t a, uint8_t b) {
+        unsigned sum = a + b;
+        return sum > 255 ? 255 : sum;
+    }
+
+    inline uint8_t qsub8(uint8_t a, uint8_t b) {
+        return a > b ? a - b : 0;
+    }
+
+    // xorshift32; the state must not be zero
+    inline uint8_t random8(State& state) {
+        uint32_t x = state.random;
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        state.random = x;
+        return x >> 24;
+    }
+
+    void renderSparkle(const Params& params, State& state, Frame& frame) {
+        // Existing sparkles decay, a few new ones light up
+        for (auto& level : state.level) {
+            level = scale8(level, 200);
+        }
+        uint8_t births = 1 + (params.speed >> 4);
+        for (uint8_t i = 0; i < births; ++i) {
+            if (random8(state) < 96) {
+                state.level[random8(state) % NUM_LEDS] = 255;
+            }
+        }
+        Rgb base = scale(params.color, 24);
+        for (size_t i = 0; i < NUM_LEDS; ++i) {
+            uint8_t level = state.level[i];
+            frame[i] = Rgb{qadd8(base.r, level), qadd8(base.g, level), qadd8(base.b, level)};
+        }
+    }
+
+    // Fire2012 per column, burning from the bottom row upwards
+    void renderFire(State& state, Frame& frame) {
+        for (uint8_t x = 0; x < LED_MATRIX_WIDTH; ++x) {
+            // Cool every cell, rows counted from the bottom
+            for (uint8_t y = 0; y < LED_MATRIX_HEIGHT; ++y) {
+                uint8_t& heat = state.level[y * LED_MATRIX_WIDTH + x];
+                heat = qsub8(heat, random8(state) % 48);
+            }
+            // Heat drifts up and diffuses
+            for (uint8_t y = LED_MATRIX_HEIGHT - 1; y >= 2; --y) {
+                state.level[y * LED_MATRIX_WIDTH + x] =
+                    (state.level[(y - 1) * LED_MATRIX_WIDTH + x] +
+                     2 * state.level[(y - 2) * LED_MATRIX_WIDTH + x]) / 3;
+            }
+            // Random sparks at the base
+            if (random8(state) < 160) {
+                uint8_t& base = state.level[x];
+                base = qadd8(base, 160 + random8(state) % 96);
+            }
+            for (uint8_t y = 0; y < LED_MATRIX_HEIGHT; ++y) {
+                uint8_t row = LED_MATRIX_HEIGHT - 1 - y;  // Bottom of the frame is y = 7
+                frame[row * LED_MATRIX_WIDTH + x] = HEAT[state.level[y * LED_MATRIX_WIDTH + x]];
+            }
+        }
+    }
+
+    // Falling code: each column has a head moving down and a fading trail
+    void renderMatrix(const Params& params, uint32_t tick, State& state, Frame& frame) {
+        for (auto& level : state.level) {
+            level = scale8(level, 180);
+        }
+        bool step = ((tick * params.speed) >> 4) != (((tick - 1) * params.speed) >> 4);
+        for (uint8_t x = 0; x < LED_MATRIX_WIDTH; ++x) {
+            uint8_t& head = state.column[x];   // 0 = idle, else row + 1
+            if (step) {
+                if (head == 0) {
+                    if (random8(state) < 40) head = 1;
+                } else {
+                    head = head < LED_MATRIX_HEIGHT ? head + 1 : 0;
+                }
+            }
+            if (head > 0) {
+                state.level[(head - 1) * LED_MATRIX_WIDTH + x] = 255;
+            }
+        }
+        for (size_t i = 0; i < NUM_LEDS; ++i) {
+            uint8_t level = state.level[i];
+            // Heads are near white, trails green
+            frame[i] = Rgb{level == 255 ? uint8_t(180) : uint8_t(0), level, level == 255 ? uint8_t(180) : uint8_t(0)};
+        }
+    }
+}
+
+void State::reset(Type effect) {
+    level.fill(0);
+    column.fill(0);
+    random = 0x2545F491;
+    type = effect;
+}
+
+void render(const Params& params, uint32_t tick, State& state, Frame& frame) {
+    if (state.type != params.type) {
+        state.reset(params.type);
+        state.random ^= params.phase * 0x9E3779B9u;  // Targets sparkle differently
+    }
+    uint8_t t = (tick * params.speed) >> 4;
+
+    switch (params.type) {
+        case Type::RAINBOW:
+            for (size_t i = 0; i < NUM_LEDS; ++i) {
+                uint8_t x = i % LED_MATRIX_WIDTH;
+                frame[i] = HUE[static_cast<uint8_t>(t * 4 + x * 32 + params.phase)];
+            }
+            break;
+
+        case Type::FADE:
+            frame.fill(scale(params.color, SINE[static_cast<uint8_t>(t * 2 + params.phase)]));
+            break;
+
+        case Type::SPARKLE:
+            renderSparkle(params, state, frame);
+            break;
+
+        case Type::WAVE:
+            for (size_t i = 0; i < NUM_LEDS; ++i) {
+                uint8_t x = i % LED_MATRIX_WIDTH;
+                uint8_t y = i / LED_MATRIX_WIDTH;
+                uint8_t angle = t * 4 + x * 32 + y * 8 + params.phase;
+                frame[i] = scale(params.color, SINE[angle]);
+            }
+            break;
+
+        case Type::FIRE:
+            renderFire(state, frame);
+            break;
+
+        case Type::MATRIX:
+            renderMatrix(params, tick, state, frame);
+            break;
+
+        case Type::SPECTRUM:
+            // Bars from two beating sines per column, green at the bottom to red on top
+            for (uint8_t x = 0; x < LED_MATRIX_WIDTH; ++x) {
+                uint8_t a = SINE[static_cast<uint8_t>(t * 3 + x * 37 + params.phase)];
+                uint8_t b = SINE[static_cast<uint8_t>(t * 5 - x * 23)];
+                uint8_t height = ((a + b) * (LED_MATRIX_HEIGHT + 1)) >> 9;
+                for (uint8_t row = 0; row < LED_MATRIX_HEIGHT; ++row) {
+                    uint8_t fromBottom = LED_MATRIX_HEIGHT - 1 - row;
+                    frame[row * LED_MATRIX_WIDTH + x] = fromBottom < height
+                        ? HUE[96 - fromBottom * 96 / (LED_MATRIX_HEIGHT - 1)]
+                        : Rgb{0, 0, 0};
+                }
+            }
+            break;
+
+        case Type::SOLID:
+        default:
+            frame.fill(params.color);
+            break;
+    }
+
+    if (params.brightness < 255) {
+        for (auto& pixel : frame) {
+            pixel = scale(pixel, params.brightness);
+        }
+    }
+}
+
+bool fromName(const char* name, Type& type) {
+    for (uint8_t i = 0; i < Config::Effects::MAX_EFFECTS; ++i) {
+        if (strcmp(name, NAMES[i]) == 0) {
+            type = static_cast<Type>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* name(Type type) {
+    uint8_t index = static_cast<uint8_t>(type);
+    return index < Config::Effects::MAX_EFFECTS ? NAMES[index] : "unknown";
+}
+
+}
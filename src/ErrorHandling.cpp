@@ -0,0 +1,163 @@
+#include "ErrorHandling.h"
+
+namespace Error {
+    namespace {
+        constexpr const char* CODE_NAMES[] = {
+            "NONE",
+            "WIFI_CONNECTION_FAILED",
+            "UDP_INIT_FAILED",
+            "WEBSOCKET_ERROR",
+            "INVALID_MESSAGE",
+            "HARDWARE_ERROR",
+            "AUTHENTICATION_FAILED",
+            "MEMORY_ERROR",
+            "TASK_CREATE_FAILED",
+            "TRAINING_ERROR",
+            "COMMUNICATION_ERROR"
+        };
+        static_assert(sizeof(CODE_NAMES) / sizeof(CODE_NAMES[0]) == static_cast<size_t>(Code::COUNT),
+                      "Every code needs a name");
+
+        constexpr const char* MESSAGE_TEXTS[] = {
+            "",
+            "Storage initialization failed",
+            "WiFi initialization failed",
+            "UDP initialization failed",
+            "Task creation failed",
+            "Max WebSocket clients reached",
+            "Invalid WebSocket message",
+            "WebSocket error",
+            "Client error reported",
+            "Client reported an unknown error code",
+            "Session history unavailable",
+            "Reliable command not acknowledged"
+        };
+        static_assert(sizeof(MESSAGE_TEXTS) / sizeof(MESSAGE_TEXTS[0]) == static_cast<size_t>(Message::COUNT),
+                      "Every message needs a text");
+    }
+
+    ErrorHandler::Slot ErrorHandler::slots[LOG_SIZE];
+    std::atomic<uint32_t> ErrorHandler::head{0};
+    std::atomic<uint32_t> ErrorHandler::cleared{0};
+    std::atomic<uint32_t> ErrorHandler::lost{0};
+    std::atomic<uint32_t> ErrorHandler::counts[static_cast<size_t>(Code::COUNT)];
+
+    const char* codeName(Code code) {
+        size_t index = static_cast<size_t>(code);
+        return index < static_cast<size_t>(Code::COUNT) ? CODE_NAMES[index] : "UNKNOWN";
+    }
+
+    const char* messageText(Message message) {
+        size_t index = static_cast<size_t>(message);
+        return index < static_cast<size_t>(Message::COUNT) ? MESSAGE_TEXTS[index] : "";
+    }
+
+    void IRAM_ATTR ErrorHandler::logError(Code code, Message message, uint8_t clientId, uint32_t arg) {
+        size_t index = static_cast<size_t>(code);
+        if (index < static_cast<size_t>(Code::COUNT)) {
+            counts[index].fetch_add(1, std::memory_order_relaxed);
+        }
+
+        uint32_t ticket = head.fetch_add(1, std::memory_order_relaxed);
+        Slot& slot = slots[ticket & (LOG_SIZE - 1)];
+        uint32_t claim = ticket * 2 + 1;
+
+        // Only take the slot from a finished, older entry
+        uint32_t current = slot.sequence.load(std::memory_order_relaxed);
+        do {
+            if ((current & 1) || static_cast<int32_t>(current - claim) > 0) {
+                lost.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        } while (!slot.sequence.compare_exchange_weak(current, claim, std::memory_order_relaxed));
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slot.timestamp.store(millis(), std::memory_order_relaxed);
+        slot.arg.store(arg, std::memory_order_relaxed);
+        slot.packed.store(static_cast<uint32_t>(code) |
+                          static_cast<uint32_t>(message) << 8 |
+                          static_cast<uint32_t>(clientId) << 16, std::memory_order_relaxed);
+        slot.sequence.store(claim + 1, std::memory_order_release);
+    }
+
+    void ErrorHandler::clearErrors() {
+        cleared.store(head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        lost.store(0, std::memory_order_relaxed);
+        for (auto& count : counts) {
+            count.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    size_t ErrorHandler::copyErrors(ErrorInfo* out, size_t max) {
+        uint32_t end = head.load(std::memory_order_acquire);
+        uint32_t begin = cleared.load(std::memory_order_relaxed);
+        if (end - begin > LOG_SIZE) {
+            begin = end - LOG_SIZE;
+        }
+        if (end - begin > max) {
+            begin = end - max;
+        }
+
+        size_t copied = 0;
+        for (uint32_t ticket = begin; ticket != end; ++ticket) {
+            const Slot& slot = slots[ticket & (LOG_SIZE - 1)];
+            uint32_t done = ticket * 2 + 2;
+            if (slot.sequence.load(std::memory_order_acquire) != done) {
+                continue;   // Still being written, or already overwritten
+            }
+            ErrorInfo& info = out[copied];
+            info.timestamp = slot.timestamp.load(std::memory_order_relaxed);
+            info.arg = slot.arg.load(std::memory_order_relaxed);
+            uint32_t packed = slot.packed.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) != done) {
+                continue;
+            }
+            info.code = static_cast<Code>(packed & 0xFF);
+            info.message = static_cast<Message>((packed >> 8) & 0xFF);
+            info.clientId = (packed >> 16) & 0xFF;
+            copied++;
+        }
+        return copied;
+    }
+
+    uint32_t ErrorHandler::getCount(Code code) {
+        size_t index = static_cast<size_t>(code);
+        return index < static_cast<size_t>(Code::COUNT) ? counts[index].load(std::memory_order_relaxed) : 0;
+    }
+
+    // Formatting happens only here, when someone actually looks
+    String ErrorHandler::getErrorJson() {
+        ErrorInfo entries[LOG_SIZE];
+        size_t count = copyErrors(entries, LOG_SIZE);
+
+        String json;
+        json.reserve(96 + count * 128);
+        char line[160];
+        snprintf(line, sizeof(line), "{\"total\":%lu,\"lost\":%lu,\"counts\":{",
+                 static_cast<unsigned long>(getTotal()), static_cast<unsigned long>(getLost()));
+        json += line;
+        bool first = true;
+        for (size_t i = 1; i < static_cast<size_t>(Code::COUNT); ++i) {
+            uint32_t value = counts[i].load(std::memory_order_relaxed);
+            if (value == 0) {
+                continue;
+            }
+            snprintf(line, sizeof(line), "%s\"%s\":%lu", first ? "" : ",",
+                     CODE_NAMES[i], static_cast<unsigned long>(value));
+            json += line;
+            first = false;
+        }
+        json += "},\"errors\":[";
+        for (size_t i = 0; i < count; ++i) {
+            const ErrorInfo& info = entries[i];
+            snprintf(line, sizeof(line),
+                     "%s{\"code\":\"%s\",\"message\":\"%s\",\"clientId\":%u,\"timestamp\":%lu,\"arg\":%lu}",
+                     i ? "," : "", codeName(info.code), messageText(info.message), info.clientId,
+                     static_cast<unsigned long>(info.timestamp), static_cast<unsigned long>(info.arg));
+            json += line;
+        }
+        json += "]}";
+        return json;
+    }
+}
@@ -0,0 +1,204 @@
+#include "FrameStream.h"
+
+namespace FrameStream {
+
+namespace {
+    struct Run {
+        uint8_t skip;
+        uint8_t start;
+        uint8_t count;
+    };
+
+    // Changed pixels as runs; a keyframe is one run over everything
+    size_t findRuns(const Frame& frame, const Frame& reference, bool all, std::array<Run, PIXELS>& runs) {
+        size_t runCount = 0;
+        size_t last = 0;    // End of the previous run
+        size_t i = 0;
+        while (i < PIXELS) {
+            if (!all && frame[i] == reference[i]) {
+                i++;
+                continue;
+            }
+            size_t start = i;
+            while (i < PIXELS && (all || frame[i] != reference[i])) {
+                i++;
+            }
+            runs[runCount++] = Run{static_cast<uint8_t>(start - last), static_cast<uint8_t>(start),
+                                   static_cast<uint8_t>(i - start)};
+            last = i;
+        }
+        return runCount;
+    }
+
+    size_t encodeRgb(const Frame& frame, const std::array<Run, PIXELS>& runs, size_t runCount, uint8_t* out) {
+        size_t pos = 0;
+        for (size_t r = 0; r < runCount; ++r) {
+            out[pos++] = runs[r].skip;
+            out[pos++] = runs[r].count;
+            for (size_t i = runs[r].start; i < runs[r].start + runs[r].count; ++i) {
+                out[pos++] = frame[i].r;
+                out[pos++] = frame[i].g;
+                out[pos++] = frame[i].b;
+            }
+        }
+        return pos;
+    }
+
+    // Returns 0 if the changed pixels use more than MAX_PALETTE colors
+    size_t encodePalette(const Frame& frame, const std::array<Run, PIXELS>& runs, size_t runCount, uint8_t* out) {
+        std::array<Rgb, MAX_PALETTE> palette;
+        std::array<uint8_t, PIXELS> indices;
+        size_t colors = 0;
+        for (size_t r = 0; r < runCount; ++r) {
+            for (size_t i = runs[r].start; i < runs[r].start + runs[r].count; ++i) {
+                size_t c = 0;
+                while (c < colors && palette[c] != frame[i]) {
+                    c++;
+                }
+                if (c == colors) {
+                    if (colors == MAX_PALETTE) {
+                        return 0;
+                    }
+                    palette[colors++] = frame[i];
+                }
+                indices[i] = c;
+            }
+        }
+
+        size_t pos = 0;
+        out[pos++] = colors;
+        for (size_t c = 0; c < colors; ++c) {
+            out[pos++] = palette[c].r;
+            out[pos++] = palette[c].g;
+            out[pos++] = palette[c].b;
+        }
+        for (size_t r = 0; r < runCount; ++r) {
+            out[pos++] = runs[r].skip;
+            out[pos++] = runs[r].count;
+            for (size_t k = 0; k < runs[r].count; k += 2) {
+                size_t i = runs[r].start + k;
+                uint8_t high = indices[i] << 4;
+                uint8_t low = (k + 1 < runs[r].count) ? indices[i + 1] : 0;
+                out[pos++] = high | low;
+            }
+        }
+        return pos;
+    }
+}
+
+void Encoder::reset() {
+    reference.fill(Rgb{0, 0, 0});
+    frameNumber = 0;
+    hasReference = false;
+}
+
+size_t Encoder::encode(const Frame& frame, bool keyframe, uint8_t* out) {
+    keyframe = keyframe || !hasReference;
+
+    std::array<Run, PIXELS> runs;
+    size_t runCount = findRuns(frame, reference, keyframe, runs);
+    if (runCount == 0) {
+        return 0;
+    }
+
+    // Try both encodings into the output and keep the smaller one
+    uint8_t palette[MAX_PAYLOAD];
+    size_t paletteSize = encodePalette(frame, runs, runCount, palette);
+    size_t rgbSize = encodeRgb(frame, runs, runCount, out + HEADER_SIZE);
+    Encoding encoding = ENCODING_RGB;
+    size_t bodySize = rgbSize;
+    if (paletteSize > 0 && paletteSize < rgbSize) {
+        memcpy(out + HEADER_SIZE, palette, paletteSize);
+        encoding = ENCODING_PALETTE;
+        bodySize = paletteSize;
+    }
+
+    out[0] = (keyframe ? FLAG_KEYFRAME : 0) | (encoding << 1);
+    out[1] = frameNumber + 1;
+    out[2] = frameNumber;
+    frameNumber++;
+    reference = frame;
+    hasReference = true;
+    return HEADER_SIZE + bodySize;
+}
+
+bool decode(const uint8_t* payload, size_t len, Frame& current, uint8_t& currentNumber, bool& synced) {
+    if (len < HEADER_SIZE) {
+        return false;
+    }
+    bool keyframe = payload[0] & FLAG_KEYFRAME;
+    Encoding encoding = static_cast<Encoding>((payload[0] >> 1) & 0x03);
+    if (!keyframe && (!synced || payload[2] != currentNumber)) {
+        return false;   // Wait for the next keyframe
+    }
+
+    Frame next = current;
+    size_t pos = HEADER_SIZE;
+    std::array<Rgb, MAX_PALETTE> palette;
+    size_t colors = 0;
+    if (encoding == ENCODING_PALETTE) {
+        if (pos >= len) return false;
+        colors = payload[pos++];
+        if (colors > MAX_PALETTE || pos + colors * 3 > len) return false;
+        for (size_t c = 0; c < colors; ++c, pos += 3) {
+            palette[c] = Rgb{payload[pos], payload[pos + 1], payload[pos + 2]};
+        }
+    }
+
+    size_t pixel = 0;
+    while (pos + 2 <= len) {
+        pixel += payload[pos++];
+        size_t count = payload[pos++];
+        if (pixel + count > PIXELS) return false;
+
+        if (encoding == ENCODING_PALETTE) {
+            if (pos + (count + 1) / 2 > len) return false;
+            for (size_t k = 0; k < count; ++k) {
+                uint8_t index = (k & 1) ? payload[pos + k / 2] & 0x0F : payload[pos + k / 2] >> 4;
+                if (index >= colors) return false;
+                next[pixel + k] = palette[index];
+            }
+            pos += (count + 1) / 2;
+        } else {
+            if (pos + count * 3 > len) return false;
+            for (size_t k = 0; k < count; ++k, pos += 3) {
+                next[pixel + k] = Rgb{payload[pos], payload[pos + 1], payload[pos + 2]};
+            }
+        }
+        pixel += count;
+    }
+    if (pos != len) {
+        return false;
+    }
+
+    current = next;
+    currentNumber = payload[1];
+    synced = true;
+    return true;
+}
+
+void Stats::reset() {
+    frames.store(0, std::memory_order_relaxed);
+    targetFrames.store(0, std::memory_order_relaxed);
+    payloads.store(0, std::memory_order_relaxed);
+    keyframes.store(0, std::memory_order_relaxed);
+    paletteFrames.store(0, std::memory_order_relaxed);
+    bytes.store(0, std::memory_order_relaxed);
+    startedAt.store(millis(), std::memory_order_relaxed);
+    encodeTime.reset();
+}
+
+void Stats::recordFrame(uint32_t encodeMicros, size_t targets) {
+    frames.fetch_add(1, std::memory_order_relaxed);
+    targetFrames.fetch_add(targets, std::memory_order_relaxed);
+    encodeTime.record(encodeMicros);
+}
+
+void Stats::recordPayload(size_t size, bool keyframe, Encoding encoding) {
+    payloads.fetch_add(1, std::memory_order_relaxed);
+    bytes.fetch_add(size, std::memory_order_relaxed);
+    if (keyframe) keyframes.fetch_add(1, std::memory_order_relaxed);
+    if (encoding == ENCODING_PALETTE) paletteFrames.fetch_add(1, std::memory_order_relaxed);
+}
+
+}
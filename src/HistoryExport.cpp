@@ -0,0 +1,86 @@
+#include "HistoryExport.h"
+#include <algorithm>
+
+namespace {
+    constexpr char CSV_HEADER[] =
+        "sequence,endedAt,uptimeClock,clientId,mode,difficulty,seed,"
+        "durationMs,score,hits,misses,avgReactionMs,bestReactionMs\n";
+}
+
+HistoryExport::HistoryExport(SessionStore& store, const SessionStore::Query& query, Format format)
+    : store(store)
+    , query(query)
+    , format(format)
+    , cursor(0)
+    , batchSize(0)
+    , batchIndex(0)
+    , lineLength(0)
+    , lineOffset(0)
+    , headerDone(false)
+    , records(0) {
+}
+
+size_t HistoryExport::fill(uint8_t* buffer, size_t maxLen) {
+    size_t written = 0;
+    while (written < maxLen) {
+        if (lineOffset == lineLength && !nextLine()) {
+            break;
+        }
+        size_t chunk = std::min(lineLength - lineOffset, maxLen - written);
+        memcpy(buffer + written, line + lineOffset, chunk);
+        written += chunk;
+        lineOffset += chunk;
+    }
+    return written;
+}
+
+bool HistoryExport::nextLine() {
+    lineOffset = 0;
+    lineLength = 0;
+    if (!headerDone) {
+        headerDone = true;
+        if (format == Format::CSV) {
+            lineLength = sizeof(CSV_HEADER) - 1;
+            memcpy(line, CSV_HEADER, lineLength);
+            return true;
+        }
+    }
+    if (batchIndex == batchSize) {
+        if (cursor == UINT32_MAX) {
+            return false;
+        }
+        // Nothing found only ends the export once the cursor says so; a
+        // timeout on the index lock returns nothing and leaves it in place
+        batchSize = store.query(query, cursor, batch.data(), batch.size());
+        batchIndex = 0;
+        if (batchSize == 0) {
+            return false;
+        }
+    }
+    lineLength = formatLine(batch[batchIndex++], format, line, sizeof(line));
+    records++;
+    return true;
+}
+
+size_t HistoryExport::formatLine(const SessionRecord& record, Format format, char* out, size_t size) {
+    const char* pattern = format == Format::CSV
+        ? "%lu,%lu,%d,%u,%u,%u,%lu,%lu,%lu,%u,%u,%u,%u\n"
+        : "{\"sequence\":%lu,\"endedAt\":%lu,\"uptimeClock\":%s,\"clientId\":%u,\"mode\":%u,"
+          "\"difficulty\":%u,\"seed\":%lu,\"durationMs\":%lu,\"score\":%lu,\"hits\":%u,"
+          "\"misses\":%u,\"avgReactionMs\":%u,\"bestReactionMs\":%u}\n";
+    bool uptime = record.flags & SessionRecord::FLAG_UPTIME;
+    int length = format == Format::CSV
+        ? snprintf(out, size, pattern,
+                   static_cast<unsigned long>(record.sequence), static_cast<unsigned long>(record.endedAt),
+                   uptime ? 1 : 0, record.clientId, record.mode, record.difficulty,
+                   static_cast<unsigned long>(record.seed), static_cast<unsigned long>(record.durationMs),
+                   static_cast<unsigned long>(record.score), record.hits, record.misses,
+                   record.avgReactionMs, record.bestReactionMs)
+        : snprintf(out, size, pattern,
+                   static_cast<unsigned long>(record.sequence), static_cast<unsigned long>(record.endedAt),
+                   uptime ? "true" : "false", record.clientId, record.mode, record.difficulty,
+                   static_cast<unsigned long>(record.seed), static_cast<unsigned long>(record.durationMs),
+                   static_cast<unsigned long>(record.score), record.hits, record.misses,
+                   record.avgReactionMs, record.bestReactionMs);
+    return length < 0 ? 0 : std::min(static_cast<size_t>(length), size - 1);
+}
@@ -0,0 +1,147 @@
+#include "JsonItems.h"
+
+JsonItems::JsonItems(const char* text, size_t length, const char* key)
+    : text(text)
+    , length(length)
+    , pos(0)
+    , state(State::MISSING) {
+    findArray(key);
+}
+
+bool JsonItems::next(const char*& item, size_t& itemLength) {
+    if (state != State::ITEMS) {
+        return false;
+    }
+    size_t end = skipValue(pos);
+    if (end == NPOS) {
+        state = State::MALFORMED;
+        return false;
+    }
+    item = text + pos;
+    itemLength = end - pos;
+
+    // Separator now, so a broken one fails before the element is used
+    pos = skipSpace(end);
+    if (pos < length && text[pos] == ',') {
+        pos = skipSpace(pos + 1);
+    } else if (pos < length && text[pos] == ']') {
+        state = State::END;
+    } else {
+        state = State::MALFORMED;
+        return false;
+    }
+    return true;
+}
+
+void JsonItems::findArray(const char* key) {
+    pos = skipSpace(0);
+    if (pos < length && text[pos] == '[') {
+        enterArray();
+        return;
+    }
+    if (pos >= length || text[pos] != '{') {
+        state = pos >= length ? State::MISSING : State::MALFORMED;
+        return;
+    }
+
+    // Members up to the one named key
+    pos = skipSpace(pos + 1);
+    size_t keyLength = strlen(key);
+    while (pos < length && text[pos] == '"') {
+        size_t nameEnd = skipString(pos);
+        if (nameEnd == NPOS) {
+            break;
+        }
+        bool match = nameEnd - pos - 2 == keyLength && memcmp(text + pos + 1, key, keyLength) == 0;
+        pos = skipSpace(nameEnd);
+        if (pos >= length || text[pos] != ':') {
+            break;
+        }
+        pos = skipSpace(pos + 1);
+        if (match) {
+            if (pos < length && text[pos] == '[') {
+                enterArray();
+            } else {
+                state = State::MISSING;
+            }
+            return;
+        }
+        pos = skipValue(pos);
+        if (pos == NPOS) {
+            break;
+        }
+        pos = skipSpace(pos);
+        if (pos < length && text[pos] == '}') {
+            state = State::MISSING;
+            return;
+        }
+        if (pos >= length || text[pos] != ',') {
+            break;
+        }
+        pos = skipSpace(pos + 1);
+    }
+    state = pos < length && text[pos] == '}' ? State::MISSING : State::MALFORMED;
+}
+
+// pos is on the opening bracket
+void JsonItems::enterArray() {
+    pos = skipSpace(pos + 1);
+    state = pos < length && text[pos] == ']' ? State::END : State::ITEMS;
+}
+
+size_t JsonItems::skipSpace(size_t at) const {
+    while (at < length && (text[at] == ' ' || text[at] == '\t' || text[at] == '\n' || text[at] == '\r')) {
+        at++;
+    }
+    return at;
+}
+
+// Position after the closing quote
+size_t JsonItems::skipString(size_t at) const {
+    for (size_t i = at + 1; i < length; ++i) {
+        if (text[i] == '\\') {
+            i++;
+        } else if (text[i] == '"') {
+            return i + 1;
+        }
+    }
+    return NPOS;
+}
+
+// Position after the value; brackets only need to balance, the parser
+// checks that they pair up
+size_t JsonItems::skipValue(size_t at) const {
+    if (at >= length) {
+        return NPOS;
+    }
+    if (text[at] == '"') {
+        return skipString(at);
+    }
+    if (text[at] == '[' || text[at] == '{') {
+        uint16_t depth = 0;
+        for (size_t i = at; i < length; ) {
+            char c = text[i];
+            if (c == '"') {
+                i = skipString(i);
+                if (i == NPOS) {
+                    return NPOS;
+                }
+                continue;
+            }
+            if (c == '[' || c == '{') {
+                depth++;
+            } else if (c == ']' || c == '}') {
+                if (--depth == 0) {
+                    return i + 1;
+                }
+            }
+            i++;
+        }
+        return NPOS;
+    }
+    size_t end = at;
+    while (end < length && !strchr(",]} \t\n\r", text[end])) {
+        end++;
+    }
+    return end == at ? NPOS : end;
+}
@@ -1,46 +1,116 @@
 #include "LEDMatrixHost.h"
 #include <Update.h>
 #include <esp_task_wdt.h>
+#include <algorithm>
+#include "JsonItems.h"
+#ifdef EMBED_ASSETS
+#include "EmbeddedAssets.h"
+#endif
+
+namespace {
+    // One validated /api/batch item, ready to be coalesced
+    struct BatchRecord {
+        uint8_t epoch;          // Records only move within their epoch
+        uint8_t destination;    // Client id, or TARGET_ALL for a group record
+        uint32_t mask;
+        Config::MessageType type;
+        uint8_t length;
+        uint8_t payload[Protocol::TRAINING_CONFIG_SIZE];
+    };
+    // An item as parsed, before it is applied
+    struct BatchItem {
+        BatchRecord record;
+        const char* problem;    // Set if the item fails
+    };
+    static_assert(Protocol::TRAINING_CONFIG_SIZE >= 4, "Batch payloads hold every command");
+    static_assert(Protocol::HEADER_SIZE + Protocol::RECORD_HEADER_SIZE + Protocol::MASK_SIZE +
+                  Protocol::TRAINING_CONFIG_SIZE < Protocol::MAX_FRAME_SIZE, "Any record fits an empty frame");
+    static_assert(Config::Network::MAX_BATCH_COMMANDS < 256, "Epochs are 8 bit");
+
+    bool batchCommandType(const char* name, Config::MessageType& type) {
+        static const struct {
+            const char* name;
+            Config::MessageType type;
+        } COMMANDS[] = {
+            {"led", Config::MessageType::LED_COMMAND},
+            {"buzzer", Config::MessageType::BUZZER_COMMAND},
+            {"effect", Config::MessageType::EFFECT_COMMAND},
+            {"training", Config::MessageType::TRAINING_START},
+            {"stop", Config::MessageType::TRAINING_STOP}
+        };
+        for (const auto& command : COMMANDS) {
+            if (strcmp(name, command.name) == 0) {
+                type = command.type;
+                return true;
+            }
+        }
+        return false;
+    }
+}
 
 // Konstruktor & Destruktor
 LEDMatrixHost::LEDMatrixHost()
     : webServer(Config::Network::WEB_SERVER_PORT)
     , webSocket("/ws")
+    , txSequence(0)
+    , reliableClients(0)
     , wsClientCount(0)
-    , isInitialized(false) {
-    clientsMutex = xSemaphoreCreateMutex();
-    messageMutex = xSemaphoreCreateMutex();
+    , isInitialized(false)
+    , statusSequence(0)
+    , statusBytesSent(0)
+    , statusMessagesSent(0)
+    , storageMountMs(0)
+    , heartbeatTaskHandle(nullptr)
+    , processorTaskHandle(nullptr)
+    , statusTaskHandle(nullptr)
+    , timerTaskHandle(nullptr)
+    , storageTaskHandle(nullptr)
+    , history(LittleFS)
+    , staticAssets(nullptr)
+    , streamTaskHandle(nullptr)
+    , streamEnabled(false)
+    , streamFps(Config::Stream::DEFAULT_FPS)
+    , keyframeInterval(Config::Stream::KEYFRAME_INTERVAL)
+    , lastMetricsPush(0) {
+    for (auto& dashboard : dashboards) {
+        dashboard.store(0, std::memory_order_relaxed);
+    }
+    for (auto& state : effectStates) {
+        state.reset(Config::Effects::Type::SOLID);
+    }
 }
 
 LEDMatrixHost::~LEDMatrixHost() {
-    if (clientsMutex) vSemaphoreDelete(clientsMutex);
-    if (messageMutex) vSemaphoreDelete(messageMutex);
 }
 
 // Initialisierung
 bool LEDMatrixHost::begin() {
     Serial.println("Initializing LED Matrix Host...");
 
+#ifndef EMBED_ASSETS
+    // The web UI lives on the filesystem; embedded builds serve it from flash
     if (!initializeStorage()) {
-        Error::ErrorHandler::logError(Error::Code::HARDWARE_ERROR, "Storage initialization failed");
+        Error::ErrorHandler::logError(Error::Code::HARDWARE_ERROR, Error::Message::STORAGE_INIT_FAILED);
         return false;
     }
+#endif
 
     if (!initializeWiFi()) {
-        Error::ErrorHandler::logError(Error::Code::WIFI_CONNECTION_FAILED, "WiFi initialization failed");
+        Error::ErrorHandler::logError(Error::Code::WIFI_CONNECTION_FAILED, Error::Message::WIFI_INIT_FAILED);
         return false;
     }
 
     if (!initializeUDP()) {
-        Error::ErrorHandler::logError(Error::Code::UDP_INIT_FAILED, "UDP initialization failed");
+        Error::ErrorHandler::logError(Error::Code::UDP_INIT_FAILED, Error::Message::UDP_INIT_FAILED);
         return false;
     }
 
+    setupMetrics();
     setupWebSocket();
     setupWebServer();
     
     if (!createTasks()) {
-        Error::ErrorHandler::logError(Error::Code::TASK_CREATE_FAILED, "Task creation failed");
+        Error::ErrorHandler::logError(Error::Code::TASK_CREATE_FAILED, Error::Message::TASK_CREATE_FAILED);
         return false;
     }
 
@@ -55,14 +125,17 @@ bool LEDMatrixHost::begin() {
 
 // Speicher-Initialisierung
 bool LEDMatrixHost::initializeStorage() {
-    if (!SPIFFS.begin(true)) {
-        Serial.println("SPIFFS Mount Failed");
+    // Must match board_build.filesystem in platformio.ini
+    uint32_t start = millis();
+    if (!LittleFS.begin(true)) {
+        Serial.println("LittleFS Mount Failed");
         return false;
     }
+    storageMountMs = millis() - start;
     
     // Check available space
-    size_t totalBytes = SPIFFS.totalBytes();
-    size_t usedBytes = SPIFFS.usedBytes();
+    size_t totalBytes = LittleFS.totalBytes();
+    size_t usedBytes = LittleFS.usedBytes();
     Serial.printf("Storage: %u bytes total, %u bytes used\n", totalBytes, usedBytes);
     
     return true;
@@ -134,7 +207,7 @@ void LEDMatrixHost::setupWebSocket() {
 }
 
 // WebSocket Event Handler
-void LEDMatrixHost::handleWebSocketEvent(AsyncWebSocket* server,
+void LEDMatrixHost::handleWebSocketEvent(AsyncWebSocket* /*server*/,
                                        AsyncWebSocketClient* client,
                                        AwsEventType type,
                                        void* arg,
@@ -150,86 +223,96 @@ void LEDMatrixHost::handleWebSocketEvent(AsyncWebSocket* server,
             break;
             
         case WS_EVT_DATA:
-            handleWebSocketData(arg, data, len);
+            handleWebSocketData(client, arg, data, len);
             break;
             
         case WS_EVT_ERROR:
-            handleWebSocketError(client, arg);
+            handleWebSocketError(client);
+            break;
+
+        case WS_EVT_PONG:
             break;
     }
 }
 
 void LEDMatrixHost::handleWebSocketConnect(AsyncWebSocketClient* client) {
-    if (wsClientCount >= Config::Network::MAX_WEBSOCKET_CLIENTS) {
+    if (!registerDashboard(client->id())) {
+        Error::ErrorHandler::logError(Error::Code::WEBSOCKET_ERROR, Error::Message::WS_CLIENT_LIMIT, 0, client->id());
         client->close();
-        Error::ErrorHandler::logError(Error::Code::WEBSOCKET_ERROR, "Max WebSocket clients reached");
         return;
     }
     
     wsClientCount++;
     Serial.printf("WebSocket client connected. ID: %u\n", client->id());
     
-    // Send initial state
-    DynamicJsonDocument doc(1024);
-    doc["type"] = "initial_state";
-    doc["clients"] = getClientListJson();
-    
-    String response;
-    serializeJson(doc, response);
-    client->text(response);
+    // Send full snapshot; later changes arrive as deltas
+    DynamicJsonDocument doc(clientListSize(Config::Network::MAX_CLIENTS));
+    buildClientList(doc);
+    sendTo(client, doc);
 }
 
 void LEDMatrixHost::handleWebSocketDisconnect(AsyncWebSocketClient* client) {
+    // Connections refused at the limit were never counted
+    if (!unregisterDashboard(client->id())) {
+        return;
+    }
     wsClientCount--;
     Serial.printf("WebSocket client disconnected. ID: %u\n", client->id());
 }
 
-void LEDMatrixHost::handleWebSocketData(void* arg, uint8_t* data, size_t len) {
+// Accepts JSON text frames and MessagePack binary frames
+void LEDMatrixHost::handleWebSocketData(AsyncWebSocketClient* client, void* arg, uint8_t* data, size_t len) {
     AwsFrameInfo* info = (AwsFrameInfo*)arg;
-    if (info->final && info->index == 0 && info->len == len && info->opcode == WS_TEXT) {
-        data[len] = 0;
-        DynamicJsonDocument doc(1024);
-        DeserializationError error = deserializeJson(doc, (char*)data);
-        
-        if (error) {
-            Error::ErrorHandler::logError(Error::Code::INVALID_MESSAGE, "Invalid WebSocket JSON");
-            return;
-        }
-        
-        processWebSocketMessage(doc);
+    if (!info->final || info->index != 0 || info->len != len) {
+        return;
+    }
+
+    DynamicJsonDocument doc(1024);
+    DeserializationError error;
+    if (info->opcode == WS_TEXT) {
+        error = deserializeJson(doc, (const char*)data, len);
+    } else if (info->opcode == WS_BINARY) {
+        error = deserializeMsgPack(doc, (const char*)data, len);
+    } else {
+        return;
+    }
+
+    if (error) {
+        Error::ErrorHandler::logError(Error::Code::INVALID_MESSAGE, Error::Message::WS_INVALID_MESSAGE, 0, client->id());
+        return;
     }
+
+    processWebSocketMessage(client, doc);
 }
 
-void LEDMatrixHost::handleWebSocketError(AsyncWebSocketClient* client, void* arg) {
-    Error::ErrorHandler::logError(Error::Code::WEBSOCKET_ERROR, 
-            String("WebSocket error for client " + String(client->id())).c_str());
+void LEDMatrixHost::handleWebSocketError(AsyncWebSocketClient* client) {
+    Error::ErrorHandler::logError(Error::Code::WEBSOCKET_ERROR, Error::Message::WS_CLIENT_ERROR, 0, client->id());
 }
 
-void LEDMatrixHost::processWebSocketMessage(const JsonDocument& doc) {
+void LEDMatrixHost::processWebSocketMessage(AsyncWebSocketClient* client, const JsonDocument& doc) {
     String command = doc["command"].as<String>();
     
-    if (command == "getClients") {
-        String response = getClientListJson();
-        webSocket.textAll(response);
+    if (command == "setEncoding") {
+        // In-band negotiation: the web server cannot echo a subprotocol
+        bool binary = doc["encoding"] == "msgpack";
+        setDashboardEncoding(client->id(), binary);
+
+        DynamicJsonDocument reply(64);
+        reply["type"] = "encoding";
+        reply["encoding"] = binary ? "msgpack" : "json";
+        sendTo(client, reply);
+    }
+    else if (command == "getClients") {
+        DynamicJsonDocument response(clientListSize(Config::Network::MAX_CLIENTS));
+        buildClientList(response);
+        sendTo(client, response);
     }
     else if (command == "startTraining") {
-        uint8_t clientId = doc["clientId"] | 0;
-        TrainingModes::TrainingConfig config;
-        // Parse training config from JSON
-        config.mode = static_cast<TrainingModes::Mode>(doc["mode"] | 0);
-        config.difficulty = static_cast<TrainingModes::Difficulty>(doc["difficulty"] | 0);
-        config.duration = doc["duration"] | 300;
-        config.targetCount = doc["targetCount"] | 10;
-        config.reactTime = doc["reactTime"] | 1000;
-        config.soundEnabled = doc["sound"] | true;
-        config.stressorsEnabled = doc["stressors"] | false;
-        config.brightness = doc["brightness"] | 128;
-        
-        startTraining(clientId, config);
+        startTraining(resolveTargets(doc), parseTrainingConfig(doc),
+                      doc["reliable"] | Config::Network::RELIABLE_TRAINING_COMMANDS);
     }
     else if (command == "stopTraining") {
-        uint8_t clientId = doc["clientId"] | 0;
-        stopTraining(clientId);
+        stopTraining(resolveTargets(doc));
     }
 }
 // Web Server Setup
@@ -242,16 +325,31 @@ void LEDMatrixHost::setupWebServer() {
 }
 
 void LEDMatrixHost::setupStaticRoutes() {
-    // Serve static files from SPIFFS
-    webServer.serveStatic("/", SPIFFS, "/").setDefaultFile("index.html");
+    // Gzipped, cache-validated assets listed by scripts/build_assets.py
+    staticAssets = new StaticAssets::Handler(LittleFS);
+#ifdef EMBED_ASSETS
+    bool indexed = staticAssets->load(StaticAssets::EMBEDDED, StaticAssets::EMBEDDED_COUNT);
+#else
+    bool indexed = staticAssets->load();
+#endif
+    if (indexed) {
+        Serial.printf("Serving %u indexed assets\n", staticAssets->count());
+        webServer.addHandler(staticAssets);
+        return;
+    }
+    delete staticAssets;
+    staticAssets = nullptr;
+
+    // Image without an index: serve static files as they are
+    webServer.serveStatic("/", LittleFS, "/").setDefaultFile("index.html");
     
     // Language files
     webServer.on("/lang/{lang}.json", HTTP_GET, [](AsyncWebServerRequest *request) {
         String lang = request->pathArg(0);
         String path = "/lang/" + lang + ".json";
         
-        if (SPIFFS.exists(path)) {
-            request->send(SPIFFS, path, "application/json");
+        if (LittleFS.exists(path)) {
+            request->send(LittleFS, path, "application/json");
         } else {
             request->send(404);
         }
@@ -264,6 +362,11 @@ void LEDMatrixHost::setupAPIRoutes() {
         handleTrainingRequest(request);
     });
 
+    // Any mix of LED, buzzer, effect and training commands in one request
+    webServer.on("/api/batch", HTTP_POST, [this](AsyncWebServerRequest *request) {
+        handleBatchRequest(request);
+    });
+
     webServer.on("/api/training/status", HTTP_GET, [this](AsyncWebServerRequest *request) {
         handleStatusRequest(request);
     });
@@ -282,445 +385,1905 @@ void LEDMatrixHost::setupAPIRoutes() {
     webServer.on("/api/effect", HTTP_POST, [this](AsyncWebServerRequest *request) {
         handleAPIRequest(request, Config::MessageType::EFFECT_COMMAND);
     });
+
+    // Frame streaming: GET reports bandwidth and CPU, POST configures
+    webServer.on("/api/stream", HTTP_GET | HTTP_POST, [this](AsyncWebServerRequest *request) {
+        handleStreamRequest(request);
+    });
+
+    // Whole history as a download: ?format=ndjson|csv&clientId=&mode=&from=&to=
+    // (before /api/history, which would also match this path)
+    webServer.on("/api/history/export", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        handleHistoryExport(request);
+    });
+
+    // Session history: ?clientId=&mode=&from=&to=&after=&limit=
+    webServer.on("/api/history", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        handleHistoryRequest(request);
+    });
+
+    // Error log and per-code counters; DELETE clears them
+    webServer.on("/api/errors", HTTP_GET | HTTP_DELETE, [this](AsyncWebServerRequest *request) {
+        handleErrorsRequest(request);
+    });
+
+    // Timeline of the hot paths as Chrome trace JSON (trace builds only)
+    webServer.on("/api/trace", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        handleTraceRequest(request);
+    });
+
+    // Prometheus scrape target
+    webServer.on("/api/metrics", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        handleMetricsRequest(request);
+    });
+
+    // System status endpoint
+    webServer.on("/api/system", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        handleSystemRequest(request);
+    });
 }
 
-void LEDMatrixHost::handleTrainingRequest(AsyncWebServerRequest* request) {
+void LEDMatrixHost::handleSystemRequest(AsyncWebServerRequest* request) {
     if (!request->authenticate(Config::Security::API_USERNAME, Config::Security::API_PASSWORD)) {
         return request->requestAuthentication();
     }
 
-    if (request->hasParam("plain", true)) {
-        String body = request->getParam("plain", true)->value();
-        DynamicJsonDocument doc(1024);
-        DeserializationError error = deserializeJson(doc, body);
+    DynamicJsonDocument doc(1536);
+    doc["uptime"] = millis();
+    doc["freeHeap"] = ESP.getFreeHeap();
 
-        if (error) {
-            request->send(400, "application/json", "{\"message\":\"Invalid JSON\"}");
-            return;
-        }
+    JsonObject queue = doc.createNestedObject("messageQueue");
+    queue["depth"] = messageQueue.size();
+    queue["capacity"] = messageQueue.capacity();
+    queue["highWater"] = messageQueue.highWaterMark();
+    queue["dropped"] = messageQueue.dropped();
 
-        uint8_t clientId = doc["clientId"];
-        TrainingModes::TrainingConfig config;
-        
-        config.mode = static_cast<TrainingModes::Mode>(doc["mode"].as<uint8_t>());
-        config.difficulty = static_cast<TrainingModes::Difficulty>(doc["difficulty"].as<uint8_t>());
-        config.duration = doc["duration"] | 300;  // default 5 minutes
-        config.targetCount = doc["targetCount"] | 10;
-        config.reactTime = doc["reactTime"] | 1000;
-        config.soundEnabled = doc["sound"] | true;
-        config.stressorsEnabled = doc["stressors"] | false;
-        config.brightness = doc["brightness"] | 128;
-
-        sendTrainingCommand(clientId, config);
-        
-        if (xSemaphoreTake(clientsMutex, pdMS_TO_TICKS(100))) {
-            auto it = clients.find(clientId);
-            if (it != clients.end()) {
-                it->second->training = config;
-                it->second->training.timestamp = millis();
-                it->second->score = 0;
-                it->second->hitCount = 0;
-                it->second->missCount = 0;
-            }
-            xSemaphoreGive(clientsMutex);
-        }
+    JsonObject status = doc.createNestedObject("statusBroadcast");
+    status["sequence"] = statusSequence;
+    status["messages"] = statusMessagesSent;
+    status["bytes"] = statusBytesSent;
 
-        request->send(200, "application/json", "{\"message\":\"Training started\"}");
-    } else {
-        request->send(400, "application/json", "{\"message\":\"No data received\"}");
-    }
-}
+    JsonObject buffers = doc.createNestedObject("wsBuffers");
+    buffers["allocations"] = wsBuffers.getAllocations();
+    buffers["reuses"] = wsBuffers.getReuses();
+    buffers["exhausted"] = wsBuffers.getExhausted();
 
-void LEDMatrixHost::handleAPIRequest(AsyncWebServerRequest* request, Config::MessageType commandType) {
-    if (!request->authenticate(Config::Security::API_USERNAME, Config::Security::API_PASSWORD)) {
-        return request->requestAuthentication();
+    if (staticAssets) {
+        JsonObject assets = doc.createNestedObject("assets");
+        assets["count"] = staticAssets->count();
+        assets["requests"] = staticAssets->getRequests();
+        assets["notModified"] = staticAssets->getNotModified();
+        assets["bytesSent"] = staticAssets->getBytesSent();
+        assets["bytesSaved"] = staticAssets->getBytesSaved();
     }
 
-    if (request->hasParam("plain", true)) {
-        String body = request->getParam("plain", true)->value();
-        DynamicJsonDocument doc(1024);
-        DeserializationError error = deserializeJson(doc, body);
+    JsonObject sessions = doc.createNestedObject("history");
+    sessions["ready"] = history.isReady();
+    sessions["sessions"] = history.getCount();
+    sessions["segments"] = history.getSegmentCount();
+    sessions["written"] = history.getWritten();
+    sessions["dropped"] = history.getDropped();
+    sessions["failed"] = history.getFailed();
+    sessions["corrupt"] = history.getCorrupt();
 
-        if (error) {
-            request->send(400, "application/json", "{\"message\":\"Invalid JSON\"}");
-            return;
-        }
+    // Boot-to-first-byte, for comparing filesystem and embedded builds
+    JsonObject boot = doc.createNestedObject("boot");
+#ifdef EMBED_ASSETS
+    boot["assets"] = "embedded";
+#else
+    boot["assets"] = "filesystem";
+#endif
+    boot["storageMountMs"] = storageMountMs;
+    boot["firstAssetMs"] = staticAssets ? staticAssets->getFirstResponseAt() : 0;
 
-        uint8_t clientId = doc["clientId"];
-        uint8_t packet[Config::Network::UDP_BUFFER_SIZE];
-        packet[0] = static_cast<uint8_t>(commandType);
-        packet[1] = clientId;
-        size_t packetSize = 2;
-
-        if (commandType == Config::MessageType::LED_COMMAND && doc.containsKey("color")) {
-            String color = doc["color"];
-            uint32_t rgb = strtoul(color.substring(1).c_str(), NULL, 16);
-            packet[2] = (rgb >> 16) & 0xFF; // Rot
-            packet[3] = (rgb >> 8) & 0xFF;  // Grün
-            packet[4] = rgb & 0xFF;         // Blau
-            packetSize += 3;
-        } else if (commandType == Config::MessageType::BUZZER_COMMAND) {
-            uint16_t frequency = doc["frequency"];
-            uint16_t duration = doc["duration"];
-            packet[2] = (frequency >> 8) & 0xFF;
-            packet[3] = frequency & 0xFF;
-            packet[4] = (duration >> 8) & 0xFF;
-            packet[5] = duration & 0xFF;
-            packetSize += 4;
-        } else if (commandType == Config::MessageType::EFFECT_COMMAND && doc.containsKey("effect")) {
-            String effect = doc["effect"];
-            if (effect == "rainbow") {
-                packet[2] = static_cast<uint8_t>(Config::Effects::Type::RAINBOW);
-            } else if (effect == "fade") {
-                packet[2] = static_cast<uint8_t>(Config::Effects::Type::FADE);
-            } else if (effect == "sparkle") {
-                packet[2] = static_cast<uint8_t>(Config::Effects::Type::SPARKLE);
-            }
-            packetSize += 1;
-        }
+    JsonObject delivery = doc.createNestedObject("reliable");
+    delivery["sent"] = reliable.getSent().get();
+    delivery["delivered"] = reliable.getDelivered().get();
+    delivery["retransmits"] = reliable.getRetransmits().get();
+    delivery["failed"] = reliable.getFailed().get();
+    delivery["superseded"] = reliable.getSuperseded().get();
+    delivery["inFlight"] = reliable.getInFlight();
 
-        sendPacketToClient(packet, packetSize, clientId);
-        request->send(200, "application/json", "{\"message\":\"Command sent\"}");
-    } else {
-        request->send(400, "application/json", "{\"message\":\"No data received\"}");
+    JsonObject latency = doc.createNestedObject("latency");
+    const std::pair<const char*, const LatencyStats*> paths[] = {
+        {"ingress", &ingressLatency},
+        {"dashboard", &dashboardLatency},
+        {"delivery", &reliable.getDeliveryLatency()}
+    };
+    for (const auto& path : paths) {
+        JsonObject stats = latency.createNestedObject(path.first);
+        stats["count"] = path.second->getCount();
+        stats["meanUs"] = path.second->getMean();
+        stats["p99Us"] = path.second->getPercentile(99);
+        stats["maxUs"] = path.second->getMax();
     }
+
+    String response;
+    serializeJson(doc, response);
+    request->send(200, "application/json", response);
 }
-// Task Creation
-bool LEDMatrixHost::createTasks() {
-    // Heartbeat task
-    BaseType_t result = xTaskCreatePinnedToCore(
-        heartbeatTask,
-        "Heartbeat",
-        Config::Tasks::STACK_SIZE,
-        this,
-        Config::Tasks::PRIORITY_MEDIUM,
-        nullptr,
-        1
-    );
-    
-    if (result != pdPASS) {
-        return false;
+
+SessionStore::Query LEDMatrixHost::parseHistoryQuery(AsyncWebServerRequest* request) {
+    SessionStore::Query query;
+    if (request->hasParam("clientId")) query.clientId = request->getParam("clientId")->value().toInt();
+    if (request->hasParam("mode")) query.mode = request->getParam("mode")->value().toInt();
+    if (request->hasParam("from")) query.from = strtoul(request->getParam("from")->value().c_str(), nullptr, 10);
+    if (request->hasParam("to")) query.to = strtoul(request->getParam("to")->value().c_str(), nullptr, 10);
+    return query;
+}
+
+// Stored sessions, oldest first, a page at a time: pass "next" back as
+// "after" to continue. from/to are endedAt seconds.
+void LEDMatrixHost::handleHistoryRequest(AsyncWebServerRequest* request) {
+    if (!request->authenticate(Config::Security::API_USERNAME, Config::Security::API_PASSWORD)) {
+        return request->requestAuthentication();
+    }
+    if (!history.isReady()) {
+        request->send(503, "application/json", "{\"message\":\"History not loaded yet\"}");
+        return;
     }
 
-    // Message processor task
-    result = xTaskCreatePinnedToCore(
-        messageProcessorTask,
-        "MsgProcessor",
-        Config::Tasks::STACK_SIZE,
-        this,
-        Config::Tasks::PRIORITY_HIGH,
-        nullptr,
-        1
-    );
-    
-    if (result != pdPASS) {
-        return false;
+    SessionStore::Query query = parseHistoryQuery(request);
+    uint32_t cursor = 0;
+    if (request->hasParam("after")) {
+        // Nothing comes after the last sequence number; +1 would wrap to
+        // the start of the history
+        unsigned long after = strtoul(request->getParam("after")->value().c_str(), nullptr, 10);
+        cursor = after >= UINT32_MAX ? UINT32_MAX : after + 1;
     }
+    size_t limit = request->hasParam("limit") ? request->getParam("limit")->value().toInt() : 50;
+    limit = constrain(limit, 1, 200);
 
-    // Status broadcast task
-    result = xTaskCreatePinnedToCore(
-        statusBroadcastTask,
-        "StatusBcast",
-        Config::Tasks::STACK_SIZE,
-        this,
-        Config::Tasks::PRIORITY_LOW,
-        nullptr,
-        1
-    );
-    
-    if (result != pdPASS) {
-        return false;
+    std::vector<SessionRecord> records(limit);
+    uint32_t start = cursor;
+    size_t count = history.query(query, cursor, records.data(), limit);
+    if (count == 0 && cursor == start && cursor != UINT32_MAX) {
+        // Index lock timed out: an empty page here would read as the end
+        request->send(503, "application/json", "{\"message\":\"History busy, try again\"}");
+        return;
     }
 
-    // Training monitor task
-    result = xTaskCreatePinnedToCore(
-        trainingMonitorTask,
-        "TrainingMon",
-        Config::Tasks::STACK_SIZE,
-        this,
-        Config::Tasks::PRIORITY_MEDIUM,
-        nullptr,
-        1
-    );
-    
-    return result == pdPASS;
+    DynamicJsonDocument doc(JSON_OBJECT_SIZE(3) + JSON_ARRAY_SIZE(count) + count * JSON_OBJECT_SIZE(14) + 64);
+    JsonArray sessions = doc.createNestedArray("sessions");
+    for (size_t i = 0; i < count; ++i) {
+        serializeSession(records[i], sessions.createNestedObject());
+    }
+    doc["stored"] = history.getCount();
+    if (cursor != UINT32_MAX && count > 0) {
+        doc["next"] = records[count - 1].sequence;
+    } else {
+        doc["next"] = nullptr;
+    }
+
+    String response;
+    serializeJson(doc, response);
+    request->send(200, "application/json", response);
 }
 
-// Task Implementation
-void LEDMatrixHost::heartbeatTask(void* parameter) {
-    LEDMatrixHost* host = static_cast<LEDMatrixHost*>(parameter);
-    TickType_t xLastWakeTime = xTaskGetTickCount();
-    
-    for (;;) {
-        host->removeInactiveClients();
-        vTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(Config::Tasks::HEARTBEAT_INTERVAL));
+// Every matching session as one chunked download. The exporter formats
+// records straight into the response buffer a batch at a time, so memory
+// stays flat however long the history is, and each chunk only costs the
+// TCP task one short flash read.
+void LEDMatrixHost::handleHistoryExport(AsyncWebServerRequest* request) {
+    if (!request->authenticate(Config::Security::API_USERNAME, Config::Security::API_PASSWORD)) {
+        return request->requestAuthentication();
+    }
+    if (!history.isReady()) {
+        request->send(503, "application/json", "{\"message\":\"History not loaded yet\"}");
+        return;
     }
-}
 
-void LEDMatrixHost::messageProcessorTask(void* parameter) {
-    LEDMatrixHost* host = static_cast<LEDMatrixHost*>(parameter);
-    
-    for (;;) {
-        if (xSemaphoreTake(host->messageMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-            while (!host->messageQueue.empty()) {
-                Message msg = host->messageQueue.front();
-                host->messageQueue.pop();
-                host->processMessage(msg);
+    bool csv = request->hasParam("format") && request->getParam("format")->value() == "csv";
+    auto exporter = std::make_shared<HistoryExport>(
+        history, parseHistoryQuery(request), csv ? HistoryExport::Format::CSV : HistoryExport::Format::NDJSON);
+
+    AsyncWebServerResponse* response = request->beginChunkedResponse(
+        csv ? "text/csv" : "application/x-ndjson",
+        [exporter](uint8_t* buffer, size_t maxLen, size_t /*index*/) -> size_t {
+            size_t written = exporter->fill(buffer, maxLen);
+            if (written == 0 && !exporter->isDone()) {
+                return RESPONSE_TRY_AGAIN;  // Index locked, not the end
             }
-            xSemaphoreGive(host->messageMutex);
-        }
-        vTaskDelay(pdMS_TO_TICKS(10));
-    }
+            return written;
+        });
+    response->addHeader("Content-Disposition",
+                        csv ? "attachment; filename=\"sessions.csv\"" : "attachment; filename=\"sessions.ndjson\"");
+    request->send(response);
 }
 
-void LEDMatrixHost::statusBroadcastTask(void* parameter) {
-    LEDMatrixHost* host = static_cast<LEDMatrixHost*>(parameter);
-    TickType_t xLastWakeTime = xTaskGetTickCount();
-    
-    for (;;) {
-        host->broadcastClientStatus();
-        vTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(1000));
+void LEDMatrixHost::handleMetricsRequest(AsyncWebServerRequest* request) {
+    if (!request->authenticate(Config::Security::API_USERNAME, Config::Security::API_PASSWORD)) {
+        return request->requestAuthentication();
     }
+
+    uint32_t start = micros();
+    sampleMetrics();
+    String body;
+    body.reserve(6144);
+    metrics.writePrometheus(body);
+    metricsRenderUs.set(micros() - start);   // Shows up in the next scrape
+
+    request->send(200, "text/plain; version=0.0.4", body);
 }
 
-void LEDMatrixHost::trainingMonitorTask(void* parameter) {
-    LEDMatrixHost* host = static_cast<LEDMatrixHost*>(parameter);
-    TickType_t xLastWakeTime = xTaskGetTickCount();
-    
-    for (;;) {
-        if (xSemaphoreTake(host->clientsMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-            for (auto& clientPair : host->clients) {
-                auto& client = clientPair.second;
-                if (client && client->isActive) {
-                    // Check if training time is up
-                    uint32_t trainingDuration = (millis() - client->training.timestamp) / 1000;
-                    if (trainingDuration >= client->training.duration) {
-                        host->stopTraining(client->id);
-                    }
-                }
-            }
-            xSemaphoreGive(host->clientsMutex);
-        }
-        vTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(1000));
+// Streams the trace rings; recording pauses until the download ends
+void LEDMatrixHost::handleTraceRequest(AsyncWebServerRequest* request) {
+    if (!request->authenticate(Config::Security::API_USERNAME, Config::Security::API_PASSWORD)) {
+        return request->requestAuthentication();
     }
+#ifdef TRACE_ENABLED
+    auto exporter = std::make_shared<Trace::Exporter>();
+    AsyncWebServerResponse* response = request->beginChunkedResponse("application/json",
+        [exporter](uint8_t* buffer, size_t maxLen, size_t /*index*/) -> size_t {
+            return exporter->fill(buffer, maxLen);
+        });
+    response->addHeader("Content-Disposition", "attachment; filename=\"trace.json\"");
+    request->send(response);
+#else
+    request->send(404, "application/json", "{\"message\":\"Tracing not built in (pio run -e esp32dev-trace)\"}");
+#endif
 }
 
-// Message Processing
-void LEDMatrixHost::processMessage(const Message& msg) {
-    switch (msg.type) {
-        case Config::MessageType::STATUS_REQUEST:
-            if (msg.data.size() >= 6) {
-                uint16_t hits = (msg.data[2] << 8) | msg.data[3];
-                uint16_t misses = (msg.data[4] << 8) | msg.data[5];
-                updateTrainingStatus(msg.clientId, TrainingModes::TrainingResult{
-                    hits,
-                    misses,
-                    millis(),
-                    0,  // avgReactionTime will be calculated
-                    0   // score will be calculated
-                });
-            }
-            break;
-            
-        case Config::MessageType::ERROR_REPORT:
-            if (msg.data.size() >= 3) {
-                Error::Code errorCode = static_cast<Error::Code>(msg.data[2]);
-                Error::ErrorHandler::logError(errorCode, 
-                    "Client error reported", msg.clientId);
-            }
-            break;
-            
-        default:
-            break;
+void LEDMatrixHost::handleErrorsRequest(AsyncWebServerRequest* request) {
+    if (!request->authenticate(Config::Security::API_USERNAME, Config::Security::API_PASSWORD)) {
+        return request->requestAuthentication();
     }
+    if (request->method() == HTTP_DELETE) {
+        Error::ErrorHandler::clearErrors();
+    }
+    request->send(200, "application/json", Error::ErrorHandler::getErrorJson());
 }
 
-// Client Management
-void LEDMatrixHost::removeInactiveClients() {
-    if (xSemaphoreTake(clientsMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-        for (auto it = clients.begin(); it != clients.end();) {
-            if (!it->second->isActive || 
-                (millis() - it->second->lastSeen) > Config::Tasks::CLIENT_TIMEOUT) {
-                it = clients.erase(it);
-            } else {
-                ++it;
-            }
-        }
-        xSemaphoreGive(clientsMutex);
+void LEDMatrixHost::handleStreamRequest(AsyncWebServerRequest* request) {
+    if (!request->authenticate(Config::Security::API_USERNAME, Config::Security::API_PASSWORD)) {
+        return request->requestAuthentication();
     }
-}
 
-void LEDMatrixHost::broadcastClientStatus() {
-    String status = getClientListJson();
-    webSocket.textAll(status);
-}
-// Training Control
-void LEDMatrixHost::startTraining(uint8_t clientId, const TrainingModes::TrainingConfig& config) {
-    if (xSemaphoreTake(clientsMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-        auto it = clients.find(clientId);
-        if (it != clients.end() && it->second->isActive) {
-            it->second->training = config;
-            it->second->training.timestamp = millis();
-            
-            // Send training start command to client
-            uint8_t packet[32];  // Adjust size as needed
-            packet[0] = static_cast<uint8_t>(Config::MessageType::EFFECT_COMMAND);
-            packet[1] = clientId;
-            packet[2] = static_cast<uint8_t>(config.mode);
-            packet[3] = static_cast<uint8_t>(config.difficulty);
-            packet[4] = (config.duration >> 8) & 0xFF;
-            packet[5] = config.duration & 0xFF;
-            packet[6] = (config.targetCount >> 8) & 0xFF;
-            packet[7] = config.targetCount & 0xFF;
-            packet[8] = (config.reactTime >> 8) & 0xFF;
-            packet[9] = config.reactTime & 0xFF;
-            packet[10] = config.soundEnabled ? 1 : 0;
-            packet[11] = config.stressorsEnabled ? 1 : 0;
-            packet[12] = config.brightness;
-            
-            sendPacketToClient(packet, 13, clientId);
-            
-            // Notify WebSocket clients
-            DynamicJsonDocument doc(512);
-            doc["type"] = "training_started";
-            doc["clientId"] = clientId;
-            doc["mode"] = static_cast<uint8_t>(config.mode);
-            doc["difficulty"] = static_cast<uint8_t>(config.difficulty);
-            
-            String notification;
-            serializeJson(doc, notification);
-            webSocket.textAll(notification);
+    if (request->method() == HTTP_POST) {
+        if (!request->hasParam("plain", true)) {
+            request->send(400, "application/json", "{\"message\":\"No data received\"}");
+            return;
+        }
+        DynamicJsonDocument body(256);
+        if (deserializeJson(body, request->getParam("plain", true)->value())) {
+            request->send(400, "application/json", "{\"message\":\"Invalid JSON\"}");
+            return;
+        }
+        streamFps = constrain(body["fps"] | streamFps.load(), 1, Config::Stream::MAX_FPS);
+        keyframeInterval = std::max<uint8_t>(body["keyframeInterval"] | keyframeInterval.load(), 1);
+        streamEnabled = body["enabled"] | streamEnabled.load();
+        streamStats.reset();  // The report always describes the current settings
+        if (streamTaskHandle) {
+            xTaskNotifyGive(streamTaskHandle);
         }
-        xSemaphoreGive(clientsMutex);
     }
-}
 
-void LEDMatrixHost::stopTraining(uint8_t clientId) {
-    if (xSemaphoreTake(clientsMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-        auto it = clients.find(clientId);
-        if (it != clients.end() && it->second->isActive) {
-            // Send stop command to client
-            uint8_t packet[3];
-            packet[0] = static_cast<uint8_t>(Config::MessageType::EFFECT_COMMAND);
-            packet[1] = clientId;
-            packet[2] = 0xFF;  // Special code for stop training
-            
-            sendPacketToClient(packet, 3, clientId);
-            
-            // Calculate final results
-            auto& result = it->second->results;
-            result.totalTime = millis() - it->second->training.timestamp;
-            result.score = TrainingModes::TrainingManager::calculateScore(result);
-            
-            // Notify WebSocket clients
-            DynamicJsonDocument doc(512);
-            doc["type"] = "training_completed";
-            doc["clientId"] = clientId;
-            doc["results"] = getTrainingStatusJson(clientId);
-            
-            String notification;
-            serializeJson(doc, notification);
-            webSocket.textAll(notification);
-            
-            // Reset training state
-            it->second->training = TrainingModes::TrainingConfig();
+    DynamicJsonDocument doc(1536);
+    uint8_t fps = streamFps;
+    doc["enabled"] = streamEnabled.load();
+    doc["fps"] = fps;
+    doc["keyframeInterval"] = keyframeInterval.load();
+
+    uint32_t elapsed = millis() - streamStats.getStartedAt();
+    uint32_t frames = streamStats.getFrames();
+    uint32_t targetFrames = streamStats.getTargetFrames();
+    uint32_t payloads = streamStats.getPayloads();
+    uint64_t bytes = streamStats.getBytes();
+    uint64_t wireBytes = bytes + static_cast<uint64_t>(payloads) * Config::Stream::PACKET_OVERHEAD;
+    const LatencyStats& encode = streamStats.getEncodeTime();
+
+    JsonObject measured = doc.createNestedObject("measured");
+    measured["elapsedMs"] = elapsed;
+    measured["frames"] = frames;
+    measured["targetFrames"] = targetFrames;
+    measured["packets"] = payloads;
+    measured["keyframes"] = streamStats.getKeyframes();
+    measured["paletteFrames"] = streamStats.getPaletteFrames();
+    measured["payloadBytes"] = bytes;
+    if (elapsed > 0) {
+        measured["fps"] = frames * 1000.0f / elapsed;
+        measured["packetsPerSecond"] = payloads * 1000.0f / elapsed;
+        measured["wireBytesPerSecond"] = wireBytes * 1000.0f / elapsed;
+    }
+    measured["tickMeanUs"] = encode.getMean();
+    measured["tickP99Us"] = encode.getPercentile(99);
+    measured["tickMaxUs"] = encode.getMax();
+    measured["cpuPercent"] = encode.getMean() * fps / 10000.0f;
+
+    // Extrapolated from the measured per-target cost for other rates and a
+    // full range of targets; the basis for choosing fps within the airtime
+    if (targetFrames > 0 && frames > 0) {
+        float wirePerTargetFrame = static_cast<float>(wireBytes) / targetFrames;
+        float usPerTargetFrame = static_cast<float>(encode.getMean()) * frames / targetFrames;
+        JsonArray projection = doc.createNestedArray("projection");
+        const uint8_t rates[] = {10, 15, 20, 30, 45, 60};
+        for (uint8_t rate : rates) {
+            JsonObject entry = projection.createNestedObject();
+            entry["fps"] = rate;
+            entry["wireBytesPerSecond"] = wirePerTargetFrame * rate * Config::Network::MAX_CLIENTS;
+            entry["cpuPercent"] = usPerTargetFrame * rate * Config::Network::MAX_CLIENTS / 10000.0f;
         }
-        xSemaphoreGive(clientsMutex);
     }
+
+    String response;
+    serializeJson(doc, response);
+    request->send(200, "application/json", response);
 }
 
-void LEDMatrixHost::updateTrainingStatus(uint8_t clientId, const TrainingModes::TrainingResult& result) {
-    if (xSemaphoreTake(clientsMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-        auto it = clients.find(clientId);
-        if (it != clients.end() && it->second->isActive) {
-            it->second->results = result;
-            it->second->results.score = TrainingModes::TrainingManager::calculateScore(result);
-            
-            // Notify WebSocket clients
-            String status = getTrainingStatusJson(clientId);
-            webSocket.textAll(status);
+void LEDMatrixHost::handleTrainingRequest(AsyncWebServerRequest* request) {
+    if (!request->authenticate(Config::Security::API_USERNAME, Config::Security::API_PASSWORD)) {
+        return request->requestAuthentication();
+    }
+
+    if (request->hasParam("plain", true)) {
+        String body = request->getParam("plain", true)->value();
+        DynamicJsonDocument doc(1024);
+        DeserializationError error = deserializeJson(doc, body);
+
+        if (error) {
+            request->send(400, "application/json", "{\"message\":\"Invalid JSON\"}");
+            return;
         }
-        xSemaphoreGive(clientsMutex);
+
+        startTraining(resolveTargets(doc), parseTrainingConfig(doc),
+                      doc["reliable"] | Config::Network::RELIABLE_TRAINING_COMMANDS);
+
+        request->send(200, "application/json", "{\"message\":\"Training started\"}");
+    } else {
+        request->send(400, "application/json", "{\"message\":\"No data received\"}");
     }
 }
 
-// Helper Methods
-void LEDMatrixHost::sendPacketToClient(uint8_t* packet, size_t packetSize, uint8_t clientId) {
-    if (clientId == static_cast<uint8_t>(Config::MessageType::BROADCAST)) {
-        udp.broadcastTo(packet, packetSize, Config::Network::UDP_PORT);
-    } else {
-        if (xSemaphoreTake(clientsMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-            auto it = clients.find(clientId);
-            if (it != clients.end() && it->second->isActive) {
-                udp.writeTo(packet, packetSize, it->second->ip, Config::Network::UDP_PORT);
+// Targets as a client bitmask: "clientIds": [..], "all": true, or the
+// single "clientId" (default 0) the API has always taken.
+uint32_t LEDMatrixHost::resolveTargets(JsonVariantConst doc) {
+    static_assert(Config::Network::MAX_CLIENTS <= 32, "Targets must fit the 32-bit mask");
+    if (doc["all"] | false) {
+        return Config::Network::MAX_CLIENTS == 32 ? UINT32_MAX : (1UL << Config::Network::MAX_CLIENTS) - 1;
+    }
+    uint32_t mask = 0;
+    if (doc["clientIds"].is<JsonArrayConst>()) {
+        for (JsonVariantConst id : doc["clientIds"].as<JsonArrayConst>()) {
+            uint8_t clientId = id | 0xFF;
+            if (clientId < Config::Network::MAX_CLIENTS) {
+                mask |= 1UL << clientId;
             }
-            xSemaphoreGive(clientsMutex);
         }
+        return mask;
     }
+    uint8_t clientId = doc["clientId"] | 0;
+    return clientId < Config::Network::MAX_CLIENTS ? 1UL << clientId : 0;
 }
 
-String LEDMatrixHost::getClientListJson() {
-    DynamicJsonDocument doc(2048);
-    JsonArray clientArray = doc.createNestedArray("clients");
-    
-    if (xSemaphoreTake(clientsMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-        for (const auto& clientPair : clients) {
-            const auto& client = clientPair.second;
-            if (client && client->isActive) {
-                JsonObject clientObj = clientArray.createNestedObject();
-                clientObj["id"] = client->id;
-                clientObj["ip"] = client->ip.toString();
-                clientObj["lastSeen"] = client->lastSeen;
-                clientObj["color"] = String(client->currentColor[0]) + "," + 
-                                   String(client->currentColor[1]) + "," + 
-                                   String(client->currentColor[2]);
-                clientObj["effect"] = static_cast<uint8_t>(client->currentEffect);
-                clientObj["brightness"] = client->brightness;
-                
-                if (client->training.timestamp > 0) {
-                    JsonObject trainingObj = clientObj.createNestedObject("training");
-                    trainingObj["mode"] = static_cast<uint8_t>(client->training.mode);
-                    trainingObj["difficulty"] = static_cast<uint8_t>(client->training.difficulty);
-                    trainingObj["duration"] = client->training.duration;
-                    trainingObj["elapsed"] = (millis() - client->training.timestamp) / 1000;
-                    trainingObj["hits"] = client->results.hits;
-                    trainingObj["misses"] = client->results.misses;
-                    trainingObj["score"] = client->results.score;
+// Accepts the settings at top level or nested under "config" (as the
+// dashboard sends them, with the seed next to it). Without a seed,
+// startTraining picks a random one.
+TrainingModes::TrainingConfig LEDMatrixHost::parseTrainingConfig(JsonVariantConst doc) {
+    JsonVariantConst source = doc["config"].isNull() ? doc : doc["config"];
+    TrainingModes::TrainingConfig config = {};
+
+    config.mode = static_cast<TrainingModes::Mode>(source["mode"] | 0);
+    config.difficulty = static_cast<TrainingModes::Difficulty>(source["difficulty"] | 0);
+    config.duration = source["duration"] | 300;  // default 5 minutes
+    config.targetCount = source["targetCount"] | 10;
+    config.reactTime = source["reactTime"] | 1000;
+    config.soundEnabled = source["sound"] | true;
+    config.stressorsEnabled = source["stressors"] | false;
+    config.brightness = source["brightness"] | 128;
+    config.seed = source["seed"] | (doc["seed"] | 0UL);
+
+    JsonVariantConst pattern = source["targetPattern"];
+    if (pattern.is<const char*>()) {
+        const char* name = pattern.as<const char*>();
+        const char* names[] = {"random", "sequence", "wave", "spiral"};
+        for (uint8_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i) {
+            if (strcmp(name, names[i]) == 0) {
+                config.modeConfig.targetPattern = i;
+            }
+        }
+    } else {
+        config.modeConfig.targetPattern = pattern | 0;
+    }
+    return config;
+}
+
+void LEDMatrixHost::handleStatusRequest(AsyncWebServerRequest* request) {
+    if (!request->authenticate(Config::Security::API_USERNAME, Config::Security::API_PASSWORD)) {
+        return request->requestAuthentication();
+    }
+
+    if (!request->hasParam("clientId")) {
+        request->send(400, "application/json", "{\"message\":\"clientId required\"}");
+        return;
+    }
+
+    uint8_t clientId = request->getParam("clientId")->value().toInt();
+    ClientState client;
+    if (!clients.read(clientId, client)) {
+        request->send(404, "application/json", "{\"message\":\"Unknown client\"}");
+        return;
+    }
+
+    DynamicJsonDocument doc(3072);
+    JsonObject obj = doc.to<JsonObject>();
+    obj["active"] = client.training.timestamp > 0;
+    serializeTrainingStatus(client, obj, millis());
+    ShotStats stats;
+    if (shotStats.read(clientId, stats)) {
+        serializeShotStats(stats, obj.createNestedObject("stats"), true);
+    }
+
+    String response;
+    serializeJson(doc, response);
+    request->send(200, "application/json", response);
+}
+
+void LEDMatrixHost::handleAPIRequest(AsyncWebServerRequest* request, Config::MessageType commandType) {
+    if (!request->authenticate(Config::Security::API_USERNAME, Config::Security::API_PASSWORD)) {
+        return request->requestAuthentication();
+    }
+
+    if (request->hasParam("plain", true)) {
+        String body = request->getParam("plain", true)->value();
+        DynamicJsonDocument doc(1024);
+        DeserializationError error = deserializeJson(doc, body);
+
+        if (error) {
+            request->send(400, "application/json", "{\"message\":\"Invalid JSON\"}");
+            return;
+        }
+
+        uint32_t targets = resolveTargets(doc);
+        uint8_t payload[Protocol::MAX_RECORD_PAYLOAD];
+        size_t payloadSize = 0;
+        if (!encodeCommand(commandType, doc, payload, payloadSize)) {
+            request->send(400, "application/json", "{\"message\":\"Invalid command\"}");
+            return;
+        }
+
+        sendGroupCommand(targets, commandType, payload, payloadSize);
+        applyCommand(targets, commandType, payload);
+        request->send(200, "application/json", "{\"message\":\"Command sent\"}");
+    } else {
+        request->send(400, "application/json", "{\"message\":\"No data received\"}");
+    }
+}
+
+// Wire payload of an LED, buzzer or effect command; false if the fields
+// it needs are missing or unknown.
+bool LEDMatrixHost::encodeCommand(Config::MessageType type, JsonVariantConst item, uint8_t* payload, size_t& len) {
+    if (type == Config::MessageType::LED_COMMAND) {
+        const char* color = item["color"];
+        if (!color || color[0] != '#') {
+            return false;
+        }
+        uint32_t rgb = strtoul(color + 1, NULL, 16);
+        payload[0] = (rgb >> 16) & 0xFF; // Rot
+        payload[1] = (rgb >> 8) & 0xFF;  // Grün
+        payload[2] = rgb & 0xFF;         // Blau
+        len = 3;
+        return true;
+    }
+    if (type == Config::MessageType::BUZZER_COMMAND) {
+        uint16_t frequency = item["frequency"];
+        uint16_t duration = item["duration"];
+        Protocol::writeU16(payload, frequency);
+        Protocol::writeU16(payload + 2, duration);
+        len = 4;
+        return true;
+    }
+    if (type == Config::MessageType::EFFECT_COMMAND) {
+        Config::Effects::Type effect;
+        if (!EffectEngine::fromName(item["effect"] | "", effect)) {
+            return false;
+        }
+        payload[0] = static_cast<uint8_t>(effect);
+        len = 1;
+        return true;
+    }
+    return false;
+}
+
+// Track what the targets show; the frame stream renders from it
+void LEDMatrixHost::applyCommand(uint32_t targetMask, Config::MessageType type, const uint8_t* payload) {
+    if (type != Config::MessageType::LED_COMMAND && type != Config::MessageType::EFFECT_COMMAND) {
+        return;
+    }
+    for (uint32_t mask = targetMask; mask; mask &= mask - 1) {
+        clients.update(__builtin_ctz(mask), [type, payload](ClientState& client) -> uint16_t {
+            if (type == Config::MessageType::LED_COMMAND) {
+                std::array<uint8_t, 3> color = {payload[0], payload[1], payload[2]};
+                if (client.currentColor == color) {
+                    return 0;
                 }
+                client.currentColor = color;
+                return ClientTable::FIELD_COLOR;
+            }
+            auto effect = static_cast<Config::Effects::Type>(payload[0]);
+            if (client.currentEffect == effect) {
+                return 0;
+            }
+            client.currentEffect = effect;
+            return ClientTable::FIELD_EFFECT;
+        });
+    }
+}
+
+// Many commands in one request. The items are parsed one at a time into
+// a document of their own, and the commands go out as one datagram per
+// destination (more only if they do not fit). Commands for a target
+// reach it in request order. Nothing is applied unless the whole body
+// parses and stays within MAX_BATCH_COMMANDS.
+void LEDMatrixHost::handleBatchRequest(AsyncWebServerRequest* request) {
+    if (!request->authenticate(Config::Security::API_USERNAME, Config::Security::API_PASSWORD)) {
+        return request->requestAuthentication();
+    }
+
+    if (!request->hasParam("plain", true)) {
+        request->send(400, "application/json", "{\"message\":\"No data received\"}");
+        return;
+    }
+
+    // Validate every item before any of them changes state
+    const String& body = request->getParam("plain", true)->value();
+    JsonItems items(body.c_str(), body.length(), "commands");
+    DynamicJsonDocument item(1024);
+    std::vector<BatchItem> staged;
+    uint32_t active = clients.getActiveMask();
+    const char* itemText;
+    size_t itemLength;
+    while (items.next(itemText, itemLength)) {
+        if (staged.size() == Config::Network::MAX_BATCH_COMMANDS) {
+            char message[64];
+            snprintf(message, sizeof(message), "{\"message\":\"commands must be at most %u items\"}",
+                     Config::Network::MAX_BATCH_COMMANDS);
+            request->send(400, "application/json", message);
+            return;
+        }
+        DeserializationError error = deserializeJson(item, itemText, itemLength);
+        if (error && error != DeserializationError::NoMemory) {
+            request->send(400, "application/json", "{\"message\":\"Invalid JSON\"}");
+            return;
+        }
+
+        // Everything that needs the item's JSON; the document is reused
+        // for the next item, so nothing may point into it
+        BatchItem staging = {};
+        BatchRecord& record = staging.record;
+        size_t length = 0;
+        record.mask = resolveTargets(item) & active;
+        if (error) {
+            staging.problem = "Item too large";
+        } else if (!batchCommandType(item["type"] | "", record.type)) {
+            staging.problem = "Unknown type";
+        } else if (record.mask == 0) {
+            staging.problem = "No connected target";
+        } else if (record.type == Config::MessageType::TRAINING_START) {
+            length = Protocol::encodeTrainingConfig(parseTrainingConfig(item), record.payload);
+        } else if (record.type != Config::MessageType::TRAINING_STOP &&
+                   !encodeCommand(record.type, item, record.payload, length)) {
+            staging.problem = "Invalid command";
+        }
+        record.length = length;
+        staged.push_back(staging);
+    }
+    if (items.isMalformed()) {
+        request->send(400, "application/json", "{\"message\":\"Invalid JSON\"}");
+        return;
+    }
+    if (items.isMissing()) {
+        request->send(400, "application/json", "{\"message\":\"commands must be an array\"}");
+        return;
+    }
+
+    DynamicJsonDocument response(JSON_OBJECT_SIZE(3) + JSON_ARRAY_SIZE(staged.size()) +
+                                 staged.size() * JSON_OBJECT_SIZE(4) + 64);
+    JsonArray results = response.createNestedArray("results");
+    std::vector<BatchRecord> records;
+    records.reserve(staged.size());
+
+    // A unicast and a group record for the same target must not swap
+    // places, so such a pair starts a new epoch
+    uint8_t epoch = 0;
+    uint32_t unicastTargets = 0;
+    uint32_t groupTargets = 0;
+    uint16_t failed = 0;
+
+    for (BatchItem& staging : staged) {
+        JsonObject result = results.createNestedObject();
+        result["index"] = results.size() - 1;
+
+        BatchRecord& record = staging.record;
+        uint32_t targets = record.mask;
+        const char* problem = staging.problem;
+        if (!problem && record.type == Config::MessageType::TRAINING_START) {
+            TrainingModes::TrainingConfig config = {};
+            Protocol::decodeTrainingConfig(record.payload, record.length, config);
+            targets = beginTraining(targets, config);
+            Protocol::encodeTrainingConfig(config, record.payload);
+            result["seed"] = config.seed;
+        } else if (!problem && record.type == Config::MessageType::TRAINING_STOP) {
+            targets = endTraining(targets);
+        } else if (!problem) {
+            applyCommand(targets, record.type, record.payload);
+        }
+        if (!problem && targets == 0) {
+            problem = "No target changed state";
+        }
+
+        if (problem) {
+            result["status"] = "error";
+            result["message"] = problem;
+            failed++;
+            continue;
+        }
+
+        bool single = (targets & (targets - 1)) == 0;
+        if (single ? (groupTargets & targets) : (unicastTargets & targets)) {
+            epoch++;
+            unicastTargets = 0;
+            groupTargets = 0;
+        }
+        (single ? unicastTargets : groupTargets) |= targets;
+
+        record.epoch = epoch;
+        record.destination = single ? __builtin_ctz(targets) : Protocol::TARGET_ALL;
+        record.mask = targets;
+        records.push_back(record);
+
+        result["status"] = "ok";
+        result["targets"] = __builtin_popcount(targets);
+    }
+
+    // Stable: records for one destination keep their request order
+    std::stable_sort(records.begin(), records.end(), [](const BatchRecord& a, const BatchRecord& b) {
+        return a.epoch != b.epoch ? a.epoch < b.epoch : a.destination < b.destination;
+    });
+
+    uint8_t buffer[Protocol::MAX_FRAME_SIZE];
+    uint16_t datagrams = 0;
+    for (size_t i = 0; i < records.size(); ) {
+        const BatchRecord& first = records[i];
+        Protocol::FrameWriter frame(buffer, sizeof(buffer), nextSequence());
+        for (; i < records.size(); ++i) {
+            const BatchRecord& record = records[i];
+            if (record.epoch != first.epoch || record.destination != first.destination) {
+                break;
+            }
+            bool added = record.destination == Protocol::TARGET_ALL
+                ? frame.addMasked(record.type, record.mask, record.payload, record.length)
+                : frame.add(record.type, record.destination, record.payload, record.length);
+            if (!added) {
+                break;  // Full; the rest goes in the next datagram
+            }
+        }
+        sendFrame(frame);
+        datagrams++;
+    }
+
+    response["commands"] = staged.size();
+    response["failed"] = failed;
+    response["datagrams"] = datagrams;
+
+    // 207 when only some items failed, 400 when none got through
+    String output;
+    serializeJson(response, output);
+    int status = failed == 0 ? 200 : (failed < staged.size() ? 207 : 400);
+    request->send(status, "application/json", output);
+}
+
+// Metriken
+void LEDMatrixHost::setupMetrics() {
+    static const char* const TASK_NAMES[MONITORED_TASKS] = {
+        "Heartbeat", "MsgProcessor", "StatusBcast", "Timers", "FrameStream", "Storage"
+    };
+
+    metrics.add("udp_rx_packets_total", "UDP datagrams received", udpRxPackets);
+    metrics.add("udp_rx_bytes_total", "UDP payload bytes received", udpRxBytes);
+    metrics.add("udp_rx_invalid_total", "UDP datagrams rejected by the frame check", udpRxInvalid);
+    metrics.add("udp_rx_rejected_total", "Records dropped at ingress (type, length or sender)", udpRxRejected);
+    metrics.add("udp_tx_packets_total", "UDP datagrams sent", udpTxPackets);
+    metrics.add("udp_tx_bytes_total", "UDP payload bytes sent", udpTxBytes);
+    metrics.add("udp_tx_errors_total", "UDP sends that failed", udpTxErrors);
+    metrics.add("reliable_sent_total", "Reliable commands submitted", reliable.getSent());
+    metrics.add("reliable_delivered_total", "Reliable commands acknowledged", reliable.getDelivered());
+    metrics.add("reliable_retransmits_total", "Reliable command retransmissions", reliable.getRetransmits());
+    metrics.add("reliable_failed_total", "Reliable commands given up after all retries", reliable.getFailed());
+    metrics.add("reliable_superseded_total", "Reliable commands replaced before their ACK", reliable.getSuperseded());
+    metrics.add("message_queue_depth", "UDP commands waiting for the processor task", queueDepth);
+    metrics.add("message_queue_high_water", "Deepest the message queue has been", queueHighWater);
+    metrics.add("message_queue_dropped_total", "UDP commands dropped on a full queue", queueDropped);
+    metrics.add("lock_wait_us", "Time spent waiting for a mutex", clients.getWriteWait(), "lock", "clients");
+    metrics.add("lock_wait_us", "Time spent waiting for a mutex", wsBuffers.getLockWait(), "lock", "ws_buffers");
+    metrics.add("ws_serialize_us", "Time to serialize one dashboard message", jsonSerializeUs, "encoding", "json");
+    metrics.add("ws_serialize_us", "Time to serialize one dashboard message", msgpackSerializeUs, "encoding", "msgpack");
+    metrics.add("ws_published_total", "Messages published to the dashboards", wsPublished);
+    metrics.add("ws_clients", "Connected dashboards", wsClients);
+    metrics.add("ws_send_queue_max", "Longest send queue of any dashboard", wsSendQueueMax);
+    metrics.add("heap_free_bytes", "Free heap", heapFree);
+    metrics.add("heap_min_free_bytes", "Lowest free heap since boot", heapMinFree);
+    metrics.add("heap_largest_free_block_bytes", "Largest allocatable heap block", heapLargestBlock);
+    for (size_t i = 0; i < MONITORED_TASKS; ++i) {
+        metrics.add("task_stack_free_bytes", "Stack never used by the task so far",
+                    taskStackFree[i], "task", TASK_NAMES[i]);
+    }
+    metrics.add("uptime_seconds", "Seconds since boot", uptimeSeconds);
+    metrics.add("metrics_render_us", "Time the previous /api/metrics render took", metricsRenderUs);
+}
+
+// Copies values kept elsewhere into their gauges
+void LEDMatrixHost::sampleMetrics() {
+    queueDepth.set(messageQueue.size());
+    queueHighWater.set(messageQueue.highWaterMark());
+    queueDropped.set(messageQueue.dropped());
+
+    uint32_t longest = 0;
+    for (const auto& dashboard : dashboards) {
+        uint32_t slot = dashboard.load();
+        AsyncWebSocketClient* client = slot ? webSocket.client(slot >> 1) : nullptr;
+        if (client) {
+            longest = std::max<uint32_t>(longest, client->queueLen());
+        }
+    }
+    wsClients.set(wsClientCount);
+    wsSendQueueMax.set(longest);
+
+    heapFree.set(ESP.getFreeHeap());
+    heapMinFree.set(ESP.getMinFreeHeap());
+    heapLargestBlock.set(ESP.getMaxAllocHeap());
+
+    // Same order as the names in setupMetrics; ESP-IDF counts stack in bytes
+    const TaskHandle_t tasks[MONITORED_TASKS] = {
+        heartbeatTaskHandle, processorTaskHandle, statusTaskHandle,
+        timerTaskHandle, streamTaskHandle, storageTaskHandle
+    };
+    for (size_t i = 0; i < MONITORED_TASKS; ++i) {
+        taskStackFree[i].set(tasks[i] ? uxTaskGetStackHighWaterMark(tasks[i]) : 0);
+    }
+    uptimeSeconds.set(millis() / 1000);
+}
+
+// Compact form for the dashboards: name -> value, labelled metrics as
+// label -> value, histograms as [count, sum]
+void LEDMatrixHost::pushMetrics() {
+    sampleMetrics();
+
+    DynamicJsonDocument doc(3072);
+    doc["type"] = "metrics";
+    JsonObject values = doc.createNestedObject("metrics");
+    for (size_t i = 0; i < metrics.size(); ++i) {
+        const Metrics::Entry& entry = metrics[i];
+        JsonObject parent = values;
+        const char* key = entry.name;
+        if (entry.labelKey) {
+            parent = values[entry.name];
+            if (parent.isNull()) {
+                parent = values.createNestedObject(entry.name);
+            }
+            key = entry.labelValue;
+        }
+
+        switch (entry.type) {
+            case Metrics::Type::COUNTER:
+                parent[key] = static_cast<const Metrics::Counter*>(entry.metric)->get();
+                break;
+            case Metrics::Type::GAUGE:
+                parent[key] = static_cast<const Metrics::Gauge*>(entry.metric)->get();
+                break;
+            case Metrics::Type::HISTOGRAM: {
+                const auto* histogram = static_cast<const Metrics::Histogram*>(entry.metric);
+                JsonArray pair = parent.createNestedArray(key);
+                pair.add(histogram->getCount());
+                pair.add(histogram->getSum());
+                break;
+            }
+        }
+    }
+    publish(doc);
+}
+
+// Task Creation
+bool LEDMatrixHost::createTasks() {
+    // Heartbeat task
+    BaseType_t result = xTaskCreatePinnedToCore(
+        heartbeatTask,
+        "Heartbeat",
+        Config::Tasks::STACK_SIZE,
+        this,
+        Config::Tasks::PRIORITY_MEDIUM,
+        &heartbeatTaskHandle,
+        1
+    );
+    
+    if (result != pdPASS) {
+        return false;
+    }
+
+    // Message processor task
+    result = xTaskCreatePinnedToCore(
+        messageProcessorTask,
+        "MsgProcessor",
+        Config::Tasks::STACK_SIZE,
+        this,
+        Config::Tasks::PRIORITY_HIGH,
+        &processorTaskHandle,
+        1
+    );
+    
+    if (result != pdPASS) {
+        return false;
+    }
+
+    // Status broadcast task
+    result = xTaskCreatePinnedToCore(
+        statusBroadcastTask,
+        "StatusBcast",
+        Config::Tasks::STACK_SIZE,
+        this,
+        Config::Tasks::PRIORITY_LOW,
+        &statusTaskHandle,
+        1
+    );
+    
+    if (result != pdPASS) {
+        return false;
+    }
+    clients.setChangeListener(statusTaskHandle);
+
+    // Timer task: training deadlines, reaction windows, client liveness
+    result = xTaskCreatePinnedToCore(
+        timerTask,
+        "Timers",
+        Config::Tasks::STACK_SIZE,
+        this,
+        Config::Tasks::PRIORITY_MEDIUM,
+        &timerTaskHandle,
+        1
+    );
+    
+    if (result != pdPASS) {
+        return false;
+    }
+
+    // Frame stream task, idle until streaming is enabled
+    result = xTaskCreatePinnedToCore(
+        streamTask,
+        "FrameStream",
+        Config::Tasks::STACK_SIZE,
+        this,
+        Config::Tasks::PRIORITY_MEDIUM,
+        &streamTaskHandle,
+        1
+    );
+    
+    if (result != pdPASS) {
+        return false;
+    }
+
+    // Storage task: session history writes stay off the training path
+    result = xTaskCreatePinnedToCore(
+        storageTask,
+        "Storage",
+        Config::Tasks::STACK_SIZE,
+        this,
+        Config::Tasks::PRIORITY_LOW,
+        &storageTaskHandle,
+        0
+    );
+    
+    return result == pdPASS;
+}
+
+// Task Implementation
+void LEDMatrixHost::heartbeatTask(void* parameter) {
+    LEDMatrixHost* host = static_cast<LEDMatrixHost*>(parameter);
+    TickType_t xLastWakeTime = xTaskGetTickCount();
+    
+    for (;;) {
+        {
+            TRACE_SCOPE("heartbeat");
+            host->sendTimeSync();
+            if (host->wsClientCount > 0 &&
+                millis() - host->lastMetricsPush >= Config::Tasks::METRICS_PUSH_INTERVAL) {
+                host->lastMetricsPush = millis();
+                host->pushMetrics();
             }
         }
-        xSemaphoreGive(clientsMutex);
+        vTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(Config::Tasks::TIME_SYNC_INTERVAL));
     }
+}
+
+void LEDMatrixHost::messageProcessorTask(void* parameter) {
+    LEDMatrixHost* host = static_cast<LEDMatrixHost*>(parameter);
     
-    String jsonString;
-    serializeJson(doc, jsonString);
-    return jsonString;
+    for (;;) {
+        // Woken by the UDP callback for every published packet
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        // Drain the whole backlog in place; the UDP callback keeps filling
+        // free slots concurrently without waiting on us.
+        TRACE_SCOPE("drain");
+        while (const Message* msg = host->messageQueue.front()) {
+            host->processMessage(*msg);
+            host->ingressLatency.record(micros() - msg->timestamp);
+            host->messageQueue.pop();
+        }
+    }
 }
 
-String LEDMatrixHost::getTrainingStatusJson(uint8_t clientId) {
-    DynamicJsonDocument doc(512);
+void LEDMatrixHost::statusBroadcastTask(void* parameter) {
+    LEDMatrixHost* host = static_cast<LEDMatrixHost*>(parameter);
+#ifdef STATUS_FULL_SNAPSHOTS
+    // Reference for the delta path: the whole list once a second, as
+    // before deltas (pio run -e native-snapshots)
+    TickType_t lastWake = xTaskGetTickCount();
+    for (;;) {
+        host->broadcastClientSnapshot();
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(1000));
+    }
+#else
+    const TickType_t minInterval = pdMS_TO_TICKS(Config::Tasks::STATUS_MIN_INTERVAL);
+    TickType_t lastBroadcast = 0;
     
-    if (xSemaphoreTake(clientsMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-        auto it = clients.find(clientId);
-        if (it != clients.end() && it->second->isActive) {
-            const auto& client = it->second;
-            doc["type"] = "training_status";
-            doc["clientId"] = clientId;
-            doc["mode"] = static_cast<uint8_t>(client->training.mode);
-            doc["difficulty"] = static_cast<uint8_t>(client->training.difficulty);
-            doc["duration"] = client->training.duration;
-            doc["elapsed"] = (millis() - client->training.timestamp) / 1000;
-            doc["hits"] = client->results.hits;
-            doc["misses"] = client->results.misses;
-            doc["score"] = client->results.score;
-            doc["avgReactionTime"] = client->results.avgReactionTime;
-        }
-        xSemaphoreGive(clientsMutex);
+    for (;;) {
+        // Woken by the client table whenever a client changes
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        // The first change after idle goes out at once; bursts are
+        // coalesced into one delta per minInterval.
+        TickType_t sinceLast = xTaskGetTickCount() - lastBroadcast;
+        if (sinceLast < minInterval) {
+            vTaskDelay(minInterval - sinceLast);
+        }
+        host->broadcastClientStatus();
+        lastBroadcast = xTaskGetTickCount();
     }
+#endif
+}
+
+void LEDMatrixHost::timerTask(void* parameter) {
+    LEDMatrixHost* host = static_cast<LEDMatrixHost*>(parameter);
     
-    String jsonString;
-    serializeJson(doc, jsonString);
-    return jsonString;
+    for (;;) {
+        uint32_t delay;
+        {
+            TRACE_SCOPE("timers");
+            delay = host->timers.advance(millis(), [host](uint16_t timerId) {
+                host->handleTimer(timerId);
+            });
+        }
+
+        // Sleep until the next timer is due, or until an earlier one is armed
+        ulTaskNotifyTake(pdTRUE, delay == host->timers.IDLE ? portMAX_DELAY : pdMS_TO_TICKS(delay));
+    }
+}
+
+void LEDMatrixHost::streamTask(void* parameter) {
+    LEDMatrixHost* host = static_cast<LEDMatrixHost*>(parameter);
+    uint8_t payload[FrameStream::MAX_PAYLOAD];
+    FrameStream::Frame frame;
+    uint32_t frameIndex = 0;
+    uint32_t streamedMask = 0;
+    TickType_t xLastWakeTime = xTaskGetTickCount();
+
+    for (;;) {
+        if (!host->streamEnabled.load()) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            streamedMask = 0;
+            xLastWakeTime = xTaskGetTickCount();
+            continue;
+        }
+
+        TRACE_SCOPE("stream_frame");
+        uint32_t start = micros();
+        uint8_t interval = std::max<uint8_t>(host->keyframeInterval.load(), 1);
+
+        // Clients that (re)joined start from a keyframe
+        uint32_t activeMask = host->clients.getActiveMask();
+        for (uint32_t joined = activeMask & ~streamedMask; joined; joined &= joined - 1) {
+            host->frameEncoders[__builtin_ctz(joined)].reset();
+        }
+        streamedMask = activeMask;
+
+        size_t targets = 0;
+        host->clients.forEachActive([&](const ClientState& client) {
+            host->renderFrame(client, frameIndex, frame);
+            // Keyframes are staggered across targets to spread the airtime
+            bool keyframe = (frameIndex + client.id) % interval == 0;
+            size_t len = host->frameEncoders[client.id].encode(frame, keyframe, payload);
+            if (len > 0) {
+                host->sendCommand(client.id, Config::MessageType::FRAME, payload, len);
+                host->streamStats.recordPayload(len, payload[0] & FrameStream::FLAG_KEYFRAME,
+                    static_cast<FrameStream::Encoding>((payload[0] >> 1) & 0x03));
+            }
+            targets++;
+        });
+        host->streamStats.recordFrame(micros() - start, targets);
+        frameIndex++;
+
+        uint8_t fps = constrain(host->streamFps.load(), 1, Config::Stream::MAX_FPS);
+        vTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(1000 / fps));
+    }
+}
+
+// Recovers the history, then writes finished sessions as they arrive
+void LEDMatrixHost::storageTask(void* parameter) {
+    LEDMatrixHost* host = static_cast<LEDMatrixHost*>(parameter);
+
+#ifdef EMBED_ASSETS
+    // Not mounted at boot in embedded builds; only the history needs it
+    if (!host->initializeStorage()) {
+        Error::ErrorHandler::logError(Error::Code::HARDWARE_ERROR, Error::Message::HISTORY_UNAVAILABLE);
+        vTaskDelete(nullptr);
+        return;
+    }
+#endif
+    uint32_t start = millis();
+    host->history.recover();
+    Serial.printf("Session history: %u sessions in %u segments, %u corrupt, recovered in %u ms\n",
+                  host->history.getCount(), host->history.getSegmentCount(),
+                  host->history.getCorrupt(), millis() - start);
+
+    for (;;) {
+        host->history.writePending(portMAX_DELAY);
+    }
+}
+
+// UDP Ingress
+// Frames are checked and walked in place in the packet buffer. Only the
+// payload bytes a handler reads are copied into the ring, since the
+// buffer is gone once this callback returns. Every accepted record
+// refreshes its sender, so targets that send anything need no heartbeat.
+void LEDMatrixHost::handleUDPPacket(AsyncUDPPacket& packet) {
+    TRACE_SCOPE("udp_rx");
+    udpRxPackets.inc();
+    udpRxBytes.inc(packet.length());
+    Protocol::FrameReader frame(packet.data(), packet.length());
+    if (!frame.isValid()) {
+        udpRxInvalid.inc();
+        return;
+    }
+
+    uint32_t now = micros();
+    uint8_t sender = Protocol::TARGET_ALL;
+    uint32_t rejected = 0;
+    bool queued = false;
+    Protocol::Command cmd;
+    while (frame.next(cmd)) {
+        const IngressRoute* route = ingressRoute(cmd.type);
+        if (!route || cmd.length < route->minLength || !ClientTable::isValidId(cmd.target)) {
+            rejected++;
+            continue;
+        }
+        if (cmd.target != sender) {
+            sender = cmd.target;
+            updateClientStatus(sender, packet.remoteIP());
+        }
+        if (!route->handler) {
+            continue;
+        }
+
+        Message* msg = messageQueue.acquire();
+        if (!msg) {
+            break;  // Ring full, counted as drop
+        }
+        msg->type = cmd.type;
+        msg->clientId = cmd.target;
+        msg->length = std::min<size_t>(cmd.length, MAX_INGRESS_PAYLOAD);
+        msg->timestamp = now;
+        memcpy(msg->data.data(), cmd.payload, msg->length);
+        messageQueue.publish();
+        queued = true;
+    }
+
+    if (rejected) {
+        udpRxRejected.inc(rejected);
+    }
+    if (queued && processorTaskHandle) {
+        xTaskNotifyGive(processorTaskHandle);
+    }
+}
+
+// Indexed by type value; NONE marks types a target never sends. Lengths
+// are checked at ingress, so handlers read their fixed fields unchecked.
+const LEDMatrixHost::IngressRoute* LEDMatrixHost::ingressRoute(Config::MessageType type) {
+    using Type = Config::MessageType;
+    static constexpr IngressRoute NONE = {Type::BROADCAST, 0, nullptr};
+    static constexpr IngressRoute ROUTES[] = {
+        NONE,
+        {Type::HEARTBEAT, 0, nullptr},
+        NONE,   // LED_COMMAND
+        NONE,   // BUZZER_COMMAND
+        NONE,   // EFFECT_COMMAND
+        {Type::STATUS_REQUEST, Protocol::STATUS_REPORT_SIZE, &LEDMatrixHost::handleStatusReport},
+        NONE,   // CONFIG_UPDATE
+        {Type::ERROR_REPORT, Protocol::ERROR_REPORT_SIZE, &LEDMatrixHost::handleErrorReport},
+        NONE,   // TRAINING_START
+        NONE,   // TRAINING_STOP
+        {Type::TIME_SYNC, ClockSync::SYNC_REPLY_SIZE, &LEDMatrixHost::handleTimeSync},
+        {Type::HIT_EVENT, Protocol::HIT_EVENT_SIZE, &LEDMatrixHost::handleHitEvent},
+        NONE,   // FRAME
+        {Type::ACK, Protocol::ACK_SIZE, &LEDMatrixHost::handleAck},
+    };
+    constexpr size_t COUNT = sizeof(ROUTES) / sizeof(ROUTES[0]);
+    static_assert([] {
+        for (size_t i = 0; i < COUNT; ++i) {
+            if (ROUTES[i].type != Type::BROADCAST && static_cast<uint8_t>(ROUTES[i].type) != i) {
+                return false;
+            }
+            if (ROUTES[i].minLength > MAX_INGRESS_PAYLOAD) {
+                return false;
+            }
+        }
+        return true;
+    }(), "Ingress routes must sit at their type's index and fit a ring slot");
+    static_assert(Protocol::HIT_EVENT_FULL_SIZE <= MAX_INGRESS_PAYLOAD, "Hit position does not fit a ring slot");
+
+    uint8_t index = static_cast<uint8_t>(type);
+    return index < COUNT && ROUTES[index].type == type ? &ROUTES[index] : nullptr;
+}
+
+// Message Processing
+void LEDMatrixHost::processMessage(const Message& msg) {
+    TRACE_SCOPE_ARG("process", static_cast<uint8_t>(msg.type));
+    const IngressRoute* route = ingressRoute(msg.type);
+    if (route && route->handler) {
+        (this->*route->handler)(msg);
+    }
+}
+
+void LEDMatrixHost::handleStatusReport(const Message& msg) {
+    uint16_t hits = Protocol::readU16(&msg.data[0]);
+    uint16_t misses = Protocol::readU16(&msg.data[2]);
+    updateTrainingStatus(msg.clientId, hits, misses);
+    dashboardLatency.record(micros() - msg.timestamp);
+}
+
+// Payload: stimulus time, hit time (target micros), then optionally the
+// hit position and the round number
+void LEDMatrixHost::handleHitEvent(const Message& msg) {
+    Shot shot{0, ShotStats::POSITION_UNKNOWN, 0};
+    if (msg.length >= Protocol::HIT_EVENT_FULL_SIZE) {
+        shot.position = msg.data[8];
+        shot.round = Protocol::readU16(&msg.data[9]);
+    }
+    recordHit(msg.clientId, Protocol::readU32(&msg.data[0]), Protocol::readU32(&msg.data[4]), shot);
+    dashboardLatency.record(micros() - msg.timestamp);
+}
+
+void LEDMatrixHost::handleErrorReport(const Message& msg) {
+    // Codes come off the wire; unknown ones are kept as the raw byte
+    if (msg.data[0] < static_cast<uint8_t>(Error::Code::COUNT)) {
+        Error::ErrorHandler::logError(static_cast<Error::Code>(msg.data[0]),
+                                      Error::Message::CLIENT_REPORTED, msg.clientId, msg.data[0]);
+    } else {
+        Error::ErrorHandler::logError(Error::Code::COMMUNICATION_ERROR,
+                                      Error::Message::CLIENT_REPORTED_UNKNOWN, msg.clientId, msg.data[0]);
+    }
+}
+
+// Arrival time, like clock sync: our own queue is not round trip
+void LEDMatrixHost::handleAck(const Message& msg) {
+    reliable.acknowledge(msg.clientId, Protocol::readU16(&msg.data[0]), msg.timestamp);
+}
+
+// Client Management
+// Packets from a known address only stamp lastSeen, without a lock. The
+// liveness timer is armed when a client appears and re-arms itself for
+// whatever is left of the timeout, so the ingress path never touches the
+// timer wheel.
+void LEDMatrixHost::updateClientStatus(uint8_t clientId, const IPAddress& ip) {
+    uint32_t now = millis();
+    if (clients.touch(clientId, ip, now)) {
+        return;
+    }
+    bool created = false;
+    if (clients.upsert(clientId, ip, now, &created) && created) {
+        armTimer(TIMER_LIVENESS, clientId, Config::Tasks::CLIENT_TIMEOUT);
+    }
+}
+
+void LEDMatrixHost::checkLiveness(uint8_t clientId) {
+    ClientState client;
+    if (!clients.read(clientId, client)) {
+        return;
+    }
+    uint32_t silent = millis() - client.lastSeen;
+    if (silent < Config::Tasks::CLIENT_TIMEOUT) {
+        armTimer(TIMER_LIVENESS, clientId, Config::Tasks::CLIENT_TIMEOUT - silent);
+    } else {
+        expireClient(clientId);
+    }
+}
+
+void LEDMatrixHost::expireClient(uint8_t clientId) {
+    cancelTimer(TIMER_TRAINING_END, clientId);
+    cancelTimer(TIMER_PHASE, clientId);
+    cancelTimer(TIMER_RETRANSMIT, clientId);
+    reliable.reset(clientId);
+    clients.remove(clientId);
+}
+
+// Clock sync probe; every target answers with its receive and send times
+void LEDMatrixHost::sendTimeSync() {
+    uint8_t payload[ClockSync::SYNC_REQUEST_SIZE];
+    Protocol::writeU32(payload, micros());
+    sendCommand(Protocol::TARGET_ALL, Config::MessageType::TIME_SYNC, payload, sizeof(payload));
+}
+
+// Reply payload: t1 (echoed), t2, t3. The arrival time stamped in the UDP
+// callback is t4, so time spent in our own queue does not count as delay.
+void LEDMatrixHost::handleTimeSync(const Message& msg) {
+    uint32_t t1 = Protocol::readU32(&msg.data[0]);
+    uint32_t t2 = Protocol::readU32(&msg.data[4]);
+    uint32_t t3 = Protocol::readU32(&msg.data[8]);
+    clients.update(msg.clientId, [&](ClientState& client) -> uint16_t {
+        ClockSync::addSample(client.clock, t1, t2, t3, msg.timestamp);
+        return 0;   // Never broadcast
+    });
+}
+
+// Sends only the fields that changed since the last broadcast; nothing
+// at all when idle. Dashboards get a full snapshot on connect or on
+// request and can detect a missed delta by a gap in "seq".
+void LEDMatrixHost::broadcastClientStatus() {
+    TRACE_SCOPE("client_delta");
+    uint32_t mask = clients.takeDirtyMask();
+    if (mask == 0) {
+        return;
+    }
+
+    DynamicJsonDocument doc(clientListSize(__builtin_popcount(mask)));
+    doc["type"] = "client_delta";
+    JsonArray changed = doc.createNestedArray("clients");
+    JsonArray removed;
+    uint32_t now = millis();
+
+    ClientState client;
+    while (mask) {
+        uint8_t id = __builtin_ctz(mask);
+        mask &= mask - 1;
+
+        uint16_t fields = clients.takeDirtyFields(id);
+        if (fields == 0) {
+            continue;
+        }
+        if (!clients.read(id, client)) {
+            if (removed.isNull()) {
+                removed = doc.createNestedArray("removed");
+            }
+            removed.add(id);
+            continue;
+        }
+        serializeClient(client, fields, changed.createNestedObject(), now);
+    }
+
+    if (changed.size() == 0 && removed.isNull()) {
+        return;
+    }
+
+    doc["seq"] = ++statusSequence;
+    statusBytesSent += measureJson(doc) * webSocket.count();
+    statusMessagesSent++;
+    publish(doc);
+}
+
+// Full client list to every dashboard; only the STATUS_FULL_SNAPSHOTS
+// build broadcasts it, to compare against the deltas
+void LEDMatrixHost::broadcastClientSnapshot() {
+    DynamicJsonDocument doc(clientListSize(Config::Network::MAX_CLIENTS));
+    buildClientList(doc);
+    statusBytesSent += measureJson(doc) * webSocket.count();
+    statusMessagesSent++;
+    publish(doc);
+}
+// Training Control
+// All addressed clients start on the same millisecond with the same seed
+// from a single TRAINING_START datagram. With reliable delivery each one
+// gets its own acknowledged unicast instead. No start time is sent, so
+// every target starts when its copy arrives: a lost copy starts late by
+// the retransmission timeout (up to RELIABLE_MAX_RTO per retry) while the
+// host's end timer already runs from now. The seed still gives all of
+// them the same sequence.
+void LEDMatrixHost::startTraining(uint32_t targetMask, const TrainingModes::TrainingConfig& requested,
+                                  bool reliableDelivery) {
+    TrainingModes::TrainingConfig config = requested;
+    uint32_t started = beginTraining(targetMask, config);
+    if (started) {
+        uint8_t payload[Protocol::TRAINING_CONFIG_SIZE];
+        size_t payloadSize = Protocol::encodeTrainingConfig(config, payload);
+        if (reliableDelivery) {
+            reliableClients.fetch_or(started);
+            sendReliable(started, Config::MessageType::TRAINING_START, payload, payloadSize);
+        } else {
+            sendGroupCommand(started, Config::MessageType::TRAINING_START, payload, payloadSize);
+        }
+    }
+}
+
+// Host side of a start: state, timers and the dashboard event. Fills in
+// seed and timestamp; returns the clients that actually started.
+uint32_t LEDMatrixHost::beginTraining(uint32_t targetMask, TrainingModes::TrainingConfig& config) {
+    // The seed alone defines the target sequence; keep it for replay
+    while (config.seed == 0) {
+        config.seed = esp_random();
+    }
+    config.timestamp = millis();
+
+    uint32_t started = 0;
+    for (uint32_t mask = targetMask; mask; mask &= mask - 1) {
+        uint8_t clientId = __builtin_ctz(mask);
+        bool updated = clients.update(clientId, [&config](ClientState& client) -> uint16_t {
+            client.training = config;
+            client.results = TrainingModes::TrainingResult();
+            return ClientTable::FIELD_TRAINING | ClientTable::FIELD_RESULTS;
+        });
+        if (!updated) {
+            continue;
+        }
+        started |= 1UL << clientId;
+        shotStats.reset(clientId);
+        armTimer(TIMER_TRAINING_END, clientId, config.duration * 1000UL);
+        if (config.reactTime > 0) {
+            armTimer(TIMER_PHASE, clientId, config.reactTime);
+        } else {
+            cancelTimer(TIMER_PHASE, clientId);
+        }
+    }
+    if (!started) {
+        return 0;
+    }
+    reliableClients.fetch_and(~started);    // startTraining opts in again
+
+    // Notify WebSocket clients
+    DynamicJsonDocument doc(1024);
+    doc["type"] = "training_started";
+    JsonArray ids = doc.createNestedArray("clientIds");
+    for (uint32_t mask = started; mask; mask &= mask - 1) {
+        ids.add(__builtin_ctz(mask));
+    }
+    doc["clientId"] = __builtin_ctz(started);  // First one, for single-client dashboards
+    doc["mode"] = static_cast<uint8_t>(config.mode);
+    doc["difficulty"] = static_cast<uint8_t>(config.difficulty);
+    doc["seed"] = config.seed;
+    doc["targetPattern"] = config.modeConfig.targetPattern;
+    
+    publish(doc);
+    return started;
+}
+
+void LEDMatrixHost::stopTraining(uint32_t targetMask) {
+    // One stop command for all of them; sessions started reliably are
+    // stopped the same way
+    uint32_t stopped = endTraining(targetMask);
+    uint32_t acknowledged = reliableClients.fetch_and(~stopped) & stopped;
+    sendGroupCommand(stopped & ~acknowledged, Config::MessageType::TRAINING_STOP, nullptr, 0);
+    sendReliable(acknowledged, Config::MessageType::TRAINING_STOP, nullptr, 0);
+}
+
+// Host side of a stop; returns the clients that were stopped
+uint32_t LEDMatrixHost::endTraining(uint32_t targetMask) {
+    uint32_t stopped = 0;
+    for (uint32_t mask = targetMask; mask; mask &= mask - 1) {
+        uint8_t clientId = __builtin_ctz(mask);
+
+        // Calculate final results and reset training state in one write
+        ClientState finished;
+        bool updated = clients.update(clientId, [&finished](ClientState& client) -> uint16_t {
+            client.results.totalTime = millis() - client.training.timestamp;
+            client.results.score = TrainingModes::TrainingManager::calculateScore(client.results);
+            finished = client;
+            client.training = TrainingModes::TrainingConfig();
+            return ClientTable::FIELD_TRAINING | ClientTable::FIELD_RESULTS;
+        });
+        if (!updated) {
+            continue;
+        }
+        stopped |= 1UL << clientId;
+        cancelTimer(TIMER_TRAINING_END, clientId);
+        cancelTimer(TIMER_PHASE, clientId);
+
+        // Notify WebSocket clients with the full shot distribution
+        DynamicJsonDocument doc(3072);
+        doc["type"] = "training_completed";
+        doc["clientId"] = clientId;
+        JsonObject results = doc.createNestedObject("results");
+        serializeTrainingStatus(finished, results, millis());
+        ShotStats stats;
+        bool hasStats = shotStats.read(clientId, stats);
+        if (hasStats) {
+            serializeShotStats(stats, results.createNestedObject("stats"), true);
+        }
+        hasStats = hasStats && stats.getCount() > 0;
+        publish(doc);
+
+        // Keep it; the storage task writes it to flash
+        SessionRecord record = {};
+        time_t now = time(nullptr);
+        bool clockSet = now > 1600000000;
+        record.endedAt = clockSet ? now : millis() / 1000;
+        record.flags = clockSet ? 0 : SessionRecord::FLAG_UPTIME;
+        record.seed = finished.training.seed;
+        record.durationMs = finished.results.totalTime;
+        record.score = finished.results.score;
+        record.hits = finished.results.hits;
+        record.misses = finished.results.misses;
+        record.avgReactionMs = hasStats ? stats.getMean() / 1000 : finished.results.avgReactionTime;
+        record.bestReactionMs = hasStats ? stats.getMin() / 1000 : 0;
+        record.clientId = clientId;
+        record.mode = static_cast<uint8_t>(finished.training.mode);
+        record.difficulty = static_cast<uint8_t>(finished.training.difficulty);
+        history.append(record);
+    }
+    return stopped;
+}
+
+// Counts only move forward: the host also counts hits and timed-out
+// reaction windows itself, and a target report must not undo those.
+void LEDMatrixHost::updateTrainingStatus(uint8_t clientId, uint16_t hits, uint16_t misses) {
+    TRACE_SCOPE_ARG("training_status", clientId);
+    ClientState updated;
+    bool found = clients.update(clientId, [hits, misses, &updated](ClientState& client) -> uint16_t {
+        uint16_t changed = 0;
+        if (hits > client.results.hits || misses > client.results.misses) {
+            client.results.hits = std::max(client.results.hits, hits);
+            client.results.misses = std::max(client.results.misses, misses);
+            client.results.score = TrainingModes::TrainingManager::calculateScore(client.results);
+            changed = ClientTable::FIELD_RESULTS;
+        }
+        updated = client;
+        return changed;
+    });
+
+    if (found) {
+        ShotStats stats;
+        publishTrainingStatus(updated, shotStats.read(clientId, stats) ? &stats : nullptr);
+    }
+}
+
+// Both timestamps come from the target clock, so the reaction time is
+// immune to WiFi latency; only the hit itself is mapped to host time.
+void LEDMatrixHost::recordHit(uint8_t clientId, uint32_t stimulusUs, uint32_t hitUs, Shot shot) {
+    TRACE_SCOPE_ARG("hit", clientId);
+    ClientState current;
+    if (!clients.read(clientId, current) || current.training.timestamp == 0 ||
+        !ClockSync::isSynced(current.clock)) {
+        return;
+    }
+    shot.reactionUs = ClockSync::toHostDuration(current.clock, stimulusUs, hitUs);
+    uint32_t hitAgeUs = micros() - ClockSync::toHostTime(current.clock, hitUs);
+
+    ShotStats stats;
+    if (!shotStats.record(clientId, shot) || !shotStats.read(clientId, stats)) {
+        return;
+    }
+
+    ClientState updated;
+    bool found = clients.update(clientId, [&stats, hitAgeUs, &updated](ClientState& client) -> uint16_t {
+        client.results.hits++;
+        client.results.avgReactionTime = (stats.getMean() + 500) / 1000;
+        client.results.totalTime = millis() - hitAgeUs / 1000 - client.training.timestamp;
+        client.results.score = TrainingModes::TrainingManager::calculateScore(client.results);
+        updated = client;
+        return ClientTable::FIELD_RESULTS;
+    });
+
+    if (found) {
+        if (updated.training.reactTime > 0) {
+            armTimer(TIMER_PHASE, clientId, updated.training.reactTime);  // Next window
+        }
+        publishTrainingStatus(updated, &stats);
+    }
+}
+
+// No hit within reactTime: count a miss and open the next window
+void LEDMatrixHost::handlePhaseTimeout(uint8_t clientId) {
+    ClientState updated;
+    bool counted = false;
+    clients.update(clientId, [&updated, &counted](ClientState& client) -> uint16_t {
+        if (client.training.timestamp == 0) {
+            return 0;
+        }
+        client.results.misses++;
+        client.results.score = TrainingModes::TrainingManager::calculateScore(client.results);
+        updated = client;
+        counted = true;
+        return ClientTable::FIELD_RESULTS;
+    });
+    if (!counted) {
+        return;
+    }
+
+    armTimer(TIMER_PHASE, clientId, updated.training.reactTime);
+    ShotStats stats;
+    publishTrainingStatus(updated, shotStats.read(clientId, stats) ? &stats : nullptr);
+}
+
+void LEDMatrixHost::publishTrainingStatus(const ClientState& client, const ShotStats* stats) {
+    DynamicJsonDocument doc(768);
+    doc["type"] = "training_status";
+    JsonObject obj = doc.as<JsonObject>();
+    serializeTrainingStatus(client, obj, millis());
+    if (stats) {
+        serializeShotStats(*stats, obj.createNestedObject("stats"), false);
+    }
+    publish(doc);
+}
+
+// Zeitgeber
+void LEDMatrixHost::armTimer(TimerKind kind, uint8_t clientId, uint32_t delay) {
+    uint16_t timerId = kind * Config::Network::MAX_CLIENTS + clientId;
+    if (timers.arm(timerId, millis(), delay) && timerTaskHandle) {
+        xTaskNotifyGive(timerTaskHandle);  // Due before the planned wake-up
+    }
+}
+
+void LEDMatrixHost::cancelTimer(TimerKind kind, uint8_t clientId) {
+    timers.cancel(kind * Config::Network::MAX_CLIENTS + clientId);
+}
+
+void LEDMatrixHost::handleTimer(uint16_t timerId) {
+    uint8_t clientId = timerId % Config::Network::MAX_CLIENTS;
+    switch (timerId / Config::Network::MAX_CLIENTS) {
+        case TIMER_TRAINING_END:
+            stopTraining(1UL << clientId);
+            break;
+
+        case TIMER_PHASE:
+            handlePhaseTimeout(clientId);
+            break;
+
+        case TIMER_LIVENESS:
+            checkLiveness(clientId);
+            break;
+
+        case TIMER_RETRANSMIT:
+            retransmit(clientId);
+            break;
+    }
+}
+
+// Frame-Rendering
+// Frames are rendered per target so range-wide effects can be phased by
+// target id; all targets share the same frame clock.
+void LEDMatrixHost::renderFrame(const ClientState& client, uint32_t frameIndex, FrameStream::Frame& frame) {
+    EffectEngine::Params params;
+    params.type = client.currentEffect;
+    params.color = FrameStream::Rgb{client.currentColor[0], client.currentColor[1], client.currentColor[2]};
+    params.brightness = client.brightness;
+    params.speed = 16;
+    params.phase = client.id * 16;
+    EffectEngine::render(params, frameIndex, effectStates[client.id], frame);
+}
+
+// Helper Methods
+bool LEDMatrixHost::sendCommand(uint8_t clientId, Config::MessageType type, const uint8_t* payload, size_t len) {
+    uint8_t buffer[Protocol::MAX_FRAME_SIZE];
+    Protocol::FrameWriter frame(buffer, sizeof(buffer), nextSequence());
+    if (!frame.add(type, clientId, payload, len)) {
+        return false;
+    }
+    sendFrame(frame);
+    return true;
+}
+
+// One datagram for any set of clients: unicast for a single one, else a
+// broadcast that only the addressed targets act on.
+bool LEDMatrixHost::sendGroupCommand(uint32_t targetMask, Config::MessageType type, const uint8_t* payload, size_t len) {
+    if (targetMask == 0) {
+        return false;
+    }
+    if ((targetMask & (targetMask - 1)) == 0) {
+        return sendCommand(__builtin_ctz(targetMask), type, payload, len);
+    }
+    uint8_t buffer[Protocol::MAX_FRAME_SIZE];
+    Protocol::FrameWriter frame(buffer, sizeof(buffer), nextSequence());
+    if (!frame.addMasked(type, targetMask, payload, len)) {
+        return false;
+    }
+    sendFrame(frame);
+    return true;
+}
+
+// Sends a frame to its only target, or broadcasts it if the records
+// address several targets; each target applies only its own records.
+void LEDMatrixHost::sendFrame(Protocol::FrameWriter& frame) {
+    if (frame.empty()) {
+        return;
+    }
+    size_t frameSize = frame.finish();
+    sendPacketToClient(frame.data(), frameSize, frame.destination());
+}
+
+void LEDMatrixHost::sendPacketToClient(uint8_t* packet, size_t packetSize, uint8_t clientId) {
+    size_t sent = 0;
+    if (clientId == static_cast<uint8_t>(Config::MessageType::BROADCAST)) {
+        sent = udp.broadcastTo(packet, packetSize, Config::Network::UDP_PORT);
+    } else {
+        ClientState client;
+        if (!clients.read(clientId, client)) {
+            return;
+        }
+        sent = udp.writeTo(packet, packetSize, IPAddress(client.ip), Config::Network::UDP_PORT);
+    }
+    if (sent == packetSize) {
+        udpTxPackets.inc();
+        udpTxBytes.inc(sent);
+    } else {
+        udpTxErrors.inc();
+    }
+}
+
+// One acknowledged unicast per client. Start and stop replace each other:
+// once a newer one is on its way the older one must not be repeated.
+void LEDMatrixHost::sendReliable(uint32_t targetMask, Config::MessageType type, const uint8_t* payload, size_t len) {
+    uint32_t now = micros();
+    for (uint32_t mask = targetMask; mask; mask &= mask - 1) {
+        uint8_t clientId = __builtin_ctz(mask);
+        reliable.cancel(clientId, Config::MessageType::TRAINING_START);
+        reliable.cancel(clientId, Config::MessageType::TRAINING_STOP);
+
+        ReliableLink::Command command;
+        if (!reliable.submit(clientId, type, payload, len, now, command)) {
+            sendCommand(clientId, type, payload, len);  // Window full: best effort
+            continue;
+        }
+        sendReliableCommand(clientId, command);
+        armTimer(TIMER_RETRANSMIT, clientId, reliable.nextTimeout(clientId, now));
+    }
+}
+
+void LEDMatrixHost::sendReliableCommand(uint8_t clientId, const ReliableLink::Command& command) {
+    uint8_t buffer[Protocol::HEADER_SIZE + Protocol::RECORD_HEADER_SIZE + ReliableLink::MAX_PAYLOAD];
+    Protocol::FrameWriter frame(buffer, sizeof(buffer), command.seq, Protocol::FLAG_RELIABLE);
+    if (frame.add(command.type, clientId, command.payload, command.length)) {
+        sendFrame(frame);
+    }
+}
+
+void LEDMatrixHost::retransmit(uint8_t clientId) {
+    std::array<ReliableLink::Command, ReliableLink::WINDOW> due;
+    uint32_t next;
+    size_t count = reliable.collectDue(clientId, micros(), due, next);
+    for (size_t i = 0; i < count; ++i) {
+        if (due[i].expired) {
+            Error::ErrorHandler::logError(Error::Code::COMMUNICATION_ERROR, Error::Message::DELIVERY_FAILED,
+                                          clientId, static_cast<uint8_t>(due[i].type));
+        } else {
+            sendReliableCommand(clientId, due[i]);
+        }
+    }
+    if (next != ReliableLink::IDLE) {
+        armTimer(TIMER_RETRANSMIT, clientId, next);
+    }
+}
+
+void LEDMatrixHost::serializeSession(const SessionRecord& record, JsonObject obj) {
+    obj["sequence"] = record.sequence;
+    obj["endedAt"] = record.endedAt;
+    obj["uptimeClock"] = (record.flags & SessionRecord::FLAG_UPTIME) != 0;
+    obj["clientId"] = record.clientId;
+    obj["mode"] = record.mode;
+    obj["difficulty"] = record.difficulty;
+    obj["seed"] = record.seed;
+    obj["durationMs"] = record.durationMs;
+    obj["score"] = record.score;
+    obj["hits"] = record.hits;
+    obj["misses"] = record.misses;
+    obj["avgReactionMs"] = record.avgReactionMs;
+    obj["bestReactionMs"] = record.bestReactionMs;
+}
+
+void LEDMatrixHost::buildClientList(JsonDocument& doc) {
+    TRACE_SCOPE("client_list");
+    doc["type"] = "client_list";
+    doc["seq"] = statusSequence;
+    JsonArray clientArray = doc.createNestedArray("clients");
+    uint32_t now = millis();
+    
+    clients.forEachActive([&clientArray, now](const ClientState& client) {
+        serializeClient(client, ClientTable::FIELD_ALL, clientArray.createNestedObject(), now);
+    });
+}
+
+// Document capacity for count clients with every field: the client and
+// training objects of up to 7 members each, plus the copied ip and colour
+// strings; the outer members and a "removed" list of deltas included
+size_t LEDMatrixHost::clientListSize(size_t count) {
+    return JSON_OBJECT_SIZE(4) + 2 * JSON_ARRAY_SIZE(count) + count * (2 * JSON_OBJECT_SIZE(7) + 32);
+}
+
+void LEDMatrixHost::serializeClient(const ClientState& client, uint16_t fields, JsonObject obj, uint32_t now) {
+    obj["id"] = client.id;
+
+    if (fields & ClientTable::FIELD_ADDRESS) {
+        obj["ip"] = IPAddress(client.ip).toString();
+        obj["lastSeen"] = client.lastSeen;
+    }
+    if (fields & ClientTable::FIELD_COLOR) {
+        char color[12];
+        snprintf(color, sizeof(color), "%u,%u,%u",
+                 client.currentColor[0], client.currentColor[1], client.currentColor[2]);
+        obj["color"] = color;
+    }
+    if (fields & ClientTable::FIELD_EFFECT) {
+        obj["effect"] = static_cast<uint8_t>(client.currentEffect);
+    }
+    if (fields & ClientTable::FIELD_BRIGHTNESS) {
+        obj["brightness"] = client.brightness;
+    }
+    if (fields & (ClientTable::FIELD_TRAINING | ClientTable::FIELD_RESULTS)) {
+        if (client.training.timestamp > 0) {
+            JsonObject trainingObj = obj.createNestedObject("training");
+            trainingObj["mode"] = static_cast<uint8_t>(client.training.mode);
+            trainingObj["difficulty"] = static_cast<uint8_t>(client.training.difficulty);
+            trainingObj["duration"] = client.training.duration;
+            trainingObj["elapsed"] = (now - client.training.timestamp) / 1000;
+            trainingObj["hits"] = client.results.hits;
+            trainingObj["misses"] = client.results.misses;
+            trainingObj["score"] = client.results.score;
+        } else if (fields & ClientTable::FIELD_TRAINING) {
+            obj["training"] = nullptr;  // Training ended
+        }
+    }
+}
+
+void LEDMatrixHost::serializeTrainingStatus(const ClientState& client, JsonObject obj, uint32_t now) {
+    obj["clientId"] = client.id;
+    obj["mode"] = static_cast<uint8_t>(client.training.mode);
+    obj["difficulty"] = static_cast<uint8_t>(client.training.difficulty);
+    obj["duration"] = client.training.duration;
+    obj["elapsed"] = (now - client.training.timestamp) / 1000;
+    obj["hits"] = client.results.hits;
+    obj["misses"] = client.results.misses;
+    obj["score"] = client.results.score;
+    obj["avgReactionTime"] = client.results.avgReactionTime;
+    obj["seed"] = client.training.seed;
+}
+
+// Summary for live updates; the detailed form adds rounds and the hit map
+void LEDMatrixHost::serializeShotStats(const ShotStats& stats, JsonObject obj, bool detailed) {
+    obj["shots"] = stats.getCount();
+    obj["meanUs"] = stats.getMean();
+    obj["stdDevUs"] = stats.getStdDev();
+    obj["minUs"] = stats.getMin();
+    obj["maxUs"] = stats.getMax();
+    obj["p50Us"] = stats.getPercentile(50);
+    obj["p90Us"] = stats.getPercentile(90);
+    obj["p99Us"] = stats.getPercentile(99);
+    obj["round"] = stats.getLastRound();
+
+    if (!detailed || stats.getCount() == 0) {
+        return;
+    }
+
+    JsonArray rounds = obj.createNestedArray("rounds");
+    uint16_t last = stats.getLastRound();
+    uint16_t first = last >= ShotStats::ROUND_HISTORY ? last - ShotStats::ROUND_HISTORY + 1 : 0;
+    for (uint32_t number = first; number <= last; ++number) {
+        const ShotStats::Round* round = stats.getRound(number);
+        if (!round) {
+            continue;
+        }
+        JsonObject roundObj = rounds.createNestedObject();
+        roundObj["round"] = round->number;
+        roundObj["hits"] = round->hits;
+        roundObj["meanUs"] = round->sumUs / round->hits;
+        roundObj["bestUs"] = round->bestUs;
+    }
+
+    JsonArray heatmap = obj.createNestedArray("heatmap");
+    for (uint8_t position = 0; position < ShotStats::MATRIX_SIZE * ShotStats::MATRIX_SIZE; ++position) {
+        heatmap.add(stats.getHitsAt(position));
+    }
+}
+
+// WebSocket-Ausgabe
+bool LEDMatrixHost::registerDashboard(uint32_t wsClientId) {
+    for (auto& dashboard : dashboards) {
+        uint32_t expected = 0;
+        if (dashboard.compare_exchange_strong(expected, wsClientId << 1)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// True if the client held a slot
+bool LEDMatrixHost::unregisterDashboard(uint32_t wsClientId) {
+    for (auto& dashboard : dashboards) {
+        uint32_t current = dashboard.load();
+        if (current != 0 && (current >> 1) == wsClientId && dashboard.compare_exchange_strong(current, 0)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void LEDMatrixHost::setDashboardEncoding(uint32_t wsClientId, bool binary) {
+    for (auto& dashboard : dashboards) {
+        // Only while the slot is still this client's
+        uint32_t current = dashboard.load();
+        if (current != 0 && (current >> 1) == wsClientId) {
+            dashboard.compare_exchange_strong(current, (wsClientId << 1) | (binary ? DASHBOARD_BINARY : 0));
+        }
+    }
+}
+
+// Serializes into a pooled buffer of exactly the frame size. The pool
+// gets it back once the last message queued from it has been sent.
+AsyncWebSocketSharedBuffer LEDMatrixHost::serializeFrame(const JsonDocument& doc, bool binary) {
+    TRACE_SCOPE_ARG("ws_serialize", binary);
+    size_t size = binary ? measureMsgPack(doc) : measureJson(doc);
+    // JSON also needs room for the terminator, which the frame leaves out
+    AsyncWebSocketSharedBuffer buffer = wsBuffers.acquire(binary ? size : size + 1);
+
+    uint32_t start = micros();
+    if (binary) {
+        serializeMsgPack(doc, buffer->data(), size);
+        msgpackSerializeUs.observe(micros() - start);
+    } else {
+        serializeJson(doc, reinterpret_cast<char*>(buffer->data()), size + 1);
+        buffer->resize(size);
+        jsonSerializeUs.observe(micros() - start);
+    }
+    return buffer;
+}
+
+// Serializes once per encoding in use; every dashboard queues the same
+// buffer by reference.
+void LEDMatrixHost::publish(const JsonDocument& doc) {
+    TRACE_SCOPE("ws_publish");
+    wsPublished.inc();
+    bool anyText = false;
+    bool anyBinary = false;
+    for (const auto& dashboard : dashboards) {
+        uint32_t slot = dashboard.load();
+        if (slot) {
+            anyBinary |= (slot & DASHBOARD_BINARY) != 0;
+            anyText |= (slot & DASHBOARD_BINARY) == 0;
+        }
+    }
+
+    AsyncWebSocketSharedBuffer text = anyText ? serializeFrame(doc, false) : nullptr;
+    AsyncWebSocketSharedBuffer packed = anyBinary ? serializeFrame(doc, true) : nullptr;
+
+    if (!anyBinary) {
+        if (text) {
+            TRACE_SCOPE("ws_text_all");
+            webSocket.textAll(text);
+        }
+    } else {
+        for (const auto& dashboard : dashboards) {
+            uint32_t slot = dashboard.load();
+            AsyncWebSocketClient* client = slot ? webSocket.client(slot >> 1) : nullptr;
+            if (!client || client->status() != WS_CONNECTED) {
+                continue;
+            }
+            if ((slot & DASHBOARD_BINARY) && packed) {
+                client->binary(packed);
+            } else if (!(slot & DASHBOARD_BINARY) && text) {
+                client->text(text);
+            }
+        }
+    }
+}
+
+void LEDMatrixHost::sendTo(AsyncWebSocketClient* client, const JsonDocument& doc) {
+    bool binary = false;
+    for (const auto& dashboard : dashboards) {
+        uint32_t slot = dashboard.load();
+        if ((slot >> 1) == client->id()) {
+            binary = slot & DASHBOARD_BINARY;
+        }
+    }
+
+    AsyncWebSocketSharedBuffer buffer = serializeFrame(doc, binary);
+    if (binary) {
+        client->binary(buffer);
+    } else {
+        client->text(buffer);
+    }
 }
 
 // Main loop method - can be used for non-task operations if needed
@@ -0,0 +1,89 @@
+#include "Metrics.h"
+
+namespace Metrics {
+    namespace {
+        const char* typeName(Type type) {
+            switch (type) {
+                case Type::COUNTER: return "counter";
+                case Type::GAUGE: return "gauge";
+                default: return "histogram";
+            }
+        }
+
+        // {key="value"} or {key="value",le="..."}, or nothing at all
+        void appendLabels(String& out, const Entry& entry, const char* le) {
+            char labels[64];
+            int length = 0;
+            if (entry.labelKey && le) {
+                length = snprintf(labels, sizeof(labels), "{%s=\"%s\",le=\"%s\"}", entry.labelKey, entry.labelValue, le);
+            } else if (entry.labelKey) {
+                length = snprintf(labels, sizeof(labels), "{%s=\"%s\"}", entry.labelKey, entry.labelValue);
+            } else if (le) {
+                length = snprintf(labels, sizeof(labels), "{le=\"%s\"}", le);
+            }
+            if (length > 0) {
+                out += labels;
+            }
+        }
+
+        void appendSample(String& out, const Entry& entry, const char* suffix, const char* le, long long value) {
+            char number[24];
+            snprintf(number, sizeof(number), " %lld\n", value);
+            out += entry.name;
+            out += suffix;
+            appendLabels(out, entry, le);
+            out += number;
+        }
+    }
+
+    bool Registry::add(const Entry& entry) {
+        if (count >= CAPACITY) {
+            return false;
+        }
+        entries[count++] = entry;
+        return true;
+    }
+
+    void Registry::writePrometheus(String& out) const {
+        const char* previous = nullptr;
+        for (size_t i = 0; i < count; ++i) {
+            const Entry& entry = entries[i];
+            if (!previous || strcmp(previous, entry.name) != 0) {
+                out += "# HELP ";
+                out += entry.name;
+                out += ' ';
+                out += entry.help;
+                out += "\n# TYPE ";
+                out += entry.name;
+                out += ' ';
+                out += typeName(entry.type);
+                out += '\n';
+                previous = entry.name;
+            }
+
+            switch (entry.type) {
+                case Type::COUNTER:
+                    appendSample(out, entry, "", nullptr, static_cast<const Counter*>(entry.metric)->get());
+                    break;
+                case Type::GAUGE:
+                    appendSample(out, entry, "", nullptr, static_cast<const Gauge*>(entry.metric)->get());
+                    break;
+                case Type::HISTOGRAM: {
+                    const Histogram& histogram = *static_cast<const Histogram*>(entry.metric);
+                    uint32_t cumulative = 0;
+                    char le[12];
+                    for (size_t b = 0; b + 1 < Histogram::BUCKETS; ++b) {
+                        cumulative += histogram.getBucket(b);
+                        snprintf(le, sizeof(le), "%lu", static_cast<unsigned long>(Histogram::upperBound(b)));
+                        appendSample(out, entry, "_bucket", le, cumulative);
+                    }
+                    cumulative += histogram.getBucket(Histogram::BUCKETS - 1);
+                    appendSample(out, entry, "_bucket", "+Inf", cumulative);
+                    appendSample(out, entry, "_sum", nullptr, histogram.getSum());
+                    appendSample(out, entry, "_count", nullptr, cumulative);
+                    break;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,196 @@
+#include "Protocol.h"
+#include <array>
+
+namespace Protocol {
+
+namespace {
+    // CRC-16/CCITT (poly 0x1021) lookup table, generated at compile time
+    constexpr std::array<uint16_t, 256> makeCrcTable() {
+        std::array<uint16_t, 256> table{};
+        for (uint16_t i = 0; i < 256; ++i) {
+            uint16_t crc = i << 8;
+            for (uint8_t bit = 0; bit < 8; ++bit) {
+                crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+            }
+            table[i] = crc;
+        }
+        return table;
+    }
+
+    constexpr std::array<uint16_t, 256> CRC_TABLE = makeCrcTable();
+
+    uint16_t frameCrc(const uint8_t* frame, size_t payloadLength) {
+        uint16_t crc = crc16(frame, 6);
+        return crc16(frame + HEADER_SIZE, payloadLength, crc);
+    }
+}
+
+uint16_t crc16(const uint8_t* data, size_t len, uint16_t crc) {
+    for (size_t i = 0; i < len; ++i) {
+        crc = (crc << 8) ^ CRC_TABLE[((crc >> 8) ^ data[i]) & 0xFF];
+    }
+    return crc;
+}
+
+// FrameWriter
+FrameWriter::FrameWriter(uint8_t* buffer, size_t capacity, uint16_t seq, uint8_t flags)
+    : buffer(buffer)
+    , capacity(capacity < MAX_FRAME_SIZE ? capacity : MAX_FRAME_SIZE)
+    , position(HEADER_SIZE)
+    , commands(0)
+    , target(TARGET_ALL) {
+    buffer[0] = VERSION;
+    buffer[1] = flags;
+    writeU16(buffer + 2, seq);
+}
+
+uint8_t* FrameWriter::append(Config::MessageType type, uint8_t target, size_t len) {
+    if (len > MAX_RECORD_PAYLOAD || RECORD_HEADER_SIZE + len > remaining()) {
+        return nullptr;
+    }
+
+    uint8_t* record = buffer + position;
+    record[0] = static_cast<uint8_t>(type);
+    record[1] = target;
+    record[2] = static_cast<uint8_t>(len);
+    position += RECORD_HEADER_SIZE + len;
+
+    if (commands == 0) {
+        this->target = target;
+    } else if (this->target != target) {
+        this->target = TARGET_ALL;
+    }
+    commands++;
+
+    return record + RECORD_HEADER_SIZE;
+}
+
+bool FrameWriter::add(Config::MessageType type, uint8_t target, const uint8_t* payload, size_t len) {
+    uint8_t* out = append(type, target, len);
+    if (!out) {
+        return false;
+    }
+    if (len > 0) {
+        memcpy(out, payload, len);
+    }
+    return true;
+}
+
+bool FrameWriter::addMasked(Config::MessageType type, uint32_t mask, const uint8_t* payload, size_t len) {
+    uint8_t* out = append(type, TARGET_MASK, MASK_SIZE + len);
+    if (!out) {
+        return false;
+    }
+    writeU32(out, mask);
+    if (len > 0) {
+        memcpy(out + MASK_SIZE, payload, len);
+    }
+    return true;
+}
+
+size_t FrameWriter::finish() {
+    size_t payloadLength = position - HEADER_SIZE;
+    writeU16(buffer + 4, payloadLength);
+    writeU16(buffer + 6, frameCrc(buffer, payloadLength));
+    return position;
+}
+
+void FrameWriter::reset(uint16_t seq) {
+    writeU16(buffer + 2, seq);
+    position = HEADER_SIZE;
+    commands = 0;
+    target = TARGET_ALL;
+}
+
+// FrameReader
+FrameReader::FrameReader(const uint8_t* data, size_t len)
+    : buffer(data)
+    , end(0)
+    , position(HEADER_SIZE)
+    , hdr{}
+    , valid(false) {
+    if (len < HEADER_SIZE || data[0] != VERSION) {
+        return;
+    }
+
+    hdr.version = data[0];
+    hdr.flags = data[1];
+    hdr.seq = readU16(data + 2);
+    hdr.length = readU16(data + 4);
+
+    if (hdr.length < RECORD_HEADER_SIZE || HEADER_SIZE + hdr.length > len) {
+        return;
+    }
+    if (readU16(data + 6) != frameCrc(data, hdr.length)) {
+        return;
+    }
+
+    end = HEADER_SIZE + hdr.length;
+    valid = true;
+}
+
+bool FrameReader::next(Command& cmd) {
+    if (!valid || position + RECORD_HEADER_SIZE > end) {
+        return false;
+    }
+
+    const uint8_t* record = buffer + position;
+    size_t len = record[2];
+    if (position + RECORD_HEADER_SIZE + len > end) {
+        valid = false;  // Truncated record, stop iterating
+        return false;
+    }
+
+    cmd.type = static_cast<Config::MessageType>(record[0]);
+    cmd.target = record[1];
+    cmd.length = len;
+    cmd.payload = record + RECORD_HEADER_SIZE;
+    if (cmd.target == TARGET_MASK) {
+        if (len < MASK_SIZE) {
+            valid = false;
+            return false;
+        }
+        cmd.mask = readU32(cmd.payload);
+        cmd.payload += MASK_SIZE;
+        cmd.length -= MASK_SIZE;
+    } else if (cmd.target == TARGET_ALL) {
+        cmd.mask = UINT32_MAX;
+    } else {
+        cmd.mask = cmd.target < 32 ? 1UL << cmd.target : 0;
+    }
+    position += RECORD_HEADER_SIZE + len;
+    return true;
+}
+
+// Payload encodings
+size_t encodeTrainingConfig(const TrainingModes::TrainingConfig& config, uint8_t* out) {
+    out[0] = static_cast<uint8_t>(config.mode);
+    out[1] = static_cast<uint8_t>(config.difficulty);
+    writeU16(out + 2, config.duration);
+    writeU16(out + 4, config.targetCount);
+    writeU16(out + 6, config.reactTime);
+    out[8] = (config.soundEnabled ? 0x01 : 0x00) | (config.stressorsEnabled ? 0x02 : 0x00);
+    out[9] = config.brightness;
+    writeU32(out + 10, config.seed);
+    out[14] = config.modeConfig.targetPattern;
+    return TRAINING_CONFIG_SIZE;
+}
+
+bool decodeTrainingConfig(const uint8_t* in, size_t len, TrainingModes::TrainingConfig& config) {
+    if (len < TRAINING_CONFIG_SIZE) {
+        return false;
+    }
+    config.mode = static_cast<TrainingModes::Mode>(in[0]);
+    config.difficulty = static_cast<TrainingModes::Difficulty>(in[1]);
+    config.duration = readU16(in + 2);
+    config.targetCount = readU16(in + 4);
+    config.reactTime = readU16(in + 6);
+    config.soundEnabled = in[8] & 0x01;
+    config.stressorsEnabled = in[8] & 0x02;
+    config.brightness = in[9];
+    config.seed = readU32(in + 10);
+    config.modeConfig.targetPattern = in[14];
+    return true;
+}
+
+}
@@ -0,0 +1,213 @@
+#include "ReliableLink.h"
+
+namespace {
+    constexpr uint32_t INITIAL_RTO_US = Config::Network::RELIABLE_INITIAL_RTO * 1000;
+    constexpr uint32_t MIN_RTO_US = Config::Network::RELIABLE_MIN_RTO * 1000;
+    constexpr uint32_t MAX_RTO_US = Config::Network::RELIABLE_MAX_RTO * 1000;
+    constexpr uint32_t GRANULARITY_US = 1000;   // Timer tick
+
+    uint32_t toDelayMs(uint32_t deadlineUs, uint32_t nowUs) {
+        int32_t remaining = static_cast<int32_t>(deadlineUs - nowUs);
+        return remaining > 0 ? (static_cast<uint32_t>(remaining) + 999) / 1000 : 0;
+    }
+}
+
+ReliableLink::ReliableLink() {
+    for (auto& peer : peers) {
+        peer = Peer();
+        // Random start so targets do not take a rebooted host's first
+        // commands for repeats
+        peer.nextSeq = esp_random() & 0xFFFF;
+        peer.rtoUs = INITIAL_RTO_US;
+    }
+    linkMutex = xSemaphoreCreateMutex();
+}
+
+ReliableLink::~ReliableLink() {
+    if (linkMutex) vSemaphoreDelete(linkMutex);
+}
+
+bool ReliableLink::submit(uint8_t clientId, Config::MessageType type, const uint8_t* payload, size_t len,
+                          uint32_t nowUs, Command& out) {
+    if (clientId >= CAPACITY || len > MAX_PAYLOAD || xSemaphoreTake(linkMutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return false;
+    }
+    Peer& peer = peers[clientId];
+    Entry* slot = nullptr;
+    for (auto& entry : peer.entries) {
+        if (!entry.used) {
+            slot = &entry;
+            break;
+        }
+    }
+    if (slot) {
+        Command& command = slot->command;
+        command.type = type;
+        command.seq = peer.nextSeq++;
+        command.length = len;
+        command.attempt = 0;
+        command.expired = false;
+        if (len) {
+            memcpy(command.payload, payload, len);
+        }
+        slot->firstSentUs = nowUs;
+        slot->sentUs = nowUs;
+        slot->deadlineUs = nowUs + peer.rtoUs;
+        slot->used = true;
+        out = command;
+    }
+    xSemaphoreGive(linkMutex);
+
+    if (slot) {
+        sent.inc();
+    }
+    return slot != nullptr;
+}
+
+bool ReliableLink::acknowledge(uint8_t clientId, uint16_t seq, uint32_t nowUs) {
+    if (clientId >= CAPACITY || xSemaphoreTake(linkMutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return false;
+    }
+    Peer& peer = peers[clientId];
+    uint32_t latencyUs = 0;
+    bool found = false;
+    for (auto& entry : peer.entries) {
+        if (!entry.used || entry.command.seq != seq) {
+            continue;
+        }
+        // Karn: after a retransmission the ACK may belong to either copy
+        if (entry.command.attempt == 0) {
+            addSample(peer, nowUs - entry.sentUs);
+        }
+        latencyUs = nowUs - entry.firstSentUs;
+        entry.used = false;
+        found = true;
+        break;
+    }
+    xSemaphoreGive(linkMutex);
+
+    if (found) {
+        delivered.inc();
+        deliveryLatency.record(latencyUs);
+    }
+    return found;
+}
+
+size_t ReliableLink::collectDue(uint8_t clientId, uint32_t nowUs, std::array<Command, WINDOW>& out,
+                                uint32_t& nextMs) {
+    nextMs = IDLE;
+    if (clientId >= CAPACITY || xSemaphoreTake(linkMutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return 0;
+    }
+    Peer& peer = peers[clientId];
+    size_t count = 0;
+    uint32_t resent = 0;
+    uint32_t dropped = 0;
+    for (auto& entry : peer.entries) {
+        if (!entry.used || static_cast<int32_t>(entry.deadlineUs - nowUs) > 0) {
+            continue;
+        }
+        Command& command = entry.command;
+        if (command.attempt >= Config::Network::RELIABLE_MAX_RETRIES) {
+            command.expired = true;
+            entry.used = false;
+            dropped++;
+        } else {
+            command.attempt++;
+            entry.sentUs = nowUs;
+            entry.deadlineUs = nowUs + std::min<uint32_t>(peer.rtoUs << std::min<uint8_t>(command.attempt, 16),
+                                                          MAX_RTO_US);
+            resent++;
+        }
+        out[count++] = command;
+    }
+    uint32_t deadline = nextDeadline(peer, nowUs);
+    xSemaphoreGive(linkMutex);
+
+    if (deadline != IDLE) {
+        nextMs = toDelayMs(deadline, nowUs);
+    }
+    retransmits.inc(resent);
+    failed.inc(dropped);
+    return count;
+}
+
+uint32_t ReliableLink::nextTimeout(uint8_t clientId, uint32_t nowUs) const {
+    if (clientId >= CAPACITY || xSemaphoreTake(linkMutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return IDLE;
+    }
+    uint32_t deadline = nextDeadline(peers[clientId], nowUs);
+    xSemaphoreGive(linkMutex);
+    return deadline == IDLE ? IDLE : toDelayMs(deadline, nowUs);
+}
+
+size_t ReliableLink::cancel(uint8_t clientId, Config::MessageType type) {
+    if (clientId >= CAPACITY || xSemaphoreTake(linkMutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return 0;
+    }
+    size_t dropped = 0;
+    for (auto& entry : peers[clientId].entries) {
+        if (entry.used && entry.command.type == type) {
+            entry.used = false;
+            dropped++;
+        }
+    }
+    xSemaphoreGive(linkMutex);
+    superseded.inc(dropped);
+    return dropped;
+}
+
+void ReliableLink::reset(uint8_t clientId) {
+    if (clientId >= CAPACITY || xSemaphoreTake(linkMutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return;
+    }
+    for (auto& entry : peers[clientId].entries) {
+        entry.used = false;
+    }
+    xSemaphoreGive(linkMutex);
+}
+
+uint32_t ReliableLink::getRtoUs(uint8_t clientId) const {
+    return clientId < CAPACITY ? peers[clientId].rtoUs : 0;
+}
+
+uint8_t ReliableLink::getInFlight() const {
+    uint8_t count = 0;
+    for (const auto& peer : peers) {
+        for (const auto& entry : peer.entries) {
+            count += entry.used;
+        }
+    }
+    return count;
+}
+
+// RFC 6298, section 2
+void ReliableLink::addSample(Peer& peer, uint32_t rttUs) {
+    if (!peer.sampled) {
+        peer.srttUs = rttUs;
+        peer.rttvarUs = rttUs / 2;
+        peer.sampled = true;
+    } else {
+        uint32_t error = peer.srttUs > rttUs ? peer.srttUs - rttUs : rttUs - peer.srttUs;
+        peer.rttvarUs = (3 * peer.rttvarUs + error) / 4;
+        peer.srttUs = (7 * peer.srttUs + rttUs) / 8;
+    }
+    uint32_t rto = peer.srttUs + std::max(GRANULARITY_US, 4 * peer.rttvarUs);
+    peer.rtoUs = constrain(rto, MIN_RTO_US, MAX_RTO_US);
+}
+
+uint32_t ReliableLink::nextDeadline(const Peer& peer, uint32_t nowUs) {
+    uint32_t earliest = IDLE;
+    int32_t soonest = INT32_MAX;
+    for (const auto& entry : peer.entries) {
+        if (!entry.used) {
+            continue;
+        }
+        int32_t remaining = static_cast<int32_t>(entry.deadlineUs - nowUs);
+        if (remaining < soonest) {
+            soonest = remaining;
+            earliest = entry.deadlineUs;
+        }
+    }
+    return earliest;
+}
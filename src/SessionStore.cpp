@@ -0,0 +1,333 @@
+#include "SessionStore.h"
+#include <algorithm>
+#include <array>
+#include "Protocol.h"
+
+namespace {
+    using Config::Storage::SEGMENT_RECORDS;
+    using Config::Storage::MAX_SEGMENTS;
+
+    constexpr size_t READ_BATCH = 16;   // Records per flash read
+    constexpr size_t CRC_OFFSET = SessionStore::RECORD_SIZE - 2;
+    constexpr char SEGMENT_SUFFIX[] = ".seg";
+
+    bool matches(const SessionStore::Query& query, const SessionRecord& record) {
+        return (query.clientId < 0 || record.clientId == query.clientId) &&
+               (query.mode < 0 || record.mode == query.mode) &&
+               record.endedAt >= query.from && record.endedAt <= query.to;
+    }
+}
+
+SessionStore::SessionStore(fs::FS& fs, const char* directory)
+    : fs(fs)
+    , directory(directory)
+    , nextSequence(0)
+    , corrupt(0) {
+    pending = xQueueCreate(Config::Storage::SESSION_QUEUE_SIZE, sizeof(SessionRecord));
+    indexMutex = xSemaphoreCreateMutex();
+}
+
+SessionStore::~SessionStore() {
+    if (active) active.close();
+    if (pending) vQueueDelete(pending);
+    if (indexMutex) vSemaphoreDelete(indexMutex);
+}
+
+//   [0]  endedAt        [4]  seed          [8]  durationMs    [12] score
+//   [16] hits           [18] misses        [20] avgReactionMs [22] bestReactionMs
+//   [24] clientId       [25] mode          [26] difficulty    [27] flags
+//   [28] reserved (0)   [30] CRC-16 of [0..29]
+void SessionStore::encode(const SessionRecord& record, uint8_t* out) {
+    Protocol::writeU32(out, record.endedAt);
+    Protocol::writeU32(out + 4, record.seed);
+    Protocol::writeU32(out + 8, record.durationMs);
+    Protocol::writeU32(out + 12, record.score);
+    Protocol::writeU16(out + 16, record.hits);
+    Protocol::writeU16(out + 18, record.misses);
+    Protocol::writeU16(out + 20, record.avgReactionMs);
+    Protocol::writeU16(out + 22, record.bestReactionMs);
+    out[24] = record.clientId;
+    out[25] = record.mode;
+    out[26] = record.difficulty;
+    out[27] = record.flags;
+    Protocol::writeU16(out + 28, 0);
+    Protocol::writeU16(out + CRC_OFFSET, Protocol::crc16(out, CRC_OFFSET));
+}
+
+bool SessionStore::decode(const uint8_t* in, SessionRecord& record) {
+    if (Protocol::readU16(in + CRC_OFFSET) != Protocol::crc16(in, CRC_OFFSET)) {
+        return false;
+    }
+    record.endedAt = Protocol::readU32(in);
+    record.seed = Protocol::readU32(in + 4);
+    record.durationMs = Protocol::readU32(in + 8);
+    record.score = Protocol::readU32(in + 12);
+    record.hits = Protocol::readU16(in + 16);
+    record.misses = Protocol::readU16(in + 18);
+    record.avgReactionMs = Protocol::readU16(in + 20);
+    record.bestReactionMs = Protocol::readU16(in + 22);
+    record.clientId = in[24];
+    record.mode = in[25];
+    record.difficulty = in[26];
+    record.flags = in[27];
+    return true;
+}
+
+SessionStore::Path SessionStore::pathFor(uint32_t firstSequence) const {
+    Path path;
+    snprintf(path.text, sizeof(path.text), "%s/%08lu%s", directory,
+             static_cast<unsigned long>(firstSequence), SEGMENT_SUFFIX);
+    return path;
+}
+
+bool SessionStore::recover() {
+    fs.mkdir(directory);
+
+    std::vector<uint32_t> found;
+    File dir = fs.open(directory);
+    if (dir && dir.isDirectory()) {
+        for (File file = dir.openNextFile(); file; file = dir.openNextFile()) {
+            // Some cores report the full path, some only the name
+            const char* name = file.name();
+            const char* slash = strrchr(name, '/');
+            const char* base = slash ? slash + 1 : name;
+            char* end;
+            unsigned long first = strtoul(base, &end, 10);
+            if (end != base && strcmp(end, SEGMENT_SUFFIX) == 0) {
+                found.push_back(first);
+            }
+        }
+    }
+    std::sort(found.begin(), found.end());
+
+    std::vector<Segment> recovered;
+    for (uint32_t first : found) {
+        Segment segment = {first, 0, false, 0, 0, 0, 0};
+        scan(segment);
+        if (segment.count == 0) {
+            fs.remove(pathFor(first));
+            continue;
+        }
+        recovered.push_back(segment);
+        nextSequence = segment.firstSequence + segment.count;
+    }
+
+    if (xSemaphoreTake(indexMutex, portMAX_DELAY) != pdTRUE) {
+        return false;
+    }
+    segments = recovered;
+    while (segments.size() > MAX_SEGMENTS) {
+        dropOldest();
+    }
+    xSemaphoreGive(indexMutex);
+
+    ready.store(true, std::memory_order_release);
+    return true;
+}
+
+// Counts the valid records from the start of the file; the first bad or
+// partial one ends the segment for good
+bool SessionStore::scan(Segment& segment) {
+    File file = fs.open(pathFor(segment.firstSequence), "r");
+    if (!file) {
+        return false;
+    }
+    size_t stored = file.size() / RECORD_SIZE;
+    uint8_t buffer[RECORD_SIZE * READ_BATCH];
+    bool intact = file.size() % RECORD_SIZE == 0;
+
+    while (segment.count < stored) {
+        size_t batch = std::min<size_t>(stored - segment.count, READ_BATCH);
+        if (file.read(buffer, batch * RECORD_SIZE) != batch * RECORD_SIZE) {
+            intact = false;
+            break;
+        }
+        size_t valid = 0;
+        SessionRecord record;
+        while (valid < batch && decode(buffer + valid * RECORD_SIZE, record)) {
+            addToSummary(segment, record);
+            valid++;
+        }
+        if (valid < batch) {
+            intact = false;
+            break;
+        }
+    }
+    file.close();
+
+    corrupt += stored - segment.count;
+    segment.sealed = !intact || segment.count >= SEGMENT_RECORDS;
+    return intact;
+}
+
+void SessionStore::addToSummary(Segment& segment, const SessionRecord& record) {
+    if (segment.count == 0) {
+        segment.minEndedAt = record.endedAt;
+        segment.maxEndedAt = record.endedAt;
+    } else {
+        segment.minEndedAt = std::min(segment.minEndedAt, record.endedAt);
+        segment.maxEndedAt = std::max(segment.maxEndedAt, record.endedAt);
+    }
+    if (record.clientId < 32) segment.clientMask |= 1UL << record.clientId;
+    if (record.mode < 32) segment.modeMask |= 1UL << record.mode;
+    segment.count++;
+}
+
+bool SessionStore::Segment::mayMatch(const Query& query) const {
+    return (query.clientId < 0 || (query.clientId < 32 && (clientMask >> query.clientId) & 1)) &&
+           (query.mode < 0 || (query.mode < 32 && (modeMask >> query.mode) & 1)) &&
+           maxEndedAt >= query.from && minEndedAt <= query.to;
+}
+
+// Caller holds indexMutex
+void SessionStore::dropOldest() {
+    fs.remove(pathFor(segments.front().firstSequence));
+    segments.erase(segments.begin());
+}
+
+// Continues the newest segment unless it is sealed, else starts one
+bool SessionStore::openSegment() {
+    if (xSemaphoreTake(indexMutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return false;
+    }
+    bool resume = !segments.empty() && !segments.back().sealed;
+    if (!resume) {
+        segments.push_back(Segment{nextSequence, 0, false, 0, 0, 0, 0});
+        while (segments.size() > MAX_SEGMENTS) {
+            dropOldest();
+        }
+    }
+    Path path = pathFor(segments.back().firstSequence);
+    xSemaphoreGive(indexMutex);
+
+    active = fs.open(path, resume ? "a" : "w");
+    return static_cast<bool>(active);
+}
+
+bool SessionStore::append(const SessionRecord& record) {
+    if (xQueueSend(pending, &record, 0) != pdTRUE) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+bool SessionStore::writePending(TickType_t wait) {
+    SessionRecord record;
+    if (xQueueReceive(pending, &record, wait) != pdTRUE) {
+        return false;
+    }
+    if (!active && !openSegment()) {
+        failed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    uint8_t buffer[RECORD_SIZE];
+    encode(record, buffer);
+    // Synced per record: a power cut can only cost the one being written
+    bool stored = active.write(buffer, RECORD_SIZE) == RECORD_SIZE;
+    active.flush();
+
+    if (xSemaphoreTake(indexMutex, portMAX_DELAY) != pdTRUE) {
+        return false;
+    }
+    Segment& segment = segments.back();
+    if (stored) {
+        addToSummary(segment, record);
+        nextSequence++;
+    } else {
+        // The tail may hold part of a record: never append behind it, and
+        // skip a sequence number so the next segment gets a fresh name
+        segment.sealed = true;
+        nextSequence = segment.firstSequence + segment.count + 1;
+    }
+    if (segment.count >= SEGMENT_RECORDS) {
+        segment.sealed = true;
+    }
+    bool sealed = segment.sealed;
+    xSemaphoreGive(indexMutex);
+
+    if (sealed) {
+        active.close();
+    }
+    if (!stored) {
+        failed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    written.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+size_t SessionStore::query(const Query& query, uint32_t& cursor, SessionRecord* out, size_t max) {
+    // Work on a copy so no lock is held while reading flash. It lives on
+    // the stack: an export calls this once per batch.
+    std::array<Segment, MAX_SEGMENTS> snapshot;
+    if (xSemaphoreTake(indexMutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return 0;
+    }
+    size_t segmentCount = std::min<size_t>(segments.size(), MAX_SEGMENTS);
+    std::copy_n(segments.begin(), segmentCount, snapshot.begin());
+    xSemaphoreGive(indexMutex);
+
+    size_t found = 0;
+    uint8_t buffer[RECORD_SIZE * READ_BATCH];
+    for (size_t i = 0; i < segmentCount; ++i) {
+        const Segment& segment = snapshot[i];
+        uint32_t end = segment.firstSequence + segment.count;
+        if (end <= cursor) {
+            continue;
+        }
+        if (!segment.mayMatch(query)) {
+            cursor = end;
+            continue;
+        }
+        File file = fs.open(pathFor(segment.firstSequence), "r");
+        uint32_t sequence = std::max(cursor, segment.firstSequence);
+        if (!file || !file.seek((sequence - segment.firstSequence) * RECORD_SIZE)) {
+            cursor = end;
+            continue;   // Rotated away meanwhile
+        }
+
+        while (sequence < end) {
+            size_t batch = std::min<size_t>(end - sequence, READ_BATCH);
+            if (file.read(buffer, batch * RECORD_SIZE) != batch * RECORD_SIZE) {
+                break;
+            }
+            for (size_t i = 0; i < batch; ++i) {
+                SessionRecord record;
+                bool valid = decode(buffer + i * RECORD_SIZE, record);
+                record.sequence = sequence++;
+                cursor = sequence;
+                if (valid && matches(query, record)) {
+                    out[found++] = record;
+                    if (found == max) {
+                        return found;
+                    }
+                }
+            }
+        }
+        cursor = end;
+    }
+    cursor = UINT32_MAX;
+    return found;
+}
+
+uint32_t SessionStore::getCount() const {
+    uint32_t count = 0;
+    if (xSemaphoreTake(indexMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+        for (const Segment& segment : segments) {
+            count += segment.count;
+        }
+        xSemaphoreGive(indexMutex);
+    }
+    return count;
+}
+
+size_t SessionStore::getSegmentCount() const {
+    size_t count = 0;
+    if (xSemaphoreTake(indexMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+        count = segments.size();
+        xSemaphoreGive(indexMutex);
+    }
+    return count;
+}
@@ -0,0 +1,129 @@
+#include "ShotStats.h"
+#include <math.h>
+
+void ShotStats::reset() {
+    count = 0;
+    mean = 0.0f;
+    m2 = 0.0f;
+    minUs = UINT32_MAX;
+    maxUs = 0;
+    lastRound = 0;
+    histogram.fill(0);
+    rounds.fill(Round{0, 0, 0, 0});
+    heatmap.fill(0);
+}
+
+void ShotStats::record(const Shot& shot) {
+    uint32_t us = shot.reactionUs;
+
+    // Welford's update keeps the variance numerically stable
+    count++;
+    float delta = us - mean;
+    mean += delta / count;
+    m2 += delta * (us - mean);
+
+    if (us < minUs) minUs = us;
+    if (us > maxUs) maxUs = us;
+
+    uint16_t& bucket = histogram[bucketFor(us)];
+    if (bucket < UINT16_MAX) bucket++;
+
+    Round& round = rounds[shot.round % ROUND_HISTORY];
+    if (round.number != shot.round || round.hits == 0) {
+        round = Round{shot.round, 0, 0, UINT32_MAX};
+    }
+    round.hits++;
+    round.sumUs += us;
+    if (us < round.bestUs) round.bestUs = us;
+    if (shot.round > lastRound) lastRound = shot.round;
+
+    if (shot.position < heatmap.size() && heatmap[shot.position] < UINT16_MAX) {
+        heatmap[shot.position]++;
+    }
+}
+
+uint32_t ShotStats::getStdDev() const {
+    return count > 1 ? static_cast<uint32_t>(sqrtf(m2 / (count - 1)) + 0.5f) : 0;
+}
+
+// Midpoint of the bucket holding the given rank, clamped to the observed range
+uint32_t ShotStats::getPercentile(uint8_t percent) const {
+    if (count == 0) {
+        return 0;
+    }
+    uint32_t rank = (static_cast<uint64_t>(count) * percent + 99) / 100;
+    if (rank == 0) rank = 1;
+
+    uint32_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        seen += histogram[i];
+        if (seen >= rank) {
+            return constrain(bucketMidpoint(i), minUs, maxUs);
+        }
+    }
+    return maxUs;
+}
+
+const ShotStats::Round* ShotStats::getRound(uint16_t number) const {
+    const Round& round = rounds[number % ROUND_HISTORY];
+    return (round.hits > 0 && round.number == number) ? &round : nullptr;
+}
+
+// Exponent selects the octave, the next SUB_BUCKET_BITS bits the bucket in it
+size_t ShotStats::bucketFor(uint32_t micros) {
+    if (micros < (1UL << MIN_EXPONENT)) {
+        return 0;
+    }
+    uint8_t exponent = 31 - __builtin_clz(micros);
+    size_t sub = (micros >> (exponent - SUB_BUCKET_BITS)) & ((1 << SUB_BUCKET_BITS) - 1);
+    size_t bucket = 1 + ((exponent - MIN_EXPONENT) << SUB_BUCKET_BITS) + sub;
+    return bucket < BUCKETS ? bucket : BUCKETS - 1;
+}
+
+uint32_t ShotStats::bucketMidpoint(size_t bucket) {
+    if (bucket == 0) {
+        return (1UL << MIN_EXPONENT) / 2;
+    }
+    uint8_t exponent = MIN_EXPONENT + ((bucket - 1) >> SUB_BUCKET_BITS);
+    uint32_t sub = (bucket - 1) & ((1 << SUB_BUCKET_BITS) - 1);
+    uint32_t width = 1UL << (exponent - SUB_BUCKET_BITS);
+    return ((1UL << SUB_BUCKET_BITS) + sub) * width + width / 2;
+}
+
+ShotStatsTable::ShotStatsTable() {
+    for (auto& entry : stats) {
+        entry.reset();
+    }
+    statsMutex = xSemaphoreCreateMutex();
+}
+
+ShotStatsTable::~ShotStatsTable() {
+    if (statsMutex) vSemaphoreDelete(statsMutex);
+}
+
+bool ShotStatsTable::reset(uint8_t id) {
+    if (id >= CAPACITY || xSemaphoreTake(statsMutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return false;
+    }
+    stats[id].reset();
+    xSemaphoreGive(statsMutex);
+    return true;
+}
+
+bool ShotStatsTable::record(uint8_t id, const Shot& shot) {
+    if (id >= CAPACITY || xSemaphoreTake(statsMutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return false;
+    }
+    stats[id].record(shot);
+    xSemaphoreGive(statsMutex);
+    return true;
+}
+
+bool ShotStatsTable::read(uint8_t id, ShotStats& out) const {
+    if (id >= CAPACITY || xSemaphoreTake(statsMutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return false;
+    }
+    out = stats[id];
+    xSemaphoreGive(statsMutex);
+    return true;
+}
@@ -0,0 +1,127 @@
+#include "StaticAssets.h"
+
+namespace StaticAssets {
+
+namespace {
+    constexpr char IMMUTABLE[] = "public, max-age=31536000, immutable";
+    constexpr char REVALIDATE[] = "no-cache";
+    constexpr size_t FIELDS = 5;    // url hash mime size gzipSize
+}
+
+bool Handler::load() {
+    File manifest = fs.open(MANIFEST, "r");
+    if (!manifest) {
+        return false;
+    }
+
+    assets.clear();
+    while (manifest.available()) {
+        String line = manifest.readStringUntil('\n');
+        line.trim();
+
+        String fields[FIELDS];
+        size_t count = 0;
+        int start = 0;
+        while (count < FIELDS && start < static_cast<int>(line.length())) {
+            int end = line.indexOf(' ', start);
+            if (end < 0) end = line.length();
+            fields[count++] = line.substring(start, end);
+            start = end + 1;
+        }
+        if (count < FIELDS || !fields[0].startsWith("/")) {
+            continue;
+        }
+
+        Asset asset;
+        asset.url = fields[0];
+        asset.path = fields[0] + ".gz";
+        asset.version = fields[1];
+        asset.etag = "\"" + fields[1] + "\"";
+        asset.mime = fields[2];
+        asset.size = fields[3].toInt();
+        asset.gzipSize = fields[4].toInt();
+        asset.data = nullptr;
+        assets.push_back(asset);
+    }
+    manifest.close();
+    return !assets.empty();
+}
+
+bool Handler::load(const EmbeddedAsset* table, size_t count) {
+    assets.clear();
+    assets.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        const EmbeddedAsset& entry = table[i];
+        Asset asset;
+        asset.url = entry.url;
+        asset.version = entry.version;
+        asset.etag = "\"" + asset.version + "\"";
+        asset.mime = entry.mime;
+        asset.size = entry.size;
+        asset.gzipSize = entry.gzipSize;
+        asset.data = entry.data;
+        assets.push_back(asset);
+    }
+    return !assets.empty();
+}
+
+// A handful of entries; a linear scan beats anything fancier
+const Asset* Handler::find(const String& url) const {
+    const char* path = url == "/" ? "/index.html" : url.c_str();
+    for (const auto& asset : assets) {
+        if (asset.url == path) {
+            return &asset;
+        }
+    }
+    return nullptr;
+}
+
+bool Handler::canHandle(AsyncWebServerRequest* request) {
+    if (request->method() != HTTP_GET || !find(request->url())) {
+        return false;
+    }
+    request->addInterestingHeader("If-None-Match");
+    return true;
+}
+
+void Handler::handleRequest(AsyncWebServerRequest* request) {
+    const Asset* asset = find(request->url());
+    if (!asset) {
+        request->send(404);
+        return;
+    }
+    requests.fetch_add(1, std::memory_order_relaxed);
+
+    bool versioned = request->hasParam("v") && request->getParam("v")->value() == asset->version;
+    AsyncWebServerResponse* response;
+
+    // Lists and weak validators (W/"...") contain the tag as well
+    if (request->hasHeader("If-None-Match") &&
+        request->getHeader("If-None-Match")->value().indexOf(asset->etag) >= 0) {
+        response = request->beginResponse(304);
+        notModified.fetch_add(1, std::memory_order_relaxed);
+        bytesSaved.fetch_add(asset->size, std::memory_order_relaxed);
+    } else {
+        if (asset->data) {
+            response = request->beginResponse_P(200, asset->mime, asset->data, asset->gzipSize);
+        } else {
+            File file = fs.open(asset->path, "r");
+            if (!file) {
+                request->send(404);
+                return;
+            }
+            response = request->beginResponse(file, asset->path, asset->mime);
+        }
+        response->addHeader("Content-Encoding", "gzip");
+        bytesSent.fetch_add(asset->gzipSize, std::memory_order_relaxed);
+        bytesSaved.fetch_add(asset->size - asset->gzipSize, std::memory_order_relaxed);
+    }
+    response->addHeader("ETag", asset->etag);
+    response->addHeader("Cache-Control", versioned ? IMMUTABLE : REVALIDATE);
+    request->send(response);
+
+    uint32_t none = 0;
+    firstResponseAt.compare_exchange_strong(none, millis(), std::memory_order_relaxed);
+}
+
+}
@@ -0,0 +1,174 @@
+#include "Trace.h"
+
+#ifdef TRACE_ENABLED
+
+#include <esp_ipc.h>
+#include <esp_timer.h>
+
+namespace Trace {
+    namespace {
+        constexpr size_t EVENTS = Config::Trace::EVENTS_PER_CORE;
+        static_assert((EVENTS & (EVENTS - 1)) == 0, "EVENTS_PER_CORE must be a power of two");
+
+        // sequence is 2 * ticket + 1 while written, 2 * ticket + 2 once done
+        struct Slot {
+            std::atomic<uint32_t> sequence{0};
+            std::atomic<uint32_t> start{0};
+            std::atomic<uint32_t> cycles{0};
+            std::atomic<uint32_t> arg{0};
+            std::atomic<uint32_t> tick{0};
+            std::atomic<const char*> name{nullptr};
+        };
+
+        // Only tasks of the owning core write; they may preempt each
+        // other, hence the ticket
+        struct Ring {
+            std::array<Slot, EVENTS> slots;
+            std::atomic<uint32_t> head{0};
+        };
+
+        Ring rings[portNUM_PROCESSORS];
+        std::atomic<uint8_t> paused{0};
+    }
+
+    void IRAM_ATTR record(const char* name, uint32_t startCycles, uint32_t cycles, uint32_t arg) {
+        if (paused.load(std::memory_order_relaxed)) {
+            return;
+        }
+        Ring& ring = rings[xPortGetCoreID()];
+        uint32_t ticket = ring.head.fetch_add(1, std::memory_order_relaxed);
+        Slot& slot = ring.slots[ticket & (EVENTS - 1)];
+
+        slot.sequence.store(ticket * 2 + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.start.store(startCycles, std::memory_order_relaxed);
+        slot.cycles.store(cycles, std::memory_order_relaxed);
+        slot.arg.store(arg, std::memory_order_relaxed);
+        slot.tick.store(xTaskGetTickCount(), std::memory_order_relaxed);
+        slot.name.store(name, std::memory_order_relaxed);
+        slot.sequence.store(ticket * 2 + 2, std::memory_order_release);
+    }
+
+    Exporter::Exporter()
+        : cyclesPerMicro(getCpuFrequencyMhz())
+        , core(0)
+        , ticket(0)
+        , end(0)
+        , started(false)
+        , finished(false)
+        , trackNamed(false)
+        , lineLength(0)
+        , lineOffset(0) {
+        paused.fetch_add(1, std::memory_order_relaxed);
+
+        // Cycle counters are per core and not in step, so each one gets
+        // its own reference point, taken on that core
+        for (uint8_t i = 0; i < portNUM_PROCESSORS; ++i) {
+            if (i == xPortGetCoreID()) {
+                sampleClock(&anchors[i]);
+            } else {
+                esp_ipc_call_blocking(i, sampleClock, &anchors[i]);
+            }
+        }
+    }
+
+    Exporter::~Exporter() {
+        paused.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void Exporter::sampleClock(void* anchor) {
+        Anchor* out = static_cast<Anchor*>(anchor);
+        out->cycles = ESP.getCycleCount();
+        out->micros = esp_timer_get_time();
+        out->tick = xTaskGetTickCount();
+    }
+
+    size_t Exporter::fill(uint8_t* buffer, size_t maxLen) {
+        size_t written = 0;
+        while (written < maxLen) {
+            if (lineOffset == lineLength && !nextLine()) {
+                break;
+            }
+            size_t chunk = std::min(lineLength - lineOffset, maxLen - written);
+            memcpy(buffer + written, line + lineOffset, chunk);
+            written += chunk;
+            lineOffset += chunk;
+        }
+        return written;
+    }
+
+    bool Exporter::nextLine() {
+        lineOffset = 0;
+        lineLength = 0;
+        if (finished) {
+            return false;
+        }
+        if (!started) {
+            started = true;
+            lineLength = snprintf(line, sizeof(line), "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+            return true;
+        }
+
+        while (core < portNUM_PROCESSORS) {
+            if (!trackNamed) {
+                // Start of a core: name its track, then its retained events
+                trackNamed = true;
+                uint32_t head = rings[core].head.load(std::memory_order_acquire);
+                ticket = head > EVENTS ? head - EVENTS : 0;
+                end = head;
+                lineLength = snprintf(line, sizeof(line),
+                    "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"core %u\"}}",
+                    core ? ",\n" : "", core, core);
+                return true;
+            }
+            while (ticket != end) {
+                if (formatEvent(ticket++)) {
+                    return true;
+                }
+            }
+            core++;
+            trackNamed = false;
+        }
+
+        finished = true;
+        lineLength = snprintf(line, sizeof(line), "\n]}\n");
+        return true;
+    }
+
+    // One event as ",\n{...}", or false if it is torn, overwritten or too old
+    bool Exporter::formatEvent(uint32_t eventTicket) {
+        const Slot& slot = rings[core].slots[eventTicket & (EVENTS - 1)];
+        uint32_t done = eventTicket * 2 + 2;
+        if (slot.sequence.load(std::memory_order_acquire) != done) {
+            return false;
+        }
+        uint32_t start = slot.start.load(std::memory_order_relaxed);
+        uint32_t cycles = slot.cycles.load(std::memory_order_relaxed);
+        uint32_t arg = slot.arg.load(std::memory_order_relaxed);
+        TickType_t tick = slot.tick.load(std::memory_order_relaxed);
+        const char* name = slot.name.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != done || !name) {
+            return false;
+        }
+
+        const Anchor& anchor = anchors[core];
+        if (anchor.tick - tick > pdMS_TO_TICKS(Config::Trace::MAX_EVENT_AGE)) {
+            return false;
+        }
+        double ts = anchor.micros - (anchor.cycles - start) / cyclesPerMicro;
+        if (cycles == INSTANT) {
+            lineLength = snprintf(line, sizeof(line),
+                ",\n{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"args\":{\"arg\":%lu}}",
+                name, core, ts, static_cast<unsigned long>(arg));
+        } else {
+            lineLength = snprintf(line, sizeof(line),
+                ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"arg\":%lu}}",
+                name, core, ts, cycles / cyclesPerMicro, static_cast<unsigned long>(arg));
+        }
+        lineLength = std::min(lineLength, sizeof(line) - 1);
+        return true;
+    }
+}
+
+#endif
@@ -0,0 +1,210 @@
+#include "TrainingModes.h"
+
+namespace TrainingModes {
+
+namespace {
+    constexpr uint8_t MATRIX_SIZE = 8;
+
+    struct DifficultyProfile {
+        uint8_t size;               // Base target size in LEDs
+        uint8_t jitterPercent;      // showTime variation around reactTime
+        uint8_t noShootPercent;
+        uint8_t distractorPercent;
+        uint16_t minDelay;          // ms
+        uint16_t maxDelay;          // ms
+    };
+
+    constexpr DifficultyProfile DIFFICULTIES[] = {
+        {3, 10, 10, 10, 1000, 2500},    // EASY
+        {2, 20, 20, 20,  600, 2000},    // MEDIUM
+        {1, 30, 30, 35,  300, 1500}     // HARD
+    };
+
+    enum Trait : uint16_t {
+        RANDOM_DELAY = 0x001,
+        JITTER       = 0x002,
+        NO_SHOOT     = 0x004,
+        MOVING       = 0x008,
+        DISTRACTORS  = 0x010,   // Only with stressorsEnabled
+        SHRINKING    = 0x020,   // Size decreases over the session
+        ACCELERATING = 0x040,   // showTime decreases over the session
+        DIMMED       = 0x080,
+        SMALL        = 0x100,   // Always 1 LED
+        BURST        = 0x200    // Groups of targets without pause
+    };
+
+    constexpr uint16_t MODE_TRAITS[] = {
+        0,                                          // BASIC_TRAINING
+        RANDOM_DELAY | JITTER,                      // REACTION_TRAINING
+        RANDOM_DELAY | NO_SHOOT,                    // COLOR_CODED
+        MOVING,                                     // MOVING_TARGET
+        RANDOM_DELAY | JITTER | DISTRACTORS,        // STRESS_TRAINING
+        ACCELERATING,                               // TIMED_TRAINING
+        SHRINKING,                                  // ENDURANCE
+        RANDOM_DELAY,                               // TEAM_TRAINING
+        RANDOM_DELAY | JITTER,                      // COMPETITION
+        JITTER | SMALL,                             // SKILL_FOCUS
+        RANDOM_DELAY | JITTER | DISTRACTORS | ACCELERATING, // ADRENALINE
+        RANDOM_DELAY | DIMMED,                      // NIGHT_VISION
+        SMALL,                                      // DISTANCE
+        RANDOM_DELAY | BURST,                       // MULTI_TARGET
+        RANDOM_DELAY | NO_SHOOT | MOVING            // HOSTAGE_RESCUE
+    };
+
+    // floor(4 * sin(k * pi / 8) + 4), clamped to the matrix
+    constexpr uint8_t WAVE_ROWS[16] = {4, 5, 6, 7, 7, 7, 6, 5, 4, 2, 1, 0, 0, 0, 1, 2};
+
+    // round(64 * sin(k * 2 * pi / 32))
+    constexpr int8_t SINE32[32] = {
+          0,  12,  24,  36,  45,  53,  59,  63,  64,  63,  59,  53,  45,  36,  24,  12,
+          0, -12, -24, -36, -45, -53, -59, -63, -64, -63, -59, -53, -45, -36, -24, -12
+    };
+
+    uint32_t rotl(uint32_t x, int k) {
+        return (x << k) | (x >> (32 - k));
+    }
+
+    uint8_t clampTo(int32_t value, uint8_t size) {
+        int32_t limit = MATRIX_SIZE - size;
+        return value < 0 ? 0 : (value > limit ? limit : value);
+    }
+}
+
+TargetSequence::TargetSequence(const TrainingConfig& config)
+    : mode(config.mode)
+    , difficulty(config.difficulty)
+    , pattern(static_cast<Pattern>(config.modeConfig.targetPattern))
+    , count(config.targetCount)
+    , index(0)
+    , reactTime(config.reactTime)
+    , stressors(config.stressorsEnabled) {
+    // SplitMix32 expands the seed; it never yields an all-zero state
+    uint32_t x = config.seed;
+    for (auto& word : state) {
+        uint32_t z = (x += 0x9E3779B9);
+        z = (z ^ (z >> 16)) * 0x85EBCA6B;
+        z = (z ^ (z >> 13)) * 0xC2B2AE35;
+        word = z ^ (z >> 16);
+    }
+}
+
+// xoshiro128**
+uint32_t TargetSequence::nextRandom() {
+    uint32_t result = rotl(state[1] * 5, 7) * 9;
+    uint32_t t = state[1] << 9;
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= t;
+    state[3] = rotl(state[3], 11);
+    return result;
+}
+
+// Multiply-shift; the bias is below 2^-24 for the small bounds used here
+uint32_t TargetSequence::nextBelow(uint32_t bound) {
+    return static_cast<uint32_t>((static_cast<uint64_t>(nextRandom()) * bound) >> 32);
+}
+
+Target TargetSequence::next() {
+    size_t modeIndex = static_cast<size_t>(mode);
+    size_t difficultyIndex = static_cast<size_t>(difficulty);
+    uint16_t traits = modeIndex < sizeof(MODE_TRAITS) / sizeof(MODE_TRAITS[0]) ? MODE_TRAITS[modeIndex] : 0;
+    const DifficultyProfile& profile = DIFFICULTIES[difficultyIndex < 3 ? difficultyIndex : 1];
+    uint16_t total = count ? count : 1;
+
+    Target target = {};
+    target.color = COLOR_GREEN;
+
+    target.size = profile.size;
+    if (traits & SMALL) {
+        target.size = 1;
+    } else if (traits & SHRINKING) {
+        uint8_t shrink = static_cast<uint32_t>(index) * profile.size / total;
+        target.size = profile.size > shrink ? profile.size - shrink : 1;
+    }
+    place(target);
+
+    target.showTime = reactTime;
+    if (traits & ACCELERATING) {
+        target.showTime -= static_cast<uint32_t>(reactTime) * index / (2 * total);
+    }
+    if (traits & JITTER) {
+        int32_t jitter = static_cast<int32_t>(nextBelow(2 * profile.jitterPercent + 1)) - profile.jitterPercent;
+        target.showTime += static_cast<int32_t>(target.showTime) * jitter / 100;
+    }
+
+    if (traits & RANDOM_DELAY) {
+        target.delay = profile.minDelay + nextBelow(profile.maxDelay - profile.minDelay + 1);
+    } else {
+        target.delay = (profile.minDelay + profile.maxDelay) / 2;
+    }
+    // MULTI_TARGET: 2-4 targets per group depending on difficulty
+    if ((traits & BURST) && index % (2 + difficultyIndex) != 0) {
+        target.delay = 0;
+    }
+
+    if ((traits & NO_SHOOT) && nextBelow(100) < profile.noShootPercent) {
+        target.color = COLOR_RED;
+        target.flags |= TARGET_NO_SHOOT;
+    } else if (mode == Mode::COLOR_CODED) {
+        constexpr uint8_t shootColors[] = {COLOR_GREEN, COLOR_BLUE, COLOR_YELLOW};
+        target.color = shootColors[nextBelow(3)];
+    }
+    if (traits & MOVING) {
+        target.flags |= TARGET_MOVING;
+        target.direction = nextBelow(8);
+    }
+    if ((traits & DISTRACTORS) && stressors && nextBelow(100) < profile.distractorPercent) {
+        target.flags |= TARGET_DISTRACTOR;
+    }
+    if (traits & DIMMED) {
+        target.flags |= TARGET_DIMMED;
+    }
+
+    index++;
+    return target;
+}
+
+void TargetSequence::place(Target& target) {
+    uint16_t total = count ? count : 1;
+    switch (pattern) {
+        case Pattern::SEQUENCE:
+            target.x = clampTo(index % MATRIX_SIZE, target.size);
+            target.y = clampTo((index / MATRIX_SIZE) % MATRIX_SIZE, target.size);
+            break;
+
+        case Pattern::WAVE:
+            target.x = clampTo(index % MATRIX_SIZE, target.size);
+            target.y = clampTo(WAVE_ROWS[index % 16], target.size);
+            break;
+
+        case Pattern::SPIRAL: {
+            // One turn over the session, radius growing to half the matrix
+            uint8_t angle = static_cast<uint32_t>(index) * 32 / total;
+            int32_t radius = static_cast<int32_t>(index) * (MATRIX_SIZE / 2);
+            int32_t cosine = SINE32[(angle + 8) % 32];
+            int32_t sine = SINE32[angle % 32];
+            target.x = clampTo(MATRIX_SIZE / 2 + cosine * radius / (64 * total), target.size);
+            target.y = clampTo(MATRIX_SIZE / 2 + sine * radius / (64 * total), target.size);
+            break;
+        }
+
+        case Pattern::RANDOM:
+        default:
+            target.x = nextBelow(MATRIX_SIZE - target.size + 1);
+            target.y = nextBelow(MATRIX_SIZE - target.size + 1);
+            break;
+    }
+}
+
+// Same weighting as the dashboard: 100 per hit, 5 per accuracy percent,
+// up to 200 for reactions faster than 2 s
+uint32_t TrainingManager::calculateScore(const TrainingResult& result) {
+    uint32_t shots = static_cast<uint32_t>(result.hits) + result.misses;
+    uint32_t accuracy = shots ? result.hits * 100U / shots : 0;
+    uint32_t reactionBonus = result.avgReactionTime < 2000 ? (2000 - result.avgReactionTime) / 10 : 0;
+    return result.hits * 100U + accuracy * 5 + reactionBonus;
+}
+
+}
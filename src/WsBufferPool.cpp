@@ -0,0 +1,69 @@
+#include "WsBufferPool.h"
+
+WsBufferPool::WsBufferPool()
+    : allocations(0)
+    , reuses(0)
+    , exhausted(0) {
+    poolMutex = xSemaphoreCreateMutex();
+}
+
+WsBufferPool::~WsBufferPool() {
+    if (poolMutex) vSemaphoreDelete(poolMutex);
+}
+
+// Only the pool's own reference is left. use_count() reads relaxed; the
+// fence pairs it with the release of the last message's reference, so
+// async_tcp is done with the bytes before they are overwritten.
+bool WsBufferPool::isIdle(const AsyncWebSocketSharedBuffer& buffer) const {
+    if (buffer.use_count() != 1) {
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return true;
+}
+
+AsyncWebSocketSharedBuffer WsBufferPool::acquire(size_t size) {
+    if (!Metrics::take(poolMutex, pdMS_TO_TICKS(100), lockWait)) {
+        exhausted.fetch_add(1, std::memory_order_relaxed);
+        return std::make_shared<std::vector<uint8_t>>(size);
+    }
+
+    // Prefer the smallest idle buffer that fits, then an empty slot, then
+    // grow whichever idle buffer is left.
+    AsyncWebSocketSharedBuffer* fit = nullptr;
+    AsyncWebSocketSharedBuffer* empty = nullptr;
+    AsyncWebSocketSharedBuffer* idle = nullptr;
+    for (auto& slot : slots) {
+        if (!slot) {
+            if (!empty) empty = &slot;
+        } else if (isIdle(slot)) {
+            if (slot->capacity() >= size) {
+                if (!fit || slot->capacity() < (*fit)->capacity()) fit = &slot;
+            } else if (!idle) {
+                idle = &slot;
+            }
+        }
+    }
+
+    AsyncWebSocketSharedBuffer buffer;
+    if (fit) {
+        (*fit)->resize(size);
+        buffer = *fit;
+        reuses.fetch_add(1, std::memory_order_relaxed);
+    } else if (empty) {
+        *empty = std::make_shared<std::vector<uint8_t>>(size);
+        buffer = *empty;
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    } else if (idle) {
+        (*idle)->resize(size);
+        buffer = *idle;
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    xSemaphoreGive(poolMutex);
+
+    if (!buffer) {
+        exhausted.fetch_add(1, std::memory_order_relaxed);
+        buffer = std::make_shared<std::vector<uint8_t>>(size);
+    }
+    return buffer;
+}
@@ -33,12 +33,14 @@ export const useMultipleTraining = (clientIds) => {
     };
 
     // Event Listener registrieren
+    trainingService.on('sessionStarted', handleSessionUpdate);
     trainingService.on('sessionUpdated', handleSessionUpdate);
     trainingService.on('sessionCompleted', handleSessionComplete);
     trainingService.on('sessionError', handleError);
 
     // Cleanup
     return () => {
+      trainingService.off('sessionStarted', handleSessionUpdate);
       trainingService.off('sessionUpdated', handleSessionUpdate);
       trainingService.off('sessionCompleted', handleSessionComplete);
       trainingService.off('sessionError', handleError);
@@ -55,19 +57,9 @@ export const useMultipleTraining = (clientIds) => {
     setError(null);
 
     try {
-      const results = await Promise.all(
-        Array.from(clientIds).map(clientId =>
-          trainingService.startTraining(clientId, config)
-        )
-      );
-
-      // Überprüfen ob alle Trainings erfolgreich gestartet wurden
-      const failedStarts = results.filter(result => !result.success);
-      if (failedStarts.length > 0) {
-        throw new Error(`${failedStarts.length} Training(s) konnten nicht gestartet werden`);
-      }
-
-      return results;
+      // Ein Befehl für alle: die Ziele starten gleichzeitig. Ziele, die der
+      // Host nicht erreicht, kommen einzeln über sessionError zurück.
+      return await trainingService.startTrainingGroup(Array.from(clientIds), config);
     } catch (err) {
       setError(err.message);
       throw err;
@@ -82,20 +74,7 @@ export const useMultipleTraining = (clientIds) => {
     setError(null);
 
     try {
-      const activeClientIds = Array.from(sessions.keys());
-      const results = await Promise.all(
-        activeClientIds.map(clientId =>
-          trainingService.stopTraining(clientId)
-        )
-      );
-
-      // Überprüfen ob alle Trainings erfolgreich gestoppt wurden
-      const failedStops = results.filter(result => !result.success);
-      if (failedStops.length > 0) {
-        throw new Error(`${failedStops.length} Training(s) konnten nicht gestoppt werden`);
-      }
-
-      return results;
+      await trainingService.stopTrainingGroup(Array.from(sessions.keys()));
     } catch (err) {
       setError(err.message);
       throw err;
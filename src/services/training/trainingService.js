@@ -17,7 +17,7 @@ class TrainingService {
    * Initialisiert die WebSocket Event Handler
    */
   setupWebSocketHandlers() {
-    wsService.on('trainingStarted', this.handleTrainingStarted.bind(this));
+    wsService.on('training_started', this.handleTrainingStarted.bind(this));
     wsService.on('trainingUpdate', this.handleTrainingUpdate.bind(this));
     wsService.on('trainingCompleted', this.handleTrainingCompleted.bind(this));
     wsService.on('trainingError', this.handleTrainingError.bind(this));
@@ -27,25 +27,36 @@ class TrainingService {
    * Startet eine neue Trainingssession
    * @param {number} clientId - Die Client ID
    * @param {TrainingConfig} config - Die Trainingskonfiguration
-   * @returns {Promise<void>}
+   * @returns {Promise<TrainingSession>} Die gestartete Session
    */
   async startTraining(clientId, config) {
-    // Validiere Konfiguration
+    const [session] = await this.startTrainingGroup([clientId], config);
+    return session;
+  }
+
+  /**
+   * Startet eine gemeinsame Session für mehrere Clients. Der Host startet
+   * alle Ziele mit einem Paket und demselben Seed; die Ziele erzeugen ihre
+   * Zielfolge daraus selbst.
+   * @param {Array<number>} clientIds - Die Client IDs
+   * @param {TrainingConfig} config - Die Trainingskonfiguration
+   * @returns {Promise<Array<TrainingSession>>} Die gestarteten Sessions
+   */
+  async startTrainingGroup(clientIds, config) {
     const validation = TrainingUtils.validateTrainingConfig(config);
     if (!validation.isValid) {
       throw new Error(`Ungültige Trainingskonfiguration: ${validation.errors.join(', ')}`);
     }
 
-    // Generiere Zielpattern
-    const targets = TrainingUtils.generateTargetPattern(config);
-
-    // Erstelle neue Session
-    const session = {
-      id: `${clientId}-${Date.now()}`,
+    // Mit dem Seed lässt sich die Session später wiederholen
+    const seed = config.seed || randomSeed();
+    const startTime = Date.now();
+    const sessions = clientIds.map(clientId => ({
+      id: `${clientId}-${startTime}`,
       clientId,
       config,
-      targets,
-      startTime: Date.now(),
+      seed,
+      startTime,
       status: SessionStatus.PENDING,
       stats: {
         hits: 0,
@@ -54,26 +65,44 @@ class TrainingService {
         avgReactionTime: 0,
         score: 0
       }
-    };
+    }));
+    sessions.forEach(session => this.activeSessions.set(session.clientId, session));
+
+    if (!wsService.sendCommand('startTraining', { clientIds, seed, config })) {
+      clientIds.forEach(clientId => this.activeSessions.delete(clientId));
+      throw new Error('Fehler beim Starten des Trainings: Keine Verbindung zum Host');
+    }
 
-    // Speichere Session
-    this.activeSessions.set(clientId, session);
+    sessions.forEach(session => this.notifyListeners('sessionStarted', session));
+    return sessions;
+  }
 
-    // Sende Startbefehl an Client
-    try {
-      await wsService.send('startTraining', {
-        clientId,
-        config,
-        targets,
-        sessionId: session.id
-      });
-    } catch (error) {
-      this.activeSessions.delete(clientId);
-      throw new Error(`Fehler beim Starten des Trainings: ${error.message}`);
+  /**
+   * Stoppt die Sessions mehrerer Clients mit einem Befehl
+   * @param {Array<number>} clientIds - Die Client IDs
+   * @returns {Promise<void>}
+   */
+  async stopTrainingGroup(clientIds) {
+    const sessions = clientIds
+      .map(clientId => this.activeSessions.get(clientId))
+      .filter(Boolean);
+    if (sessions.length === 0) {
+      throw new Error('Keine aktive Trainingssession gefunden');
+    }
+
+    if (!wsService.sendCommand('stopTraining', { clientIds: sessions.map(session => session.clientId) })) {
+      throw new Error('Fehler beim Stoppen des Trainings: Keine Verbindung zum Host');
     }
 
-    // Benachrichtige Listener
-    this.notifyListeners('sessionStarted', session);
+    const endTime = Date.now();
+    sessions.forEach(session => {
+      session.status = SessionStatus.COMPLETED;
+      session.endTime = endTime;
+      session.stats = TrainingUtils.calculateTrainingStats(session);
+      this.sessionHistory.set(session.id, session);
+      this.activeSessions.delete(session.clientId);
+      this.notifyListeners('sessionCompleted', session);
+    });
   }
 
   /**
@@ -88,8 +117,10 @@ class TrainingService {
     }
 
     try {
-      await wsService.send('stopTraining', { clientId, sessionId: session.id });
-      
+      if (!wsService.sendCommand('stopTraining', { clientId })) {
+        throw new Error('Keine Verbindung zum Host');
+      }
+
       session.status = SessionStatus.COMPLETED;
       session.endTime = Date.now();
       
@@ -120,7 +151,9 @@ class TrainingService {
     }
 
     try {
-      await wsService.send('pauseTraining', { clientId, sessionId: session.id });
+      if (!wsService.sendCommand('pauseTraining', { clientId })) {
+        throw new Error('Keine Verbindung zum Host');
+      }
       session.status = SessionStatus.PAUSED;
       this.notifyListeners('sessionPaused', session);
     } catch (error) {
@@ -140,7 +173,9 @@ class TrainingService {
     }
 
     try {
-      await wsService.send('resumeTraining', { clientId, sessionId: session.id });
+      if (!wsService.sendCommand('resumeTraining', { clientId })) {
+        throw new Error('Keine Verbindung zum Host');
+      }
       session.status = SessionStatus.RUNNING;
       this.notifyListeners('sessionResumed', session);
     } catch (error) {
@@ -153,11 +188,23 @@ class TrainingService {
    * @param {Object} data - Event Daten
    */
   handleTrainingStarted(data) {
-    const session = this.activeSessions.get(data.clientId);
-    if (session) {
-      session.status = SessionStatus.RUNNING;
-      this.notifyListeners('sessionStarted', session);
-    }
+    // Der Host meldet alle gestarteten Ziele eines Befehls zusammen; wer
+    // mit demselben Seed noch wartet, wurde nicht erreicht
+    const started = new Set(data.clientIds || [data.clientId]);
+    const pending = Array.from(this.activeSessions.values())
+      .filter(session => session.status === SessionStatus.PENDING && session.seed === data.seed);
+
+    pending.forEach(session => {
+      if (started.has(session.clientId)) {
+        session.status = SessionStatus.RUNNING;
+        this.notifyListeners('sessionStarted', session);
+      } else {
+        this.handleTrainingError({
+          clientId: session.clientId,
+          error: `Training für Client ${session.clientId} konnte nicht gestartet werden`
+        });
+      }
+    });
   }
 
 /**
@@ -384,5 +431,10 @@ function average(values) {
   return values.reduce((sum, val) => sum + val, 0) / values.length;
 }
 
+// Seed für die Zielfolge; 0 hieße für den Host "selbst wählen"
+function randomSeed() {
+  return crypto.getRandomValues(new Uint32Array(1))[0] || 1;
+}
+
 // Exportiere Singleton-Instanz
 export const trainingService = new TrainingService();
@@ -96,64 +96,6 @@ import {
     return Math.round(score);
   };
   
-  /**
-   * Generiert ein Trainingsmuster basierend auf der Konfiguration
-   * @param {TrainingConfig} config - Die Trainingskonfiguration
-   * @returns {Array} Array von Zielpositionen
-   */
-  export const generateTargetPattern = (config) => {
-    const targets = [];
-    const matrixSize = 8; // 8x8 LED Matrix
-  
-    for (let i = 0; i < config.targetCount; i++) {
-      let target = {
-        id: i,
-        x: 0,
-        y: 0,
-        duration: config.reactTime,
-        size: Math.max(1, Math.round(2 * DifficultyModifiers[config.difficulty].targetSize))
-      };
-  
-      switch (config.targetPattern) {
-        case 'sequence':
-          target.x = (i % matrixSize);
-          target.y = Math.floor(i / matrixSize) % matrixSize;
-          break;
-  
-        case 'wave':
-          target.x = i % matrixSize;
-          target.y = Math.floor(Math.sin((i / matrixSize) * Math.PI) * (matrixSize / 2) + (matrixSize / 2));
-          break;
-  
-        case 'spiral':
-          const angle = (i / config.targetCount) * 2 * Math.PI;
-          const radius = ((i / config.targetCount) * matrixSize / 2);
-          target.x = Math.floor(Math.cos(angle) * radius + matrixSize / 2);
-          target.y = Math.floor(Math.sin(angle) * radius + matrixSize / 2);
-          break;
-  
-        case 'random':
-        default:
-          target.x = Math.floor(Math.random() * matrixSize);
-          target.y = Math.floor(Math.random() * matrixSize);
-          break;
-      }
-  
-      // Bewegungsmuster hinzufügen
-      if (config.movementPattern !== 'static') {
-        target.movement = {
-          pattern: config.movementPattern,
-          speed: 1 + (config.difficulty === 'hard' ? 1 : 0),
-          range: Math.floor(matrixSize / 4)
-        };
-      }
-  
-      targets.push(target);
-    }
-  
-    return targets;
-  };
-  
   /**
    * Analysiert eine Trainingssession und gibt Verbesserungsvorschläge
    * @param {TrainingSession} session - Die zu analysierende Session
@@ -420,7 +362,6 @@ export const analyzePerformanceDropoff = (session) => {
     generateTrainingConfig,
     calculateTrainingStats,
     calculateScore,
-    generateTargetPattern,
     analyzeTrainingSession,
     generateSessionSummary,
     validateTrainingConfig,
@@ -62,14 +62,22 @@ class WebSocketService {
   }
 
   send(type, payload) {
+    return this.sendMessage({ type, ...payload });
+  }
+
+  // Befehle an den Host: der Host wertet das Feld "command" aus
+  sendCommand(command, payload) {
+    return this.sendMessage({ command, ...payload });
+  }
+
+  sendMessage(message) {
     if (!this.connected) {
       console.warn('WebSocket nicht verbunden. Nachricht kann nicht gesendet werden.');
       return false;
     }
 
     try {
-      const message = JSON.stringify({ type, ...payload });
-      this.ws.send(message);
+      this.ws.send(JSON.stringify(message));
       return true;
     } catch (error) {
       console.error('Fehler beim Senden der WebSocket Nachricht:', error);
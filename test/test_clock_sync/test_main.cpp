@@ -0,0 +1,184 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <algorithm>
+#include "ClockSync.h"
+#include "config.h"
+
+namespace {
+    constexpr uint32_t SYNC_INTERVAL_US = Config::Tasks::TIME_SYNC_INTERVAL * 1000UL;
+    constexpr uint32_t REACTION_US = 350000;    // Typical hit reaction time
+
+    // Deterministic noise so a failure reproduces
+    struct Random {
+        uint32_t state;
+        uint32_t next() {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return state;
+        }
+        uint32_t below(uint32_t limit) { return next() % limit; }
+    };
+
+    // One target clock against the host and the WiFi path between them.
+    // Each direction gets its own jitter; some samples also queue on one
+    // side only, which is the asymmetry the delay filter has to catch.
+    struct Link {
+        uint32_t offsetUs;          // Target clock at host time 0
+        int32_t driftPpm;
+        uint32_t baseDelayUs;       // One way
+        uint32_t jitterUs;          // Per direction, uniform
+        uint8_t spikePercent;       // Samples with one-sided queueing
+        uint32_t spikeUs;           // Up to this much extra
+        Random random;
+
+        // Host time runs as 64 bits so the target's drift stays exact
+        // across the 32-bit wrap
+        uint32_t targetTime(uint64_t hostUs) const {
+            int64_t drift = static_cast<int64_t>(hostUs) * driftPpm / 1000000;
+            return offsetUs + static_cast<uint32_t>(hostUs + drift);
+        }
+
+        uint32_t oneWay() {
+            uint32_t delay = baseDelayUs + (jitterUs ? random.below(jitterUs) : 0);
+            if (spikePercent && random.below(100) < spikePercent) {
+                delay += random.below(spikeUs);
+            }
+            return delay;
+        }
+
+        // Runs one exchange starting at hostUs and feeds it to the estimate
+        bool exchange(ClockSync::Estimate& estimate, uint64_t hostUs) {
+            uint64_t arrive = hostUs + oneWay();
+            uint64_t reply = arrive + 50 + random.below(250);
+            uint64_t back = reply + oneWay();
+            return ClockSync::addSample(estimate, static_cast<uint32_t>(hostUs),
+                                        targetTime(arrive), targetTime(reply),
+                                        static_cast<uint32_t>(back));
+        }
+    };
+
+    // Error of mapping the target's clock at hostUs back onto the host
+    int32_t offsetError(const ClockSync::Estimate& estimate, const Link& link, uint64_t hostUs) {
+        uint32_t mapped = ClockSync::toHostTime(estimate, link.targetTime(hostUs));
+        return static_cast<int32_t>(mapped - static_cast<uint32_t>(hostUs));
+    }
+
+    // Error of a reaction time measured on the target clock
+    int32_t reactionError(const ClockSync::Estimate& estimate, const Link& link, uint64_t hostUs) {
+        uint32_t measured = ClockSync::toHostDuration(estimate, link.targetTime(hostUs),
+                                                      link.targetTime(hostUs + REACTION_US));
+        return static_cast<int32_t>(measured - REACTION_US);
+    }
+
+    struct Run {
+        int32_t maxOffsetError;     // After warmup
+        int32_t maxReactionError;   // Once the drift baseline has settled
+        uint32_t accepted;
+        uint32_t rejected;
+    };
+
+    Run simulate(Link& link, uint64_t startUs, uint32_t seconds) {
+        ClockSync::Estimate estimate = {};
+        Run run = {0, 0, 0, 0};
+        uint32_t rounds = seconds * 1000000ULL / SYNC_INTERVAL_US;
+        for (uint32_t i = 0; i < rounds; ++i) {
+            uint64_t hostUs = startUs + static_cast<uint64_t>(i) * SYNC_INTERVAL_US;
+            if (link.exchange(estimate, hostUs)) {
+                run.accepted++;
+            } else {
+                run.rejected++;
+            }
+
+            // Hits land between probes
+            uint64_t hitUs = hostUs + SYNC_INTERVAL_US / 2;
+            if (i >= 20) {
+                int32_t error = abs(offsetError(estimate, link, hitUs));
+                run.maxOffsetError = std::max(run.maxOffsetError, error);
+            }
+            if (i >= 240) {
+                int32_t error = abs(reactionError(estimate, link, hitUs));
+                run.maxReactionError = std::max(run.maxReactionError, error);
+            }
+        }
+        return run;
+    }
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_exact_without_jitter(void) {
+    Link link = {0x12345678, 0, 1500, 0, 0, 0, {1}};
+    Run run = simulate(link, 0, 30);
+    TEST_ASSERT_LESS_OR_EQUAL(1, run.maxOffsetError);
+    TEST_ASSERT_EQUAL_UINT32(0, run.rejected);
+}
+
+void test_offset_bounded_under_jitter(void) {
+    Link link = {0x9ABCDEF0, 0, 1500, 800, 0, 0, {7}};
+    Run run = simulate(link, 5000000, 120);
+    // Half the jitter is the worst one sample can be off; the filter
+    // averages well inside that
+    TEST_ASSERT_LESS_OR_EQUAL(250, run.maxOffsetError);
+}
+
+void test_one_sided_queueing_rejected(void) {
+    Link link = {0x00C0FFEE, 0, 1500, 400, 15, 20000, {42}};
+    Run run = simulate(link, 0, 120);
+    TEST_ASSERT_GREATER_THAN(0, run.rejected);
+    // Without the delay filter a 20 ms spike would move the offset by up
+    // to 10 ms
+    TEST_ASSERT_LESS_OR_EQUAL(400, run.maxOffsetError);
+}
+
+void test_drift_tracked(void) {
+    for (int32_t ppm : {-40, -5, 25, 40}) {
+        Link link = {0x40000000, ppm, 1500, 600, 5, 10000, {static_cast<uint32_t>(ppm + 100)}};
+        Run run = simulate(link, 0, 180);
+        // 40 ppm over the 500 ms between probes is 20 us that the
+        // drift estimate has to carry
+        TEST_ASSERT_LESS_OR_EQUAL(300, run.maxOffsetError);
+        // Uncorrected, 40 ppm of a 350 ms reaction is 14 us; the drift
+        // estimate has to remove most of it
+        TEST_ASSERT_LESS_OR_EQUAL(5, run.maxReactionError);
+    }
+}
+
+void test_host_and_target_wraparound(void) {
+    // Host micros() wraps after 71.6 minutes; start just before it with a
+    // target clock that wraps at a different moment
+    Link link = {0xFFFF0000, 30, 1500, 600, 5, 10000, {99}};
+    Run run = simulate(link, 0xFFFFFFFFULL - 60000000ULL, 180);
+    TEST_ASSERT_LESS_OR_EQUAL(300, run.maxOffsetError);
+    TEST_ASSERT_LESS_OR_EQUAL(5, run.maxReactionError);
+}
+
+void test_synced_after_min_samples(void) {
+    Link link = {0, 0, 1500, 0, 0, 0, {1}};
+    ClockSync::Estimate estimate = {};
+    for (int i = 0; i < 3; ++i) {
+        link.exchange(estimate, static_cast<uint64_t>(i) * SYNC_INTERVAL_US);
+        TEST_ASSERT_FALSE(ClockSync::isSynced(estimate));
+    }
+    link.exchange(estimate, 3ULL * SYNC_INTERVAL_US);
+    TEST_ASSERT_TRUE(ClockSync::isSynced(estimate));
+}
+
+void test_negative_duration_is_zero(void) {
+    ClockSync::Estimate estimate = {};
+    TEST_ASSERT_EQUAL_UINT32(0, ClockSync::toHostDuration(estimate, 2000, 1000));
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_exact_without_jitter);
+    RUN_TEST(test_offset_bounded_under_jitter);
+    RUN_TEST(test_one_sided_queueing_rejected);
+    RUN_TEST(test_drift_tracked);
+    RUN_TEST(test_host_and_target_wraparound);
+    RUN_TEST(test_synced_after_min_samples);
+    RUN_TEST(test_negative_duration_is_zero);
+    return UNITY_END();
+}
@@ -0,0 +1,106 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <string>
+#include <vector>
+#include "JsonItems.h"
+
+namespace {
+    struct Walk {
+        std::vector<std::string> items;
+        bool missing;
+        bool malformed;
+    };
+
+    Walk walk(const char* text, const char* key = "commands") {
+        JsonItems items(text, strlen(text), key);
+        Walk result = {{}, false, false};
+        const char* item;
+        size_t length;
+        while (items.next(item, length)) {
+            result.items.emplace_back(item, length);
+        }
+        result.missing = items.isMissing();
+        result.malformed = items.isMalformed();
+        return result;
+    }
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_top_level_array(void) {
+    Walk result = walk(" [ {\"a\":1} , 2,\"x\" ,[3,[4]] ,null]  ");
+    TEST_ASSERT_FALSE(result.malformed);
+    TEST_ASSERT_FALSE(result.missing);
+    TEST_ASSERT_EQUAL(5, result.items.size());
+    TEST_ASSERT_EQUAL_STRING("{\"a\":1}", result.items[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("2", result.items[1].c_str());
+    TEST_ASSERT_EQUAL_STRING("\"x\"", result.items[2].c_str());
+    TEST_ASSERT_EQUAL_STRING("[3,[4]]", result.items[3].c_str());
+    TEST_ASSERT_EQUAL_STRING("null", result.items[4].c_str());
+}
+
+void test_array_under_key(void) {
+    Walk result = walk("{\"other\":{\"commands\":[9]},\"list\":[1,2],\"commands\":[{\"type\":\"led\"}],\"z\":1}");
+    TEST_ASSERT_FALSE(result.malformed);
+    TEST_ASSERT_EQUAL(1, result.items.size());
+    TEST_ASSERT_EQUAL_STRING("{\"type\":\"led\"}", result.items[0].c_str());
+}
+
+void test_brackets_inside_strings(void) {
+    Walk result = walk("[{\"color\":\"]},[\\\"{\"},\"\\\\\"]");
+    TEST_ASSERT_FALSE(result.malformed);
+    TEST_ASSERT_EQUAL(2, result.items.size());
+    TEST_ASSERT_EQUAL_STRING("{\"color\":\"]},[\\\"{\"}", result.items[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("\"\\\\\"", result.items[1].c_str());
+}
+
+void test_empty_array(void) {
+    Walk result = walk("{\"commands\": [ ]}");
+    TEST_ASSERT_EQUAL(0, result.items.size());
+    TEST_ASSERT_FALSE(result.malformed);
+    TEST_ASSERT_FALSE(result.missing);
+}
+
+void test_missing_array(void) {
+    TEST_ASSERT_TRUE(walk("{}").missing);
+    TEST_ASSERT_TRUE(walk("{\"command\":[1]}").missing);
+    TEST_ASSERT_TRUE(walk("{\"commands\":{\"a\":1}}").missing);
+    TEST_ASSERT_TRUE(walk("   ").missing);
+}
+
+void test_malformed(void) {
+    const char* broken[] = {
+        "[1,]",
+        "[1 2]",
+        "[{\"a\":1}",
+        "[\"open",
+        "{\"commands\" [1]}",
+        "{\"x\":1 \"commands\":[1]}",
+        "{\"x\":\"open",
+        "nonsense",
+    };
+    for (const char* text : broken) {
+        TEST_ASSERT_TRUE_MESSAGE(walk(text).malformed, text);
+    }
+}
+
+void test_items_before_error_are_returned(void) {
+    // The caller applies nothing until the walk ends cleanly
+    Walk result = walk("[1,2 3]");
+    TEST_ASSERT_EQUAL(1, result.items.size());
+    TEST_ASSERT_TRUE(result.malformed);
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_top_level_array);
+    RUN_TEST(test_array_under_key);
+    RUN_TEST(test_brackets_inside_strings);
+    RUN_TEST(test_empty_array);
+    RUN_TEST(test_missing_array);
+    RUN_TEST(test_malformed);
+    RUN_TEST(test_items_before_error_are_returned);
+    return UNITY_END();
+}
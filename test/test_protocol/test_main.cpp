@@ -0,0 +1,263 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "Protocol.h"
+
+using Config::MessageType;
+
+namespace {
+    uint8_t frame[Protocol::MAX_FRAME_SIZE];
+
+    // CRC over header bytes 0..5 and the payload, as the writer computes it
+    void rewriteCrc(uint8_t* data) {
+        uint16_t length = Protocol::readU16(data + 4);
+        uint16_t crc = Protocol::crc16(data, 6);
+        crc = Protocol::crc16(data + Protocol::HEADER_SIZE, length, crc);
+        Protocol::writeU16(data + 6, crc);
+    }
+
+    size_t buildSample() {
+        const uint8_t color[3] = {0x10, 0x20, 0x30};
+        const uint8_t effect[1] = {0x07};
+        Protocol::FrameWriter writer(frame, sizeof(frame), 0xBEEF, Protocol::FLAG_RELIABLE);
+        TEST_ASSERT_TRUE(writer.add(MessageType::LED_COMMAND, 5, color, sizeof(color)));
+        TEST_ASSERT_TRUE(writer.addMasked(MessageType::EFFECT_COMMAND, 0x80000011, effect, sizeof(effect)));
+        TEST_ASSERT_TRUE(writer.add(MessageType::TRAINING_STOP, Protocol::TARGET_ALL, nullptr, 0));
+        TEST_ASSERT_EQUAL(3, writer.commandCount());
+        TEST_ASSERT_EQUAL_UINT8(Protocol::TARGET_ALL, writer.destination());
+        return writer.finish();
+    }
+}
+
+void setUp(void) {
+    memset(frame, 0, sizeof(frame));
+}
+
+void tearDown(void) {}
+
+void test_round_trip(void) {
+    size_t size = buildSample();
+    TEST_ASSERT_EQUAL(Protocol::HEADER_SIZE + 3 * Protocol::RECORD_HEADER_SIZE + 3 + Protocol::MASK_SIZE + 1, size);
+
+    Protocol::FrameReader reader(frame, size);
+    TEST_ASSERT_TRUE(reader.isValid());
+    TEST_ASSERT_EQUAL_UINT8(Protocol::VERSION, reader.header().version);
+    TEST_ASSERT_EQUAL_UINT8(Protocol::FLAG_RELIABLE, reader.header().flags);
+    TEST_ASSERT_EQUAL_UINT16(0xBEEF, reader.header().seq);
+
+    Protocol::Command cmd;
+    TEST_ASSERT_TRUE(reader.next(cmd));
+    TEST_ASSERT_EQUAL_UINT8(MessageType::LED_COMMAND, cmd.type);
+    TEST_ASSERT_EQUAL_UINT8(5, cmd.target);
+    TEST_ASSERT_EQUAL_UINT8(3, cmd.length);
+    TEST_ASSERT_EQUAL_UINT8(0x20, cmd.payload[1]);
+    TEST_ASSERT_EQUAL_UINT32(1UL << 5, cmd.mask);
+
+    TEST_ASSERT_TRUE(reader.next(cmd));
+    TEST_ASSERT_EQUAL_UINT8(MessageType::EFFECT_COMMAND, cmd.type);
+    TEST_ASSERT_EQUAL_UINT8(Protocol::TARGET_MASK, cmd.target);
+    TEST_ASSERT_EQUAL_UINT8(1, cmd.length);
+    TEST_ASSERT_EQUAL_UINT8(0x07, cmd.payload[0]);
+    TEST_ASSERT_EQUAL_UINT32(0x80000011, cmd.mask);
+
+    TEST_ASSERT_TRUE(reader.next(cmd));
+    TEST_ASSERT_EQUAL_UINT8(MessageType::TRAINING_STOP, cmd.type);
+    TEST_ASSERT_EQUAL_UINT8(0, cmd.length);
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, cmd.mask);
+
+    TEST_ASSERT_FALSE(reader.next(cmd));
+}
+
+void test_masked_record_addresses_only_its_targets(void) {
+    size_t size = buildSample();
+    Protocol::FrameReader reader(frame, size);
+    Protocol::Command cmd;
+    reader.next(cmd);
+    reader.next(cmd);
+    TEST_ASSERT_TRUE(cmd.addresses(0));
+    TEST_ASSERT_TRUE(cmd.addresses(4));
+    TEST_ASSERT_TRUE(cmd.addresses(31));
+    TEST_ASSERT_FALSE(cmd.addresses(1));
+    TEST_ASSERT_FALSE(cmd.addresses(5));
+    TEST_ASSERT_FALSE(cmd.addresses(32));
+}
+
+void test_masked_record_without_mask_is_rejected(void) {
+    const uint8_t payload[2] = {1, 2};
+    Protocol::FrameWriter writer(frame, sizeof(frame), 1);
+    writer.add(MessageType::EFFECT_COMMAND, Protocol::TARGET_MASK, payload, sizeof(payload));
+    size_t size = writer.finish();
+
+    Protocol::FrameReader reader(frame, size);
+    TEST_ASSERT_TRUE(reader.isValid());
+    Protocol::Command cmd;
+    TEST_ASSERT_FALSE(reader.next(cmd));
+    TEST_ASSERT_FALSE(reader.isValid());
+}
+
+void test_truncated_frame_is_rejected(void) {
+    size_t size = buildSample();
+    for (size_t cut = 1; cut <= size; ++cut) {
+        Protocol::FrameReader reader(frame, size - cut);
+        TEST_ASSERT_FALSE(reader.isValid());
+    }
+}
+
+void test_truncated_record_stops_iteration(void) {
+    size_t size = buildSample();
+    // Last record claims more payload than the frame holds; CRC still right
+    frame[size - Protocol::RECORD_HEADER_SIZE + 2] = 9;
+    rewriteCrc(frame);
+
+    Protocol::FrameReader reader(frame, size);
+    TEST_ASSERT_TRUE(reader.isValid());
+    Protocol::Command cmd;
+    TEST_ASSERT_TRUE(reader.next(cmd));
+    TEST_ASSERT_TRUE(reader.next(cmd));
+    TEST_ASSERT_FALSE(reader.next(cmd));
+    TEST_ASSERT_FALSE(reader.isValid());
+}
+
+void test_corrupt_byte_fails_crc(void) {
+    size_t size = buildSample();
+    // Every bit of the covered header bytes, the CRC and the payload
+    for (size_t i = 0; i < size; ++i) {
+        if (i == 0 || i == 4 || i == 5) {
+            continue;   // Version and length fail their own checks first
+        }
+        for (uint8_t bit = 0; bit < 8; ++bit) {
+            frame[i] ^= 1 << bit;
+            Protocol::FrameReader reader(frame, size);
+            TEST_ASSERT_FALSE(reader.isValid());
+            frame[i] ^= 1 << bit;
+        }
+    }
+    Protocol::FrameReader intact(frame, size);
+    TEST_ASSERT_TRUE(intact.isValid());
+}
+
+void test_cheap_checks_reject_before_crc(void) {
+    size_t size = buildSample();
+    frame[0] = Protocol::VERSION + 1;
+    rewriteCrc(frame);
+    TEST_ASSERT_FALSE(Protocol::FrameReader(frame, size).isValid());
+
+    Protocol::FrameWriter empty(frame, sizeof(frame), 2);
+    size = empty.finish();
+    TEST_ASSERT_EQUAL(Protocol::HEADER_SIZE, size);
+    TEST_ASSERT_FALSE(Protocol::FrameReader(frame, size).isValid());
+
+    TEST_ASSERT_FALSE(Protocol::FrameReader(frame, Protocol::HEADER_SIZE - 1).isValid());
+}
+
+void test_trailing_bytes_are_ignored(void) {
+    size_t size = buildSample();
+    frame[size] = 0xAA;
+    Protocol::FrameReader reader(frame, size + 1);
+    TEST_ASSERT_TRUE(reader.isValid());
+    Protocol::Command cmd;
+    size_t records = 0;
+    while (reader.next(cmd)) {
+        records++;
+    }
+    TEST_ASSERT_EQUAL(3, records);
+}
+
+void test_writer_refuses_what_does_not_fit(void) {
+    uint8_t payload[Protocol::MAX_RECORD_PAYLOAD] = {};
+    Protocol::FrameWriter writer(frame, 32, 3);
+    TEST_ASSERT_TRUE(writer.add(MessageType::LED_COMMAND, 1, payload, 32 - Protocol::HEADER_SIZE - 3));
+    size_t remaining = writer.remaining();
+    TEST_ASSERT_FALSE(writer.add(MessageType::LED_COMMAND, 2, payload, 1));
+    TEST_ASSERT_EQUAL(remaining, writer.remaining());
+    TEST_ASSERT_EQUAL(1, writer.commandCount());
+    TEST_ASSERT_EQUAL_UINT8(1, writer.destination());
+
+    Protocol::FrameWriter large(frame, sizeof(frame), 4);
+    TEST_ASSERT_NULL(large.append(MessageType::LED_COMMAND, 1, Protocol::MAX_RECORD_PAYLOAD + 1));
+}
+
+void test_duplicate_filter_in_order_and_repeats(void) {
+    Protocol::DuplicateFilter filter;
+    TEST_ASSERT_TRUE(filter.accept(100));
+    TEST_ASSERT_FALSE(filter.accept(100));
+    TEST_ASSERT_TRUE(filter.accept(101));
+    TEST_ASSERT_TRUE(filter.accept(103));
+    TEST_ASSERT_TRUE(filter.accept(102));      // Late but unseen
+    TEST_ASSERT_FALSE(filter.accept(102));
+    TEST_ASSERT_FALSE(filter.accept(101));
+}
+
+void test_duplicate_filter_wraps_around(void) {
+    Protocol::DuplicateFilter filter;
+    TEST_ASSERT_TRUE(filter.accept(0xFFFD));
+    TEST_ASSERT_TRUE(filter.accept(0x0001));   // Across the wrap, 4 ahead
+    TEST_ASSERT_TRUE(filter.accept(0xFFFF));
+    TEST_ASSERT_TRUE(filter.accept(0x0000));
+    TEST_ASSERT_FALSE(filter.accept(0xFFFD));
+    TEST_ASSERT_FALSE(filter.accept(0xFFFF));
+    TEST_ASSERT_FALSE(filter.accept(0x0000));
+    TEST_ASSERT_FALSE(filter.accept(0x0001));
+    TEST_ASSERT_TRUE(filter.accept(0xFFFE));
+}
+
+void test_duplicate_filter_window_edges(void) {
+    Protocol::DuplicateFilter filter;
+    TEST_ASSERT_TRUE(filter.accept(1000));
+    TEST_ASSERT_TRUE(filter.accept(1031));
+    TEST_ASSERT_FALSE(filter.accept(1000));    // 31 behind: still remembered
+    TEST_ASSERT_TRUE(filter.accept(1032));
+    TEST_ASSERT_TRUE(filter.accept(1000));     // 32 behind: out of the window, new again
+    // A restarted sender far behind is not ignored
+    TEST_ASSERT_TRUE(filter.accept(7));
+    TEST_ASSERT_FALSE(filter.accept(7));
+}
+
+void test_training_config_round_trip(void) {
+    TrainingModes::TrainingConfig config = {};
+    config.mode = static_cast<TrainingModes::Mode>(2);
+    config.difficulty = static_cast<TrainingModes::Difficulty>(1);
+    config.duration = 600;
+    config.targetCount = 40;
+    config.reactTime = 1500;
+    config.soundEnabled = true;
+    config.stressorsEnabled = false;
+    config.brightness = 200;
+    config.seed = 0xDEADBEEF;
+    config.modeConfig.targetPattern = 3;
+
+    uint8_t payload[Protocol::TRAINING_CONFIG_SIZE];
+    TEST_ASSERT_EQUAL(Protocol::TRAINING_CONFIG_SIZE, Protocol::encodeTrainingConfig(config, payload));
+
+    TrainingModes::TrainingConfig decoded = {};
+    TEST_ASSERT_TRUE(Protocol::decodeTrainingConfig(payload, sizeof(payload), decoded));
+    TEST_ASSERT_EQUAL(config.mode, decoded.mode);
+    TEST_ASSERT_EQUAL(config.difficulty, decoded.difficulty);
+    TEST_ASSERT_EQUAL_UINT16(600, decoded.duration);
+    TEST_ASSERT_EQUAL_UINT16(40, decoded.targetCount);
+    TEST_ASSERT_EQUAL_UINT16(1500, decoded.reactTime);
+    TEST_ASSERT_TRUE(decoded.soundEnabled);
+    TEST_ASSERT_FALSE(decoded.stressorsEnabled);
+    TEST_ASSERT_EQUAL_UINT8(200, decoded.brightness);
+    TEST_ASSERT_EQUAL_UINT32(0xDEADBEEF, decoded.seed);
+    TEST_ASSERT_EQUAL_UINT8(3, decoded.modeConfig.targetPattern);
+
+    TEST_ASSERT_FALSE(Protocol::decodeTrainingConfig(payload, sizeof(payload) - 1, decoded));
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_masked_record_addresses_only_its_targets);
+    RUN_TEST(test_masked_record_without_mask_is_rejected);
+    RUN_TEST(test_truncated_frame_is_rejected);
+    RUN_TEST(test_truncated_record_stops_iteration);
+    RUN_TEST(test_corrupt_byte_fails_crc);
+    RUN_TEST(test_cheap_checks_reject_before_crc);
+    RUN_TEST(test_trailing_bytes_are_ignored);
+    RUN_TEST(test_writer_refuses_what_does_not_fit);
+    RUN_TEST(test_duplicate_filter_in_order_and_repeats);
+    RUN_TEST(test_duplicate_filter_wraps_around);
+    RUN_TEST(test_duplicate_filter_window_edges);
+    RUN_TEST(test_training_config_round_trip);
+    return UNITY_END();
+}
@@ -0,0 +1,205 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <memory>
+#include "ReliableLink.h"
+
+using Config::MessageType;
+
+namespace {
+    constexpr uint32_t INITIAL_RTO_US = Config::Network::RELIABLE_INITIAL_RTO * 1000;
+    constexpr uint32_t MIN_RTO_US = Config::Network::RELIABLE_MIN_RTO * 1000;
+    constexpr uint32_t MAX_RTO_US = Config::Network::RELIABLE_MAX_RTO * 1000;
+    constexpr uint8_t CLIENT = 5;
+
+    std::unique_ptr<ReliableLink> link;
+    const uint8_t payload[4] = {1, 2, 3, 4};
+
+    ReliableLink::Command submit(uint32_t nowUs, MessageType type = MessageType::TRAINING_START) {
+        ReliableLink::Command command;
+        TEST_ASSERT_TRUE(link->submit(CLIENT, type, payload, sizeof(payload), nowUs, command));
+        return command;
+    }
+
+    // One round trip without loss
+    void exchange(uint32_t sentUs, uint32_t rttUs) {
+        ReliableLink::Command command = submit(sentUs);
+        TEST_ASSERT_TRUE(link->acknowledge(CLIENT, command.seq, sentUs + rttUs));
+    }
+}
+
+void setUp(void) {
+    link.reset(new ReliableLink());
+}
+
+void tearDown(void) {
+    link.reset();
+}
+
+void test_initial_rto_until_sampled(void) {
+    TEST_ASSERT_EQUAL_UINT32(INITIAL_RTO_US, link->getRtoUs(CLIENT));
+    TEST_ASSERT_EQUAL_UINT32(ReliableLink::IDLE, link->nextTimeout(CLIENT, 0));
+    submit(0);
+    TEST_ASSERT_EQUAL_UINT32(INITIAL_RTO_US / 1000, link->nextTimeout(CLIENT, 0));
+}
+
+void test_rto_follows_rfc6298(void) {
+    // First sample: SRTT = R, RTTVAR = R/2, RTO = R + 4 * R/2
+    exchange(0, 10000);
+    TEST_ASSERT_EQUAL_UINT32(30000, link->getRtoUs(CLIENT));
+    // RTTVAR = 3/4 * 5000 + 1/4 * |10000 - 30000| = 8750
+    // SRTT = 7/8 * 10000 + 1/8 * 30000 = 12500
+    exchange(100000, 30000);
+    TEST_ASSERT_EQUAL_UINT32(12500 + 4 * 8750, link->getRtoUs(CLIENT));
+}
+
+void test_rto_clamped(void) {
+    exchange(0, 1000);
+    TEST_ASSERT_EQUAL_UINT32(MIN_RTO_US, link->getRtoUs(CLIENT));
+    for (uint32_t i = 1; i <= 4; ++i) {
+        exchange(i * 10000000, 1500000);
+    }
+    TEST_ASSERT_EQUAL_UINT32(MAX_RTO_US, link->getRtoUs(CLIENT));
+}
+
+void test_karn_skips_retransmitted(void) {
+    ReliableLink::Command command = submit(0);
+    std::array<ReliableLink::Command, ReliableLink::WINDOW> due;
+    uint32_t nextMs;
+    TEST_ASSERT_EQUAL(1, link->collectDue(CLIENT, INITIAL_RTO_US, due, nextMs));
+    TEST_ASSERT_EQUAL_UINT16(command.seq, due[0].seq);
+    TEST_ASSERT_EQUAL_UINT8(1, due[0].attempt);
+
+    // The ACK may be for either copy: no RTT sample, but it is delivered
+    TEST_ASSERT_TRUE(link->acknowledge(CLIENT, command.seq, INITIAL_RTO_US + 5000));
+    TEST_ASSERT_EQUAL_UINT32(INITIAL_RTO_US, link->getRtoUs(CLIENT));
+    TEST_ASSERT_EQUAL_UINT32(1, link->getDelivered().get());
+    TEST_ASSERT_EQUAL_UINT32(INITIAL_RTO_US + 5000, link->getDeliveryLatency().getMax());
+}
+
+void test_backoff_doubles_up_to_max(void) {
+    submit(0);
+    std::array<ReliableLink::Command, ReliableLink::WINDOW> due;
+    uint32_t now = INITIAL_RTO_US;
+    uint32_t nextMs;
+    for (uint8_t attempt = 1; attempt <= 4; ++attempt) {
+        TEST_ASSERT_EQUAL(1, link->collectDue(CLIENT, now, due, nextMs));
+        uint32_t expected = std::min<uint32_t>(INITIAL_RTO_US << attempt, MAX_RTO_US);
+        TEST_ASSERT_EQUAL_UINT32(expected / 1000, nextMs);
+        // Not due a microsecond early
+        TEST_ASSERT_EQUAL(0, link->collectDue(CLIENT, now + expected - 1, due, nextMs));
+        now += expected;
+    }
+    TEST_ASSERT_EQUAL_UINT32(4, link->getRetransmits().get());
+}
+
+void test_window_full(void) {
+    uint16_t first = submit(0).seq;
+    for (uint8_t i = 1; i < ReliableLink::WINDOW; ++i) {
+        TEST_ASSERT_EQUAL_UINT16(static_cast<uint16_t>(first + i), submit(i).seq);
+    }
+    ReliableLink::Command command;
+    TEST_ASSERT_FALSE(link->submit(CLIENT, MessageType::TRAINING_STOP, nullptr, 0, 10, command));
+    TEST_ASSERT_EQUAL_UINT8(ReliableLink::WINDOW, link->getInFlight());
+
+    // Other clients have their own window
+    TEST_ASSERT_TRUE(link->submit(CLIENT + 1, MessageType::TRAINING_STOP, nullptr, 0, 10, command));
+
+    TEST_ASSERT_TRUE(link->acknowledge(CLIENT, first + 1, 1000));
+    TEST_ASSERT_TRUE(link->submit(CLIENT, MessageType::TRAINING_STOP, nullptr, 0, 1000, command));
+    TEST_ASSERT_EQUAL_UINT16(static_cast<uint16_t>(first + ReliableLink::WINDOW), command.seq);
+}
+
+void test_rejects_oversized_and_unknown(void) {
+    uint8_t large[ReliableLink::MAX_PAYLOAD + 1] = {};
+    ReliableLink::Command command;
+    TEST_ASSERT_FALSE(link->submit(CLIENT, MessageType::TRAINING_START, large, sizeof(large), 0, command));
+    TEST_ASSERT_FALSE(link->submit(ReliableLink::CAPACITY, MessageType::TRAINING_START, payload, 1, 0, command));
+    TEST_ASSERT_FALSE(link->acknowledge(CLIENT, 1234, 0));
+    TEST_ASSERT_EQUAL_UINT32(0, link->getSent().get());
+}
+
+void test_duplicate_ack_ignored(void) {
+    ReliableLink::Command command = submit(0);
+    TEST_ASSERT_TRUE(link->acknowledge(CLIENT, command.seq, 1000));
+    TEST_ASSERT_FALSE(link->acknowledge(CLIENT, command.seq, 2000));
+    TEST_ASSERT_EQUAL_UINT32(1, link->getDelivered().get());
+}
+
+void test_cancel_drops_one_type(void) {
+    ReliableLink::Command start = submit(0);
+    submit(1);
+    submit(INITIAL_RTO_US / 2, MessageType::TRAINING_STOP);
+    TEST_ASSERT_EQUAL(2, link->cancel(CLIENT, MessageType::TRAINING_START));
+    TEST_ASSERT_EQUAL_UINT32(2, link->getSuperseded().get());
+    TEST_ASSERT_EQUAL_UINT8(1, link->getInFlight());
+    TEST_ASSERT_FALSE(link->acknowledge(CLIENT, start.seq, 1000));
+
+    // Only the stop is left to time out
+    std::array<ReliableLink::Command, ReliableLink::WINDOW> due;
+    uint32_t nextMs;
+    TEST_ASSERT_EQUAL(0, link->collectDue(CLIENT, INITIAL_RTO_US, due, nextMs));
+    TEST_ASSERT_EQUAL_UINT32(INITIAL_RTO_US / 2000, nextMs);
+    TEST_ASSERT_EQUAL(1, link->collectDue(CLIENT, INITIAL_RTO_US * 3 / 2, due, nextMs));
+    TEST_ASSERT_EQUAL(MessageType::TRAINING_STOP, due[0].type);
+}
+
+void test_expires_after_max_retries(void) {
+    ReliableLink::Command command = submit(0);
+    std::array<ReliableLink::Command, ReliableLink::WINDOW> due;
+    uint32_t now = 0;
+    uint32_t nextMs = INITIAL_RTO_US / 1000;
+    for (uint8_t attempt = 1; attempt <= Config::Network::RELIABLE_MAX_RETRIES; ++attempt) {
+        now += nextMs * 1000;
+        TEST_ASSERT_EQUAL(1, link->collectDue(CLIENT, now, due, nextMs));
+        TEST_ASSERT_FALSE(due[0].expired);
+        TEST_ASSERT_EQUAL_UINT8(attempt, due[0].attempt);
+        TEST_ASSERT_EQUAL_MEMORY(payload, due[0].payload, sizeof(payload));
+    }
+
+    now += nextMs * 1000;
+    TEST_ASSERT_EQUAL(1, link->collectDue(CLIENT, now, due, nextMs));
+    TEST_ASSERT_TRUE(due[0].expired);
+    TEST_ASSERT_EQUAL_UINT16(command.seq, due[0].seq);
+    TEST_ASSERT_EQUAL_UINT32(ReliableLink::IDLE, nextMs);
+    TEST_ASSERT_EQUAL_UINT8(0, link->getInFlight());
+    TEST_ASSERT_EQUAL_UINT32(1, link->getFailed().get());
+    TEST_ASSERT_EQUAL_UINT32(Config::Network::RELIABLE_MAX_RETRIES, link->getRetransmits().get());
+    TEST_ASSERT_FALSE(link->acknowledge(CLIENT, command.seq, now + 1000));
+}
+
+void test_deadline_across_wrap(void) {
+    uint32_t start = 0xFFFFFFFF - INITIAL_RTO_US / 2;
+    submit(start);
+    std::array<ReliableLink::Command, ReliableLink::WINDOW> due;
+    uint32_t nextMs;
+    TEST_ASSERT_EQUAL(0, link->collectDue(CLIENT, start + INITIAL_RTO_US / 4, due, nextMs));
+    TEST_ASSERT_EQUAL_UINT32(INITIAL_RTO_US * 3 / 4000, nextMs);
+    TEST_ASSERT_EQUAL(1, link->collectDue(CLIENT, start + INITIAL_RTO_US, due, nextMs));
+}
+
+void test_reset_keeps_rtt(void) {
+    exchange(0, 10000);
+    submit(100000);
+    submit(100001);
+    link->reset(CLIENT);
+    TEST_ASSERT_EQUAL_UINT8(0, link->getInFlight());
+    TEST_ASSERT_EQUAL_UINT32(ReliableLink::IDLE, link->nextTimeout(CLIENT, 100002));
+    TEST_ASSERT_EQUAL_UINT32(30000, link->getRtoUs(CLIENT));
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_initial_rto_until_sampled);
+    RUN_TEST(test_rto_follows_rfc6298);
+    RUN_TEST(test_rto_clamped);
+    RUN_TEST(test_karn_skips_retransmitted);
+    RUN_TEST(test_backoff_doubles_up_to_max);
+    RUN_TEST(test_window_full);
+    RUN_TEST(test_rejects_oversized_and_unknown);
+    RUN_TEST(test_duplicate_ack_ignored);
+    RUN_TEST(test_cancel_drops_one_type);
+    RUN_TEST(test_expires_after_max_retries);
+    RUN_TEST(test_deadline_across_wrap);
+    RUN_TEST(test_reset_keeps_rtt);
+    return UNITY_END();
+}
@@ -0,0 +1,170 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "TrainingModes.h"
+
+using namespace TrainingModes;
+
+namespace {
+    constexpr uint32_t SEED = 0x5EED1234;
+    constexpr uint16_t COUNT = 48;
+
+    TrainingConfig makeConfig(Mode mode, Difficulty difficulty, Pattern pattern, uint16_t count = COUNT) {
+        TrainingConfig config = {};
+        config.mode = mode;
+        config.difficulty = difficulty;
+        config.targetCount = count;
+        config.reactTime = 1200;
+        config.stressorsEnabled = true;
+        config.seed = SEED;
+        config.modeConfig.targetPattern = static_cast<uint8_t>(pattern);
+        return config;
+    }
+
+    // FNV-1a over every field, byte by byte, so the hash does not depend
+    // on struct layout or byte order
+    uint32_t hashSequence(const TrainingConfig& config) {
+        TargetSequence sequence(config);
+        uint32_t hash = 2166136261u;
+        while (sequence.hasNext()) {
+            Target t = sequence.next();
+            const uint8_t bytes[] = {
+                t.x, t.y, t.size, t.color, t.flags, t.direction,
+                static_cast<uint8_t>(t.delay), static_cast<uint8_t>(t.delay >> 8),
+                static_cast<uint8_t>(t.showTime), static_cast<uint8_t>(t.showTime >> 8)
+            };
+            for (uint8_t b : bytes) {
+                hash = (hash ^ b) * 16777619u;
+            }
+        }
+        return hash;
+    }
+
+    // Host and targets must agree on these on every build; a change here
+    // breaks replay of recorded sessions and mixed firmware versions.
+    // Indexed [mode][difficulty][pattern]. Modes with the same traits share
+    // a row (REACTION_TRAINING and COMPETITION), and so do HARD sessions
+    // whose targets are 1 LED anyway.
+    constexpr uint32_t GOLDEN[15][3][4] = {
+        {{0xEEE0FAFF, 0x027DE379, 0x00469B12, 0x40C9174C}, {0x8C041145, 0x7C8EA511, 0xD0CEB917, 0x3BA5C2C0}, {0xC03F9C11, 0x2506E18D, 0x4C72E8B0, 0x1AFC0390}},
+        {{0x32D8C0F0, 0x51D297FB, 0x13981298, 0xAD3C4F3E}, {0x7835100A, 0x762E38CF, 0x1FB47269, 0x5E7820C6}, {0x7F5BA642, 0xB5EBB0A1, 0xC3FB7BE0, 0xD326E284}},
+        {{0x040F1E7C, 0x8D60BAA5, 0x394D90E2, 0xBCEB3A60}, {0x74229C56, 0x422ED1F4, 0xB4E15B8A, 0x31E8B455}, {0x978EC443, 0xA2A3FA4D, 0x801508FC, 0x6586E638}},
+        {{0x40CF5851, 0x44F5F89F, 0x28ED0EC0, 0xDCB58282}, {0x95402A73, 0x1EC286E3, 0x922B7745, 0x49A2AB92}, {0x047554E4, 0xCFD4EB6B, 0x572E8F82, 0x80EAF8F6}},
+        {{0xE3B6EC7B, 0xAD42DCD4, 0x3833B847, 0x65E64705}, {0x4541FF1A, 0x9889D709, 0x32A110B3, 0xFC229EC8}, {0x1E8344CF, 0xFC40B18D, 0xB62AB46C, 0xC4BA11BC}},
+        {{0xF975668D, 0x59D9A42B, 0xAC387AC0, 0x57EA580A}, {0x03623EB3, 0x94987B03, 0x1686CB19, 0x3929C182}, {0x390718EF, 0x1A55AF2F, 0xAC492166, 0xE1D388EA}},
+        {{0xC3DF1C5B, 0xF9A578FD, 0x30922CB1, 0x6FE91D90}, {0x46BE525E, 0xE9048298, 0xE13689E1, 0x7A1C2EEC}, {0xC03F9C11, 0x2506E18D, 0x4C72E8B0, 0x1AFC0390}},
+        {{0x9B17AFA2, 0x0DB485D9, 0xD5018D46, 0xA20FBDB8}, {0x735026CC, 0xED05669A, 0x236B5404, 0x6F40228B}, {0x089AA1FF, 0x56A97B71, 0x7F3945B4, 0x48585E00}},
+        {{0x32D8C0F0, 0x51D297FB, 0x13981298, 0xAD3C4F3E}, {0x7835100A, 0x762E38CF, 0x1FB47269, 0x5E7820C6}, {0x7F5BA642, 0xB5EBB0A1, 0xC3FB7BE0, 0xD326E284}},
+        {{0x3E3BC803, 0x83745DF5, 0xBF51D828, 0xEB8BFE30}, {0x893B6672, 0x7B5AF777, 0x383D17FE, 0xFCD78C96}, {0xA2FF45EB, 0x8BFACCD6, 0xB71A3017, 0x27D6EB0B}},
+        {{0x52A501B7, 0xDD704B53, 0xD78BEF8C, 0xCA970A02}, {0x7BC7026A, 0x2FA12B45, 0xC133AAF3, 0xA1807160}, {0x274AA0DC, 0x02426467, 0x10C97FE2, 0x2EF6CF6E}},
+        {{0xCF2FF332, 0xAD328E09, 0x33162E86, 0xC7457B48}, {0xC72BBDFC, 0x4A3C864A, 0x9C4220F4, 0x03C75D0B}, {0xD6AD63DF, 0xF4C15EF1, 0x83E04594, 0x9BDB3590}},
+        {{0x638C83D9, 0x6DC3903D, 0xB6DF04F8, 0xDB0FDD10}, {0x8A9830F1, 0x9611847D, 0xE24331A0, 0x3868F06C}, {0xC03F9C11, 0x2506E18D, 0x4C72E8B0, 0x1AFC0390}},
+        {{0x9D54152D, 0x036652A2, 0x40C30BF5, 0x83F05137}, {0xE400A65D, 0xB77AB2EE, 0xB22DDB5C, 0x44B6158B}, {0xF79D10D7, 0x3AC4B610, 0xCAAD2585, 0x824EB671}},
+        {{0xDF9F76CD, 0x0B2FB87B, 0x18600A9C, 0x821AF87A}, {0xA61FD66B, 0x36C99BFC, 0xE6361D72, 0x6FDA397D}, {0xBB265241, 0xBF3FEA1C, 0x030513B1, 0x6FE835C5}},
+    };
+
+    void assertTarget(const Target& expected, const Target& actual) {
+        TEST_ASSERT_EQUAL_UINT8(expected.x, actual.x);
+        TEST_ASSERT_EQUAL_UINT8(expected.y, actual.y);
+        TEST_ASSERT_EQUAL_UINT8(expected.size, actual.size);
+        TEST_ASSERT_EQUAL_UINT8(expected.color, actual.color);
+        TEST_ASSERT_EQUAL_UINT8(expected.flags, actual.flags);
+        TEST_ASSERT_EQUAL_UINT8(expected.direction, actual.direction);
+        TEST_ASSERT_EQUAL_UINT16(expected.delay, actual.delay);
+        TEST_ASSERT_EQUAL_UINT16(expected.showTime, actual.showTime);
+    }
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_golden_hashes(void) {
+    for (uint8_t m = 0; m < 15; ++m) {
+        for (uint8_t d = 0; d < 3; ++d) {
+            for (uint8_t p = 0; p < 4; ++p) {
+                TrainingConfig config = makeConfig(static_cast<Mode>(m), static_cast<Difficulty>(d), static_cast<Pattern>(p));
+                char message[48];
+                snprintf(message, sizeof(message), "mode %u difficulty %u pattern %u", m, d, p);
+                TEST_ASSERT_EQUAL_UINT32_MESSAGE(GOLDEN[m][d][p], hashSequence(config), message);
+            }
+        }
+    }
+}
+
+// Spelled out, so a failing hash can be told apart from a changed field
+void test_golden_hostage_rescue_hard_random(void) {
+    const Target expected[] = {
+        // x, y, size, color, flags, direction, delay, showTime
+        {5, 0, 1, COLOR_GREEN, TARGET_MOVING, 2, 1463, 1200},
+        {7, 3, 1, COLOR_GREEN, TARGET_MOVING, 0, 633, 1200},
+        {7, 0, 1, COLOR_GREEN, TARGET_MOVING, 3, 1498, 1200},
+        {0, 3, 1, COLOR_RED, TARGET_NO_SHOOT | TARGET_MOVING, 6, 687, 1200},
+        {2, 2, 1, COLOR_RED, TARGET_NO_SHOOT | TARGET_MOVING, 7, 484, 1200},
+        {5, 4, 1, COLOR_GREEN, TARGET_MOVING, 5, 1483, 1200},
+    };
+    TargetSequence sequence(makeConfig(Mode::HOSTAGE_RESCUE, Difficulty::HARD, Pattern::RANDOM, 6));
+    for (const Target& target : expected) {
+        TEST_ASSERT_TRUE(sequence.hasNext());
+        assertTarget(target, sequence.next());
+    }
+    TEST_ASSERT_FALSE(sequence.hasNext());
+}
+
+void test_golden_adrenaline_medium_spiral(void) {
+    const Target expected[] = {
+        {4, 4, 2, COLOR_GREEN, 0, 0, 701, 1308},
+        {4, 4, 2, COLOR_GREEN, 0, 0, 1016, 1012},
+        {4, 5, 2, COLOR_GREEN, 0, 0, 988, 960},
+        {2, 4, 2, COLOR_GREEN, TARGET_DISTRACTOR, 0, 1896, 756},
+        {3, 2, 2, COLOR_GREEN, 0, 0, 1922, 960},
+        {5, 1, 2, COLOR_GREEN, 0, 0, 1170, 581},
+    };
+    TargetSequence sequence(makeConfig(Mode::ADRENALINE, Difficulty::MEDIUM, Pattern::SPIRAL, 6));
+    for (const Target& target : expected) {
+        assertTarget(target, sequence.next());
+    }
+    TEST_ASSERT_EQUAL_UINT16(6, sequence.position());
+}
+
+void test_seed_changes_sequence(void) {
+    TrainingConfig config = makeConfig(Mode::REACTION_TRAINING, Difficulty::MEDIUM, Pattern::RANDOM);
+    uint32_t base = hashSequence(config);
+    config.seed = SEED + 1;
+    TEST_ASSERT_TRUE(hashSequence(config) != base);
+    config.seed = SEED;
+    TEST_ASSERT_EQUAL_UINT32(base, hashSequence(config));
+}
+
+void test_targets_fit_matrix(void) {
+    for (uint8_t m = 0; m < 15; ++m) {
+        for (uint8_t d = 0; d < 3; ++d) {
+            for (uint8_t p = 0; p < 4; ++p) {
+                TargetSequence sequence(makeConfig(static_cast<Mode>(m), static_cast<Difficulty>(d), static_cast<Pattern>(p)));
+                while (sequence.hasNext()) {
+                    Target target = sequence.next();
+                    TEST_ASSERT_TRUE(target.size >= 1);
+                    TEST_ASSERT_TRUE(target.x + target.size <= 8);
+                    TEST_ASSERT_TRUE(target.y + target.size <= 8);
+                    TEST_ASSERT_TRUE(target.showTime > 0);
+                    TEST_ASSERT_TRUE(target.direction < 8);
+                }
+            }
+        }
+    }
+}
+
+void test_empty_session(void) {
+    TargetSequence sequence(makeConfig(Mode::BASIC_TRAINING, Difficulty::EASY, Pattern::SEQUENCE, 0));
+    TEST_ASSERT_FALSE(sequence.hasNext());
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_golden_hashes);
+    RUN_TEST(test_golden_hostage_rescue_hard_random);
+    RUN_TEST(test_golden_adrenaline_medium_spiral);
+    RUN_TEST(test_seed_changes_sequence);
+    RUN_TEST(test_targets_fit_matrix);
+    RUN_TEST(test_empty_session);
+    return UNITY_END();
+}